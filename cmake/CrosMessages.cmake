@@ -0,0 +1,23 @@
+# Generation of the C message types (see include/cros_typed_message.h)
+#
+# cros_generate_messages(<target> <msg_root_dir> <output_dir> <pkg/Type.msg | pkg/Type.srv>...)
+#
+# Adds the target <target>, which runs cros-msggen to write the header <output_dir>/<pkg>/<Type>.h of each message
+# or service file listed (relative to msg_root_dir). Add <output_dir> to the include directories and make the
+# programs that use the headers depend on <target>.
+
+function(cros_generate_messages target msg_root_dir output_dir)
+  set(generated_headers)
+  set(source_files)
+  foreach(msg_file ${ARGN})
+    string(REGEX REPLACE "\\.(msg|srv)$" ".h" header_file ${msg_file})
+    list(APPEND generated_headers ${output_dir}/${header_file})
+    list(APPEND source_files ${msg_root_dir}/${msg_file})
+  endforeach()
+
+  add_custom_command(OUTPUT ${generated_headers}
+                     COMMAND cros-msggen ${msg_root_dir} ${output_dir} ${ARGN}
+                     DEPENDS cros-msggen ${source_files}
+                     COMMENT "Generating the C message types of ${target}" VERBATIM)
+  add_custom_target(${target} DEPENDS ${generated_headers})
+endfunction()
@@ -4,6 +4,7 @@
 #include "xmlrpc_params.h"
 #include "cros_node.h"
 #include "cros_message.h"
+#include "cros_typed_message.h"
 #include "cros_err_codes.h"
 
 #define CROS_INFINITE_TIMEOUT ~0UL
@@ -305,11 +306,21 @@ typedef CallbackResponse (*ServiceProviderApiCallback)(cRosMessage *request, cRo
 typedef CallbackResponse (*SubscriberApiCallback)(cRosMessage *message,  void *context);
 /*! \brief Application-defined callback function which is called by the library */
 typedef CallbackResponse (*PublisherApiCallback)(cRosMessage *message, void *context);
+// Callbacks of the typed publishers and subscribers: message points to the struct of the generated type (see cros_typed_message.h)
+typedef CallbackResponse (*TypedSubscriberApiCallback)(void *message, void *context);
+typedef CallbackResponse (*TypedPublisherApiCallback)(void *message, void *context);
 
 // Transfer data from message buffer (context_) of the Publisher/Service caller to the output ROS packet buffer (buffer)
 cRosErrCodePack cRosNodeSerializeOutgoingMessage(DynBuffer *buffer, void *context_);
+// Transfer the outgoing message of the Publisher (context_) to the packet of frame. The frame takes the memory of the
+// variable-length numeric arrays of at least min_ext_size bytes (0 copies them all) and sends it without copying it
+cRosErrCodePack cRosNodeSerializeOutgoingFrame(TcprosFrame *frame, void *context_, size_t min_ext_size);
 // Transfer data from packet buffer (buffer) of the Service caller to the input mesage buffer (context_)
 cRosErrCodePack cRosNodeDeserializeIncomingPacket(DynBuffer *buffer, void *context_);
+// Same as cRosNodeDeserializeIncomingPacket() but the numeric arrays of the input message are left in the packet (see cRosMessageDeserializeView())
+cRosErrCodePack cRosNodeDeserializeIncomingView(SharedBuffer *packet, void *context_);
+// Same as cRosNodeDeserializeIncomingPacket() but the fields of the input message are decoded when accessed (see cRosMessageDeserializeLazy())
+cRosErrCodePack cRosNodeDeserializeIncomingLazy(SharedBuffer *packet, void *context_);
 
 // Intermediary functions that call the user callback functions
 // context is a structure (object) opaque for the caller function
@@ -318,6 +329,23 @@ cRosErrCodePack cRosNodePublisherCallback(void *context_);
 cRosErrCodePack cRosNodeServiceCallerCallback(int call_resp_flag, void* contex_);
 cRosErrCodePack cRosNodeServiceProviderCallback(void *context_);
 void cRosNodeStatusCallback(CrosNodeStatusUsr *status, void* context_);
+// Like cRosNodeSubscriberCallback(), but the user callback is run by the node worker pool through the subscriber strand.
+// The received message is moved into a cRosSharedMessage read by the callback and held by the subscriber queue
+cRosErrCodePack cRosNodePostSubscriberCallback(CrosWorkStrand *strand, void *context_);
+// Deserialize a service request and hand it to the service-provider callback through the provider strand. The response
+// is returned in the node finished_svc_works queue
+cRosErrCodePack cRosNodePostServiceProviderCallback(CrosNode *n, CrosWorkStrand *strand, DynBuffer *packet,
+                                                    int server_idx, uint32_t seq, void *context_);
+// Returns the message in which the publisher callback stores the message to be sent
+cRosMessage *cRosNodeContextOutgoingMsg(void *context_);
+// Hand a message of a publisher in the same process to a subscriber: the callback (run through strand if it is not NULL)
+// reads the shared message itself and the queue of the subscriber keeps a reference to it, so nothing is copied
+cRosErrCodePack cRosNodeDeliverIntraProcessMsg(cRosSharedMessage *s_msg, void *sub_context_, CrosWorkStrand *strand);
+// Enlarge the block pool of the message type of a publisher or subscriber so that its queue of n_blocks messages reuses
+// their memory (see cRosMessageDefReservePoolSize())
+cRosErrCodePack cRosNodeContextReservePool(void *context_, int n_blocks);
+// Returns 1 if the context belongs to a typed publisher or subscriber, 0 otherwise
+int cRosNodeContextIsTyped(void *context_);
 
 // Master api: register/unregister methods
 cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service_name, const char *service_type, int loop_period, ServiceCallerApiCallback callback, NodeStatusApiCallback status_callback, void *context, int persistent, int tcp_nodelay, int *svcidx_ptr);
@@ -331,6 +359,13 @@ void cRosApiReleaseSubscriber(CrosNode *node, int subidx);
 cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period, PublisherApiCallback callback, NodeStatusApiCallback status_callback, void *context, int *pubidx_ptr);
 cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx);
 void cRosApiReleasePublisher(CrosNode *node, int pubidx);
+// Publishers and subscribers of a message type generated by cros-msggen: the messages are serialized and deserialized
+// by the generated code instead of through cRosMessage objects. The type identification (type name, MD5 sum and
+// definition) is taken from type, so no message definition file is loaded. The typed subscribers do not queue the
+// received messages (cRosNodeReceiveTopicMsg() does not get them): the callback receives a struct that is reused for
+// the next message. They are unregistered with cRosApiUnregisterSubscriber() and cRosApiUnregisterPublisher()
+cRosErrCodePack cRosApiRegisterTypedSubscriber(CrosNode *node, const char *topic_name, const cRosTypedMessageType *type, TypedSubscriberApiCallback callback, NodeStatusApiCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr);
+cRosErrCodePack cRosApiRegisterTypedPublisher(CrosNode *node, const char *topic_name, const cRosTypedMessageType *type, int loop_period, TypedPublisherApiCallback callback, NodeStatusApiCallback status_callback, void *context, int *pubidx_ptr);
 
 // Master api: name service and system state
 cRosErrCodePack cRosApiLookupNode(CrosNode *node, const char *node_name, LookupNodeCallback callback, void *context, int *caller_id_ptr);
@@ -398,9 +433,97 @@ cRosErrCodePack cRosApiGetParamNames(CrosNode *node, GetParamNamesCallback callb
 
 // Message polling
 cRosErrCodePack cRosNodeReceiveTopicMsg(CrosNode *node, int subidx, cRosMessage *msg, unsigned char *buff_overflow, unsigned long time_out);
+// Extract up to max_msgs messages from the queue of a subscriber in one call (in arrival order, in msgs[0], msgs[1], ...)
+// after running the node until the queue holds at least min_msgs messages (0 does not wait) or time_out msec elapse.
+// The messages get the fields of the queue slots in exchange for their own ones, so nothing is copied if they are
+// (or are empty messages that become) of the subscriber type. *n_msgs is set to the number of extracted messages, which
+// are returned even if CROS_RCV_TOP_TIMEOUT_ERR indicates that there were fewer than min_msgs. min_msgs greater than the
+// queue size (see cRosNodeSetSubscriberQueueSize()) waits for a full queue
+cRosErrCodePack cRosNodeReceiveTopicMsgs(CrosNode *node, int subidx, cRosMessage **msgs, int max_msgs, int min_msgs, int *n_msgs, unsigned char *buff_overflow, unsigned long time_out);
 cRosErrCodePack cRosNodeQueueTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg );
 cRosErrCodePack cRosNodeSendTopicMsg(CrosNode *node, int pubidx, cRosMessage *msg, unsigned long time_out);
+// Thread-safe cRosNodeQueueTopicMsg(): it can be called from any thread while another one runs the node, and it only waits
+// for the node thread while it registers or releases a publisher. CROS_TOPIC_PUB_IND_ERR is returned if pubidx is not a
+// registered publisher (e.g., it has just been released)
+cRosErrCodePack cRosNodePostTopicMsg(CrosNode *node, int pubidx, cRosMessage *msg);
+// Publish a message of a typed publisher right away: msg (a struct of the publisher type) is serialized once and queued
+// in all the subscriber connections, without any intermediate cRosMessage. The message is dropped if no subscriber is
+// connected. It must be called from the thread that runs the node
+cRosErrCodePack cRosNodeSendTypedMsg(CrosNode *node, int pubidx, const void *msg);
+// Run the subscriber and service-provider callbacks in a pool of n_threads worker threads instead of in cRosNodeDoEventsLoop(),
+// so that slow callbacks do not stall the node sockets. The callbacks of each subscriber (or service provider) are still run
+// in order and one at a time. queue_size is the maximum num messages (or requests) of each one waiting for a worker
+// (lower than 1 selects CN_CALLBACK_QUEUE_SIZE): received messages that do not fit are not passed to the callback (the
+// overflow flag of cRosNodeReceiveTopicMsg() is set) and requests that do not fit are answered with a failure.
+// The callbacks can only use the thread-safe functions of the node (e.g., cRosNodePostTopicMsg()) and their errors are
+// logged instead of returned by cRosNodeDoEventsLoop(). A subscriber callback reads the received message that is also kept
+// in the subscriber queue (which copies it only if it is extracted before the callback ends), so it must not modify it.
+// n_threads = 0 runs the callbacks in cRosNodeDoEventsLoop() again
+cRosErrCodePack cRosNodeSetCallbackThreads(CrosNode *node, int n_threads, int queue_size);
+// Size and overflow policy of the outgoing queue of each subscriber connection of a publisher
+cRosErrCodePack cRosNodeSetPublisherConnQueue(CrosNode *node, int pubidx, int queue_size, TcprosFrameQueuePolicy policy);
+// Send the messages of at least min_size bytes of a publisher with MSG_ZEROCOPY where supported (0 disables it)
+cRosErrCodePack cRosNodeSetPublisherZeroCopy(CrosNode *node, int pubidx, size_t min_size);
+// Deliver the variable-length numeric arrays of the messages received by a subscriber as views of the received packets
+// instead of copying them (see cRosMessageDeserializeView()). Each packet is freed when the last message that points into
+// it is freed or overwritten, so the callback and cRosNodeReceiveTopicMsg() get the array data without any copy (enable = 0
+// goes back to copying the arrays)
+cRosErrCodePack cRosNodeSetSubscriberZeroCopy(CrosNode *node, int subidx, int enable);
+// Decode the fields of the messages received by a subscriber only when the callback (or the receiver of the queued
+// messages) accesses them through cRosMessageGetField() or the field handles (see cRosMessageDeserializeLazy()), so that
+// reading a few fields of large messages does not cost decoding all of them. The received packets are kept until the
+// messages are completely decoded, freed or overwritten, and the decoded numeric arrays are views of them (enable = 0 goes
+// back to decoding the messages when they are received)
+cRosErrCodePack cRosNodeSetSubscriberLazy(CrosNode *node, int subidx, int enable);
+// Maximum number of received messages of a subscriber kept in its queue for cRosNodeReceiveTopicMsg() (MAX_QUEUE_LEN by
+// default). Fast topics read by a slow consumer can use deep queues and the rest can use shallow ones, down to 1 message.
+// If the queue holds more messages than queue_size, the oldest ones are dropped. The block pool of the message type is
+// enlarged to fit the queue (see CN_MESSAGE_POOL_SIZE)
+cRosErrCodePack cRosNodeSetSubscriberQueueSize(CrosNode *node, int subidx, int queue_size);
+// What to do when a message is received by a subscriber and its queue is full (CROS_SUB_QUEUE_DROP_NEWEST by default):
+// discard the received message, discard the oldest queued message or (CROS_SUB_QUEUE_KEEP_LATEST) keep only the latest
+// received message even if the queue is not full. CROS_SUB_QUEUE_BLOCK discards nothing: the subscriber connections are not
+// read until cRosNodeReceiveTopicMsg() makes room in the queue, so TCP flow control slows the publishers down. Hence, with
+// CROS_SUB_QUEUE_BLOCK the queued messages must be extracted or the subscriber stops receiving after filling its queue
+cRosErrCodePack cRosNodeSetSubscriberQueuePolicy(CrosNode *node, int subidx, CrosSubscriberQueuePolicy policy);
+// Number of received messages of a subscriber discarded by its queue policy (or by shrinking its queue) since it was registered
+cRosErrCodePack cRosNodeGetSubscriberDroppedMsgs(CrosNode *node, int subidx, unsigned long *n_dropped);
+// Maximum number of messages of a publisher waiting to be sent (MAX_QUEUE_LEN by default), which were queued by
+// cRosNodeSendTopicMsg() or cRosNodePostTopicMsg(). The block pool of the message type is enlarged to fit the queue
+cRosErrCodePack cRosNodeSetPublisherQueueSize(CrosNode *node, int pubidx, int queue_size);
+// Connect the publishers and subscribers of this node with the ones of the other nodes of the process that enable it too
+// (and with each other) without sockets: a subscriber that finds a publisher of the same topic and type in one of these
+// nodes skips the requestTopic call and the TCPROS connection, and the publisher then hands each message to the subscriber
+// without serializing it. All the subscribers share one read-only copy of each message (or the message itself if the
+// publisher has no periodic callback nor TCPROS connections), so their callbacks must not modify it. The message is
+// delivered by the thread that runs the node of each subscriber (the nodes can be run by different threads), and the
+// subscriber queue only copies it if it is extracted while it is still shared. If a subscriber node lags
+// CN_SUBSCRIBER_INTRA_QUEUE_SIZE messages behind, the newer messages are dropped and counted like the ones dropped by the
+// subscriber queue. Typed publishers and subscribers keep using TCPROS. It must be enabled before registering the
+// publishers and subscribers of the node: disabling it drops the intra-process connections of the node, which are not
+// replaced by TCPROS ones
+cRosErrCodePack cRosNodeSetIntraProcess(CrosNode *node, int enable);
 cRosErrCodePack cRosNodeServiceCall(CrosNode *node, int svcidx, cRosMessage *req_msg, cRosMessage *resp_msg, unsigned long time_out);
+// Non-blocking service call: cRosNodeServiceCallStart() queues the request, which is sent by the node loop, and
+// cRosNodeServiceCallFinish() gets the response once it has been received (CROS_CALL_SVC_TIMEOUT_ERR is returned before).
+// Only one call of each service caller can be in progress (CROS_CALL_INI_TIMEOUT_ERR is returned otherwise).
+// The completion can be waited for together with other events through a wait set (see cRosWaitSetAddServiceCall())
+cRosErrCodePack cRosNodeServiceCallStart(CrosNode *node, int svcidx, cRosMessage *req_msg);
+cRosErrCodePack cRosNodeServiceCallFinish(CrosNode *node, int svcidx, cRosMessage *resp_msg);
+// Wait sets: a thread can wait for several subscribers (a message in the queue), service calls (the response of a call
+// started with cRosNodeServiceCallStart()) and file descriptors of its own (readable, e.g., an eventfd written by another
+// thread) at once. cRosWaitSetWait() runs the node until any member is ready or time_out msec elapse
+// (CROS_WAIT_SET_TIMEOUT_ERR), and cRosWaitSetIsReady() tells which members were. The Add functions return the index
+// of the new member in *member_idx_ptr. The file descriptors are only monitored during cRosWaitSetWait() and must remain
+// open meanwhile. The set does not extract anything: the ready members are then read with cRosNodeReceiveTopicMsg(),
+// cRosNodeServiceCallFinish(), etc.
+void cRosWaitSetInit(CrosWaitSet *ws, CrosNode *node);
+void cRosWaitSetRelease(CrosWaitSet *ws);
+cRosErrCodePack cRosWaitSetAddSubscriber(CrosWaitSet *ws, int subidx, int *member_idx_ptr);
+cRosErrCodePack cRosWaitSetAddServiceCall(CrosWaitSet *ws, int svcidx, int *member_idx_ptr);
+cRosErrCodePack cRosWaitSetAddFd(CrosWaitSet *ws, int fd, int *member_idx_ptr);
+cRosErrCodePack cRosWaitSetWait(CrosWaitSet *ws, int *n_ready_ptr, unsigned long time_out);
+int cRosWaitSetIsReady(CrosWaitSet *ws, int member_idx);
 cRosMessage *cRosApiCreatePublisherMessage(CrosNode *node, int pubidx);
 cRosMessage *cRosApiCreateServiceCallerRequest(CrosNode *node, int svcidx);
 
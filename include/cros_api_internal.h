@@ -106,6 +106,41 @@ void cRosNodeReleaseServiceCaller(ServiceCallerNode *node);
  */
 void cRosNodeReleaseParameterSubscrition(ParameterSubscription *subscription);
 
+/*! \brief Add a Tcpros server proc index to the list of processes that send the messages of a publisher
+ *
+ *  The list is enlarged if needed.
+ *  \param pub Pointer to the publisher
+ *  \param server_idx Index of the Tcpros server proc
+ *  \return Returns 0 on success or -1 on failure (e.g., No memory available)
+ */
+int cRosNodePublisherAddTcprosProc(PublisherNode *pub, int server_idx);
+
+/*! \brief Make the node attend a publisher in the next cycle of cRosNodeDoEventsLoop() (e.g., because a message has been
+ *         queued or a subscriber has connected), instead of waiting for its next periodic publication
+ *
+ *  \param n Pointer to the CrosNode object
+ *  \param pub_idx Index of the publisher
+ *  \return Returns 0 on success or -1 on failure (e.g., No memory available)
+ */
+int cRosNodeWakeUpPublisher( CrosNode *n, int pub_idx );
+
+/*! \brief Queue a serialized message in the outgoing queues of all the subscriber connections of a publisher
+ *
+ *  The connections whose queue is full are closed. Each connection takes its own reference to the frame.
+ *  \param n Pointer to the CrosNode object
+ *  \param pub_idx Index of the publisher
+ *  \param frame Sealed frame that contains the message
+ */
+void cRosNodePublishFrame( CrosNode *n, int pub_idx, TcprosFrame *frame );
+
+/*! \brief Make room in the queue of a subscriber for a message that is going to be queued, according to the queue policy
+ *         of the subscriber (see cRosNodeSetSubscriberQueuePolicy())
+ *
+ *  The overflow flag and the dropped-message counter of the subscriber are updated.
+ *  \param sub_node Pointer to the subscriber
+ */
+void cRosNodeApplySubscriberQueuePolicy( SubscriberNode *sub_node );
+
 /*! \brief Search for a Tcpros client proc that is currently not assigned
  *         to any subscriber and assign it to the specified subscriber
  *
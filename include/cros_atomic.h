@@ -0,0 +1,38 @@
+#ifndef _CROS_ATOMIC_H_
+#define _CROS_ATOMIC_H_
+
+/*! \defgroup cros_atomic cROS atomic operations
+ *
+ *  Minimal set of atomic operations used by the data structures that are shared with other threads
+ *  (see cros_mpsc_queue.h). The loads have acquire semantics, the stores have release semantics and
+ *  the read-modify-write operations are full barriers.
+ *  NOTE: these are cROS internal macros, usually you don't need to use them.
+ */
+
+/*! \addtogroup cros_atomic
+ *  @{
+ */
+
+#if defined(_MSC_VER)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#  define CROS_ATOMIC_LOAD_PTR(ptr) InterlockedCompareExchangePointer((PVOID volatile *)(ptr), NULL, NULL)
+#  define CROS_ATOMIC_STORE_PTR(ptr, val) ((void)InterlockedExchangePointer((PVOID volatile *)(ptr), (PVOID)(val)))
+#  define CROS_ATOMIC_XCHG_PTR(ptr, val) InterlockedExchangePointer((PVOID volatile *)(ptr), (PVOID)(val))
+#  define CROS_ATOMIC_LOAD_INT(ptr) InterlockedCompareExchange((LONG volatile *)(ptr), 0, 0)
+#  define CROS_ATOMIC_STORE_INT(ptr, val) ((void)InterlockedExchange((LONG volatile *)(ptr), (LONG)(val)))
+#  define CROS_ATOMIC_XCHG_INT(ptr, val) InterlockedExchange((LONG volatile *)(ptr), (LONG)(val))
+#  define CROS_ATOMIC_FETCH_ADD_INT(ptr, val) InterlockedExchangeAdd((LONG volatile *)(ptr), (LONG)(val))
+#else
+#  define CROS_ATOMIC_LOAD_PTR(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#  define CROS_ATOMIC_STORE_PTR(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#  define CROS_ATOMIC_XCHG_PTR(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+#  define CROS_ATOMIC_LOAD_INT(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#  define CROS_ATOMIC_STORE_INT(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#  define CROS_ATOMIC_XCHG_INT(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+#  define CROS_ATOMIC_FETCH_ADD_INT(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_SEQ_CST)
+#endif
+
+/*! @}*/
+
+#endif
@@ -31,6 +31,14 @@ struct timeval cRosClockGetTimeSecUsec( void );
  */
 uint64_t cRosClockGetTimeMs( void );
 
+/*! \brief Return the current value of a monotonic clock, expressed in nanoseconds.
+ *         The origin of the clock is arbitrary, so only differences between values are meaningful.
+ *         Unlike cRosClockGetTimeMs(), the value is not affected by changes of the system time
+ *
+ *  \return The current monotonic time in ns
+ */
+uint64_t cRosClockGetTimeNs( void );
+
 /*! \brief Convert an interval expressed as milliseconds in a timeval structure,
  *         that express the same interval as seconds and microseconds
  *
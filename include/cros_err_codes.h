@@ -55,6 +55,10 @@
   MSG_COD_ELEM(CROS_SOCK_OPEN_TIMEOUT_ERR, "The specified timeout was up while waiting for the specified port to be open") \
   MSG_COD_ELEM(CROS_SOCK_OPEN_CONN_ERR, "An error occurred when the specified target port was tried to be connected (target address could not be resolved?)") \
   MSG_COD_ELEM(CROS_EXTRACT_MSG_INT_ERR, "An internal error occurred when sending an inmediate message: The message could not be extracted from the queue") \
+  MSG_COD_ELEM(CROS_POST_QUEUE_FULL_ERR, "The message could not be posted because too many messages posted from other threads are waiting to be sent") \
+  MSG_COD_ELEM(CROS_CALLBACK_QUEUE_FULL_ERR, "The callback could not be run because too many received messages or service requests are waiting for a worker thread") \
+  MSG_COD_ELEM(CROS_MSG_FIELD_PATH_ERR, "The specified field path does not correspond to a field of the message type (only nested non-array messages can be traversed)") \
+  MSG_COD_ELEM(CROS_WAIT_SET_TIMEOUT_ERR, "The specified timeout was up while waiting for a member of the wait set to become ready") \
   MSG_COD_ELEM(LAST_ERR_LIST_CODE, "") // Sentinel code used to mark the last element of the global error list
 
 #define CROS_SUCCESS_ERR_PACK 0U //! Function return value indicating success
@@ -0,0 +1,110 @@
+#ifndef _CROS_EVENT_BACKEND_H_
+#define _CROS_EVENT_BACKEND_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "tcpip_socket.h"
+
+/*! \defgroup cros_event_backend cROS event backend
+ *
+ *  I/O readiness notification used by the node event loop. The sockets are registered once
+ *  and their interest set is only modified when the state of the owner process changes, so the
+ *  event loop does not have to rebuild the monitored descriptor sets in every iteration.
+ *  On Linux epoll() is used; select() is kept as the portable fallback.
+ */
+
+/*! \addtogroup cros_event_backend
+ *  @{
+ */
+
+#define CROS_EVENT_READ   0x1 //! The socket is ready for reading (or for accepting a connection)
+#define CROS_EVENT_WRITE  0x2 //! The socket is ready for writing (or an asynchronous connection has completed)
+#define CROS_EVENT_EXCEPT 0x4 //! An exceptional condition is pending on the socket
+
+typedef enum CrosEventBackendType
+{
+  CROS_EVENT_BACKEND_SELECT = 0,
+  CROS_EVENT_BACKEND_EPOLL
+} CrosEventBackendType;
+
+// Backend used by the nodes. It can be overridden at build time (e.g., -DCROS_EVENT_BACKEND_DEFAULT=CROS_EVENT_BACKEND_SELECT)
+#ifndef CROS_EVENT_BACKEND_DEFAULT
+#  ifdef __linux__
+#    define CROS_EVENT_BACKEND_DEFAULT CROS_EVENT_BACKEND_EPOLL
+#  else
+#    define CROS_EVENT_BACKEND_DEFAULT CROS_EVENT_BACKEND_SELECT
+#  endif
+#endif
+
+/*! \brief Readiness notification of a registered socket */
+typedef struct CrosEvent CrosEvent;
+struct CrosEvent
+{
+  uint32_t tag; //! Identifier specified when the socket was registered
+  unsigned int events; //! Combination of CROS_EVENT_READ, CROS_EVENT_WRITE and CROS_EVENT_EXCEPT
+};
+
+/*! \brief Socket registered in a select() backend */
+typedef struct CrosEventBackendEntry CrosEventBackendEntry;
+struct CrosEventBackendEntry
+{
+  TcpIpSocket *socket; //! Registered socket. The entry is discarded when the socket is closed
+  uint32_t tag; //! Identifier returned in the CrosEvent when the socket becomes ready
+};
+
+typedef struct CrosEventBackend CrosEventBackend;
+struct CrosEventBackend
+{
+  CrosEventBackendType type; //! Mechanism used to wait for the socket events
+  int epoll_fd; //! epoll instance (only used by the epoll backend)
+  void *os_events; //! Buffer filled by epoll_wait() (only used by the epoll backend)
+  int os_events_max; //! Number of elements allocated in os_events
+  int timer_fd; //! timerfd used for the timeouts that are not a whole number of milliseconds, or -1 (only used by the epoll backend)
+  int timer_armed; //! If 1, timer_fd has been armed by the last wait (only used by the epoll backend)
+  CrosEventBackendEntry *entries; //! Registered sockets (only used by the select backend)
+  size_t n_entries; //! Number of elements used in entries
+  size_t max_entries; //! Number of elements allocated in entries
+};
+
+/*! \brief Initialize an event backend
+ *
+ *  If the requested backend type is not available, the select() backend is used instead.
+ *  \param b Pointer to the CrosEventBackend object
+ *  \param type Requested backend type (usually CROS_EVENT_BACKEND_DEFAULT)
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosEventBackendInit( CrosEventBackend *b, CrosEventBackendType type );
+
+/*! \brief Release the resources of an event backend
+ *
+ *  \param b Pointer to the CrosEventBackend object
+ */
+void cRosEventBackendRelease( CrosEventBackend *b );
+
+/*! \brief Set the events that are monitored for a socket
+ *
+ *  The registration is persistent: it remains until a different interest set is specified or
+ *  until the socket is closed. Nothing is done if the specified interest set is the one already registered.
+ *  \param b Pointer to the CrosEventBackend object
+ *  \param s Socket to monitor. It is ignored if it is not open
+ *  \param events Combination of CROS_EVENT_READ, CROS_EVENT_WRITE and CROS_EVENT_EXCEPT. 0 stops monitoring the socket
+ *  \param tag Identifier returned in the CrosEvent when the socket becomes ready
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosEventBackendSetInterest( CrosEventBackend *b, TcpIpSocket *s, unsigned int events, uint32_t tag );
+
+/*! \brief Wait until some of the registered sockets become ready or the timeout is up
+ *
+ *  \param b Pointer to the CrosEventBackend object
+ *  \param events Array where the ready sockets are returned
+ *  \param max_events Maximum number of elements that can be stored in events
+ *  \param time_out Maximum time to wait in nanoseconds. The epoll backend honors it with sub-millisecond resolution
+ *         (through a timerfd); the select() backend rounds it up to whole milliseconds
+ *  \return Returns the number of elements stored in events, 0 on timeout or interruption, -1 on failure
+ */
+int cRosEventBackendWait( CrosEventBackend *b, CrosEvent *events, int max_events, uint64_t time_out );
+
+/*! @}*/
+
+#endif
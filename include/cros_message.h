@@ -2,6 +2,7 @@
 #define _CROS_MESSAGE_H_
 
 #include "dyn_buffer.h"
+#include "shared_buffer.h"
 #include "cros_err_codes.h"
 
 /*! \defgroup cros_message cROS TCPROS
@@ -78,38 +79,136 @@ struct cRosMessageField
     int is_fixed_array;
     int array_size;
     int array_capacity;
+    int is_view; //! 1 if the array elements point into a received packet (see cRosMessageDeserializeView()). They are copied before the array is resized
     CrosMessageType type;
     char *type_s;
 };
 
 typedef struct t_msgDef cRosMessageDef;
-
+typedef struct t_msgLayout cRosMessageLayout;
+typedef struct t_msgLazyState cRosMessageLazyState;
+
+/*! A message built by cRosMessageBuildFromDef() uses the compiled layout of its type (layout field):
+ *  all its fields and nested non-array messages are stored in a single memory block.
+ *  The nested non-array messages must not be freed or replaced independently of their parent.
+ *  view_buffer is the received packet that the array views of the message fields point into (see cRosMessageDeserializeView()).
+ *  lazy_state records the fields of a message received by cRosMessageDeserializeLazy() that have not been decoded yet */
 struct cRosMessage
 {
     cRosMessageField **fields;
     cRosMessageDef *msgDef;
     char *md5sum;
     int n_fields;
+    cRosMessageLayout *layout;
+    SharedBuffer *view_buffer;
+    cRosMessageLazyState *lazy_state;
+};
+
+/*! \brief Message read by several holders (e.g., a subscriber queue and the worker thread that runs the subscriber callback)
+ *         instead of copied for each one. The message must not be modified while it is shared. The reference count is
+ *         updated atomically, so the references can be released from any thread */
+typedef struct cRosSharedMessage cRosSharedMessage;
+struct cRosSharedMessage
+{
+    int ref_count;                      //! Number of references to the message
+    cRosMessage msg;                    //! Shared message (without message definition)
 };
 
 cRosMessage * cRosMessageNew(void);
 
 void cRosMessageInit(cRosMessage *message);
 
+/*! \brief Build the definition of a message type from its .msg file (msg_root_dir/msg_type.msg, or msg_type if msg_root_dir is NULL).
+ *         Each file is loaded, parsed and its MD5 sum computed only the first time that it is used in the process: the definitions
+ *         are kept in a process-wide cache (keyed by the file path) and the following calls get a reference to the cached
+ *         definition, which is shared by the messages built from it and must not be modified
+ *
+ *  \param msg_def_ptr Pointer to the variable that receives the definition, which must be released with cRosMessageDefFree()
+ *  \param msg_root_dir Directory of the message packages or NULL
+ *  \param msg_type Message type (e.g. std_msgs/String) or path of the .msg file if msg_root_dir is NULL
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
 cRosErrCodePack cRosMessageDefBuild(cRosMessageDef **msg_def_ptr, const char *msg_root_dir, const char *msg_type);
 
+/*! \brief Free the process-wide cache of message definitions, so that the next built definitions are loaded again from their files.
+ *         The messages already built are not affected. It must not be called while other threads are building messages
+ */
+void cRosMessageDefCacheClear(void);
+
 cRosErrCodePack cRosMessageNewBuild(const char *msg_root_dir, const char *msg_type, cRosMessage **new_msg_ptr);
 
+/*! \brief Keep the memory blocks of the freed messages of a type for the new messages of the type, so that building, copying
+ *         and freeing these messages (e.g., in a cRosMessageQueue) do not allocate and free their fields, names and nested
+ *         messages one by one. Only strings and variable-length arrays are still allocated independently.
+ *         The pool is shared by all the messages built from msg_def and its copies, and it can be used from any thread
+ *
+ *  \param msg_def Definition of the message type
+ *  \param n_blocks Maximum number of free blocks kept in the pool. 0 frees the pooled blocks and disables the pool
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
+cRosErrCodePack cRosMessageDefSetPoolSize(cRosMessageDef *msg_def, int n_blocks);
+
+/*! \brief Enlarge the block pool of a message type (see cRosMessageDefSetPoolSize()) so that it keeps at least n_blocks free
+ *         blocks. The pool is never shrunk, so each user of a shared definition can reserve the blocks it needs without
+ *         reducing the ones reserved by the others
+ *
+ *  \param msg_def Definition of the message type
+ *  \param n_blocks Minimum number of free blocks kept in the pool
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
+cRosErrCodePack cRosMessageDefReservePoolSize(cRosMessageDef *msg_def, int n_blocks);
+
 void cRosMessageFieldsPrint(cRosMessage *msg, int n_indent);
 
 int cRosMessageFieldCopy(cRosMessageField *new_field, cRosMessageField *orig_field);
 
 int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src);
 
+/*! \brief Exchange the fields (and MD5 sum) of two messages without copying them, so that the content of a message can be moved
+ *         into another one in constant time. The message definitions (msgDef) are not exchanged.
+ *         The messages must have been allocated independently: nested messages (the as_msg field data of another message)
+ *         cannot be swapped
+ *
+ *  \param m1 Pointer to the first message
+ *  \param m2 Pointer to the second message
+ */
+void cRosMessageFieldsSwap(cRosMessage *m1, cRosMessage *m2);
+
 cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src);
 
 cRosMessage *cRosMessageCopy(cRosMessage *m_src);
 
+/*! \brief Create a shared message that takes the fields of a message without copying them: m receives the fields of a new
+ *         (zeroed) message of the same type, taken from the block pool of the type if enabled, so it can be reused (e.g.,
+ *         to deserialize the next received message). If m was not built from a compiled layout, its fields are copied.
+ *         The fields of m not decoded yet (see cRosMessageDeserializeLazy()) are decoded first, since the holders of the
+ *         shared message can read it from different threads
+ *
+ *  \param m Pointer to the message to be moved
+ *  \return A pointer to the new shared message, with a reference count of 1, or NULL on failure (m keeps its fields)
+ */
+cRosSharedMessage *cRosSharedMessageNewMove(cRosMessage *m);
+
+/*! \brief Create a shared message with a copy of the fields of a message (see cRosSharedMessageNewMove())
+ *
+ *  \param m Pointer to the message to be copied
+ *  \return A pointer to the new shared message, with a reference count of 1, or NULL on failure
+ */
+cRosSharedMessage *cRosSharedMessageNewCopy(cRosMessage *m);
+
+/*! \brief Add a reference to a shared message
+ *
+ *  \param s_msg Pointer to a cRosSharedMessage object, or NULL
+ *  \return s_msg
+ */
+cRosSharedMessage *cRosSharedMessageRetain(cRosSharedMessage *s_msg);
+
+/*! \brief Remove a reference to a shared message, freeing it when no reference is left
+ *
+ *  \param s_msg Pointer to a cRosSharedMessage object, or NULL
+ */
+void cRosSharedMessageRelease(cRosSharedMessage *s_msg);
+
 cRosErrCodePack cRosMessageBuildFromDef(cRosMessage **message, cRosMessageDef *msg_def );
 
 void cRosMessageFree(cRosMessage *message);
@@ -188,12 +287,144 @@ int cRosMessageFieldArrayAtMsgSet(cRosMessageField *field, int position, cRosMes
 
 int cRosMessageFieldArrayClear(cRosMessageField *field);
 
+/*! \brief Make room for n_elems elements in a variable-length array of numbers (or bool, char or byte), so that they can
+ *         then be pushed back without reallocating the array
+ *
+ *  \param field The array field
+ *  \param n_elems Number of elements that the array must be able to hold
+ *  \return 0 on success, -1 if the field is not a variable-length numeric array or no memory could be allocated
+ */
+int cRosMessageFieldArrayReserve(cRosMessageField *field, int n_elems);
+
+/*! \brief Set the number of elements of a variable-length array of numbers (or bool, char or byte). The new elements are
+ *         set to zero, so that the array can then be filled in place (e.g., through cRosMessageFieldArrayAtFloat64(field, 0))
+ *
+ *  \param field The array field
+ *  \param n_elems New number of elements
+ *  \return 0 on success, -1 if the field is not a variable-length numeric array (or a fixed-length one of n_elems elements)
+ *          or no memory could be allocated
+ */
+int cRosMessageFieldArrayResize(cRosMessageField *field, int n_elems);
+
+/*! \brief Replace the elements of an array of numbers (or bool, char or byte) with a copy of n_elems elements, in a single copy
+ *
+ *  \param field The array field
+ *  \param data Pointer to the new elements, which must be of the type of the array elements (e.g., double for float64[])
+ *  \param n_elems Number of new elements. It must be the array length for fixed-length arrays
+ *  \return 0 on success, -1 if the field is not a numeric array, n_elems is not valid or no memory could be allocated
+ */
+int cRosMessageFieldArrayAssign(cRosMessageField *field, const void *data, int n_elems);
+
+/*! \brief Make a variable-length array of numbers (or bool, char or byte) use the elements of a buffer without copying them.
+ *         The previous elements are freed and the message takes the ownership of the buffer
+ *
+ *  \param field The array field
+ *  \param data Buffer allocated with malloc() that contains the elements, of the type of the array elements. It is freed
+ *              with free() by the message
+ *  \param n_elems Number of elements in the buffer
+ *  \param capacity Number of elements that fit in the buffer (not lower than n_elems), which can be used by the next push backs
+ *  \return 0 on success or -1 if the field is not a variable-length numeric array or the parameters are not valid (then the
+ *          buffer is not adopted)
+ */
+int cRosMessageFieldArrayAdopt(cRosMessageField *field, void *data, int n_elems, int capacity);
+
+typedef struct cRosMessageFieldHandle cRosMessageFieldHandle;
+
+/*! \brief Resolve the path of a field in the messages of a type into a handle, so that the field can then be accessed in constant
+ *         time (without searching it by name) in any message of this type.
+ *         The path elements are field names separated by '.' (e.g., "header.stamp.secs"). All the path elements but the last one
+ *         must be nested messages (not arrays)
+ *
+ *  \param msg_def Definition of the message type (e.g., msgDef of a message created with cRosApiCreatePublisherMessage())
+ *  \param path Path of the field
+ *  \param handle_ptr Pointer to the variable that receives the new handle. It must be freed with cRosMessageFieldHandleFree()
+ *  \return CROS_SUCCESS_ERR_PACK on success, CROS_MSG_FIELD_PATH_ERR if the path does not correspond to a field, or other error code
+ */
+cRosErrCodePack cRosMessageFieldHandleResolve(cRosMessageDef *msg_def, const char *path, cRosMessageFieldHandle **handle_ptr);
+
+void cRosMessageFieldHandleFree(cRosMessageFieldHandle *handle);
+
+/*! \brief Get the field of a message corresponding to a handle
+ *
+ *  \param message The message. It should be of the type of the handle
+ *  \param handle The field handle
+ *  \return A pointer to the field or NULL if the message does not contain the field
+ */
+cRosMessageField *cRosMessageGetFieldByHandle(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+//! Get a pointer to the value of a numeric (non-array) field through its handle. NULL is returned if the field type does not match
+int8_t *cRosMessageHandleAtInt8(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+int16_t *cRosMessageHandleAtInt16(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+int32_t *cRosMessageHandleAtInt32(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+int64_t *cRosMessageHandleAtInt64(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+uint8_t *cRosMessageHandleAtUInt8(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+uint16_t *cRosMessageHandleAtUInt16(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+uint32_t *cRosMessageHandleAtUInt32(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+uint64_t *cRosMessageHandleAtUInt64(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+float *cRosMessageHandleAtFloat32(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+double *cRosMessageHandleAtFloat64(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+const char *cRosMessageHandleStringGet(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
+int cRosMessageHandleStringSet(cRosMessage *message, const cRosMessageFieldHandle *handle, const char *val);
+
 size_t cRosMessageSize(cRosMessage *message);
 
 cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer *buffer);
 
 cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer *buffer);
 
+/*! \brief Deserialize a message without copying its variable-length arrays of numeric types (and bool, char and byte):
+ *         these fields become views that point into the packet, and the message keeps a reference to the packet
+ *         until it is freed or deserialized again. The other fields are copied as in cRosMessageDeserialize().
+ *         The view elements are shared with the copies of the message, so they should be only read. An array
+ *         that is resized is first copied into its own memory.
+ *         Only the messages built from a message definition (cRosMessageBuildFromDef()) support views, and the
+ *         array elements that are not aligned in the packet to their size are copied too
+ *
+ *  \param message The message to be filled
+ *  \param packet Packet containing the serialized message, starting at its position indicator. It must not be modified
+ *                while it is shared
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
+cRosErrCodePack cRosMessageDeserializeView(cRosMessage *message, SharedBuffer *packet);
+
+/*! \brief Deserialize a message on demand: the packet is only scanned to find where each field starts, and each field is
+ *         decoded the first time that it is accessed through cRosMessageGetField(), cRosMessageGetFieldByHandle() or the
+ *         cRosMessageHandleAt*() functions. The message keeps a reference to the packet until all its fields are decoded, or
+ *         it is freed or deserialized again. The decoded variable-length numeric arrays are views of the packet
+ *         (see cRosMessageDeserializeView()).
+ *         The rest of the functions that use the whole message (e.g., cRosMessageSerialize() or cRosMessageFieldsPrint())
+ *         decode the pending fields first, and the copies of the message decode their fields on demand too. The fields that
+ *         are accessed directly (message->fields) must be decoded first with cRosMessageDecodePending().
+ *         The fields are decoded as a whole, so accessing a field of a nested message decodes all the nested message.
+ *         Only the messages built from a message definition (cRosMessageBuildFromDef()) support lazy decoding, and the
+ *         fixed-size messages are always decoded at once, since they are read in a single copy
+ *
+ *  \param message The message to be filled
+ *  \param packet Packet containing the serialized message, starting at its position indicator. It must not be modified
+ *                while it is shared
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise. The whole packet is checked, so a truncated
+ *          message is reported here and not when its fields are accessed
+ */
+cRosErrCodePack cRosMessageDeserializeLazy(cRosMessage *message, SharedBuffer *packet);
+
+/*! \brief Decode the fields of a message received by cRosMessageDeserializeLazy() that have not been accessed yet
+ *
+ *  \param message The message
+ *  \return CROS_SUCCESS_ERR_PACK on success (also if the message has no pending fields) or the error code otherwise
+ */
+cRosErrCodePack cRosMessageDecodePending(cRosMessage *message);
+
 CrosMessageType getMessageType(const char *type);
 
 const char * getMessageTypeString(CrosMessageType type);
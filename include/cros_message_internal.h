@@ -2,7 +2,10 @@
 #define _CROS_MESSAGE_INTERNAL_H_
 
 #include "dyn_string.h"
+#include "cros_message.h"
 #include "cros_err_codes.h"
+#include "cros_thread.h"
+#include "tcpros_frame.h"
 
 static const char* FILEEXT_MSG = "msg";
 
@@ -72,10 +75,83 @@ struct t_msgDef
     msgFieldDef* first_field;
     msgConst* constants;
     msgConst* first_const;
+    cRosMessageLayout* layout; // Compiled layout of the message instances, built the first time that a message is built from this definition
+    int ref_count; // Number of owners (messages, parent definitions, cache, ...) of the definition, which is freed by the last cRosMessageDefFree()
 };
 
 typedef struct t_msgDef cRosMessageDef;
 
+// Compiled layout of a message type.
+// All the instances of a message built from a layout keep the following in a single memory block (pointed by message->fields):
+// the field pointer array, the field structs, the field names and type strings, the elements of fixed-length arrays
+// (or the element pointers for string and message arrays) and, recursively, the nested non-array messages
+// (cRosMessage struct, MD5 sum and block). Only the strings, the variable-length arrays and the messages
+// of message arrays are allocated separately.
+typedef enum CrosLayoutFieldKind
+{
+  CROS_LAYOUT_SCALAR = 0,     // Builtin numeric field
+  CROS_LAYOUT_FIXED_ARRAY,    // Fixed-length array of builtin numeric elements
+  CROS_LAYOUT_ARRAY,          // Variable-length array of builtin numeric elements
+  CROS_LAYOUT_STRING,         // String field
+  CROS_LAYOUT_STRING_ARRAY,   // Fixed or variable-length array of strings
+  CROS_LAYOUT_MSG,            // Nested message embedded in the block of its parent
+  CROS_LAYOUT_MSG_ARRAY       // Fixed or variable-length array of nested messages
+} CrosLayoutFieldKind;
+
+struct t_msgLayoutField
+{
+    CrosLayoutFieldKind kind;
+    CrosMessageType type;
+    int array_size;           // Number of elements of fixed-length arrays, -1 for variable-length arrays and 0 for the rest of fields
+    size_t elem_size;         // Size of the field (or array element) value in the wire for builtin numeric types, 0 otherwise
+    size_t scalar_run_size;   // Wire size of the consecutive scalar fields starting at this one, 0 if this field is not scalar
+    size_t name_offset;       // Offset of the field name in the block
+    size_t type_s_offset;     // Offset of the field type string in the block, 0 if the field has no type string
+    size_t data_offset;       // Offset of the fixed-length array elements or of the embedded nested message in the block
+    cRosMessageLayout* child; // Layout of the nested message type (time, duration, header and custom types)
+};
+
+typedef struct t_msgLayoutField msgLayoutField;
+
+struct t_msgLayout
+{
+    int ref_count;            // Number of definitions, messages and parent layouts that use the layout
+    int n_fields;
+    msgLayoutField* fields;
+    size_t block_size;        // Size of the memory block of an instance
+    size_t strings_offset;    // Offset of the field names and type strings in the block
+    size_t strings_size;
+    char* strings;            // Field names and type strings, copied into each block
+    int is_fixed_size;        // 1 if the messages have no strings and no variable-length arrays, so all of them take wire_size bytes in the packets
+    size_t wire_size;         // Serialized size of the messages (only valid if is_fixed_size is 1)
+    char md5sum[33];          // MD5 sum of the type (empty for the builtin time, duration and header types)
+    CrosMutex pool_lock;      // Protects the block pool, since messages are also released by the callback worker threads
+    int pool_size;            // Maximum number of released memory blocks kept for new messages (0 disables the pool)
+    int n_pool_blocks;        // Number of blocks in the pool
+    void* pool_first;         // Blocks in the pool, linked through their first bytes
+};
+
+// Fields of a message received by cRosMessageDeserializeLazy() that are still in the packet.
+// Lazy decoding only applies to the fields of the top-level message: each one is decoded as a whole
+struct t_msgLazyState
+{
+    SharedBuffer* packet;     // Packet that contains the pending fields, NULL when all the fields have been decoded
+    int n_fields;
+    int n_pending;            // Number of fields not decoded yet
+    size_t* field_offsets;    // Offset of each field in the packet data
+    unsigned char* pending;   // 1 for each field not decoded yet
+};
+
+struct cRosMessageFieldHandle
+{
+    cRosMessageLayout* layout; // Layout of the message type against which the path was resolved
+    size_t field_offset;      // Offset of the field struct in the memory block of the messages of this layout
+    CrosMessageType type;
+    int is_array;
+    int depth;                // Number of elements of the path
+    int* field_inds;          // Field index of each path element, used with the messages that were not built from the layout
+};
+
 struct t_msgDep
 {
     cRosMessageDef* msg;
@@ -114,6 +190,75 @@ cRosErrCodePack loadFromFileMsg(char* filename, cRosMessageDef* msg);
 
 cRosErrCodePack cRosMessageDefCopy(cRosMessageDef** ptr_new_msg_def, cRosMessageDef* orig_msg_def );
 
+// Take a new reference to a definition, which is shared instead of copied. It returns msgDef
+cRosMessageDef *cRosMessageDefRetain(cRosMessageDef *msgDef);
+
+// Release a reference to a definition. The definition is freed when the last reference is released
 void cRosMessageDefFree(cRosMessageDef *msgDef);
 
+unsigned char *getMD5Msg(cRosMessageDef* msg);
+
+int arrayFieldValuesPushBack(cRosMessageField *field, const void* data, int element_size, int n_new_elements);
+
+// Copy the elements of an array field that is a view of a received packet into its own memory, so that it can be modified
+int arrayFieldDetachView(cRosMessageField *field);
+
+// Compiled message layouts (cros_message_layout.c)
+
+// Get the layout of the messages built from msg_def. It is compiled the first time, the following calls return the same layout
+cRosErrCodePack cRosMessageLayoutGet(cRosMessageDef *msg_def, cRosMessageLayout **layout_ptr);
+
+cRosMessageLayout *cRosMessageLayoutRetain(cRosMessageLayout *layout);
+
+void cRosMessageLayoutRelease(cRosMessageLayout *layout);
+
+// Check whether the messages of two layouts have the same fields, so that their values can be copied in place
+int cRosMessageLayoutIsSameType(cRosMessageLayout *layout1, cRosMessageLayout *layout2);
+
+// Build a new message of the specified layout. The fields are set to zero
+cRosErrCodePack cRosMessageLayoutNewMessage(cRosMessage **message_ptr, cRosMessageLayout *layout);
+
+// Build the fields of a message without fields according to a layout. On error the message is left without fields
+cRosErrCodePack cRosMessageLayoutFieldsAlloc(cRosMessage *message, cRosMessageLayout *layout);
+
+// Free the memory of the fields of a message built from a layout that is allocated out of its memory block, and its lazy decoding state
+void cRosMessageLayoutFieldsRelease(cRosMessage *message);
+
+// Free the memory block of a message built from a layout, or keep it in the block pool of the layout
+void cRosMessageLayoutBlockFree(cRosMessageLayout *layout, void *block);
+
+// Set the size of the block pool of a layout and of the layouts of its nested message arrays
+void cRosMessageLayoutSetPoolSize(cRosMessageLayout *layout, int pool_size);
+
+// Enlarge the block pool of a layout and of the layouts of its nested message arrays to at least pool_size blocks
+void cRosMessageLayoutReservePoolSize(cRosMessageLayout *layout, int pool_size);
+
+// Copy the field values of m_src into m_dst reusing the memory of m_dst. The layouts of both messages must be of the same type
+int cRosMessageLayoutFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src);
+
+cRosErrCodePack cRosMessageLayoutSerialize(cRosMessage *message, DynBuffer *buffer);
+
+// Serialize the message into the packet of the frame. The variable-length numeric arrays of at least min_ext_size bytes
+// that are not views are given to the frame, which sends them from their own memory (the arrays of the message are left
+// empty). min_ext_size = 0 copies all the arrays into the packet
+cRosErrCodePack cRosMessageLayoutSerializeFrame(cRosMessage *message, TcprosFrame *frame, size_t min_ext_size);
+
+// Like cRosMessageSerialize() but into the packet of the frame, giving it the large arrays of the message as
+// cRosMessageLayoutSerializeFrame() does (messages without layout are copied completely)
+cRosErrCodePack cRosMessageSerializeFrame(cRosMessage *message, TcprosFrame *frame, size_t min_ext_size);
+
+cRosErrCodePack cRosMessageLayoutDeserialize(cRosMessage *message, DynBuffer *buffer);
+
+// Deserialize the message from the packet, leaving its variable-length numeric arrays as views of the packet
+cRosErrCodePack cRosMessageLayoutDeserializeView(cRosMessage *message, SharedBuffer *packet);
+
+// Scan the packet to find the fields of the message, which are decoded when accessed (see cRosMessageDeserializeLazy())
+cRosErrCodePack cRosMessageLayoutDeserializeLazy(cRosMessage *message, SharedBuffer *packet);
+
+// Decode a field of a message if it is still pending in the packet of a lazy deserialization
+cRosErrCodePack cRosMessageLayoutDecodeField(cRosMessage *message, int field_ind);
+
+// Decode all the pending fields of a message
+cRosErrCodePack cRosMessageLayoutDecodePending(cRosMessage *message);
+
 #endif // _CROS_MESSAGE_INTERNAL_H_
@@ -14,11 +14,13 @@
 #include "cros_message.h"
 
 
-#define MAX_QUEUE_LEN 10 //! Maximum number of messages that can be hold in the queue
+#define MAX_QUEUE_LEN 10 //! Default maximum number of messages that can be hold in the queue (see cRosMessageQueueSetCapacity())
 
 struct cRosMessageQueue
 {
-  cRosMessage msgs[MAX_QUEUE_LEN]; //! Content of the queue
+  cRosMessage *msgs; //! Content of the queue: a circular buffer of capacity messages, allocated when the first message is added
+  cRosSharedMessage **shared; //! Shared message held by each position of msgs instead of its own fields, or NULL (see cRosMessageQueueAddShared())
+  unsigned int capacity; //! Maximum number of messages that can be hold in the queue
   unsigned int length; //! Number of messages currently in the queue
   unsigned int first_msg_ind; //! Index of the oldest message in the queue (the one that was inserted first)
 };
@@ -27,11 +29,27 @@ typedef struct cRosMessageQueue cRosMessageQueue;
 
 /*! \brief Initializes a queue.
  *
- *  This function must be called before using a queue for the first time.
+ *  This function must be called before using a queue for the first time. The queue can hold MAX_QUEUE_LEN messages.
  *  \param q Pointer to the queue.
  */
 void cRosMessageQueueInit(cRosMessageQueue *q);
 
+/*! \brief Change the maximum number of messages that can be hold in the queue.
+ *
+ *  If the queue contains more messages than the new capacity, the oldest ones are removed.
+ *  \param q Pointer to the queue.
+ *  \param capacity New maximum number of messages. It must be at least 1.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory (the queue is not modified), -2 = invalid capacity.
+ */
+int cRosMessageQueueSetCapacity(cRosMessageQueue *q, unsigned int capacity);
+
+/*! \brief Get the maximum number of messages that can be hold in the queue.
+ *
+ *  \param q Pointer to the queue.
+ *  \return The capacity of the queue.
+ */
+unsigned int cRosMessageQueueCapacity(cRosMessageQueue *q);
+
 /*! \brief Empty queue.
  *
  *  This function removes all the messages in a queue.
@@ -80,6 +98,44 @@ int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m);
  */
 int cRosMessageQueueExtract(cRosMessageQueue *q, cRosMessage *m);
 
+/*! \brief Move a message at the end of the queue.
+ *
+ *  This function adds a new element (message) at the end of the queue without copying its fields: the fields of the message
+ *  pointed by m are moved into the queue and m receives the fields of a new (zeroed) message of the same type, so it can be reused
+ *  (for example, to deserialize the next received message). If m was not built from a compiled layout, its fields are copied as
+ *  cRosMessageQueueAdd() does.
+ *  \param q Pointer to the queue.
+ *  \param m Pointer to the message to be moved.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory, -2 = No free space to add a new element. If an error
+ *          occurs, m is not modified.
+ */
+int cRosMessageQueueAddMove(cRosMessageQueue *q, cRosMessage *m);
+
+/*! \brief Add a reference to a shared message at the end of the queue.
+ *
+ *  This function adds a new element (message) at the end of the queue without copying its fields: the queue keeps a reference
+ *  to the shared message until it is removed, and the message is only copied if it is extracted (or got) while other holders
+ *  still share it. cRosMessageQueuePeekFirst() and cRosMessageQueuePeekLast() return the shared message, which must not be modified.
+ *  \param q Pointer to the queue.
+ *  \param s_msg Pointer to the shared message to be added.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory, -2 = No free space to add a new element. If an error
+ *          occurs, no reference is added.
+ */
+int cRosMessageQueueAddShared(cRosMessageQueue *q, cRosSharedMessage *s_msg);
+
+/*! \brief Extract the first message of the queue by moving its fields.
+ *
+ *  This function removes a element (message) at the start of the queue and moves its fields to the message pointed by m without
+ *  copying them. The previous fields of m are freed. If m already contains fields of a different message type (or the message in
+ *  the queue was not built from a compiled layout), the fields are copied as cRosMessageQueueExtract() does. A shared message
+ *  (see cRosMessageQueueAddShared()) is only moved if the queue holds its last reference, otherwise it is copied.
+ *  \param q Pointer to the queue.
+ *  \param m Pointer to the message that receives the fields of the removed message.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory, -2 = No messages in the queue. If an error occurs, the
+ *          message is not removed from the queue.
+ */
+int cRosMessageQueueExtractMove(cRosMessageQueue *q, cRosMessage *m);
+
 /*! \brief Get a copy of the first message from the queue.
  *
  *  This function obtains the element (message) at the start of the queue. The fields of the message at the start of the queue will be copied
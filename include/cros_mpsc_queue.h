@@ -0,0 +1,56 @@
+#ifndef _CROS_MPSC_QUEUE_H_
+#define _CROS_MPSC_QUEUE_H_
+
+/*! \defgroup cros_mpsc_queue cROS MPSC queue
+ *
+ *  Lock-free, unbounded, intrusive FIFO queue for multiple producers and a single consumer.
+ *  Any thread can push elements without blocking (a push is one atomic exchange), while only one thread
+ *  (the one running the node event loop) pops them. The elements embed a CrosMpscNode, so the queue
+ *  does not allocate memory.
+ *  A pop can transiently fail to see an element whose push has not completed yet, so producers that
+ *  need the consumer to notice the element must notify it after the push (see tcpIpSocketNotify()).
+ *  NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+
+/*! \addtogroup cros_mpsc_queue
+ *  @{
+ */
+
+typedef struct CrosMpscNode CrosMpscNode;
+struct CrosMpscNode
+{
+  CrosMpscNode *next; //! Next (more recently pushed) element of the queue
+};
+
+typedef struct CrosMpscQueue CrosMpscQueue;
+struct CrosMpscQueue
+{
+  CrosMpscNode *head; //! Most recently pushed element (modified by the producers)
+  CrosMpscNode *tail; //! Oldest element (only used by the consumer)
+  CrosMpscNode stub;  //! Dummy element that keeps the queue non-empty internally
+};
+
+/*! \brief Initialize an empty queue. The queue must not be moved in memory afterwards
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ */
+void cRosMpscQueueInit( CrosMpscQueue *q );
+
+/*! \brief Append an element to the queue. It can be called from any thread
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ *  \param n Pointer to the link embedded in the element
+ */
+void cRosMpscQueuePush( CrosMpscQueue *q, CrosMpscNode *n );
+
+/*! \brief Extract the oldest element of the queue. It must only be called from the consumer thread
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ *  \return The pointer to the link embedded in the element, or NULL if the queue is empty
+ *          (or the push of its oldest element has not completed yet)
+ */
+CrosMpscNode *cRosMpscQueuePop( CrosMpscQueue *q );
+
+/*! @}*/
+
+#endif
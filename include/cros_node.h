@@ -22,6 +22,11 @@
 #include "cros_api_call.h"
 #include "cros_message_queue.h"
 #include "cros_err_codes.h"
+#include "cros_event_backend.h"
+#include "cros_slot_table.h"
+#include "cros_timer_heap.h"
+#include "cros_mpsc_queue.h"
+#include "cros_worker_pool.h"
 
 /*! \defgroup cros_node cROS Node */
 
@@ -29,56 +34,96 @@
  *  @{
  */
 
-/*! Max num published topics */
+/*! The node tables grow when needed. The following values are their default initial sizes,
+ *  which can be changed through the CrosNodeCapacityHints passed to cRosNodeCreateEx() */
+
+/*! Default initial num published topics */
 #define CN_MAX_PUBLISHED_TOPICS 5
 
-/*! Max num subscribed topics */
+/*! Default initial num subscribed topics */
 #define CN_MAX_SUBSCRIBED_TOPICS 5
 
-/*! Max num service providers */
+/*! Default initial num service providers */
 #define CN_MAX_SERVICE_PROVIDERS 8
 
-/*! Max num service callers */
+/*! Default initial num service callers */
 #define CN_MAX_SERVICE_CALLERS 8
 
-/*! Max num parameter subscriptions */
+/*! Default initial num parameter subscriptions */
 #define CN_MAX_PARAMETER_SUBSCRIPTIONS 20
 
-/*! Max num serving XMLRPC connections */
+/*! Default initial num serving XMLRPC connections */
 #define CN_MAX_XMLRPC_SERVER_CONNECTIONS 5
 
-/*! Max num serving TCPROS connections */
+/*! Default initial num serving TCPROS connections */
 #define CN_MAX_TCPROS_SERVER_CONNECTIONS 5
 
-/*! Max num serving RPCROS connections */
+/*! Default initial num serving RPCROS connections */
 #define CN_MAX_RPCROS_SERVER_CONNECTIONS CN_MAX_SERVICE_PROVIDERS
 
 /*!
- * Max num XMLRPC connections against another subscribed nodes
+ * Default initial num XMLRPC connections against another subscribed nodes
  *  (first connection index reserved to roscore)
  * */
-#define CN_MAX_XMLRPC_CLIENT_CONNECTIONS 1 + CN_MAX_SUBSCRIBED_TOPICS
+#define CN_MAX_XMLRPC_CLIENT_CONNECTIONS (1 + CN_MAX_SUBSCRIBED_TOPICS)
 
 /*!
- * Max num TCPROS connections against another subscribed nodes
+ * Default initial num TCPROS connections against another subscribed nodes
  * */
 #define CN_MAX_TCPROS_CLIENT_CONNECTIONS CN_MAX_SUBSCRIBED_TOPICS
 
 /*!
- * Max num RPCROS connections against other service-providing nodes
+ * Default initial num RPCROS connections against other service-providing nodes
  * (service calls are one to one, so, one TcprosProcess per ServiceCallerNode)
  * */
 #define CN_MAX_RPCROS_CLIENT_CONNECTIONS CN_MAX_SERVICE_CALLERS
 
+/*! Default maximum num published messages waiting to be sent through each subscriber connection */
+#define CN_PUBLISHER_CONN_QUEUE_SIZE 8
+
+/*! Minimum size (in bytes) of the variable-length numeric arrays of the queued messages of a publisher without periodic
+ *  callback that are sent from the memory of the message instead of copied into the serialized packet */
+#define CN_PUBLISHER_EXTERNAL_ARRAY_MIN_SIZE 4096
+
+/*! Initial size (in bytes) of the receive buffer of each subscriber connection. It grows to fit larger messages */
+#define CN_TCPROS_RECV_BUFFER_SIZE 16384
+
+/*! Maximum num messages dispatched from a subscriber connection each time it is attended,
+ *  so that a connection receiving a burst cannot starve the others */
+#define CN_TCPROS_MAX_MSGS_PER_EVENT 32
+
+/*! Maximum num messages posted to a publisher from other threads (see cRosNodePostTopicMsg()) that can wait
+ *  for room in the publisher queue */
+#define CN_PUBLISHER_POST_QUEUE_SIZE 64
+
+/*! Maximum num messages of publishers in the process (see cRosNodeSetIntraProcess()) that can wait for the node of a
+ *  subscriber to deliver them. Further messages are dropped until the node catches up */
+#define CN_SUBSCRIBER_INTRA_QUEUE_SIZE 64
+
+/*! Default maximum num received messages (or service requests) of each subscriber (or service provider) waiting
+ *  for a worker thread to run its callback (see cRosNodeSetCallbackThreads()) */
+#define CN_CALLBACK_QUEUE_SIZE 16
+
 /*! Node automatic XMLRPC ping cycle period (in msec) */
 #define CN_PING_LOOP_PERIOD 1000
 
 /*! Maximum I/O operations timeout (in msec) */
 #define CN_IO_TIMEOUT 3000
 
+/*! Period (in msec) of the check for processes that exceeded CN_IO_TIMEOUT */
+#define CN_IO_TIMEOUT_CHECK_PERIOD (CN_IO_TIMEOUT/10)
+
 /*! Maximum time that the node will wait for unregistering all publishers, subscribers, servicer providers... in the ROS master (in msec) */
 #define CN_UNREGISTRATION_TIMEOUT 3000
 
+/*! Minimum number of freed message memory blocks kept for reuse by the message type of each publisher and subscriber, so
+ *  that their message queues do not allocate memory once they are warmed up. The pool of a type grows with the deepest
+ *  queue configured for it (see cRosMessageDefReservePoolSize()) */
+#define CN_MESSAGE_POOL_SIZE MAX_QUEUE_LEN
+
+/*! Number of fields of the rosgraph_msgs/Log messages filled by cRosLogToMessage() through field handles */
+#define CN_ROSOUT_N_FIELDS 11
+
 typedef struct PublisherNode PublisherNode;
 typedef struct SubscriberNode SubscriberNode;
 typedef struct ServiceProviderNode ServiceProviderNode;
@@ -112,6 +157,27 @@ typedef struct CrosNodeStatusUsr
 /*! \brief Callback to communicate publisher or subscriber status */
 typedef void (*NodeStatusApiCallback)(CrosNodeStatusUsr *status, void* context);
 
+/*! Subscriber of a node in the same process that receives the messages of a publisher without sockets (see cRosNodeSetIntraProcess()) */
+typedef struct CrosIntraProcessLink CrosIntraProcessLink;
+struct CrosIntraProcessLink
+{
+  struct CrosNode *node;              //! Node of the subscriber (it can be the node of the publisher)
+  SubscriberNode *sub;                //! The subscriber, which receives the messages through its intra_msgs queue
+};
+
+/*! \brief Publishers of a node as seen by the threads that post messages (see cRosNodePostTopicMsg()). The valid entries
+ *         are never modified, so these threads read the table without locking. When the node needs more publisher slots,
+ *         the table is replaced by a larger copy and the replaced one is kept until the node is destroyed
+ */
+typedef struct CrosPostTable CrosPostTable;
+struct CrosPostTable
+{
+  int n_pubs;                         //! Number of valid entries in pubs (accessed atomically)
+  int max_pubs;                       //! Number of entries allocated in pubs
+  PublisherNode **pubs;               //! The publisher elements of the node table, whose addresses do not change
+  CrosPostTable *replaced;            //! Table replaced by this one, or NULL
+};
+
 /*! Structure that define a published topic */
 struct PublisherNode
 {
@@ -119,13 +185,36 @@ struct PublisherNode
   char *topic_type;                   //! The published topic data type (e.g., std_msgs/String, ...)
   char *md5sum;                       //! The MD5 sum of the message type
   char *message_definition;           //! Full text of message definition (output of gendeps --cat)
-  int   tcpros_id_list[CN_MAX_TCPROS_SERVER_CONNECTIONS+1]; //! List of node->tcpros_server_proc IDs allocated for this publisher. The last element of the list is always -1 (sentinel)
+  int  *tcpros_id_list;                //! List of node->tcpros_server_proc IDs allocated for this publisher. The last element of the list is always -1 (sentinel)
+  int   max_tcpros_ids;               //! Number of elements allocated in tcpros_id_list (including the sentinel)
   void *context;
   int loop_period;                    //! Period (in msec) for publication cycle
-  uint64_t wake_up_time;              //! The time for the next automatic message publication (in msec, since the Epoch)
+  uint64_t next_period_time;          //! The time for the next automatic message publication (in ns, see cRosClockGetTimeNs())
+  CrosTimer timer;                    //! Scheduled in the node timer heap when the publisher has something to send (periodic or queued message)
   cRosMessageQueue msg_queue;         //! Messages on this topic wait in this queue to be send for every process
+  int conn_queue_size;                //! Maximum num messages waiting to be sent through each subscriber connection
+  TcprosFrameQueuePolicy conn_queue_policy; //! What to do when a message is published and the queue of a subscriber connection is full
+  size_t zerocopy_min_size;           //! Minimum size of the messages sent with MSG_ZEROCOPY (where supported), or 0 to always copy them
+  CrosMpscQueue posted_msgs;          //! Messages posted from other threads (see cRosNodePostTopicMsg()), waiting to be moved to msg_queue
+  int n_posted_msgs;                  //! Number of messages in posted_msgs (accessed atomically)
+  int post_pending;                   //! 1 if the publisher is in the node posted_pubs queue (accessed atomically)
+  int post_open;                      //! 1 while other threads can post messages to the publisher (accessed atomically)
+  int n_post_users;                   //! Number of threads posting a message to the publisher at the moment (accessed atomically)
+  CrosMpscNode posted_link;           //! Link of the publisher in the node posted_pubs queue
+  CrosIntraProcessLink *intra_links;  //! Subscribers in the process that get the published messages without TCPROS. Modified by the threads of the subscriber nodes while holding the node pubs_lock
+  int n_intra_links;                  //! Number of elements used in intra_links (read atomically without pubs_lock)
+  int max_intra_links;                //! Number of elements allocated in intra_links
 };
 
+/*! \brief Action taken when a message is received and the queue of the subscriber is full (see cRosNodeSetSubscriberQueuePolicy()) */
+typedef enum
+{
+  CROS_SUB_QUEUE_DROP_NEWEST = 0,     //! The received message is not queued (it is still passed to the callback)
+  CROS_SUB_QUEUE_DROP_OLDEST,         //! The oldest queued message is discarded to make room for the received one
+  CROS_SUB_QUEUE_KEEP_LATEST,         //! Each received message replaces all the queued ones, so only the latest one is kept
+  CROS_SUB_QUEUE_BLOCK                //! The subscriber connections are not read until a message is extracted from the queue
+} CrosSubscriberQueuePolicy;
+
 /*! Structure that define a subscribed topic */
 struct SubscriberNode
 {
@@ -137,6 +226,16 @@ struct SubscriberNode
   void *context;                      //! Pointer to an internal library structure that stores received messages and its type
   cRosMessageQueue msg_queue;         //! Each time a message on this topic is received it is queued here
   unsigned char msg_queue_overflow;   //! If 1, the subscriber tried to insert a message in the queue but it was full
+  CrosSubscriberQueuePolicy msg_queue_policy; //! What to do when a message is received and msg_queue is full
+  unsigned long msg_queue_n_dropped;  //! Number of received messages discarded by msg_queue_policy since the subscriber was registered
+  unsigned char zerocopy_views;       //! If 1, the numeric arrays of the received messages are views of the received packets (see cRosNodeSetSubscriberZeroCopy())
+  unsigned char lazy_decoding;        //! If 1, the fields of the received messages are decoded when accessed (see cRosNodeSetSubscriberLazy())
+  CrosWorkStrand callback_strand;     //! Runs the subscriber callbacks in the node worker pool (not initialized if the node has no pool)
+  CrosMpscQueue intra_msgs;           //! Messages handed over by publishers in the process (see cRosNodeSetIntraProcess()), waiting for the node thread to deliver them
+  int n_intra_msgs;                   //! Number of messages in intra_msgs (accessed atomically)
+  int n_intra_dropped;                //! Messages dropped because intra_msgs was full that are not counted in msg_queue_n_dropped yet (accessed atomically)
+  int intra_pending;                  //! 1 if the subscriber is in the node intra_subs queue (accessed atomically)
+  CrosMpscNode intra_link;            //! Link of the subscriber in the node intra_subs queue
 };
 
 struct ServiceProviderNode
@@ -147,6 +246,23 @@ struct ServiceProviderNode
   char *serviceresponse_type;
   char *md5sum;
   void *context;
+  CrosWorkStrand callback_strand;     //! Runs the service-provider callbacks in the node worker pool (not initialized if the node has no pool)
+};
+
+/*! Service request attended by a thread of the node worker pool (see cRosNodeSetCallbackThreads()).
+ *  The worker returns it through the node finished_svc_works queue once the response is ready */
+typedef struct ServiceProviderWork ServiceProviderWork;
+struct ServiceProviderWork
+{
+  CrosMpscNode link;                  //! Link in the node finished_svc_works queue
+  struct CrosNode *node;              //! Node that received the request
+  void *context;                      //! Context of the service provider
+  int server_idx;                     //! Index of the node->rpcros_server_proc that received the request
+  uint32_t seq;                       //! Identifier of the request (see TcprosProcess svc_work_seq)
+  cRosMessage *request;               //! The received request
+  cRosMessage *response;              //! The response generated by the service-provider callback
+  DynBuffer response_data;            //! The serialized response (built by the worker)
+  cRosErrCodePack result;             //! Error code of the callback and the serialization
 };
 
 struct ServiceCallerNode
@@ -164,10 +280,39 @@ struct ServiceCallerNode
   unsigned char tcp_nodelay;          //! If 1, the service caller should set TCP_NODELAY on the socket, if possible
   void *context;
   int loop_period;                    //! Period (in msec) for service-call cycle
-  uint64_t wake_up_time;              //! The time for the next automatic service call (in msec, since the Epoch)
+  uint64_t next_period_time;          //! The time for the next automatic service call (in ns, see cRosClockGetTimeNs())
+  CrosTimer timer;                    //! Scheduled in the node timer heap while the caller process waits for a new call
   cRosMessageQueue msg_queue;         //! Service requests and service responses for this service wait in this queue to be send
 };
 
+/*! \brief Kind of the members of a CrosWaitSet */
+typedef enum
+{
+  CROS_WAIT_SUBSCRIBER = 0,           //! Ready when the queue of a subscriber holds at least one message
+  CROS_WAIT_SERVICE_CALL,             //! Ready when the response of a call started with cRosNodeServiceCallStart() has been received
+  CROS_WAIT_FD                        //! Ready when a file descriptor of the user (e.g., an eventfd) is readable
+} CrosWaitSetMemberType;
+
+typedef struct CrosWaitSetMember CrosWaitSetMember;
+struct CrosWaitSetMember
+{
+  CrosWaitSetMemberType type;         //! What the member waits for
+  int idx;                            //! Index of the subscriber or the service caller (not used by CROS_WAIT_FD members)
+  TcpIpSocket fd_socket;              //! Wraps the file descriptor of a CROS_WAIT_FD member to monitor it in the node event backend
+  unsigned char ready;                //! 1 if the member was ready when cRosWaitSetWait() returned. Otherwise 0
+};
+
+/*! \brief Set of subscribers, service calls and file descriptors that a thread can wait for at once (see cRosWaitSetWait()).
+ *         Don't modify its internal members: use the related functions instead */
+typedef struct CrosWaitSet CrosWaitSet;
+struct CrosWaitSet
+{
+  struct CrosNode *node;              //! Node that owns the subscribers and service callers of the members
+  CrosWaitSetMember *members;         //! Members of the set, in the order they were added
+  int n_members;                      //! Number of elements used in members
+  int max_members;                    //! Number of elements allocated in members
+};
+
 struct ParameterSubscription
 {
   char *parameter_key;
@@ -197,39 +342,80 @@ struct CrosNode
   CrosLogLevel log_level;
   int rosout_pub_idx;           //! Index of the publisher of the /rosout topic for ROS log messages
 
-  uint64_t xmlrpc_master_wake_up_time; //! The time (in msec, since the Epoch) for the next automatic operation cycle of the xmlrpc_client_proc[0] (xmlrpc master-node client proc)
+  CrosTimerHeap timers;         //! Pending wake-ups of the node: publishers, service callers, master ping and I/O timeout check (see cRosNodeDoEventsLoop())
+  CrosTimer xmlrpc_master_timer; //! Expires at the next automatic operation cycle of the xmlrpc_client_proc[0] (xmlrpc master-node client proc)
+  CrosTimer io_timeout_timer;   //! Expires at the next check of the processes that exceeded CN_IO_TIMEOUT
 
   uint32_t log_last_id;         //! Sequence number of the last transmitted rosout log message
+  cRosMessageFieldHandle *rosout_field_handles[CN_ROSOUT_N_FIELDS]; //! Fields of the /rosout messages, resolved on the first log message
 
   unsigned int next_call_id;
   ApiCallQueue master_api_queue;
   ApiCallQueue slave_api_queue;
 
+  CrosEventBackend event_backend; //! Monitors the sockets of all the node processes (see cRosNodeDoEventsLoop())
+
+  TcpIpSocket wakeup_notifier;    //! Wakes up cRosNodeDoEventsLoop() when a message is posted from another thread
+  CrosWaitSet *waiting_set;       //! Wait set whose file descriptors are being monitored by cRosWaitSetWait(), or NULL
+  unsigned char intra_process;    //! If 1, the node is in the process registry and connects with the other registered nodes without sockets (see cRosNodeSetIntraProcess())
+  struct CrosNode *next_intra_process_node; //! Next node in the process registry of intra-process nodes
+  CrosMpscQueue posted_pubs;      //! Publishers with messages posted from other threads (see cRosNodePostTopicMsg())
+  CrosMpscQueue intra_subs;       //! Subscribers with messages handed over by publishers in the process (see cRosNodeSetIntraProcess())
+  CrosPostTable *post_table;      //! Publishers that other threads can post messages to (accessed atomically)
+  CrosMutex pubs_lock;            //! Held by the threads of other intra-process nodes while they access pubs or the intra links of a publisher, and by the node thread while it enlarges pubs, (un)registers a publisher or walks its intra links
+
+  CrosWorkerPool *callback_pool;  //! Threads that run the subscriber and service-provider callbacks, or NULL to run them in cRosNodeDoEventsLoop()
+  int callback_queue_size;        //! Capacity of the callback strand of each subscriber and service provider
+  CrosMpscQueue finished_svc_works; //! Service requests whose response has been generated by the worker pool
+  uint32_t last_svc_work_seq;     //! Identifier of the last service request handed to the worker pool
+
+  TcprosProcess **zc_closed_procs; //! Closed publisher connections whose frames sent with MSG_ZEROCOPY are still used by the kernel
+  int n_zc_closed_procs;          //! Number of elements used in zc_closed_procs
+  int max_zc_closed_procs;        //! Number of elements allocated in zc_closed_procs
+
+  CrosEvent *ready_events;        //! Buffer where the event backend returns the ready sockets
+  int max_ready_events;           //! Number of elements allocated in ready_events
+
   //! Manage connections for XMLRPC calls from this node to others
-  XmlrpcProcess xmlrpc_client_proc[CN_MAX_XMLRPC_CLIENT_CONNECTIONS];
+  XmlrpcProcess **xmlrpc_client_proc;
+  CrosSlotTable xmlrpc_client_slots;    //! Size of xmlrpc_client_proc and its idle processes (xmlrpc_client_proc[0] is never reused)
+  CrosSlotList xmlrpc_client_connects;  //! Indices of the processes of xmlrpc_client_proc that must start a connection
   XmlrpcProcess xmlrpc_listner_proc;   //! Accept new XMLRPC connections from roscore or other nodes
   /*! Manage connections for XMLRPC calls from roscore or other nodes to this node */
-  XmlrpcProcess xmlrpc_server_proc[CN_MAX_XMLRPC_SERVER_CONNECTIONS];
+  XmlrpcProcess **xmlrpc_server_proc;
+  CrosSlotTable xmlrpc_server_slots;    //! Size of xmlrpc_server_proc and its idle processes
 
   //! Manage connections for TCPROS calls from this node to others
-  TcprosProcess tcpros_client_proc[CN_MAX_TCPROS_CLIENT_CONNECTIONS];
+  TcprosProcess **tcpros_client_proc;
+  CrosSlotTable tcpros_client_slots;    //! Size of tcpros_client_proc and its idle processes
+  CrosSlotList tcpros_client_connects;  //! Indices of the processes of tcpros_client_proc that must start a connection
+  CrosSlotList tcpros_client_pending;   //! Indices of the processes of tcpros_client_proc with buffered messages left to dispatch or whose reading is paused
   TcprosProcess tcpros_listner_proc;   //! Accept new TCPROS connections from roscore or other nodes
 
   /*! Manage connections for TCPROS between this and other nodes  */
-  TcprosProcess tcpros_server_proc[CN_MAX_TCPROS_SERVER_CONNECTIONS];
+  TcprosProcess **tcpros_server_proc;
+  CrosSlotTable tcpros_server_slots;    //! Size of tcpros_server_proc and its idle processes
 
-  //! Manage connections for RPCROS calls from this node to others
-  TcprosProcess rpcros_client_proc[CN_MAX_RPCROS_CLIENT_CONNECTIONS];
+  //! Manage connections for RPCROS calls from this node to others (rpcros_client_proc[i] is used by service_callers[i])
+  TcprosProcess **rpcros_client_proc;
+  CrosSlotTable rpcros_client_slots;    //! Size of rpcros_client_proc
+  CrosSlotList rpcros_client_connects;  //! Indices of the processes of rpcros_client_proc that must start a connection
   TcprosProcess rpcros_listner_proc;   //! Accept new TCPROS connections from roscore or other nodes
 
   /*! Manage connections for RPCROS between this and other nodes  */
-  TcprosProcess rpcros_server_proc[CN_MAX_RPCROS_SERVER_CONNECTIONS];
-
-  PublisherNode pubs[CN_MAX_PUBLISHED_TOPICS];            //! All the published topic, defined by PublisherNode structures
-  SubscriberNode subs[CN_MAX_SUBSCRIBED_TOPICS];          //! All the subscribed topic, defined by PublisherNode structures
-  ServiceProviderNode service_providers[CN_MAX_SERVICE_PROVIDERS]; //! All the provided services to register
-  ServiceCallerNode service_callers[CN_MAX_SERVICE_CALLERS]; //! All the services to call
-  ParameterSubscription paramsubs[CN_MAX_PARAMETER_SUBSCRIPTIONS];
+  TcprosProcess **rpcros_server_proc;
+  CrosSlotTable rpcros_server_slots;    //! Size of rpcros_server_proc and its idle processes
+
+  PublisherNode **pubs;                 //! All the published topic, defined by PublisherNode structures
+  CrosSlotTable pub_slots;              //! Size of pubs and its unused elements
+  SubscriberNode **subs;                //! All the subscribed topic, defined by PublisherNode structures
+  CrosSlotTable sub_slots;              //! Size of subs and its unused elements
+  ServiceProviderNode **service_providers; //! All the provided services to register
+  CrosSlotTable service_provider_slots; //! Size of service_providers and its unused elements
+  ServiceCallerNode **service_callers;  //! All the services to call
+  CrosSlotTable service_caller_slots;   //! Size of service_callers and its unused elements
+  ParameterSubscription **paramsubs;
+  CrosSlotTable paramsub_slots;         //! Size of paramsubs and its unused elements
 
   int n_pubs;                   //! Number of node's published topics
   int n_subs;                   //! Number of node's subscribed topics
@@ -256,13 +442,46 @@ void cRosGetMsgFilePath(CrosNode *node, char *buffer, size_t bufsize, const char
  *  \param node_host The node host (ipv4, e.g. 192.168.0.2)
  *  \param roscore_host The roscore host (ipv4, e.g. 192.168.0.1)
  *  \param roscore_port The roscore port
- *  \param select_timeout_ms Max timeout for the select() in ms. NULL defaults to UINT64_MAX
+ *  \param message_root_path Directory with the message register
  *
+ *  The node tables are created with the default initial sizes (CN_MAX_* constants). Use cRosNodeCreateEx()
+ *  to specify other sizes.
  *  \return A pointer to the new CrosNode on success, NULL on failure
  */
 CrosNode *cRosNodeCreate(const char *node_name, const char *node_host, const char *roscore_host, unsigned short roscore_port,
                          const char *message_root_path);
 
+/*! \brief Initial sizes of the node tables. A value lower than 1 selects the default size (CN_MAX_*) */
+typedef struct CrosNodeCapacityHints
+{
+  int published_topics;           //! Initial num published topics
+  int subscribed_topics;          //! Initial num subscribed topics
+  int service_providers;          //! Initial num service providers
+  int service_callers;            //! Initial num service callers (and RPCROS client connections)
+  int parameter_subscriptions;    //! Initial num parameter subscriptions
+  int xmlrpc_server_connections;  //! Initial num serving XMLRPC connections
+  int tcpros_server_connections;  //! Initial num serving TCPROS connections
+  int rpcros_server_connections;  //! Initial num serving RPCROS connections
+  int xmlrpc_client_connections;  //! Initial num XMLRPC client connections (including the connection to roscore)
+  int tcpros_client_connections;  //! Initial num TCPROS client connections
+} CrosNodeCapacityHints;
+
+/*! \brief Dynamically create a CrosNode instance specifying the initial size of its tables.
+ *
+ *  The tables of the node grow when more publishers, subscribers, connections, etc. are needed, so the
+ *  hints only avoid enlarging them at run time. Small hints keep the memory footprint of simple nodes small.
+ *  \param node_name The node name: it is the absolute name, i.e. it should includes the namespace
+ *  \param node_host The node host (ipv4, e.g. 192.168.0.2)
+ *  \param roscore_host The roscore host (ipv4, e.g. 192.168.0.1)
+ *  \param roscore_port The roscore port
+ *  \param message_root_path Directory with the message register
+ *  \param hints Initial table sizes. NULL selects the default sizes
+ *
+ *  \return A pointer to the new CrosNode on success, NULL on failure
+ */
+CrosNode *cRosNodeCreateEx(const char *node_name, const char *node_host, const char *roscore_host, unsigned short roscore_port,
+                           const char *message_root_path, const CrosNodeCapacityHints *hints);
+
 /*! \brief Unregister from ROS master and release all the internal allocated memory for a CrosNode
  *          object previously crated with cRosNodeCreate()
  *
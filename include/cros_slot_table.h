@@ -0,0 +1,115 @@
+#ifndef _CROS_SLOT_TABLE_H_
+#define _CROS_SLOT_TABLE_H_
+
+#include <stddef.h>
+
+/*! \defgroup cros_slot_table cROS slot table
+ *
+ *  Bookkeeping of the growable tables of a node (publishers, subscribers, processes, ...).
+ *  A table is an array of pointers to individually allocated elements (slots), so the address of
+ *  an element does not change when the table is enlarged. The indices of the slots that can be reused
+ *  are kept in a stack, so finding a free slot does not require scanning the table.
+ */
+
+/*! \addtogroup cros_slot_table
+ *  @{
+ */
+
+typedef struct CrosSlotTable CrosSlotTable;
+struct CrosSlotTable
+{
+  int n_slots;      //! Number of slots (allocated elements) in the table
+  int max_slots;    //! Number of elements that fit in the table before it has to be enlarged
+  int *free_slots;  //! Stack of the indices of the slots that can be reused. The last one is the next slot to be reused
+  int n_free_slots; //! Number of indices in free_slots
+};
+
+/*! \brief List of the indices of the slots of a table that the node must attend (e.g., the processes that must start
+ *         a connection), so that the whole table does not have to be scanned. The elements keep a flag to be stored
+ *         only once, so the list is never longer than the table
+ */
+typedef struct CrosSlotList CrosSlotList;
+struct CrosSlotList
+{
+  int *slots;     //! Indices of the slots, in the order in which they were stored
+  int n_slots;    //! Number of indices in slots
+  int max_slots;  //! Number of indices that fit in slots before it has to be enlarged
+};
+
+/*! \brief Initialize an empty slot table
+ *
+ *  \param t Pointer to the CrosSlotTable object
+ */
+void cRosSlotTableInit( CrosSlotTable *t );
+
+/*! \brief Enlarge a table so that at least a specific number of elements fit in it without reallocating it
+ *
+ *  \param t Pointer to the CrosSlotTable object
+ *  \param table Pointer to the table (array of pointers to the elements)
+ *  \param max_slots Number of elements that must fit in the table
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosSlotTableReserve( CrosSlotTable *t, void ***table, int max_slots );
+
+/*! \brief Allocate a new element at the end of the table. The table is enlarged if needed
+ *
+ *  The new element is not initialized and its index is not stored in the stack of free slots.
+ *  \param t Pointer to the CrosSlotTable object
+ *  \param table Pointer to the table (array of pointers to the elements)
+ *  \param elem_size Size in bytes of the table elements
+ *  \return Returns the index of the new slot on success, -1 on failure
+ */
+int cRosSlotTableAdd( CrosSlotTable *t, void ***table, size_t elem_size );
+
+/*! \brief Store the index of a slot that can be reused
+ *
+ *  \param t Pointer to the CrosSlotTable object
+ *  \param idx Index of the slot
+ *  \return Returns 0 on success, -1 if the index is not valid or the stack is full
+ */
+int cRosSlotTablePushFree( CrosSlotTable *t, int idx );
+
+/*! \brief Take the index of the slot that was stored most recently as reusable
+ *
+ *  \param t Pointer to the CrosSlotTable object
+ *  \return Returns the slot index, or -1 if there is no reusable slot
+ */
+int cRosSlotTablePopFree( CrosSlotTable *t );
+
+/*! \brief Free all the elements of a table and the table itself. The element contents must have been released before
+ *
+ *  \param t Pointer to the CrosSlotTable object
+ *  \param table Pointer to the table (array of pointers to the elements). It is set to NULL
+ */
+void cRosSlotTableRelease( CrosSlotTable *t, void ***table );
+
+/*! \brief Initialize an empty slot list
+ *
+ *  \param l Pointer to the CrosSlotList object
+ */
+void cRosSlotListInit( CrosSlotList *l );
+
+/*! \brief Store the index of a slot at the end of a list. The list is enlarged if needed
+ *
+ *  \param l Pointer to the CrosSlotList object
+ *  \param idx Index of the slot
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosSlotListPush( CrosSlotList *l, int idx );
+
+/*! \brief Remove the oldest indices of a list. The indices stored after them are kept in order
+ *
+ *  \param l Pointer to the CrosSlotList object
+ *  \param n_slots Number of indices to remove from the beginning of the list
+ */
+void cRosSlotListConsume( CrosSlotList *l, int n_slots );
+
+/*! \brief Free the memory of a list, leaving it empty
+ *
+ *  \param l Pointer to the CrosSlotList object
+ */
+void cRosSlotListRelease( CrosSlotList *l );
+
+/*! @}*/
+
+#endif
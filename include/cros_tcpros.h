@@ -2,6 +2,7 @@
 #define _CROS_TCPROS_H_
 
 #include "cros_node.h"
+#include "tcpros_frame.h"
 
 typedef enum
 {
@@ -53,21 +54,30 @@ void cRosMessagePrepareSubcriptionHeader( CrosNode *n, int client_idx );
  */
 void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx );
 
-/*! \brief Prepare a TCPROS message (with data) to be sent to a subscriber
+/*! \brief Serialize the outgoing message of a publisher into a new TCPROS frame, which can be shared
+ *         by all the subscriber connections of the publisher
  *
  *  \param n Ponter to the CrosNode object
- *  \param server_idx Index of the TcprosProcess ( tcpros_server_proc[server_idx] ) to be considered
+ *  \param pub_idx Index of the publisher ( pubs[pub_idx] ) whose outgoing message is serialized
+ *  \param take_arrays If not 0, the frame takes the variable-length numeric arrays of the outgoing message of at least
+ *         CN_PUBLISHER_EXTERNAL_ARRAY_MIN_SIZE bytes and sends them without copying them into its packet (the arrays
+ *         of the outgoing message are left empty)
+ *  \param frame_ptr Pointer to a variable that receives the new frame (with one reference owned by the caller),
+ *         or NULL on failure
  *  \return CROS_SUCCESS_ERR_PACK on success, otherwise an error code
  */
-cRosErrCodePack cRosMessagePreparePublicationPacket( CrosNode *n, int server_idx );
+cRosErrCodePack cRosMessagePreparePublicationFrame( CrosNode *n, int pub_idx, int take_arrays, TcprosFrame **frame_ptr );
 
 /*! \brief Read the TCPROS message (with data) received from the publisher
  *
  *  \param n Ponter to the CrosNode object
  *  \param client_idx Index of the TcprosProcess ( tcpros_client_proc[server_idx] ) to be considered for the parsing
+ *  \param packet Pointer to the buffer holding the message body. If the subscriber uses zero-copy views or lazy decoding,
+ *         it must be the packet of the TcprosProcess, whose memory is handed over to the received message. Otherwise
+ *         it can be a read-only view of the receive buffer (see dynBufferInitView())
  *  \return CROS_SUCCESS_ERR_PACK on success, otherwise an error code
  */
-cRosErrCode cRosMessageParsePublicationPacket( CrosNode *n, int client_idx );
+cRosErrCode cRosMessageParsePublicationPacket( CrosNode *n, int client_idx, DynBuffer *packet );
 
 /*! \brief Parse a RCPROS header sent from a service caller
  *
@@ -127,6 +137,15 @@ cRosErrCodePack cRosMessageParseServiceResponsePacket( CrosNode *n, int client_i
  */
 cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server_idx);
 
+/*! \brief Prepare a RCPROS response generated out of the process (e.g., by a worker thread) to be sent back to a service caller
+ *
+ *  \param n Ponter to the CrosNode object
+ *  \param server_idx Index of the TcprosProcess ( rpcros_server_proc[server_idx] ) to be considered
+ *  \param call_err Result of the service-provider callback. If it is not CROS_SUCCESS_ERR_PACK a failure response is prepared
+ *  \param service_response The serialized response message (only used if call_err is CROS_SUCCESS_ERR_PACK)
+ */
+void cRosMessageSetServiceResponsePacket( CrosNode *n, int server_idx, cRosErrCodePack call_err, DynBuffer *service_response );
+
 /*! \brief Prepare a RCPROS header to be initially sent to a service provider
  *
  *  \param n Ponter to the CrosNode object
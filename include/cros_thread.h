@@ -0,0 +1,157 @@
+#ifndef _CROS_THREAD_H_
+#define _CROS_THREAD_H_
+
+/*! \defgroup cros_thread cROS threads
+ *
+ *  Minimal portable wrappers of the threads, mutexes and condition variables used by the worker pool
+ *  (see cros_worker_pool.h). They map to POSIX threads or to the Win32 API.
+ *  NOTE: these are cROS internal objects, usually you don't need to use them.
+ */
+
+/*! \addtogroup cros_thread
+ *  @{
+ */
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#endif
+
+/*! \brief Function executed by a thread */
+typedef void (*CrosThreadFunc)( void *arg );
+
+typedef struct CrosThread CrosThread;
+struct CrosThread
+{
+#ifdef _WIN32
+  HANDLE handle;                //! Win32 thread handle
+#else
+  pthread_t handle;             //! POSIX thread identifier
+#endif
+  CrosThreadFunc func;          //! Function executed by the thread
+  void *arg;                    //! Parameter of func
+};
+
+typedef struct CrosMutex CrosMutex;
+struct CrosMutex
+{
+#ifdef _WIN32
+  CRITICAL_SECTION cs;
+#else
+  pthread_mutex_t mutex;
+#endif
+};
+
+/*! \brief Flag that makes a function run only once in the process (see cRosOnceRun()). Static variables of this type
+ *         must be initialized with CROS_ONCE_INIT */
+#ifdef _WIN32
+typedef INIT_ONCE CrosOnce;
+#  define CROS_ONCE_INIT INIT_ONCE_STATIC_INIT
+#else
+typedef pthread_once_t CrosOnce;
+#  define CROS_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+
+/*! \brief Function run through a CrosOnce flag */
+typedef void (*CrosOnceFunc)( void );
+
+typedef struct CrosCond CrosCond;
+struct CrosCond
+{
+#ifdef _WIN32
+  CONDITION_VARIABLE cond;
+#else
+  pthread_cond_t cond;
+#endif
+};
+
+/*! \brief Start a new thread. The CrosThread object must not be moved in memory until the thread is joined
+ *
+ *  \param t Pointer to the CrosThread object
+ *  \param func Function executed by the thread
+ *  \param arg Parameter of func
+ *  \return 0 on success, -1 on failure
+ */
+int cRosThreadCreate( CrosThread *t, CrosThreadFunc func, void *arg );
+
+/*! \brief Wait until a thread finishes and release its resources
+ *
+ *  \param t Pointer to the CrosThread object
+ */
+void cRosThreadJoin( CrosThread *t );
+
+/*! \brief Let the other threads run before the calling thread continues (used by short busy waits)
+ */
+void cRosThreadYield( void );
+
+/*! \brief Initialize a (non-recursive) mutex
+ *
+ *  \param m Pointer to the CrosMutex object
+ *  \return 0 on success, -1 on failure
+ */
+int cRosMutexInit( CrosMutex *m );
+
+/*! \brief Release the resources of a mutex, which must be unlocked
+ *
+ *  \param m Pointer to the CrosMutex object
+ */
+void cRosMutexRelease( CrosMutex *m );
+
+/*! \brief Lock a mutex, waiting until it is unlocked by other threads
+ *
+ *  \param m Pointer to the CrosMutex object
+ */
+void cRosMutexLock( CrosMutex *m );
+
+/*! \brief Unlock a mutex locked by the calling thread
+ *
+ *  \param m Pointer to the CrosMutex object
+ */
+void cRosMutexUnlock( CrosMutex *m );
+
+/*! \brief Run a function the first time that it is called with a flag. The calls made by other threads meanwhile wait
+ *         until the function returns, so it can initialize the process-wide objects (e.g., a static mutex)
+ *
+ *  \param once Pointer to the CrosOnce flag, initialized with CROS_ONCE_INIT
+ *  \param func Function to run
+ */
+void cRosOnceRun( CrosOnce *once, CrosOnceFunc func );
+
+/*! \brief Initialize a condition variable
+ *
+ *  \param c Pointer to the CrosCond object
+ *  \return 0 on success, -1 on failure
+ */
+int cRosCondInit( CrosCond *c );
+
+/*! \brief Release the resources of a condition variable, which must have no waiting thread
+ *
+ *  \param c Pointer to the CrosCond object
+ */
+void cRosCondRelease( CrosCond *c );
+
+/*! \brief Atomically unlock a mutex and wait until the condition variable is signaled. The mutex is locked again
+ *         before returning. Spurious wake-ups are possible, so the caller must check its condition in a loop
+ *
+ *  \param c Pointer to the CrosCond object
+ *  \param m Pointer to the CrosMutex object, locked by the calling thread
+ */
+void cRosCondWait( CrosCond *c, CrosMutex *m );
+
+/*! \brief Wake up one of the threads waiting on a condition variable (if any)
+ *
+ *  \param c Pointer to the CrosCond object
+ */
+void cRosCondSignal( CrosCond *c );
+
+/*! \brief Wake up all the threads waiting on a condition variable
+ *
+ *  \param c Pointer to the CrosCond object
+ */
+void cRosCondBroadcast( CrosCond *c );
+
+/*! @}*/
+
+#endif
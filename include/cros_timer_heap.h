@@ -0,0 +1,93 @@
+#ifndef _CROS_TIMER_HEAP_H_
+#define _CROS_TIMER_HEAP_H_
+
+#include <stdint.h>
+
+/*! \defgroup cros_timer_heap cROS timer heap
+ *
+ *  Binary min-heap of timers ordered by expiration time. The timers are embedded in the objects
+ *  that own them (publishers, service callers, ...) and the heap only stores pointers to them, so
+ *  scheduling, rescheduling and cancelling a timer is O(log n) and finding the next expiration is O(1).
+ *  The expiration times are expressed in ns of the clock returned by cRosClockGetTimeNs().
+ */
+
+/*! \addtogroup cros_timer_heap
+ *  @{
+ */
+
+typedef struct CrosTimer CrosTimer;
+struct CrosTimer
+{
+  uint64_t expiry;  //! Expiration time (in ns, see cRosClockGetTimeNs())
+  uint32_t tag;     //! Value identifying the owner of the timer
+  int heap_idx;     //! Position of the timer in the heap, or -1 if the timer is not scheduled
+};
+
+typedef struct CrosTimerHeap CrosTimerHeap;
+struct CrosTimerHeap
+{
+  CrosTimer **timers; //! Heap of scheduled timers. timers[0] is the one that expires first
+  int n_timers;       //! Number of scheduled timers
+  int max_timers;     //! Number of elements allocated in timers
+};
+
+/*! \brief Initialize a timer that is not scheduled
+ *
+ *  \param t Pointer to the CrosTimer object
+ *  \param tag Value identifying the owner of the timer
+ */
+void cRosTimerInit( CrosTimer *t, uint32_t tag );
+
+/*! \brief Check whether a timer is currently scheduled in a heap
+ *
+ *  \param t Pointer to the CrosTimer object
+ *  \return 1 if the timer is scheduled, 0 otherwise
+ */
+int cRosTimerIsScheduled( const CrosTimer *t );
+
+/*! \brief Initialize an empty timer heap
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ */
+void cRosTimerHeapInit( CrosTimerHeap *h );
+
+/*! \brief Release the memory of a timer heap. The timers that are still scheduled are marked as not scheduled
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ */
+void cRosTimerHeapRelease( CrosTimerHeap *h );
+
+/*! \brief Schedule a timer to expire at a specific time. If the timer is already scheduled, its expiration time is changed
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param t Pointer to the CrosTimer object
+ *  \param expiry Expiration time (in ns, see cRosClockGetTimeNs())
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosTimerHeapSchedule( CrosTimerHeap *h, CrosTimer *t, uint64_t expiry );
+
+/*! \brief Remove a timer from the heap. Nothing is done if the timer is not scheduled
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param t Pointer to the CrosTimer object
+ */
+void cRosTimerHeapCancel( CrosTimerHeap *h, CrosTimer *t );
+
+/*! \brief Get the timer that expires first, without removing it from the heap
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \return The pointer to the timer, or NULL if no timer is scheduled
+ */
+CrosTimer *cRosTimerHeapPeek( CrosTimerHeap *h );
+
+/*! \brief Remove from the heap and return the timer that expires first, if it has already expired
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param now Current time (in ns, see cRosClockGetTimeNs())
+ *  \return The pointer to the expired timer, or NULL if no timer has expired at time now
+ */
+CrosTimer *cRosTimerHeapPopExpired( CrosTimerHeap *h, uint64_t now );
+
+/*! @}*/
+
+#endif
@@ -0,0 +1,224 @@
+/*! \file cros_typed_message.h
+ *  \brief This header file declares the types and functions used by the C message types generated by cros-msggen
+ *
+ *  cros-msggen (see cmake/CrosMessages.cmake) translates each .msg file into a plain C struct and inline functions
+ *  that compute its serialized size, pack it and unpack it, without using the dynamic cRosMessage model.
+ *  For a message type pkg/Name the generated header pkg/Name.h defines:
+ *  - The struct pkg_Name. The strings are char * and the variable-length arrays are a pointer (name), their number of
+ *    elements (name_size) and their number of allocated elements (name_capacity). The strings and arrays are allocated
+ *    with malloc(), so that pkg_Name_release() can free them.
+ *  - pkg_Name_init(), pkg_Name_release(), pkg_Name_size(), pkg_Name_pack() and pkg_Name_unpack().
+ *  - The macros PKG_NAME_MD5SUM and PKG_NAME_DEFINITION, and the message constants.
+ *  - pkg_Name_type(), which returns the description of the type used by the typed publishers and subscribers
+ *    (see cRosApiRegisterTypedPublisher()).
+ *  For a service type pkg/Name the header defines the pkg_NameRequest and pkg_NameResponse message types.
+ */
+
+#ifndef _CROS_TYPED_MESSAGE_H_
+#define _CROS_TYPED_MESSAGE_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dyn_buffer.h"
+#include "cros_err_codes.h"
+
+/*! \defgroup cros_typed_message cROS generated message types
+ *
+ *  Support of the message types generated at build time
+ */
+
+/*! \addtogroup cros_typed_message
+ *  @{
+ */
+
+//! Field of type time in the generated structs
+typedef struct cRosTypedTime cRosTypedTime;
+struct cRosTypedTime
+{
+  uint32_t secs;
+  uint32_t nsecs;
+};
+
+//! Field of type duration in the generated structs
+typedef struct cRosTypedDuration cRosTypedDuration;
+struct cRosTypedDuration
+{
+  int32_t secs;
+  int32_t nsecs;
+};
+
+//! Field of type Header (std_msgs/Header) in the generated structs
+typedef struct cRosTypedHeader cRosTypedHeader;
+struct cRosTypedHeader
+{
+  uint32_t seq;
+  cRosTypedTime stamp;
+  char *frame_id;
+};
+
+/*! Description of a generated message type: its identification in the TCPROS connections and the functions that
+ *  manage its struct. The functions receive a pointer to the struct of the type */
+typedef struct cRosTypedMessageType cRosTypedMessageType;
+struct cRosTypedMessageType
+{
+  const char *type_name;          //! The message data type (e.g., std_msgs/String)
+  const char *md5sum;             //! The MD5 sum of the message type
+  const char *definition;         //! Text of the message definition sent in the connection headers
+  size_t struct_size;             //! sizeof() the generated struct
+  void (*init)(void *msg);        //! Initialize an empty message
+  void (*release)(void *msg);     //! Free the strings and arrays of a message
+  size_t (*size)(const void *msg); //! Number of bytes of the serialized message
+  unsigned char *(*pack)(const void *msg, unsigned char *dst); //! Write the serialized message (size() bytes) and return the end of the written data
+  cRosErrCodePack (*unpack)(void *msg, const unsigned char **src, const unsigned char *end); //! Read a serialized message and advance *src
+};
+
+static inline cRosErrCodePack cRosTypedUnpackBytes(void *dst, size_t n, const unsigned char **src, const unsigned char *end)
+{
+  if((size_t)(end - *src) < n)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+  if(n > 0)
+    memcpy(dst, *src, n);
+  *src += n;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static inline unsigned char *cRosTypedPackUInt32(unsigned char *dst, uint32_t val)
+{
+  memcpy(dst, &val, sizeof(uint32_t));
+  return dst + sizeof(uint32_t);
+}
+
+//! Read the number of elements of an array and check that the packet contains at least min_elem_size bytes for each one
+static inline cRosErrCodePack cRosTypedUnpackArrayLen(uint32_t *n_elems, size_t min_elem_size, const unsigned char **src, const unsigned char *end)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = cRosTypedUnpackBytes(n_elems, sizeof(uint32_t), src, end);
+  if(ret_err == CROS_SUCCESS_ERR_PACK && min_elem_size > 0 && (size_t)(end - *src) / min_elem_size < *n_elems)
+    ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+  return ret_err;
+}
+
+//! Make room for n_elems elements in a variable-length array. The new elements are zeroed
+static inline cRosErrCodePack cRosTypedArrayReserve(void **data, uint32_t *capacity, uint32_t n_elems, size_t elem_size)
+{
+  if(n_elems > *capacity)
+  {
+    unsigned char *new_data = (unsigned char *)realloc(*data, n_elems * elem_size);
+    if(new_data == NULL)
+      return CROS_MEM_ALLOC_ERR;
+    memset(new_data + *capacity * elem_size, 0, (n_elems - *capacity) * elem_size);
+    *data = new_data;
+    *capacity = n_elems;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static inline size_t cRosTypedStringSize(const char *str)
+{
+  return sizeof(uint32_t) + ((str != NULL)? strlen(str) : 0);
+}
+
+static inline unsigned char *cRosTypedStringPack(unsigned char *dst, const char *str)
+{
+  uint32_t len = (str != NULL)? (uint32_t)strlen(str) : 0;
+
+  dst = cRosTypedPackUInt32(dst, len);
+  if(len > 0)
+    memcpy(dst, str, len);
+  return dst + len;
+}
+
+static inline cRosErrCodePack cRosTypedStringUnpack(char **str, const unsigned char **src, const unsigned char *end)
+{
+  cRosErrCodePack ret_err;
+  uint32_t len;
+  char *new_str;
+
+  ret_err = cRosTypedUnpackArrayLen(&len, 1, src, end);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+  new_str = (char *)realloc(*str, (size_t)len + 1);
+  if(new_str == NULL)
+    return CROS_MEM_ALLOC_ERR;
+  memcpy(new_str, *src, len);
+  new_str[len] = '\0';
+  *str = new_str;
+  *src += len;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static inline size_t cRosTypedHeaderSize(const cRosTypedHeader *header)
+{
+  return sizeof(uint32_t) + sizeof(cRosTypedTime) + cRosTypedStringSize(header->frame_id);
+}
+
+static inline unsigned char *cRosTypedHeaderPack(const cRosTypedHeader *header, unsigned char *dst)
+{
+  dst = cRosTypedPackUInt32(dst, header->seq);
+  memcpy(dst, &header->stamp, sizeof(cRosTypedTime));
+  return cRosTypedStringPack(dst + sizeof(cRosTypedTime), header->frame_id);
+}
+
+static inline cRosErrCodePack cRosTypedHeaderUnpack(cRosTypedHeader *header, const unsigned char **src, const unsigned char *end)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = cRosTypedUnpackBytes(&header->seq, sizeof(uint32_t), src, end);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosTypedUnpackBytes(&header->stamp, sizeof(cRosTypedTime), src, end);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosTypedStringUnpack(&header->frame_id, src, end);
+  return ret_err;
+}
+
+static inline void cRosTypedHeaderRelease(cRosTypedHeader *header)
+{
+  free(header->frame_id);
+  header->frame_id = NULL;
+}
+
+/*! \brief Append a message of a generated type to a buffer. The buffer is enlarged only once
+ *
+ *  \param type Description of the message type
+ *  \param msg Pointer to the struct of the message
+ *  \param buffer Buffer where the serialized message is appended
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
+static inline cRosErrCodePack cRosTypedMessageSerialize(const cRosTypedMessageType *type, const void *msg, DynBuffer *buffer)
+{
+  size_t size = type->size(msg);
+  unsigned char *dst = dynBufferReserve(buffer, size);
+
+  if(dst == NULL)
+    return CROS_MEM_ALLOC_ERR;
+  type->pack(msg, dst);
+  dynBufferCommit(buffer, size);
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+/*! \brief Read a message of a generated type from the current position of a buffer. The memory of the strings and
+ *         arrays of the message is reused
+ *
+ *  \param type Description of the message type
+ *  \param msg Pointer to the struct of the message, which must have been initialized
+ *  \param buffer Buffer that contains the serialized message. Its position indicator is moved to the end of the message
+ *  \return CROS_SUCCESS_ERR_PACK on success or the error code otherwise
+ */
+static inline cRosErrCodePack cRosTypedMessageDeserialize(const cRosTypedMessageType *type, void *msg, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err;
+  const unsigned char *start = dynBufferGetCurrentData(buffer);
+  const unsigned char *src = start;
+
+  ret_err = type->unpack(msg, &src, start + dynBufferGetRemainingDataSize(buffer));
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    dynBufferMovePoseIndicator(buffer, (int)(src - start));
+  return ret_err;
+}
+
+/*! @}*/
+
+#endif // _CROS_TYPED_MESSAGE_H_
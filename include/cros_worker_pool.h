@@ -0,0 +1,100 @@
+#ifndef _CROS_WORKER_POOL_H_
+#define _CROS_WORKER_POOL_H_
+
+#include "cros_thread.h"
+
+/*! \defgroup cros_worker_pool cROS worker pool
+ *
+ *  Pool of threads that run the work items handed off by the thread running the node event loop.
+ *  The items are posted to strands: each strand is a bounded FIFO queue whose items are run in order
+ *  and never concurrently, while different strands are run in parallel by the pool threads.
+ *  The node uses one strand per subscriber and per service provider, so the callbacks of a role keep
+ *  their order and do not need to be reentrant.
+ *  NOTE: these are cROS internal objects, usually you don't need to use them.
+ */
+
+/*! \addtogroup cros_worker_pool
+ *  @{
+ */
+
+/*! \brief Function that runs a work item. canceled is 1 if the item is being discarded without running it
+ *         (the strand is being released), so that the function only has to release arg */
+typedef void (*CrosWorkCallback)( void *arg, int canceled );
+
+typedef struct CrosWorkItem CrosWorkItem;
+struct CrosWorkItem
+{
+  CrosWorkCallback func;                //! Function that runs the item
+  void *arg;                            //! Parameter of func
+};
+
+typedef struct CrosWorkerPool CrosWorkerPool;
+typedef struct CrosWorkStrand CrosWorkStrand;
+
+struct CrosWorkStrand
+{
+  CrosWorkerPool *pool;                 //! Pool that runs the items of the strand, or NULL if the strand is not initialized
+  CrosWorkItem *items;                  //! Circular buffer of items waiting to be run
+  int capacity;                         //! Maximum number of waiting items
+  int first;                            //! Index in items of the oldest waiting item
+  int count;                            //! Number of waiting items
+  unsigned char scheduled;              //! 1 while the strand is in the pool ready list or one of its items is running
+  unsigned char running;                //! 1 while a pool thread runs one of its items
+  CrosWorkStrand *next_ready;           //! Next strand in the pool ready list
+  unsigned long n_rejected;             //! Number of items that could not be posted because the strand was full
+};
+
+struct CrosWorkerPool
+{
+  CrosThread *threads;                  //! The pool threads
+  int n_threads;                        //! Number of elements of threads
+  CrosMutex lock;                       //! Protects the pool and the strands that use it
+  CrosCond work_ready;                  //! Signaled when a strand is added to the ready list or the pool is stopping
+  CrosCond strand_done;                 //! Signaled when a pool thread finishes running an item
+  CrosWorkStrand *ready_first;          //! Oldest strand with items waiting to be run
+  CrosWorkStrand *ready_last;           //! Newest strand with items waiting to be run
+  unsigned char stopping;               //! 1 when the pool threads must exit
+};
+
+/*! \brief Initialize a pool and start its threads. The pool must not be moved in memory afterwards
+ *
+ *  \param p Pointer to the CrosWorkerPool object
+ *  \param n_threads Number of threads (greater than 0)
+ *  \return 0 on success, -1 on failure
+ */
+int cRosWorkerPoolInit( CrosWorkerPool *p, int n_threads );
+
+/*! \brief Stop the pool threads and release the pool. The strands of the pool must have been released before
+ *
+ *  \param p Pointer to the CrosWorkerPool object
+ */
+void cRosWorkerPoolRelease( CrosWorkerPool *p );
+
+/*! \brief Initialize an empty strand of a pool. The strand must not be moved in memory afterwards
+ *
+ *  \param s Pointer to the CrosWorkStrand object
+ *  \param p Pointer to the pool that will run the items of the strand
+ *  \param capacity Maximum number of items waiting to be run (greater than 0)
+ *  \return 0 on success, -1 on failure
+ */
+int cRosWorkStrandInit( CrosWorkStrand *s, CrosWorkerPool *p, int capacity );
+
+/*! \brief Release a strand: wait until its running item (if any) finishes and cancel its waiting items.
+ *         If the strand is not initialized nothing is done
+ *
+ *  \param s Pointer to the CrosWorkStrand object
+ */
+void cRosWorkStrandRelease( CrosWorkStrand *s );
+
+/*! \brief Append an item to a strand. It never blocks: if the strand is full, the item is rejected
+ *
+ *  \param s Pointer to the CrosWorkStrand object
+ *  \param func Function that runs the item
+ *  \param arg Parameter of func
+ *  \return 0 on success, -1 if the strand is full (func is not called)
+ */
+int cRosWorkStrandPost( CrosWorkStrand *s, CrosWorkCallback func, void *arg );
+
+/*! @}*/
+
+#endif
@@ -26,6 +26,15 @@ struct DynBuffer
  */
 void dynBufferInit( DynBuffer *d_buf );
 
+/*! \brief Initialize a dynamic buffer that reads n bytes of external memory without copying them.
+ *         The buffer does not own the memory, so it must only be read: it cannot be modified nor released
+ *
+ *  \param d_buf Pointer to a DynBuffer object to be initialized
+ *  \param data Pointer to the memory to be read
+ *  \param n Number of bytes to be read
+ */
+void dynBufferInitView( DynBuffer *d_buf, const unsigned char *data, size_t n );
+
 /*! \brief Release a dynamic buffer
  *
  *  \param d_buf Pointer to a DynBuffer object to be released
@@ -42,6 +51,24 @@ void dynBufferRelease( DynBuffer *d_buf );
  */
 int dynBufferPushBackBuf( DynBuffer *d_buf, const unsigned char *new_buf, size_t n );
 
+/*! \brief Make sure that at least n bytes can be appended to the dynamic buffer without reallocating it,
+ *         so that they can be written in place (e.g., by recv()). The written bytes must be then appended
+ *         to the buffer content with dynBufferCommit()
+ *
+ *  \param d_buf Pointer to a DynBuffer object
+ *  \param n Number of bytes to be reserved
+ *
+ *  \return A pointer to the first reserved byte (the end of the current content), or NULL on failure
+ */
+unsigned char *dynBufferReserve( DynBuffer *d_buf, size_t n );
+
+/*! \brief Append to the dynamic buffer content the first n bytes written in the memory returned by dynBufferReserve()
+ *
+ *  \param d_buf Pointer to a DynBuffer object
+ *  \param n Number of written bytes. It cannot be greater than the number of reserved bytes
+ */
+void dynBufferCommit( DynBuffer *d_buf, size_t n );
+
 /*! \brief Replace the content of the dynamic buffer starting from current position indicator with the content
  *         of the buffer cont_buf.
  *
@@ -0,0 +1,105 @@
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include <stddef.h>
+
+/*! \defgroup ring_buffer Ring buffer */
+
+/*! \addtogroup ring_buffer
+ *  @{
+ */
+
+/*! \brief Circular byte buffer. Data is appended at its end and consumed from its beginning
+ *         without moving the stored bytes. Don't modify its internal members: use
+ *         the related functions instead */
+typedef struct RingBuffer RingBuffer;
+struct RingBuffer
+{
+  unsigned char *data;            //! Buffer memory
+  size_t capacity;                //! Size of the buffer memory
+  size_t head;                    //! Offset of the first stored byte
+  size_t size;                    //! Number of stored bytes
+};
+
+/*! \brief Initialize an empty ring buffer (no memory is allocated)
+ *
+ *  \param r_buf Pointer to a RingBuffer object to be initialized
+ */
+void ringBufferInit( RingBuffer *r_buf );
+
+/*! \brief Release the memory of a ring buffer
+ *
+ *  \param r_buf Pointer to a RingBuffer object to be released
+ */
+void ringBufferRelease( RingBuffer *r_buf );
+
+/*! \brief Discard all the stored bytes (the memory is not released)
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ */
+void ringBufferClear( RingBuffer *r_buf );
+
+/*! \brief Make sure that the ring buffer can store at least capacity bytes, keeping the stored ones
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param capacity Minimum capacity
+ *
+ *  \return 0 on success, -1 on failure
+ */
+int ringBufferReserve( RingBuffer *r_buf, size_t capacity );
+
+/*! \brief Get the number of stored bytes
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *
+ *  \return The number of stored bytes
+ */
+size_t ringBufferGetSize( RingBuffer *r_buf );
+
+/*! \brief Get the largest contiguous free region where new bytes can be written (e.g., by recv())
+ *
+ *  The written bytes must be then appended with ringBufferCommit()
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param len Pointer to a variable that receives the length of the region
+ *
+ *  \return A pointer to the free region (if len is 0 the buffer is full)
+ */
+unsigned char *ringBufferGetWriteRegion( RingBuffer *r_buf, size_t *len );
+
+/*! \brief Append the n bytes written in the region returned by ringBufferGetWriteRegion()
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param n Number of written bytes
+ */
+void ringBufferCommit( RingBuffer *r_buf, size_t n );
+
+/*! \brief Get the largest contiguous region of stored bytes, starting from the first one
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param len Pointer to a variable that receives the length of the region
+ *
+ *  \return A pointer to the first stored byte
+ */
+const unsigned char *ringBufferGetReadRegion( RingBuffer *r_buf, size_t *len );
+
+/*! \brief Copy n stored bytes, starting from the byte at offset, without consuming them
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param offset Offset of the first byte to copy from the first stored byte
+ *  \param dst Destination memory
+ *  \param n Number of bytes to copy
+ *
+ *  \return 0 on success, -1 if the buffer does not store so many bytes
+ */
+int ringBufferPeek( RingBuffer *r_buf, size_t offset, void *dst, size_t n );
+
+/*! \brief Consume (discard) the first n stored bytes
+ *
+ *  \param r_buf Pointer to a RingBuffer object
+ *  \param n Number of bytes to consume. If it is greater than the number of stored bytes, all of them are consumed
+ */
+void ringBufferConsume( RingBuffer *r_buf, size_t n );
+
+/*! @}*/
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _SHARED_BUFFER_H_
+#define _SHARED_BUFFER_H_
+
+#include "dyn_buffer.h"
+
+/*! \defgroup shared_buffer Shared buffer */
+
+/*! \addtogroup shared_buffer
+ *  @{
+ */
+
+/*! \brief Reference-counted dynamic buffer. It is used to keep a received packet alive while
+ *         the messages deserialized from it point into its data (see cRosMessageDeserializeView()).
+ *         The content must not be modified once the buffer is shared. The reference count is
+ *         updated atomically, so the references can be released from any thread */
+typedef struct SharedBuffer SharedBuffer;
+struct SharedBuffer
+{
+  int ref_count;                  //! Number of references to the buffer
+  DynBuffer buffer;               //! Buffer content
+};
+
+/*! \brief Create a shared buffer taking over the memory of a dynamic buffer (including its position indicator).
+ *         The dynamic buffer is left empty
+ *
+ *  \param d_buf Pointer to the DynBuffer object whose content is taken
+ *
+ *  \return A pointer to the new shared buffer, with a reference count of 1, or NULL on failure (d_buf is not modified)
+ */
+SharedBuffer *sharedBufferNewFrom( DynBuffer *d_buf );
+
+/*! \brief Add a reference to a shared buffer
+ *
+ *  \param s_buf Pointer to a SharedBuffer object, or NULL
+ *
+ *  \return s_buf
+ */
+SharedBuffer *sharedBufferRetain( SharedBuffer *s_buf );
+
+/*! \brief Remove a reference to a shared buffer, freeing it when no reference is left
+ *
+ *  \param s_buf Pointer to a SharedBuffer object, or NULL
+ */
+void sharedBufferRelease( SharedBuffer *s_buf );
+
+/*! @}*/
+
+#endif
@@ -55,6 +55,19 @@ struct TcpIpSocket
   unsigned char connected; //! It is 1 if the socket is connected (inbound or outbound). Otherwise it is 0
   unsigned char listening; //! It is 1 if the socket is already in the listening state (ready to accept connections). Otherwise it is 0
   unsigned char is_nonblocking; //! It is 1 if the socket has been configured as non blocking. Otherwise it is 0
+  unsigned int ev_events; //! Events for which the socket is currently registered in an event backend. It is reset when the socket is closed
+  unsigned char zerocopy; //! It is 1 if the socket has been configured to send with MSG_ZEROCOPY. Otherwise it is 0
+  uint32_t zc_sent; //! Number of send operations done with MSG_ZEROCOPY
+  uint32_t zc_completed; //! Number of MSG_ZEROCOPY send operations whose memory is no longer used by the kernel
+  uint32_t zc_backoff; //! Number of large send operations still done without MSG_ZEROCOPY since the kernel refused it (ENOBUFS)
+};
+
+/*! \brief Memory region to be sent by tcpIpSocketWriteIov() */
+typedef struct TcpIpSocketIoVec TcpIpSocketIoVec;
+struct TcpIpSocketIoVec
+{
+  const void *base; //! Start of the region
+  size_t len; //! Length of the region in bytes
 };
 
 /*! \brief Initialize the TcpIpSocket object with default values
@@ -96,6 +109,49 @@ int tcpIpSocketSetNonBlocking( TcpIpSocket *s );
  */
 int tcpIpSocketSetNoDelay ( TcpIpSocket *s );
 
+/*! \brief Enable MSG_ZEROCOPY sending for a socket (only available on Linux 4.14 or later).
+ *         The memory sent with zero copy cannot be modified or released until the kernel
+ *         notifies its completion (see tcpIpSocketPollZeroCopy())
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *
+ *  \return Returns 1 on success, 0 on failure or if the platform does not support it
+ */
+int tcpIpSocketSetZeroCopy ( TcpIpSocket *s );
+
+/*! \brief Read the MSG_ZEROCOPY completion notifications of a socket and update s->zc_completed
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *
+ *  \return Returns the number of notifications read
+ */
+int tcpIpSocketPollZeroCopy ( TcpIpSocket *s );
+
+/*! \brief Open a notifier: a non-blocking descriptor that becomes readable when tcpIpSocketNotify() is called,
+ *         so that another thread can wake up a thread waiting for socket events.
+ *         It is an eventfd on Linux and a UDP socket connected to itself on other platforms.
+ *         The notifier is closed with tcpIpSocketClose()
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *
+ *  \return Returns 1 on success, 0 on failure
+ */
+int tcpIpSocketOpenNotifier ( TcpIpSocket *s );
+
+/*! \brief Make a notifier readable. It can be called from any thread and it never blocks
+ *
+ *  \param s Pointer to a TcpIpSocket object opened with tcpIpSocketOpenNotifier()
+ *
+ *  \return Returns 1 on success, 0 on failure
+ */
+int tcpIpSocketNotify ( TcpIpSocket *s );
+
+/*! \brief Consume the pending notifications of a notifier, so that it is not readable anymore
+ *
+ *  \param s Pointer to a TcpIpSocket object opened with tcpIpSocketOpenNotifier()
+ */
+void tcpIpSocketClearNotifications ( TcpIpSocket *s );
+
 /*! \brief Set a TCP/IP4 socket to be re-bound immediately without timeout
  *
  *  \param s Pointer to a TcpIpSocket object
@@ -184,6 +240,36 @@ int tcpIpSocketDisconnect( TcpIpSocket *s );
  */
 TcpIpSocketState tcpIpSocketWriteBuffer( TcpIpSocket *s, DynBuffer *d_buf );
 
+/*! \brief Send a binary message on a connected socket starting from a caller-managed offset
+ *
+ *  Unlike tcpIpSocketWriteBuffer(), the position indicator of the buffer is not modified,
+ *  so the same buffer can be sent at the same time through several sockets.
+ *  \param s Pointer to a TcpIpSocket object
+ *  \param d_buf The dynamic buffer to be written
+ *  \param offset Pointer to the number of bytes of the buffer already sent. It is updated with the written bytes
+ *
+ *  \return Returns the same values as tcpIpSocketWriteBuffer()
+ */
+TcpIpSocketState tcpIpSocketWriteBufferFrom( TcpIpSocket *s, DynBuffer *d_buf, size_t *offset );
+
+/*! \brief Send several memory regions through a connected socket with a single gather-write, as if they were
+ *         a contiguous buffer, starting from the byte at *offset
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *  \param iov Array of memory regions
+ *  \param iov_cnt Number of elements of iov
+ *  \param offset Pointer to the number of bytes of the regions already sent. It is updated with the bytes sent
+ *  \param zerocopy_min_size If the socket has MSG_ZEROCOPY enabled, the send operations of at least this number of
+ *         bytes are done with zero copy (and s->zc_sent is incremented). 0 disables zero copy
+ *
+ *  \return Returns TCPIPSOCKET_DONE on success,
+ *          TCPIPSOCKET_IN_PROGRESS (only if the socket is non-blocking)
+ *          if the write operation would block,
+ *          TCPIPSOCKET_DISCONNECTED if the socket has been disconnectd,
+ *          or TCPIPSOCKET_FAILED on failure
+ */
+TcpIpSocketState tcpIpSocketWriteIov( TcpIpSocket *s, const TcpIpSocketIoVec *iov, int iov_cnt, size_t *offset, size_t zerocopy_min_size );
+
 /*! \brief Send a string on a connected socket
  *
  *  \param s Pointer to a TcpIpSocket object
@@ -210,6 +296,21 @@ TcpIpSocketState tcpIpSocketWriteString( TcpIpSocket *s, DynString *d_str );
  */
 TcpIpSocketState tcpIpSocketReadBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size_t length, size_t *reads);
 
+/*! \brief Receive up to max_size bytes from a connected socket directly into the memory pointed by buf
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *  \param buf Pointer to the destination memory
+ *  \param max_size Maximum number of bytes to be received
+ *  \param n_reads Pointer to a variable that receives the number of received bytes
+ *
+ *  \return Returns TCPIPSOCKET_DONE on success,
+ *          TCPIPSOCKET_IN_PROGRESS (only if the socket is non-blocking)
+ *          if the read operation would block,
+ *          TCPIPSOCKET_DISCONNECTED if the socket has been disconnectd,
+ *          or TCPIPSOCKET_FAILED on failure
+ */
+TcpIpSocketState tcpIpSocketReadData( TcpIpSocket *s, void *buf, size_t max_size, size_t *n_reads );
+
 /*! \brief Receive a binary message from a connected socket
  *
  *  \param s Pointer to a TcpIpSocket object
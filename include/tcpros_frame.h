@@ -0,0 +1,185 @@
+#ifndef _TCPROS_FRAME_H_
+#define _TCPROS_FRAME_H_
+
+#include <stdint.h>
+
+#include "dyn_buffer.h"
+#include "tcpip_socket.h"
+
+/*! \defgroup tcpros_frame TCPROS frame */
+
+/*! \addtogroup tcpros_frame
+ *  @{
+ */
+
+/*! \brief Function called to release the user-owned memory of an external frame segment when the frame is freed */
+typedef void (*TcprosFrameReleaseCallback)( void *context );
+
+/*! \brief Contiguous part of the frame content. It is either a range of the frame packet or user-owned memory
+ *         NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+typedef struct TcprosFrameSegment TcprosFrameSegment;
+struct TcprosFrameSegment
+{
+  const void *ext_data;                 //! User-owned memory of the segment, or NULL if the segment is stored in the frame packet
+  size_t offset;                        //! Offset of the segment in the frame packet (if ext_data is NULL)
+  size_t len;                           //! Length of the segment in bytes
+  TcprosFrameReleaseCallback release;   //! Function called when the frame is freed (for external segments), or NULL
+  void *release_context;                //! Parameter of the release function
+};
+
+/*! \brief Serialized TCPROS packet shared by several TcprosProcess objects (e.g., all the connections
+ *         of a publisher). The message is serialized once and each connection sends it from its own
+ *         write offset. The frame is freed when the last reference is released.
+ *         The frame content can include external segments (e.g., large arrays owned by the user), which are
+ *         sent without copying them into the frame packet (scatter/gather).
+ *         NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+typedef struct TcprosFrame TcprosFrame;
+struct TcprosFrame
+{
+  DynBuffer packet;                     //! The serialized content, except the packet size field and the external segments
+  uint32_t size_field;                  //! The packet size field (in ROS byte order), sent before the content
+  TcprosFrameSegment *segments;         //! Content segments, in sending order
+  int n_segments;                       //! Number of elements used in segments
+  int max_segments;                     //! Number of elements allocated in segments
+  size_t packet_seg_start;              //! Offset in packet of the bytes not yet included in segments
+  TcpIpSocketIoVec *iov;                //! Memory regions to be sent (built by tcprosFrameSeal())
+  int iov_cnt;                          //! Number of elements of iov
+  int ref_count;                        //! Number of references to the frame
+};
+
+/*! \brief Create a new frame with an empty packet. The reference counter of the new frame is 1
+ *
+ *  \return A pointer to the new frame on success, NULL on failure
+ */
+TcprosFrame *tcprosFrameNew( void );
+
+/*! \brief Append user-owned memory to the frame content, after the data currently serialized in the frame packet.
+ *         The memory is not copied, so it must not be modified until release is called
+ *
+ *  \param f Pointer to the TcprosFrame object
+ *  \param data Pointer to the memory
+ *  \param len Length of the memory in bytes
+ *  \param release Function called when the frame is freed, or NULL
+ *  \param release_context Parameter of the release function
+ *  \return 0 on success, -1 on failure
+ */
+int tcprosFrameAppendExternal( TcprosFrame *f, const void *data, size_t len,
+                               TcprosFrameReleaseCallback release, void *release_context );
+
+/*! \brief Finish the frame content: set the packet size field and build the memory regions to be sent (f->iov).
+ *         The frame content cannot be modified after calling this function
+ *
+ *  \param f Pointer to the TcprosFrame object
+ *  \return 0 on success, -1 on failure
+ */
+int tcprosFrameSeal( TcprosFrame *f );
+
+/*! \brief Add a reference to a frame
+ *
+ *  \param f Pointer to the TcprosFrame object
+ *  \return The pointer to the frame (f)
+ */
+TcprosFrame *tcprosFrameRetain( TcprosFrame *f );
+
+/*! \brief Remove a reference to a frame. The frame is freed when no reference remains
+ *
+ *  \param f Pointer to the TcprosFrame object. If it is NULL nothing is done
+ */
+void tcprosFrameRelease( TcprosFrame *f );
+
+/*! \brief Action taken when a frame is pushed into a full TcprosFrameQueue */
+typedef enum
+{
+  TCPROS_FRAME_QUEUE_DROP_OLDEST = 0,   //! The oldest queued frame is discarded to make room for the new one
+  TCPROS_FRAME_QUEUE_DROP_NEWEST,       //! The new frame is discarded
+  TCPROS_FRAME_QUEUE_DISCONNECT         //! The new frame is not queued and the connection must be closed
+} TcprosFrameQueuePolicy;
+
+/*! \brief Bounded FIFO queue of frames waiting to be sent through a connection.
+ *         The queue owns a reference to each queued frame.
+ *         NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+typedef struct TcprosFrameQueueEntry TcprosFrameQueueEntry;
+struct TcprosFrameQueueEntry
+{
+  TcprosFrame *frame;                   //! The queued frame
+  uint32_t tag;                         //! Value stored with the frame
+};
+
+typedef struct TcprosFrameQueue TcprosFrameQueue;
+struct TcprosFrameQueue
+{
+  TcprosFrameQueueEntry *entries;       //! Circular buffer of queued frames
+  int capacity;                         //! Maximum number of queued frames
+  int first;                            //! Index in entries of the oldest queued frame
+  int count;                            //! Number of queued frames
+  TcprosFrameQueuePolicy policy;        //! What to do when a frame is pushed into the full queue
+  unsigned long n_dropped;              //! Number of frames discarded since the queue was initialized
+};
+
+/*! \brief Initialize an empty frame queue with no capacity
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ */
+void tcprosFrameQueueInit( TcprosFrameQueue *q );
+
+/*! \brief Release all the queued frames and the memory of a frame queue
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ */
+void tcprosFrameQueueRelease( TcprosFrameQueue *q );
+
+/*! \brief Change the maximum number of frames of a queue. If the queue holds more frames than
+ *         the new capacity, the oldest ones are discarded
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ *  \param capacity The new capacity (it must be greater than 0)
+ *  \return 0 on success, -1 on failure
+ */
+int tcprosFrameQueueSetCapacity( TcprosFrameQueue *q, int capacity );
+
+/*! \brief Append a frame to a queue, adding a reference to it. If the queue is full, the queue policy is applied
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ *  \param f Pointer to the frame
+ *  \return 0 if the frame has been queued, 1 if a frame has been discarded according to the policy,
+ *          -1 if the queue is full and its policy is TCPROS_FRAME_QUEUE_DISCONNECT
+ */
+int tcprosFrameQueuePush( TcprosFrameQueue *q, TcprosFrame *f );
+
+/*! \brief Like tcprosFrameQueuePush(), but a value is stored with the frame
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ *  \param f Pointer to the frame
+ *  \param tag Value stored with the frame (see tcprosFrameQueuePeek())
+ *  \return 0 if the frame has been queued, 1 if a frame has been discarded according to the policy,
+ *          -1 if the queue is full and its policy is TCPROS_FRAME_QUEUE_DISCONNECT
+ */
+int tcprosFrameQueuePushTagged( TcprosFrameQueue *q, TcprosFrame *f, uint32_t tag );
+
+/*! \brief Get the oldest frame of a queue without extracting it
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ *  \param tag Pointer to a variable that receives the value stored with the frame, or NULL
+ *  \return The pointer to the frame, or NULL if the queue is empty
+ */
+TcprosFrame *tcprosFrameQueuePeek( TcprosFrameQueue *q, uint32_t *tag );
+
+/*! \brief Extract the oldest frame of a queue. The reference held by the queue is transferred to the caller
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ *  \return The pointer to the frame, or NULL if the queue is empty
+ */
+TcprosFrame *tcprosFrameQueuePop( TcprosFrameQueue *q );
+
+/*! \brief Discard all the frames of a queue (the memory of the queue IS NOT released)
+ *
+ *  \param q Pointer to the TcprosFrameQueue object
+ */
+void tcprosFrameQueueClear( TcprosFrameQueue *q );
+
+/*! @}*/
+
+#endif
@@ -2,6 +2,10 @@
 #define _TCPROS_PROCESS_H_
 
 #include "tcpip_socket.h"
+#include "cros_event_backend.h"
+#include "cros_slot_table.h"
+#include "tcpros_frame.h"
+#include "ring_buffer.h"
 
 /*! \defgroup tcpros_process TCPROS process */
 
@@ -46,6 +50,14 @@ struct TcprosProcess
   unsigned char tcp_nodelay;            //! If 1, the publisher should set TCP_NODELAY on the socket, if possible. Otherwise 0
   unsigned char persistent;             //! If 1, the service connection should be kept open for multiple requests. Otherwise it should be 0
   DynBuffer packet;                     //! The incoming/outgoing TCPROS packet
+  TcprosFrame *frame;                   //! Shared outgoing packet (e.g., a published message) being sent instead of packet, or NULL
+  size_t frame_offset;                  //! Number of bytes of frame already sent
+  TcprosFrameQueue frame_queue;         //! Shared packets waiting to be sent after frame
+  uint32_t frame_zc_sent;               //! Value of socket.zc_sent when the process started to send frame
+  size_t zerocopy_min_size;             //! Minimum size of the frames sent with MSG_ZEROCOPY, or 0 if zero copy is not used
+  TcprosFrameQueue zc_frames;           //! Frames sent with MSG_ZEROCOPY that the kernel may still be using (tagged with the last send operation number)
+  RingBuffer recv_buffer;               //! Received bytes not yet dispatched (used by subscribers to receive several messages at once)
+  unsigned char read_paused;            //! If 1, the socket is not watched for incoming data (see tcprosProcessPauseReading()). Otherwise 0
   uint64_t last_change_time;            //! Last state change time (in ms)
   int topic_idx;                        //! Index used to associate the process to a publisher or a subscriber
   int service_idx;                      //! Index used to associate the process to a service provider or a service client
@@ -54,6 +66,15 @@ struct TcprosProcess
   int probe;							              //! The current session is a probing one
   int sub_tcpros_port;                  //! Port (obtained from a publisher node) to which the process must connect
   char *sub_tcpros_host;                //! Host (obtained from a publisher node) to which the process must connect
+  CrosEventBackend *event_backend;      //! Event backend that monitors the socket of the process, or NULL if it is not monitored
+  uint32_t event_tag;                   //! Identifier of the process in the event backend
+  CrosSlotTable *idle_slots;            //! If not NULL, slot_idx is stored in this table as reusable when the process becomes idle
+  int slot_idx;                         //! Index of the process in the node table that owns it
+  unsigned char in_idle_slots;          //! 1 if slot_idx is currently stored in idle_slots. Otherwise 0
+  CrosSlotList *connect_slots;          //! If not NULL, slot_idx is stored in this list when the process must start a connection
+  unsigned char in_connect_slots;       //! 1 if slot_idx is currently stored in connect_slots. Otherwise 0
+  unsigned char in_pending_slots;       //! 1 if the node has stored slot_idx to dispatch the buffered messages or resume reading later. Otherwise 0
+  uint32_t svc_work_seq;                //! Identifier of the last service request of the process handed to the node worker pool
 };
 
 
@@ -83,6 +104,47 @@ void tcprosProcessClear( TcprosProcess *p );
  */
 void tcprosProcessReset( TcprosProcess *p );
 
+/*! \brief Set the shared packet that the process must send next
+ *
+ *  A reference to the new frame is added and the reference to the previous frame (if any) is released.
+ *  \param p Pointer to TcprosProcess object
+ *  \param f Pointer to the frame to be sent, or NULL to stop using a frame
+ */
+void tcprosProcessSetFrame( TcprosProcess *p, TcprosFrame *f );
+
+/*! \brief Replace the frame of the process with the oldest frame waiting in its frame queue.
+ *         If the previous frame has been sent with MSG_ZEROCOPY, it is kept until the kernel releases it
+ *
+ *  \param p Pointer to TcprosProcess object
+ *  \return 1 if a new frame must be sent, 0 if the frame queue was empty (the process frame is set to NULL)
+ */
+int tcprosProcessNextFrame( TcprosProcess *p );
+
+/*! \brief Release the frames sent with MSG_ZEROCOPY whose memory is no longer used by the kernel
+ *
+ *  \param p Pointer to TcprosProcess object
+ *  \return The number of zero-copy completion notifications received through the socket
+ */
+int tcprosProcessReleaseZeroCopyFrames( TcprosProcess *p );
+
+/*! \brief Check whether the kernel may still be using frames sent by the process with MSG_ZEROCOPY. The frame being sent
+ *         is moved to the zero-copy frames if needed, so it must be called before closing the connection
+ *
+ *  \param p Pointer to TcprosProcess object
+ *  \return 1 if some frame is still in use, 0 otherwise
+ */
+int tcprosProcessZeroCopyInUse( TcprosProcess *p );
+
+/*! \brief Move the socket of a process and the frames sent through it with MSG_ZEROCOPY to another process, which keeps
+ *         them until the kernel releases the frames (see tcprosProcessReleaseZeroCopyFrames()). The peer is disconnected and
+ *         the socket stops being monitored, but it is not closed, since the completion notifications are read through it.
+ *         The socket of p is left closed, so the process can be reset
+ *
+ *  \param p Pointer to TcprosProcess object whose connection is being closed
+ *  \param dst Pointer to an initialized TcprosProcess object that receives the socket and the frames
+ */
+void tcprosProcessDetachZeroCopyFrames( TcprosProcess *p, TcprosProcess *dst );
+
 /*! \brief Change the internal state of an TcprosProcess object, and update its timer
  *
  *  \param s Pointer to TcprosProcess object
@@ -90,6 +152,25 @@ void tcprosProcessReset( TcprosProcess *p );
  */
 void tcprosProcessChangeState( TcprosProcess *p, TcprosProcessState state );
 
+/*! \brief Update the events monitored for the socket of a TcprosProcess object according to its current state
+ *
+ *  It is called automatically when the state changes. It must be also called when the socket is (re)opened
+ *  without a state change (e.g., when a connection is started).
+ *
+ *  \param p Pointer to TcprosProcess object
+ */
+void tcprosProcessUpdateEvents( TcprosProcess *p );
+
+/*! \brief Stop (or resume) watching the socket of a TcprosProcess object for incoming data while it is in a reading state
+ *
+ *  The data sent by the peer stays in the socket buffers meanwhile, so TCP flow control eventually stops the peer.
+ *  The process reads normally again when it becomes idle.
+ *
+ *  \param p Pointer to TcprosProcess object
+ *  \param pause 1 to stop reading, 0 to resume it
+ */
+void tcprosProcessPauseReading( TcprosProcess *p, int pause );
+
 /*! @}*/
 
 #endif
@@ -2,6 +2,8 @@
 #define _XMLRPC_PROCESS_H_
 
 #include "tcpip_socket.h"
+#include "cros_event_backend.h"
+#include "cros_slot_table.h"
 #include "xmlrpc_protocol.h"
 #include "cros_api_call.h"
 
@@ -41,6 +43,13 @@ struct XmlrpcProcess
   uint64_t last_change_time;            //! Last state change time (in ms)
   char host[256];
   int port;
+  CrosEventBackend *event_backend;      //! Event backend that monitors the socket of the process, or NULL if it is not monitored
+  uint32_t event_tag;                   //! Identifier of the process in the event backend
+  CrosSlotTable *idle_slots;            //! If not NULL, slot_idx is stored in this table as reusable when the process becomes idle
+  int slot_idx;                         //! Index of the process in the node table that owns it
+  unsigned char in_idle_slots;          //! 1 if slot_idx is currently stored in idle_slots. Otherwise 0
+  CrosSlotList *connect_slots;          //! If not NULL, slot_idx is stored in this list when the process must start a connection
+  unsigned char in_connect_slots;       //! 1 if slot_idx is currently stored in connect_slots. Otherwise 0
 };
 
 
@@ -76,6 +85,15 @@ void xmlrpcProcessReset( XmlrpcProcess *p);
  */
 void xmlrpcProcessChangeState( XmlrpcProcess *p, XmlrpcProcessState state );
 
+/*! \brief Update the events monitored for the socket of an XmlrpcProcess object according to its current state
+ *
+ *  It is called automatically when the state changes. It must be also called when the socket is (re)opened
+ *  without a state change (e.g., when a connection is started).
+ *
+ *  \param p Pointer to XmlrpcProcess object
+ */
+void xmlrpcProcessUpdateEvents( XmlrpcProcess *p );
+
 /*! @}*/
 
 #endif
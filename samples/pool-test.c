@@ -0,0 +1,339 @@
+/*! \file pool-test.c
+ *  \brief The file tests the execution of the subscriber callbacks in the worker pool of a node
+ *         (see cRosNodeSetCallbackThreads()).
+ *
+ *  Two nodes are run by the main thread: /pool_test_pub publishes the topic /pool_test and
+ *  /pool_test_sub subscribes to it twice, running its callbacks in a pool of worker threads.
+ *  Several producer threads post numbered messages to the publisher with cRosNodePostTopicMsg().
+ *  The callback of the first subscriber checks that the messages of each producer arrive in order,
+ *  and the callback of the second one is slow, so its strand is busy when this subscriber is
+ *  unregistered and released. The test checks that no callback of the released subscriber runs
+ *  afterwards. A ROS master must be running. The exit code is EXIT_FAILURE if a check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#  include <direct.h>
+
+#  define DIR_SEPARATOR_STR "\\"
+#else
+#  include <unistd.h>
+
+#  define DIR_SEPARATOR_STR "/"
+#endif
+
+#include "cros.h"
+#include "cros_thread.h"
+#include "cros_atomic.h"
+
+#define N_PRODUCERS 4          //! Num threads posting messages to the publisher
+#define N_PRODUCER_MSGS 250    //! Num messages posted by each producer
+#define N_WORKERS 4            //! Num threads of the worker pool of the subscriber node
+#define SLOW_CALLBACK_MS 20    //! Time spent by each call to the callback of the slow subscriber
+#define TEST_TIMEOUT_MS 30000  //! Maximum duration of each step of the test
+
+typedef struct Producer Producer;
+struct Producer
+{
+  CrosThread thread;
+  int id;
+  cRosMessage *msg;    //! Message reused by the producer (the node copies it when it is posted)
+  int n_posted;        //! Num messages posted successfully
+};
+
+static CrosNode *pub_node, *sub_node;
+static int pub_idx, ordered_sub_idx, slow_sub_idx;
+
+static int last_seq[N_PRODUCERS];         //! Last message received from each producer (only used by the ordered subscriber strand)
+static int n_ordered_msgs = 0;            //! Num producer messages received by the ordered subscriber
+static int n_warm_up_msgs = 0;            //! Num warm-up messages received by the ordered subscriber
+static int n_disordered_msgs = 0;         //! Num messages received out of order
+static int n_running_callbacks = 0;       //! Num callbacks running in the workers right now
+static int max_running_callbacks = 0;     //! Maximum of n_running_callbacks
+static int n_slow_calls = 0;              //! Num calls to the callback of the slow subscriber
+static int slow_callback_running = 0;     //! 1 while the callback of the slow subscriber is running
+static int slow_sub_released = 0;         //! Set by the node thread when the slow subscriber is released
+static int slow_busy_at_release = 0;      //! slow_callback_running when the slow subscriber was released
+static int n_slow_calls_at_release = 0;   //! n_slow_calls when the slow subscriber was released
+
+static void sleepMs( unsigned int ms )
+{
+#ifdef _WIN32
+  Sleep(ms);
+#else
+  usleep(ms*1000);
+#endif
+}
+
+static void enterCallback( void )
+{
+  int n_running = CROS_ATOMIC_FETCH_ADD_INT(&n_running_callbacks, 1) + 1, prev_max;
+
+  // Store the largest value again if another callback stored a larger one meanwhile
+  while((prev_max = CROS_ATOMIC_XCHG_INT(&max_running_callbacks, n_running)) > n_running)
+    n_running = prev_max;
+}
+
+static void exitCallback( void )
+{
+  CROS_ATOMIC_FETCH_ADD_INT(&n_running_callbacks, -1);
+}
+
+// Messages: "<producer id> <sequence number>". The producer id -1 is used by the warm-up messages
+static CallbackResponse callbackOrderedSub( cRosMessage *message, void *data_context )
+{
+  cRosMessageField *data_field = cRosMessageGetField(message, "data");
+  int id, seq;
+
+  enterCallback();
+  if(data_field != NULL && sscanf(data_field->data.as_string, "%d %d", &id, &seq) == 2)
+  {
+    if(id < 0)
+      CROS_ATOMIC_FETCH_ADD_INT(&n_warm_up_msgs, 1);
+    else if(id < N_PRODUCERS)
+    {
+      // The callbacks of a subscriber run one at a time, so last_seq is not shared with other threads
+      if(seq <= last_seq[id])
+        CROS_ATOMIC_FETCH_ADD_INT(&n_disordered_msgs, 1);
+      last_seq[id] = seq;
+      CROS_ATOMIC_FETCH_ADD_INT(&n_ordered_msgs, 1);
+    }
+  }
+  exitCallback();
+  return 0; // 0=success
+}
+
+static CallbackResponse callbackSlowSub( cRosMessage *message, void *data_context )
+{
+  enterCallback();
+  CROS_ATOMIC_STORE_INT(&slow_callback_running, 1);
+  CROS_ATOMIC_FETCH_ADD_INT(&n_slow_calls, 1);
+  sleepMs(SLOW_CALLBACK_MS);
+  CROS_ATOMIC_STORE_INT(&slow_callback_running, 0);
+  exitCallback();
+  return 0;
+}
+
+// Called by the node thread (the main thread) just before the slow subscriber is released
+static void statusSlowSub( CrosNodeStatusUsr *status, void *context )
+{
+  if(status->state != CROS_STATUS_SUBSCRIBER_UNREGISTERED)
+    return;
+
+  slow_busy_at_release = CROS_ATOMIC_LOAD_INT(&slow_callback_running);
+  slow_sub_released = 1;
+}
+
+static void producerThread( void *arg )
+{
+  Producer *producer = (Producer *)arg;
+  cRosMessageField *data_field = cRosMessageGetField(producer->msg, "data");
+  char data[32];
+  int seq, n_tries;
+
+  for(seq = 0; seq < N_PRODUCER_MSGS; seq++)
+  {
+    snprintf(data, sizeof(data), "%d %d", producer->id, seq);
+    if(cRosMessageSetFieldValueString(data_field, data) != 0)
+      continue;
+    // The message is posted again while the queue of posted messages is full
+    for(n_tries = 0; n_tries < 1000; n_tries++)
+    {
+      if(cRosNodePostTopicMsg(pub_node, pub_idx, producer->msg) == CROS_SUCCESS_ERR_PACK)
+      {
+        producer->n_posted++;
+        break;
+      }
+      sleepMs(1);
+    }
+  }
+}
+
+// Run both nodes until the function returns 1 or the test timeout is up. Returns 0 on timeout
+static int runNodesUntil( int (*done)(void *), void *arg )
+{
+  uint64_t start_time = cRosClockGetTimeMs();
+
+  while(!done(arg))
+  {
+    if(cRosClockGetTimeMs() - start_time > TEST_TIMEOUT_MS)
+      return 0;
+    cRosNodeDoEventsLoop(pub_node, 1);
+    cRosNodeDoEventsLoop(sub_node, 1);
+  }
+  return 1;
+}
+
+static int warmUpReceived( void *arg )
+{
+  static uint64_t last_post_time = 0;
+  cRosMessage *msg = (cRosMessage *)arg;
+
+  // The subscriber may not be connected yet, so a new message is published every 100 ms
+  if(cRosClockGetTimeMs() - last_post_time >= 100)
+  {
+    cRosNodePostTopicMsg(pub_node, pub_idx, msg);
+    last_post_time = cRosClockGetTimeMs();
+  }
+  return CROS_ATOMIC_LOAD_INT(&n_warm_up_msgs) > 0;
+}
+
+static int slowSubBusy( void *arg )
+{
+  return CROS_ATOMIC_LOAD_INT(&n_slow_calls) > 1;
+}
+
+static int slowSubReleased( void *arg )
+{
+  return slow_sub_released;
+}
+
+static int allMsgsReceived( void *arg )
+{
+  return CROS_ATOMIC_LOAD_INT(&n_ordered_msgs) >= *(int *)arg;
+}
+
+static int workersIdle( void *arg )
+{
+  return CROS_ATOMIC_LOAD_INT(&n_running_callbacks) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *default_host = "127.0.0.1",
+       *node_host = default_host,
+       *roscore_host = default_host;
+  unsigned short roscore_port = 11311;
+  Producer producers[N_PRODUCERS];
+  cRosErrCodePack err_cod;
+  cRosMessage *warm_up_msg;
+  int i, n_posted, failed = 0;
+
+  for(i = 1; i < argc; i++)
+  {
+    if( strcmp(argv[i],"-host") == 0 && i + 1 < argc)
+      node_host = argv[++i];
+    else if( strcmp(argv[i],"-chost") == 0 && i + 1 < argc)
+      roscore_host = argv[++i];
+    else if( strcmp(argv[i],"-cport") == 0 && i + 1 < argc)
+    {
+      int i_port = atoi(argv[++i]);
+      if( i_port < 0 || i_port > USHRT_MAX )
+      {
+        fprintf(stderr,"Invalid port value %d.\n",i_port);
+        return(EXIT_FAILURE);
+      }
+      roscore_port = (unsigned short)i_port;
+    }
+    else
+    {
+      printf("Usage: %s [-host <node_host>] [-chost <roscore host>] [-cport <roscore port>]\n", argv[0]);
+      return(strcmp(argv[i], "-h") == 0? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+  }
+
+  char path[4096];
+  getcwd(path, sizeof(path));
+  strncat(path, DIR_SEPARATOR_STR"rosdb", sizeof(path) - strlen(path) - 1);
+
+  pub_node = cRosNodeCreate("/pool_test_pub", node_host, roscore_host, roscore_port, path);
+  sub_node = cRosNodeCreate("/pool_test_sub", node_host, roscore_host, roscore_port, path);
+  if(pub_node == NULL || sub_node == NULL)
+    return EXIT_FAILURE;
+
+  // Room for all the messages, so that none of them is dropped
+  err_cod = cRosNodeSetCallbackThreads(sub_node, N_WORKERS, N_PRODUCERS * N_PRODUCER_MSGS);
+  if(err_cod == CROS_SUCCESS_ERR_PACK)
+    err_cod = cRosApiRegisterPublisher(pub_node, "/pool_test", "std_msgs/String", -1, NULL, NULL, NULL, &pub_idx);
+  if(err_cod == CROS_SUCCESS_ERR_PACK)
+    err_cod = cRosNodeSetPublisherQueueSize(pub_node, pub_idx, N_PRODUCERS * N_PRODUCER_MSGS);
+  if(err_cod == CROS_SUCCESS_ERR_PACK)
+    err_cod = cRosApiRegisterSubscriber(sub_node, "/pool_test", "std_msgs/String", callbackOrderedSub, NULL, NULL, 0, &ordered_sub_idx);
+  if(err_cod == CROS_SUCCESS_ERR_PACK)
+    err_cod = cRosApiRegisterSubscriber(sub_node, "/pool_test", "std_msgs/String", callbackSlowSub, statusSlowSub, NULL, 0, &slow_sub_idx);
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosPrintErrCodePack(err_cod, "pool-test: the publisher and subscribers could not be created");
+    return EXIT_FAILURE;
+  }
+
+  warm_up_msg = cRosApiCreatePublisherMessage(pub_node, pub_idx);
+  cRosMessageSetFieldValueString(cRosMessageGetField(warm_up_msg, "data"), "-1 0");
+  if(!runNodesUntil(warmUpReceived, warm_up_msg))
+  {
+    printf("pool-test: the subscriber did not receive the warm-up messages\n");
+    return EXIT_FAILURE;
+  }
+  cRosMessageFree(warm_up_msg);
+
+  for(i = 0; i < N_PRODUCERS; i++)
+  {
+    last_seq[i] = -1;
+    producers[i].id = i;
+    producers[i].n_posted = 0;
+    producers[i].msg = cRosApiCreatePublisherMessage(pub_node, pub_idx);
+    if(producers[i].msg == NULL || cRosThreadCreate(&producers[i].thread, producerThread, &producers[i]) != 0)
+    {
+      printf("pool-test: producer %d could not be started\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Release the slow subscriber while its strand runs a callback and has more messages waiting
+  if(!runNodesUntil(slowSubBusy, NULL))
+  {
+    printf("pool-test: the slow subscriber did not receive messages\n");
+    failed = 1;
+  }
+  cRosApiUnregisterSubscriber(sub_node, slow_sub_idx);
+  if(!runNodesUntil(slowSubReleased, NULL))
+  {
+    printf("pool-test: the slow subscriber was not released\n");
+    failed = 1;
+  }
+  n_slow_calls_at_release = CROS_ATOMIC_LOAD_INT(&n_slow_calls);
+
+  n_posted = 0;
+  for(i = 0; i < N_PRODUCERS; i++)
+  {
+    cRosThreadJoin(&producers[i].thread);
+    cRosMessageFree(producers[i].msg);
+    n_posted += producers[i].n_posted;
+  }
+
+  if(!runNodesUntil(allMsgsReceived, &n_posted) || !runNodesUntil(workersIdle, NULL))
+  {
+    printf("pool-test: only %d of %d messages were received\n", CROS_ATOMIC_LOAD_INT(&n_ordered_msgs), n_posted);
+    failed = 1;
+  }
+
+  printf("pool-test: %d messages posted by %d producers, %d received (%d out of order)\n",
+         n_posted, N_PRODUCERS, CROS_ATOMIC_LOAD_INT(&n_ordered_msgs), CROS_ATOMIC_LOAD_INT(&n_disordered_msgs));
+  printf("pool-test: %d callbacks ran at the same time in %d workers\n", CROS_ATOMIC_LOAD_INT(&max_running_callbacks), N_WORKERS);
+  printf("pool-test: the slow subscriber was released after %d calls (callback running: %d), %d calls in total\n",
+         n_slow_calls_at_release, slow_busy_at_release, CROS_ATOMIC_LOAD_INT(&n_slow_calls));
+
+  if(CROS_ATOMIC_LOAD_INT(&n_disordered_msgs) > 0)
+    failed = 1;
+  if(CROS_ATOMIC_LOAD_INT(&n_slow_calls) != n_slow_calls_at_release || CROS_ATOMIC_LOAD_INT(&slow_callback_running))
+  {
+    printf("pool-test: a callback of the slow subscriber ran after it was released\n");
+    failed = 1;
+  }
+
+  // All done: free memory and unregister from ROS master
+  err_cod = cRosNodeDestroy( sub_node );
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(err_cod, "cRosNodeDestroy() failed; Error unregistering from ROS master");
+  err_cod = cRosNodeDestroy( pub_node );
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(err_cod, "cRosNodeDestroy() failed; Error unregistering from ROS master");
+
+  printf("pool-test: %s\n", failed? "FAILED" : "OK");
+  return failed? EXIT_FAILURE : EXIT_SUCCESS;
+}
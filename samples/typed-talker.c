@@ -0,0 +1,146 @@
+/*! \file typed-talker.c
+ *  \brief This file is an example of cROS usage implementing publishers of message types generated at build time
+ *         by cros-msggen (see cmake/CrosMessages.cmake). It can be used together with listener or typed-listener.
+ *
+ *  It creates a publisher to the topic /chatter of the generated type std_msgs_String. Each 100ms the callback
+ *  function callback_pub() fills the struct of the message, which is serialized by the generated code.
+ *  Each time, the callback also publishes the state of two joints in the topic /joint_states through
+ *  cRosNodeSendTypedMsg(), which sends a message right away instead of waiting for the publisher period.
+ *  When the number of published messages is 10 the ROS node exits and the program finishes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#  include <direct.h>
+
+#  define DIR_SEPARATOR_STR "\\"
+#else
+#  include <unistd.h>
+
+#  define DIR_SEPARATOR_STR "/"
+#endif
+
+#include "cros.h"
+#include "cros_clock.h"
+#include "std_msgs/String.h"
+#include "sensor_msgs/JointState.h"
+
+#define ROS_MASTER_PORT 11311
+#define ROS_MASTER_ADDRESS "127.0.0.1"
+
+CrosNode *node; //! Pointer to object storing the ROS node. This object includes all the ROS node state variables
+unsigned char exit_flag = 0; //! ROS node loop exit flag. When set to 1 the cRosNodeStart() function exits
+int joint_pubidx; //! Index of the /joint_states publisher
+sensor_msgs_JointState joint_state; //! Joint-state message, which keeps its memory from one publication to the next
+
+// This callback will be invoked when it's our turn to publish a new message
+static CallbackResponse callback_pub(void *message, void* data_context)
+{
+  static int pub_count = 0;
+  std_msgs_String *msg = (std_msgs_String *)message;
+  char buf[1024];
+  char *new_data;
+  cRosErrCodePack err_cod;
+
+  snprintf(buf, sizeof(buf), "hello world %d", pub_count);
+  // The strings of the generated structs are allocated with malloc(): the struct release function frees them
+  new_data = (char *)realloc(msg->data, strlen(buf) + 1);
+  if(new_data == NULL)
+    return 1;
+  strcpy(new_data, buf);
+  msg->data = new_data;
+  ROS_INFO(node, "%s\n", buf);
+
+  joint_state.header.seq = pub_count;
+  joint_state.position[0] = 0.1 * pub_count;
+  joint_state.position[1] = -0.1 * pub_count;
+  err_cod = cRosNodeSendTypedMsg(node, joint_pubidx, &joint_state);
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(err_cod, "cRosNodeSendTypedMsg() failed");
+
+  if(++pub_count > 10) exit_flag=1;
+
+  return 0; // 0=success
+}
+
+// Allocate the arrays of the joint-state message: two joints with position only
+static int init_joint_state(void)
+{
+  sensor_msgs_JointState_init(&joint_state);
+  joint_state.name = (char **)calloc(2, sizeof(char *));
+  joint_state.position = (double *)calloc(2, sizeof(double));
+  if(joint_state.name == NULL || joint_state.position == NULL)
+    return -1;
+  joint_state.name_size = joint_state.name_capacity = 2;
+  joint_state.position_size = joint_state.position_capacity = 2;
+  joint_state.name[0] = strdup("shoulder");
+  joint_state.name[1] = strdup("elbow");
+  return (joint_state.name[0] != NULL && joint_state.name[1] != NULL)? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+  // We need to tell our node where to find the .msg files used by the other roles
+  char path[4097];
+  const char *node_name;
+  cRosErrCodePack err_cod;
+  int pubidx;
+
+  if(argc>1)
+    node_name=argv[1];
+  else
+    node_name="/talker"; // Default node name if no command-line parameters are specified
+  getcwd(path, sizeof(path));
+  strncat(path, DIR_SEPARATOR_STR"rosdb", sizeof(path) - strlen(path) - 1);
+  // Create a new node and tell it to connect to roscore in the usual place
+  node = cRosNodeCreate(node_name, "127.0.0.1", ROS_MASTER_ADDRESS, ROS_MASTER_PORT, path);
+  if( node == NULL )
+  {
+    printf("cRosNodeCreate() failed; is this program already being run?");
+    return EXIT_FAILURE;
+  }
+
+  if(init_joint_state() != 0)
+  {
+    printf("Can't allocate memory for the joint-state message\n");
+    sensor_msgs_JointState_release(&joint_state);
+    cRosNodeDestroy( node );
+    return EXIT_FAILURE;
+  }
+
+  // Create a publisher to topic /chatter of the generated type std_msgs/String and request that the associated callback be invoked every 100ms (10Hz)
+  err_cod = cRosApiRegisterTypedPublisher(node, "/chatter", std_msgs_String_type(), 100, callback_pub, NULL, NULL, &pubidx);
+  if(err_cod == CROS_SUCCESS_ERR_PACK)
+  {
+    // The joint states are only sent by cRosNodeSendTypedMsg(), so this publisher has no period (-1) nor callback
+    err_cod = cRosApiRegisterTypedPublisher(node, "/joint_states", sensor_msgs_JointState_type(), -1, NULL, NULL, NULL, &joint_pubidx);
+  }
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosPrintErrCodePack(err_cod, "cRosApiRegisterTypedPublisher() failed");
+    sensor_msgs_JointState_release(&joint_state);
+    cRosNodeDestroy( node );
+    return EXIT_FAILURE;
+  }
+
+  printf("Node TCPROS port: %i\n", node->tcpros_port);
+
+  // Run the main loop until exit_flag is 1
+  err_cod = cRosNodeStart( node, CROS_INFINITE_TIMEOUT, &exit_flag );
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(err_cod, "cRosNodeStart() returned an error code");
+
+  // All done: free memory and unregister from ROS master. The publisher callback can still be called meanwhile
+  err_cod=cRosNodeDestroy( node );
+  sensor_msgs_JointState_release(&joint_state);
+  if(err_cod != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosPrintErrCodePack(err_cod, "cRosNodeDestroy() failed; Error unregistering from ROS master");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
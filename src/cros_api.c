@@ -76,6 +76,8 @@ typedef struct ProviderContext
   NodeStatusApiCallback status_api_callback; //! The application-defined callback function called when the state of the role has chnaged
   cRosMessageQueue *msg_queue; //! It is just a reference to the queue declared in node. For the publisher: it is msgs to send. For the subscriber: it is msgs received. For the svc caller: it is first svc request and then svc response
   void *context; //! Context parameter specified by the application and that will be passed to the application-defined callback functions
+  const cRosTypedMessageType *typed_type; //! Generated message type of a typed publisher or subscriber (NULL for the cRosMessage roles)
+  void *typed_msg; //! Struct of the typed message that is sent or has been received (used instead of outgoing or incoming)
 } ProviderContext;
 
 static void initProviderContext(ProviderContext *context)
@@ -89,6 +91,8 @@ static void initProviderContext(ProviderContext *context)
   context->api_callback=NULL;
   context->msg_queue=NULL;
   context->context=NULL;
+  context->typed_type=NULL;
+  context->typed_msg=NULL;
 }
 
 static void freeProviderContext(ProviderContext *context)
@@ -99,10 +103,41 @@ static void freeProviderContext(ProviderContext *context)
     cRosMessageFree(context->outgoing);
     free(context->message_definition);
     free(context->md5sum);
+    if(context->typed_msg != NULL)
+    {
+      context->typed_type->release(context->typed_msg);
+      free(context->typed_msg);
+    }
     free(context);
   }
 }
 
+// The typed roles take the type identification from the generated code instead of loading the message definition file
+static cRosErrCodePack newTypedProviderContext(ProviderType type, const cRosTypedMessageType *typed_type, ProviderContext **context_ptr)
+{
+  ProviderContext *context = (ProviderContext *)malloc(sizeof(ProviderContext));
+  if (context == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  initProviderContext(context);
+  context->type = type;
+  context->typed_type = typed_type;
+  context->md5sum = strdup(typed_type->md5sum);
+  context->message_definition = strdup(typed_type->definition);
+  context->typed_msg = malloc(typed_type->struct_size);
+  if(context->md5sum == NULL || context->message_definition == NULL || context->typed_msg == NULL)
+  {
+    free(context->typed_msg);
+    context->typed_msg = NULL;
+    freeProviderContext(context);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  typed_type->init(context->typed_msg);
+
+  *context_ptr = context;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 static cRosErrCodePack newProviderContext(const char *provider_path, ProviderType type, ProviderContext **context_ptr)
 {
   cRosErrCodePack ret_err;
@@ -127,6 +162,8 @@ static cRosErrCodePack newProviderContext(const char *provider_path, ProviderTyp
     case CROS_SUBSCRIBER:
     {
       ret_err = cRosMessageNewBuild(NULL, provider_path, &context->incoming);
+      if (ret_err == CROS_SUCCESS_ERR_PACK)
+        ret_err = cRosMessageDefReservePoolSize(context->incoming->msgDef, CN_MESSAGE_POOL_SIZE); // The queued messages reuse their memory
       if (ret_err == CROS_SUCCESS_ERR_PACK)
       {
         strcpy(context->md5sum, context->incoming->md5sum);
@@ -137,6 +174,8 @@ static cRosErrCodePack newProviderContext(const char *provider_path, ProviderTyp
     case CROS_PUBLISHER:
     {
       ret_err = cRosMessageNewBuild(NULL, provider_path, &context->outgoing);
+      if (ret_err == CROS_SUCCESS_ERR_PACK)
+        ret_err = cRosMessageDefReservePoolSize(context->outgoing->msgDef, CN_MESSAGE_POOL_SIZE);
       if (ret_err == CROS_SUCCESS_ERR_PACK)
       {
         strcpy(context->md5sum, context->outgoing->md5sum);
@@ -174,19 +213,52 @@ cRosErrCodePack cRosNodeSerializeOutgoingMessage(DynBuffer *buffer, void *contex
   cRosErrCodePack ret_err;
   ProviderContext *context = (ProviderContext *)context_;
 
-  ret_err = cRosMessageSerialize(context->outgoing, buffer);
+  if(context->typed_type != NULL)
+    ret_err = cRosTypedMessageSerialize(context->typed_type, context->typed_msg, buffer);
+  else
+    ret_err = cRosMessageSerialize(context->outgoing, buffer);
   return(ret_err);
 }
 
+cRosErrCodePack cRosNodeSerializeOutgoingFrame(TcprosFrame *frame, void *context_, size_t min_ext_size)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+
+  if(context->typed_type != NULL) // The arrays of the typed messages belong to the user
+    return cRosTypedMessageSerialize(context->typed_type, context->typed_msg, &frame->packet);
+  return cRosMessageSerializeFrame(context->outgoing, frame, min_ext_size);
+}
+
 cRosErrCodePack cRosNodeDeserializeIncomingPacket(DynBuffer *buffer, void *context_)
 {
   cRosErrCodePack ret_err;
   ProviderContext *context = (ProviderContext *)context_;
 
-  ret_err = cRosMessageDeserialize(context->incoming, buffer);
+  if(context->typed_type != NULL)
+    ret_err = cRosTypedMessageDeserialize(context->typed_type, context->typed_msg, buffer);
+  else
+    ret_err = cRosMessageDeserialize(context->incoming, buffer);
   return(ret_err);
 }
 
+cRosErrCodePack cRosNodeDeserializeIncomingView(SharedBuffer *packet, void *context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+
+  if(context->typed_type != NULL) // The typed messages always own their arrays
+    return cRosTypedMessageDeserialize(context->typed_type, context->typed_msg, &packet->buffer);
+  return cRosMessageDeserializeView(context->incoming, packet);
+}
+
+cRosErrCodePack cRosNodeDeserializeIncomingLazy(SharedBuffer *packet, void *context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+
+  if(context->typed_type != NULL) // The typed messages are plain structs, so they are always decoded at once
+    return cRosTypedMessageDeserialize(context->typed_type, context->typed_msg, &packet->buffer);
+  return cRosMessageDeserializeLazy(context->incoming, packet);
+}
+
 cRosErrCodePack cRosNodePublisherCallback(void *context_)
 {
   cRosErrCodePack ret_err;
@@ -194,9 +266,15 @@ cRosErrCodePack cRosNodePublisherCallback(void *context_)
 
   ret_err = CROS_SUCCESS_ERR_PACK; // Default return value
 
-  if(cRosMessageQueueUsage(context->msg_queue) > 0) // An inmediate message is waiting to be sent
+  if(context->typed_type != NULL) // Typed publishers send their immediate messages with cRosNodeSendTypedMsg() and have no queue
   {
-    if(cRosMessageQueueExtract(context->msg_queue, context->outgoing) != 0)
+    TypedPublisherApiCallback publisher_user_callback = (TypedPublisherApiCallback)context->api_callback;
+    if(publisher_user_callback != NULL && publisher_user_callback(context->typed_msg, context->context) != 0)
+      ret_err = CROS_TOP_PUB_CALLBACK_ERR;
+  }
+  else if(cRosMessageQueueUsage(context->msg_queue) > 0) // An inmediate message is waiting to be sent
+  {
+    if(cRosMessageQueueExtractMove(context->msg_queue, context->outgoing) != 0)
       ret_err = CROS_EXTRACT_MSG_INT_ERR;
   }
   else // It is time to send a periodic message
@@ -223,7 +301,14 @@ cRosErrCodePack cRosNodeSubscriberCallback(void *context_)
 {
   cRosErrCodePack ret_err;
   ProviderContext *context = (ProviderContext *)context_;
-  cRosMessageQueueAdd(context->msg_queue, context->incoming);
+
+  if(context->typed_type != NULL) // Typed subscribers hand the received struct to the callback and do not queue it
+  {
+    TypedSubscriberApiCallback typed_callback_fn = (TypedSubscriberApiCallback)context->api_callback;
+    if(typed_callback_fn != NULL && typed_callback_fn(context->typed_msg, context->context) != 0)
+      return CROS_TOP_SUB_CALLBACK_ERR;
+    return CROS_SUCCESS_ERR_PACK;
+  }
 
   // Cast to the appropriate public api callback and invoke it on the user context
   SubscriberApiCallback subs_user_callback_fn = (SubscriberApiCallback)context->api_callback;
@@ -238,9 +323,256 @@ cRosErrCodePack cRosNodeSubscriberCallback(void *context_)
   else
     ret_err = CROS_SUCCESS_ERR_PACK;
 
+  // The callback has already seen the received message, so its fields can be moved into the queue instead of copied
+  cRosMessageQueueAddMove(context->msg_queue, context->incoming);
+
+  return ret_err;
+}
+
+// Received message waiting for a worker thread to run the subscriber callback
+typedef struct SubscriberWork
+{
+  ProviderContext *context;
+  cRosSharedMessage *msg;
+} SubscriberWork;
+
+static void runSubscriberWork(void *arg, int canceled)
+{
+  SubscriberWork *work = (SubscriberWork *)arg;
+
+  if(!canceled)
+  {
+    SubscriberApiCallback subs_user_callback_fn = (SubscriberApiCallback)work->context->api_callback;
+    if(subs_user_callback_fn(&work->msg->msg, work->context->context) != 0)
+      cRosPrintErrCodePack(CROS_TOP_SUB_CALLBACK_ERR, "runSubscriberWork() : The subscriber callback failed");
+  }
+  cRosSharedMessageRelease(work->msg);
+  free(work);
+}
+
+// Received typed message waiting for a worker thread to run the subscriber callback
+typedef struct TypedSubscriberWork
+{
+  ProviderContext *context;
+  void *msg;
+} TypedSubscriberWork;
+
+static void runTypedSubscriberWork(void *arg, int canceled)
+{
+  TypedSubscriberWork *work = (TypedSubscriberWork *)arg;
+
+  if(!canceled)
+  {
+    TypedSubscriberApiCallback typed_callback_fn = (TypedSubscriberApiCallback)work->context->api_callback;
+    if(typed_callback_fn(work->msg, work->context->context) != 0)
+      cRosPrintErrCodePack(CROS_TOP_SUB_CALLBACK_ERR, "runTypedSubscriberWork() : The subscriber callback failed");
+  }
+  work->context->typed_type->release(work->msg);
+  free(work->msg);
+  free(work);
+}
+
+// The received struct is handed over to the worker and the next message is received in a new one
+static cRosErrCodePack postTypedSubscriberCallback(CrosWorkStrand *strand, ProviderContext *context)
+{
+  TypedSubscriberWork *work;
+  void *new_msg;
+
+  if(context->api_callback == NULL)
+    return CROS_SUCCESS_ERR_PACK;
+
+  work = (TypedSubscriberWork *)malloc(sizeof(TypedSubscriberWork));
+  new_msg = malloc(context->typed_type->struct_size);
+  if(work == NULL || new_msg == NULL)
+  {
+    PRINT_ERROR("postTypedSubscriberCallback() : Can't allocate memory\n");
+    free(work);
+    free(new_msg);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  context->typed_type->init(new_msg);
+  work->context = context;
+  work->msg = context->typed_msg;
+
+  if(cRosWorkStrandPost(strand, runTypedSubscriberWork, work) != 0)
+  {
+    free(work);
+    free(new_msg); // The received message stays in the context
+    return CROS_CALLBACK_QUEUE_FULL_ERR;
+  }
+  context->typed_msg = new_msg;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+// Hand a shared message to the worker that runs the subscriber callback. The queue of the subscriber holds a reference
+// to the message too, and it only copies the message if it is extracted before the callback ends
+static cRosErrCodePack postSharedSubscriberCallback(CrosWorkStrand *strand, ProviderContext *context, cRosSharedMessage *s_msg)
+{
+  SubscriberWork *work;
+
+  cRosMessageQueueAddShared(context->msg_queue, s_msg);
+
+  work = (SubscriberWork *)malloc(sizeof(SubscriberWork));
+  if(work == NULL)
+  {
+    PRINT_ERROR("postSharedSubscriberCallback() : Can't allocate memory\n");
+    return CROS_MEM_ALLOC_ERR;
+  }
+  work->context = context;
+  work->msg = cRosSharedMessageRetain(s_msg);
+
+  if(cRosWorkStrandPost(strand, runSubscriberWork, work) != 0)
+  {
+    cRosSharedMessageRelease(work->msg);
+    free(work);
+    return CROS_CALLBACK_QUEUE_FULL_ERR;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosNodePostSubscriberCallback(CrosWorkStrand *strand, void *context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+  cRosSharedMessage *s_msg;
+  cRosErrCodePack ret_err;
+
+  if(context->typed_type != NULL)
+    return postTypedSubscriberCallback(strand, context);
+
+  if(context->api_callback == NULL) // Only the queue keeps the received message
+  {
+    cRosMessageQueueAddMove(context->msg_queue, context->incoming);
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  // The fields of the received message are moved (not copied) into a message shared by the worker and the queue, so that
+  // context->incoming can be refilled by the next message
+  s_msg = cRosSharedMessageNewMove(context->incoming);
+  if(s_msg == NULL)
+  {
+    PRINT_ERROR("cRosNodePostSubscriberCallback() : Can't allocate memory\n");
+    cRosMessageQueueAddMove(context->msg_queue, context->incoming);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  ret_err = postSharedSubscriberCallback(strand, context, s_msg);
+  cRosSharedMessageRelease(s_msg);
+  return ret_err;
+}
+
+cRosMessage *cRosNodeContextOutgoingMsg(void *context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+  return context->outgoing;
+}
+
+cRosErrCodePack cRosNodeDeliverIntraProcessMsg(cRosSharedMessage *s_msg, void *sub_context_, CrosWorkStrand *strand)
+{
+  ProviderContext *sub_context = (ProviderContext *)sub_context_;
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  if(strand != NULL && sub_context->api_callback != NULL) // The worker runs the callback later, with its own reference
+    return postSharedSubscriberCallback(strand, sub_context, s_msg);
+
+  // The callback reads the message shared by the publisher, so nothing is copied for it
+  SubscriberApiCallback subs_user_callback_fn = (SubscriberApiCallback)sub_context->api_callback;
+  if(subs_user_callback_fn != NULL && subs_user_callback_fn(&s_msg->msg, sub_context->context) != 0)
+    ret_err = CROS_TOP_SUB_CALLBACK_ERR;
+
+  cRosMessageQueueAddShared(sub_context->msg_queue, s_msg);
   return ret_err;
 }
 
+cRosErrCodePack cRosNodeContextReservePool(void *context_, int n_blocks)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+  cRosMessage *msg = (context->type == CROS_SUBSCRIBER)? context->incoming : context->outgoing;
+
+  if(context->typed_type != NULL || msg == NULL || msg->msgDef == NULL) // Typed messages are plain structs without pool
+    return CROS_SUCCESS_ERR_PACK;
+  return cRosMessageDefReservePoolSize(msg->msgDef, n_blocks);
+}
+
+int cRosNodeContextIsTyped(void *context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+  return (context != NULL && context->typed_type != NULL);
+}
+
+static void runServiceProviderWork(void *arg, int canceled)
+{
+  ServiceProviderWork *work = (ServiceProviderWork *)arg;
+  ProviderContext *context = (ProviderContext *)work->context;
+  CrosNode *n = work->node; // The node can free the work as soon as it is pushed
+
+  if(!canceled)
+  {
+    ServiceProviderApiCallback serviceProviderApiCallback = (ServiceProviderApiCallback)context->api_callback;
+    if(serviceProviderApiCallback(work->request, work->response, context->context) == 0)
+      work->result = cRosMessageSerialize(work->response, &work->response_data);
+    else
+      work->result = CROS_SVC_SER_CALLBACK_ERR;
+    if(work->result != CROS_SUCCESS_ERR_PACK)
+      cRosPrintErrCodePack(work->result, "runServiceProviderWork() : The service response could not be generated");
+  }
+  else
+    work->result = CROS_SVC_SER_CALLBACK_ERR; // The provider is being released: the caller receives a failure response
+
+  cRosMessageFree(work->request);
+  cRosMessageFree(work->response);
+  work->request = NULL;
+  work->response = NULL;
+
+  // Return the response to the thread running the node
+  cRosMpscQueuePush(&n->finished_svc_works, &work->link);
+  tcpIpSocketNotify(&n->wakeup_notifier);
+}
+
+cRosErrCodePack cRosNodePostServiceProviderCallback(CrosNode *n, CrosWorkStrand *strand, DynBuffer *packet,
+                                                    int server_idx, uint32_t seq, void *context_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)context_;
+  ServiceProviderWork *work;
+
+  ret_err = cRosMessageDeserialize(context->incoming, packet);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  work = (ServiceProviderWork *)malloc(sizeof(ServiceProviderWork));
+  if(work == NULL)
+  {
+    PRINT_ERROR("cRosNodePostServiceProviderCallback() : Can't allocate memory\n");
+    return CROS_MEM_ALLOC_ERR;
+  }
+  work->link.next = NULL;
+  work->node = n;
+  work->context = context;
+  work->server_idx = server_idx;
+  work->seq = seq;
+  // The response keeps its definition, so that the callback can grow arrays of custom messages in it
+  work->request = cRosMessageCopyWithoutDef(context->incoming);
+  work->response = cRosMessageCopy(context->outgoing);
+  dynBufferInit(&work->response_data);
+  work->result = CROS_SUCCESS_ERR_PACK;
+  if(work->request == NULL || work->response == NULL)
+  {
+    PRINT_ERROR("cRosNodePostServiceProviderCallback() : Can't allocate memory\n");
+    cRosMessageFree(work->request);
+    cRosMessageFree(work->response);
+    free(work);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  if(cRosWorkStrandPost(strand, runServiceProviderWork, work) != 0)
+  {
+    cRosMessageFree(work->request);
+    cRosMessageFree(work->response);
+    free(work);
+    return CROS_CALLBACK_QUEUE_FULL_ERR;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 cRosErrCodePack cRosNodeServiceCallerCallback(int call_resp_flag, void* contex_)
 {
   cRosErrCodePack ret_err;
@@ -268,7 +600,7 @@ cRosErrCodePack cRosNodeServiceCallerCallback(int call_resp_flag, void* contex_)
     }
     else // Non-periodic service call
     {
-      if(cRosMessageQueueAdd(context->msg_queue, context->incoming) == 0) // Add response msg to the queue (in case the svc was called non periodically)
+      if(cRosMessageQueueAddMove(context->msg_queue, context->incoming) == 0) // Add response msg to the queue (in case the svc was called non periodically)
         ret_err = CROS_SUCCESS_ERR_PACK; // A new message has been aded to the queue to later store the received response
       else
         ret_err = CROS_MEM_ALLOC_ERR;
@@ -351,7 +683,7 @@ cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service
     {
       if(svcidx_ptr != NULL)
         *svcidx_ptr = svcidx; // Return the index of the created service caller
-      nodeContext->msg_queue = &node->service_callers[svcidx].msg_queue;
+      nodeContext->msg_queue = &node->service_callers[svcidx]->msg_queue;
     }
     else
       ret_err=CROS_MEM_ALLOC_ERR;
@@ -361,9 +693,10 @@ cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service
 
 void cRosApiReleaseServiceCaller(CrosNode *node, int svcidx)
 {
-  ServiceCallerNode *svc = &node->service_callers[svcidx];
+  ServiceCallerNode *svc = node->service_callers[svcidx];
   ProviderContext *context = (ProviderContext *)svc->context;
   freeProviderContext(context);
+  cRosTimerHeapCancel(&node->timers, &svc->timer);
   cRosNodeReleaseServiceCaller(svc);
 }
 
@@ -402,10 +735,10 @@ cRosErrCodePack cRosApiRegisterServiceProvider(CrosNode *node, const char *servi
 cRosErrCodePack cRosApiUnregisterServiceProvider(CrosNode *node, int svcidx)
 {
   int ret_err;
-  if (svcidx < 0 || svcidx >= CN_MAX_SERVICE_PROVIDERS)
+  if (svcidx < 0 || svcidx >= node->service_provider_slots.n_slots)
     return CROS_BAD_PARAM_ERR;
 
-  ServiceProviderNode *service = &node->service_providers[svcidx];
+  ServiceProviderNode *service = node->service_providers[svcidx];
   if (service->service_name == NULL)
     return CROS_TOPIC_SUB_IND_ERR;
 
@@ -416,8 +749,9 @@ cRosErrCodePack cRosApiUnregisterServiceProvider(CrosNode *node, int svcidx)
 
 void cRosApiReleaseServiceProvider(CrosNode *node, int svcidx)
 {
-  ServiceProviderNode *svc = &node->service_providers[svcidx];
+  ServiceProviderNode *svc = node->service_providers[svcidx];
   ProviderContext *context = (ProviderContext *)svc->context;
+  cRosWorkStrandRelease(&svc->callback_strand); // The context cannot be freed while a worker uses it
   freeProviderContext(context);
   cRosNodeReleaseServiceProvider(svc);
 }
@@ -443,7 +777,7 @@ cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name
                                   nodeContext->md5sum, nodeContext, tcp_nodelay);
     if(subidx >= 0) // Success
     {
-      nodeContext->msg_queue = &node->subs[subidx].msg_queue; // Allow the callback functions to access the msg queue
+      nodeContext->msg_queue = &node->subs[subidx]->msg_queue; // Allow the callback functions to access the msg queue
       if(subidx_ptr != NULL)
         *subidx_ptr = subidx; // Return the index of the created service caller
     }
@@ -456,10 +790,10 @@ cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name
 cRosErrCodePack cRosApiUnregisterSubscriber(CrosNode *node, int subidx)
 {
   int ret_err;
-  if (subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if (subidx < 0 || subidx >= node->sub_slots.n_slots)
     return CROS_BAD_PARAM_ERR;
 
-  SubscriberNode *sub = &node->subs[subidx];
+  SubscriberNode *sub = node->subs[subidx];
   if (sub->topic_name == NULL)
     return CROS_TOPIC_SUB_IND_ERR;
 
@@ -470,8 +804,9 @@ cRosErrCodePack cRosApiUnregisterSubscriber(CrosNode *node, int subidx)
 
 void cRosApiReleaseSubscriber(CrosNode *node, int subidx)
 {
-  SubscriberNode *sub = &node->subs[subidx];
+  SubscriberNode *sub = node->subs[subidx];
   ProviderContext *context = (ProviderContext *)sub->context;
+  cRosWorkStrandRelease(&sub->callback_strand); // The context cannot be freed while a worker uses it
   freeProviderContext(context);
   cRosNodeReleaseSubscriber(sub);
 }
@@ -501,7 +836,7 @@ cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name,
     if(pubidx >= 0) // Success
     {
       // Allow the callback functions to access the msg queue and send-now flag
-      nodeContext->msg_queue = &node->pubs[pubidx].msg_queue;
+      nodeContext->msg_queue = &node->pubs[pubidx]->msg_queue;
       if(pubidx_ptr != NULL)
         *pubidx_ptr = pubidx; // Return the index of the created service caller
     }
@@ -514,10 +849,10 @@ cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name,
 cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx)
 {
   int ret_err;
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if (pubidx < 0 || pubidx >= node->pub_slots.n_slots)
     return CROS_BAD_PARAM_ERR;
 
-  PublisherNode *pub = &node->pubs[pubidx];
+  PublisherNode *pub = node->pubs[pubidx];
   if (pub->topic_name == NULL)
     return CROS_TOPIC_PUB_IND_ERR;
 
@@ -528,12 +863,113 @@ cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx)
 
 void cRosApiReleasePublisher(CrosNode *node, int pubidx)
 {
-  PublisherNode *pub = &node->pubs[pubidx];
+  PublisherNode *pub = node->pubs[pubidx];
   ProviderContext *context = (ProviderContext *)pub->context;
   freeProviderContext(context);
+  cRosTimerHeapCancel(&node->timers, &pub->timer);
   cRosNodeReleasePublisher(pub);
 }
 
+cRosErrCodePack cRosApiRegisterTypedSubscriber(CrosNode *node, const char *topic_name, const cRosTypedMessageType *type,
+                              TypedSubscriberApiCallback callback, NodeStatusApiCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *nodeContext = NULL;
+  int subidx;
+
+  if(type == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  ret_err = newTypedProviderContext(CROS_SUBSCRIBER, type, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_api_callback = status_callback;
+    nodeContext->context = context;
+
+    subidx = cRosNodeRegisterSubscriber(node, nodeContext->message_definition, topic_name, type->type_name,
+                                  nodeContext->md5sum, nodeContext, tcp_nodelay);
+    if(subidx >= 0)
+    {
+      nodeContext->msg_queue = &node->subs[subidx]->msg_queue; // Not used by the typed subscribers
+      if(subidx_ptr != NULL)
+        *subidx_ptr = subidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosApiRegisterTypedPublisher(CrosNode *node, const char *topic_name, const cRosTypedMessageType *type, int loop_period,
+                             TypedPublisherApiCallback callback, NodeStatusApiCallback status_callback, void *context, int *pubidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *nodeContext = NULL;
+  int pubidx;
+
+  if(type == NULL || (loop_period >= 0 && callback == NULL))
+    return CROS_BAD_PARAM_ERR;
+
+  ret_err = newTypedProviderContext(CROS_PUBLISHER, type, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_api_callback = status_callback;
+    nodeContext->context = context;
+
+    pubidx = cRosNodeRegisterPublisher(node, nodeContext->message_definition, topic_name, type->type_name,
+                                  nodeContext->md5sum, loop_period, nodeContext);
+    if(pubidx >= 0)
+    {
+      nodeContext->msg_queue = &node->pubs[pubidx]->msg_queue; // Not used by the typed publishers
+      if(pubidx_ptr != NULL)
+        *pubidx_ptr = pubidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeSendTypedMsg(CrosNode *node, int pubidx, const void *msg)
+{
+  cRosErrCodePack ret_err;
+  PublisherNode *pub_node;
+  ProviderContext *context;
+  TcprosFrame *frame;
+
+  if(pubidx < 0 || pubidx >= node->pub_slots.n_slots || msg == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node = node->pubs[pubidx];
+  context = (ProviderContext *)pub_node->context;
+  if(pub_node->topic_name == NULL || context->typed_type == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(pub_node->tcpros_id_list[0] == -1) // No subscriber is connected: the message is dropped, as ROS publishers do
+    return CROS_SUCCESS_ERR_PACK;
+
+  // The struct is serialized once, straight into the frame that all the connections send
+  frame = tcprosFrameNew();
+  if(frame == NULL)
+    return CROS_MEM_ALLOC_ERR;
+  ret_err = cRosTypedMessageSerialize(context->typed_type, msg, &frame->packet);
+  if(ret_err == CROS_SUCCESS_ERR_PACK && tcprosFrameSeal(frame) != 0)
+    ret_err = CROS_MEM_ALLOC_ERR;
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    cRosNodePublishFrame(node, pubidx, frame);
+  tcprosFrameRelease(frame);
+
+  return ret_err;
+}
+
 cRosErrCodePack cRosApicRosApiLookupNode(CrosNode *node, const char *node_name, LookupNodeCallback callback, void *context, int *caller_id_ptr)
 {
   int caller_id;
@@ -2063,14 +2499,16 @@ cRosMessage *cRosApiCreatePublisherMessage(CrosNode *node, int pubidx)
   ProviderContext *pub_context;
   PublisherNode *pub;
 
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if (pubidx < 0 || pubidx >= node->pub_slots.n_slots)
     return NULL;
 
-  pub = &node->pubs[pubidx];
+  pub = node->pubs[pubidx];
   if (pub->topic_name == NULL)
     return NULL;
 
   pub_context = pub->context;
+  if (pub_context->typed_type != NULL) // The typed publishers have no cRosMessage
+    return NULL;
   new_msg = cRosMessageCopy(pub_context->outgoing);
 
   return new_msg;
@@ -2082,10 +2520,10 @@ cRosMessage *cRosApiCreateServiceCallerRequest(CrosNode *node, int svcidx)
   ServiceCallerNode *svc_caller;
   ProviderContext *caller_context;
 
-  if (svcidx < 0 || svcidx >= CN_MAX_SERVICE_CALLERS)
+  if (svcidx < 0 || svcidx >= node->service_caller_slots.n_slots)
     return NULL;
 
-  svc_caller = &node->service_callers[svcidx];
+  svc_caller = node->service_callers[svcidx];
   if (svc_caller->service_name == NULL)
     return NULL;
 
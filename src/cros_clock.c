@@ -66,6 +66,26 @@ uint64_t cRosClockGetTimeMs( void )
   return(ms_since_epoch);
 }
 
+uint64_t cRosClockGetTimeNs( void )
+{
+#ifdef _WIN32
+  static LARGE_INTEGER counter_freq = {0};
+  LARGE_INTEGER counter;
+
+  if (counter_freq.QuadPart == 0)
+    QueryPerformanceFrequency(&counter_freq);
+  QueryPerformanceCounter(&counter);
+  // Split the conversion to avoid overflowing the multiplication
+  return (uint64_t)(counter.QuadPart / counter_freq.QuadPart) * 1000000000ULL +
+         (uint64_t)(counter.QuadPart % counter_freq.QuadPart) * 1000000000ULL / counter_freq.QuadPart;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    return 0;
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
 struct timeval cRosClockGetTimeVal( uint64_t msec )
 {
   PRINT_VVDEBUG ( "cRosClockGetTimeVal() msec: %lu\n", msec );
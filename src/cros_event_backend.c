@@ -0,0 +1,382 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "cros_event_backend.h"
+#include "cros_defs.h"
+
+#ifdef __linux__
+#  include <unistd.h>
+#  include <errno.h>
+#  include <sys/epoll.h>
+#  include <sys/timerfd.h>
+#endif
+
+enum { EVENT_BACKEND_INIT_ENTRIES = 16 };
+
+#ifdef __linux__
+// The interest set is stored together with the tag in the epoll user data, so that the
+// conditions that epoll always reports (EPOLLERR and EPOLLHUP) can be translated as select() does
+#define EPOLL_DATA_PACK(tag, events) (((uint64_t)(events) << 32) | (uint64_t)(tag))
+#define EPOLL_DATA_TAG(data) ((uint32_t)((data) & 0xFFFFFFFF))
+#define EPOLL_DATA_EVENTS(data) ((unsigned int)((data) >> 32))
+// User data of the timerfd. It cannot be confused with a socket, since no socket is registered with all the events
+#define EPOLL_DATA_TIMER UINT64_MAX
+
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC 1000000000ULL
+
+static uint32_t epollEventsFromInterest( unsigned int events )
+{
+  uint32_t epoll_events = 0;
+  if( events & CROS_EVENT_READ )
+    epoll_events |= EPOLLIN;
+  if( events & CROS_EVENT_WRITE )
+    epoll_events |= EPOLLOUT;
+  if( events & CROS_EVENT_EXCEPT )
+    epoll_events |= EPOLLPRI;
+  return epoll_events;
+}
+
+static int epollSetInterest( CrosEventBackend *b, TcpIpSocket *s, unsigned int events, uint32_t tag )
+{
+  struct epoll_event ev;
+  int op, ret;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = epollEventsFromInterest(events);
+  ev.data.u64 = EPOLL_DATA_PACK(tag, events);
+
+  if( events == 0 )
+    op = EPOLL_CTL_DEL;
+  else if( s->ev_events == 0 )
+    op = EPOLL_CTL_ADD;
+  else
+    op = EPOLL_CTL_MOD;
+
+  ret = epoll_ctl(b->epoll_fd, op, s->fd, &ev);
+  if( ret == -1 && op == EPOLL_CTL_ADD && errno == EEXIST )
+    ret = epoll_ctl(b->epoll_fd, EPOLL_CTL_MOD, s->fd, &ev);
+  else if( ret == -1 && op == EPOLL_CTL_MOD && errno == ENOENT )
+    ret = epoll_ctl(b->epoll_fd, EPOLL_CTL_ADD, s->fd, &ev);
+  else if( ret == -1 && op == EPOLL_CTL_DEL && (errno == ENOENT || errno == EBADF) )
+    ret = 0; // The socket is not monitored anymore
+
+  if( ret == -1 )
+  {
+    PRINT_ERROR("epollSetInterest() : epoll_ctl() failed for socket FD %i. Error code: %i\n", s->fd, errno);
+    return -1;
+  }
+  return 0;
+}
+
+// Create the timerfd used for the sub-millisecond timeouts and register it in the epoll instance
+static int epollOpenTimer( CrosEventBackend *b )
+{
+  struct epoll_event ev;
+
+  b->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if( b->timer_fd == -1 )
+  {
+    PRINT_ERROR("epollOpenTimer() : timerfd_create() failed. Error code: %i\n", errno);
+    return -1;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u64 = EPOLL_DATA_TIMER;
+  if( epoll_ctl(b->epoll_fd, EPOLL_CTL_ADD, b->timer_fd, &ev) == -1 )
+  {
+    PRINT_ERROR("epollOpenTimer() : epoll_ctl() failed for the timer. Error code: %i\n", errno);
+    close(b->timer_fd);
+    b->timer_fd = -1;
+    return -1;
+  }
+  return 0;
+}
+
+// Arm the timerfd to expire after time_out ns (or disarm it if time_out is 0)
+static int epollSetTimer( CrosEventBackend *b, uint64_t time_out )
+{
+  struct itimerspec its;
+
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = (time_t)(time_out / NSEC_PER_SEC);
+  its.it_value.tv_nsec = (long)(time_out % NSEC_PER_SEC);
+  if( timerfd_settime(b->timer_fd, 0, &its, NULL) == -1 )
+  {
+    PRINT_ERROR("epollSetTimer() : timerfd_settime() failed. Error code: %i\n", errno);
+    return -1;
+  }
+  b->timer_armed = (time_out != 0);
+  return 0;
+}
+
+// Calculate the epoll_wait() timeout (in msec) for a timeout in ns. A whole number of milliseconds is passed to
+// epoll_wait() directly. Otherwise the timerfd is armed (so the wait is not rounded to the next millisecond)
+// and epoll_wait() waits without timeout. If the timerfd is not available, the timeout is rounded up
+static int epollPrepareTimeout( CrosEventBackend *b, uint64_t time_out )
+{
+  uint64_t time_out_ms;
+
+  if( time_out % NSEC_PER_MSEC != 0 && time_out < (uint64_t)INT_MAX * NSEC_PER_MSEC &&
+      (b->timer_fd != -1 || epollOpenTimer( b ) == 0) &&
+      epollSetTimer( b, time_out ) == 0 )
+    return -1;
+
+  if( b->timer_armed ) // A timer armed by a previous wait must not interrupt this one
+    epollSetTimer( b, 0 );
+
+  time_out_ms = time_out / NSEC_PER_MSEC + ((time_out % NSEC_PER_MSEC != 0)? 1 : 0);
+  return (time_out_ms > INT_MAX)? INT_MAX : (int)time_out_ms;
+}
+
+static int epollWait( CrosEventBackend *b, CrosEvent *events, int max_events, uint64_t time_out )
+{
+  struct epoll_event *os_events;
+  int n_ready, n_events, i;
+
+  if( max_events <= 0 )
+    return 0;
+
+  if( b->os_events_max < max_events )
+  {
+    os_events = (struct epoll_event *)realloc(b->os_events, max_events * sizeof(struct epoll_event));
+    if( os_events == NULL )
+    {
+      PRINT_ERROR("epollWait() : Can't allocate memory\n");
+      return -1;
+    }
+    b->os_events = os_events;
+    b->os_events_max = max_events;
+  }
+  os_events = (struct epoll_event *)b->os_events;
+
+  n_ready = epoll_wait(b->epoll_fd, os_events, max_events, epollPrepareTimeout( b, time_out ));
+  if( n_ready == -1 )
+  {
+    if( errno == EINTR )
+    {
+      PRINT_VDEBUG("epollWait() : epoll_wait() returned EINTR error code\n");
+      return 0;
+    }
+    PRINT_ERROR("epollWait() : epoll_wait() call failed. Error code: %i\n", errno);
+    return -1;
+  }
+
+  n_events = 0;
+  for( i = 0; i < n_ready; i++ )
+  {
+    unsigned int interest = EPOLL_DATA_EVENTS(os_events[i].data.u64);
+    unsigned int ready = 0;
+
+    if( os_events[i].data.u64 == EPOLL_DATA_TIMER ) // The timeout is up
+    {
+      uint64_t n_expirations;
+      if( read(b->timer_fd, &n_expirations, sizeof(n_expirations)) == -1 && errno != EAGAIN )
+        PRINT_ERROR("epollWait() : read() failed for the timer. Error code: %i\n", errno);
+      b->timer_armed = 0;
+      continue;
+    }
+
+    if( os_events[i].events & EPOLLIN )
+      ready |= CROS_EVENT_READ;
+    if( os_events[i].events & EPOLLOUT )
+      ready |= CROS_EVENT_WRITE;
+    if( os_events[i].events & EPOLLPRI )
+      ready |= CROS_EVENT_EXCEPT;
+    if( os_events[i].events & (EPOLLERR | EPOLLHUP) )
+    {
+      // select() reports these conditions as readability/writability, so the pending I/O
+      // operation finds out the error. Sockets only watched for exceptions get CROS_EVENT_EXCEPT
+      if( interest & (CROS_EVENT_READ | CROS_EVENT_WRITE) )
+        ready |= interest & (CROS_EVENT_READ | CROS_EVENT_WRITE);
+      else
+        ready |= CROS_EVENT_EXCEPT;
+    }
+
+    events[n_events].tag = EPOLL_DATA_TAG(os_events[i].data.u64);
+    events[n_events].events = ready;
+    n_events++;
+  }
+
+  return n_events;
+}
+#endif
+
+static int selectSetInterest( CrosEventBackend *b, TcpIpSocket *s, unsigned int events, uint32_t tag )
+{
+  size_t i;
+
+  for( i = 0; i < b->n_entries; i++ )
+  {
+    if( b->entries[i].tag == tag )
+    {
+      if( events == 0 ) // Removed right away, since the socket object may be freed before the next wait
+        b->entries[i] = b->entries[--b->n_entries];
+      else
+        b->entries[i].socket = s;
+      return 0;
+    }
+  }
+
+  if( events == 0 )
+    return 0;
+
+  if( b->n_entries == b->max_entries )
+  {
+    size_t new_max = (b->max_entries == 0)? EVENT_BACKEND_INIT_ENTRIES : 2 * b->max_entries;
+    CrosEventBackendEntry *new_entries = (CrosEventBackendEntry *)realloc(b->entries, new_max * sizeof(CrosEventBackendEntry));
+    if( new_entries == NULL )
+    {
+      PRINT_ERROR("selectSetInterest() : Can't allocate memory\n");
+      return -1;
+    }
+    b->entries = new_entries;
+    b->max_entries = new_max;
+  }
+
+  b->entries[b->n_entries].socket = s;
+  b->entries[b->n_entries].tag = tag;
+  b->n_entries++;
+  return 0;
+}
+
+static int selectWait( CrosEventBackend *b, CrosEvent *events, int max_events, uint64_t time_out )
+{
+  fd_set r_fds, w_fds, err_fds;
+  int nfds = -1, n_set, n_ready;
+  size_t i;
+
+  FD_ZERO( &r_fds );
+  FD_ZERO( &w_fds );
+  FD_ZERO( &err_fds );
+
+  i = 0;
+  while( i < b->n_entries )
+  {
+    TcpIpSocket *s = b->entries[i].socket;
+    if( s->fd == FN_INVALID_SOCKET || s->ev_events == 0 ) // The socket has been closed or is not monitored anymore
+    {
+      b->entries[i] = b->entries[b->n_entries - 1];
+      b->n_entries--;
+      continue;
+    }
+
+    if( s->ev_events & CROS_EVENT_READ )
+      FD_SET( s->fd, &r_fds );
+    if( s->ev_events & CROS_EVENT_WRITE )
+      FD_SET( s->fd, &w_fds );
+    if( s->ev_events & CROS_EVENT_EXCEPT )
+      FD_SET( s->fd, &err_fds );
+    if( s->fd > nfds )
+      nfds = s->fd;
+    i++;
+  }
+
+  // tcpIpSocketSelect() expects milliseconds: round up so that the node does not wake up before its timers expire
+  n_set = tcpIpSocketSelect( nfds + 1, &r_fds, &w_fds, &err_fds, time_out / 1000000ULL + ((time_out % 1000000ULL != 0)? 1 : 0) );
+  if( n_set <= 0 )
+    return n_set;
+
+  n_ready = 0;
+  for( i = 0; i < b->n_entries && n_ready < max_events; i++ )
+  {
+    TcpIpSocket *s = b->entries[i].socket;
+    unsigned int ready = 0;
+
+    if( FD_ISSET( s->fd, &r_fds ) )
+      ready |= CROS_EVENT_READ;
+    if( FD_ISSET( s->fd, &w_fds ) )
+      ready |= CROS_EVENT_WRITE;
+    if( FD_ISSET( s->fd, &err_fds ) )
+      ready |= CROS_EVENT_EXCEPT;
+
+    if( ready != 0 )
+    {
+      events[n_ready].tag = b->entries[i].tag;
+      events[n_ready].events = ready;
+      n_ready++;
+    }
+  }
+
+  return n_ready;
+}
+
+int cRosEventBackendInit( CrosEventBackend *b, CrosEventBackendType type )
+{
+  b->type = CROS_EVENT_BACKEND_SELECT;
+  b->epoll_fd = -1;
+  b->os_events = NULL;
+  b->os_events_max = 0;
+  b->timer_fd = -1;
+  b->timer_armed = 0;
+  b->entries = NULL;
+  b->n_entries = 0;
+  b->max_entries = 0;
+
+#ifdef __linux__
+  if( type == CROS_EVENT_BACKEND_EPOLL )
+  {
+    b->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if( b->epoll_fd != -1 )
+      b->type = CROS_EVENT_BACKEND_EPOLL;
+    else
+      PRINT_ERROR("cRosEventBackendInit() : epoll_create1() failed (error code: %i). Using select() instead\n", errno);
+  }
+#endif
+
+  return 0;
+}
+
+void cRosEventBackendRelease( CrosEventBackend *b )
+{
+#ifdef __linux__
+  if( b->timer_fd != -1 )
+    close(b->timer_fd);
+  if( b->epoll_fd != -1 )
+    close(b->epoll_fd);
+#endif
+  b->timer_fd = -1;
+  b->timer_armed = 0;
+  b->epoll_fd = -1;
+  free(b->os_events);
+  b->os_events = NULL;
+  b->os_events_max = 0;
+  free(b->entries);
+  b->entries = NULL;
+  b->n_entries = 0;
+  b->max_entries = 0;
+}
+
+int cRosEventBackendSetInterest( CrosEventBackend *b, TcpIpSocket *s, unsigned int events, uint32_t tag )
+{
+  int ret;
+
+  if( s->fd == FN_INVALID_SOCKET ) // Closed sockets are removed from the backend automatically
+    return 0;
+
+  if( s->ev_events == events ) // Nothing has changed
+    return 0;
+
+#ifdef __linux__
+  if( b->type == CROS_EVENT_BACKEND_EPOLL )
+    ret = epollSetInterest( b, s, events, tag );
+  else
+#endif
+    ret = selectSetInterest( b, s, events, tag );
+
+  if( ret == 0 )
+    s->ev_events = events;
+
+  return ret;
+}
+
+int cRosEventBackendWait( CrosEventBackend *b, CrosEvent *events, int max_events, uint64_t time_out )
+{
+#ifdef __linux__
+  if( b->type == CROS_EVENT_BACKEND_EPOLL )
+    return epollWait( b, events, max_events, time_out );
+#endif
+  return selectWait( b, events, max_events, time_out );
+}
@@ -100,46 +100,77 @@ const char *LogLevelToString(CrosLogLevel log_level)
   return ret;
 }
 
+// Fields of the rosgraph_msgs/Log messages, in the order of node->rosout_field_handles
+enum RosoutField
+{
+  ROSOUT_HEADER_SEQ = 0,
+  ROSOUT_HEADER_SECS,
+  ROSOUT_HEADER_NSECS,
+  ROSOUT_HEADER_FRAME_ID,
+  ROSOUT_LEVEL,
+  ROSOUT_NAME,
+  ROSOUT_MSG,
+  ROSOUT_FILE,
+  ROSOUT_FUNCTION,
+  ROSOUT_LINE,
+  ROSOUT_TOPICS
+};
+
+static const char *Rosout_field_paths[CN_ROSOUT_N_FIELDS] =
+{
+  "header.seq", "header.stamp.secs", "header.stamp.nsecs", "header.frame_id", "level", "name",
+  "msg", "file", "function", "line", "topics"
+};
+
+// Resolve the field handles of the /rosout messages the first time that they are needed
+static int resolveRosoutFields(CrosNode *node, cRosMessage *message)
+{
+  cRosErrCodePack err_cod;
+  int field_ind;
+
+  for(field_ind = 0; field_ind < CN_ROSOUT_N_FIELDS; field_ind++)
+  {
+    if(node->rosout_field_handles[field_ind] != NULL)
+      continue;
+
+    err_cod = cRosMessageFieldHandleResolve(message->msgDef, Rosout_field_paths[field_ind], &node->rosout_field_handles[field_ind]);
+    if(err_cod != CROS_SUCCESS_ERR_PACK)
+    {
+      cRosPrintErrCodePack(err_cod, "resolveRosoutFields() : Field %s of the log message", Rosout_field_paths[field_ind]);
+      return -1;
+    }
+  }
+  return 0;
+}
+
 cRosMessage *cRosLogToMessage(CrosNode* node, CrosLog* log)
 {
   cRosMessage *message;
+  cRosMessageFieldHandle **fields = node->rosout_field_handles;
   size_t pub_ind;
 
   message = cRosApiCreatePublisherMessage(node, node->rosout_pub_idx);
-  if(message != NULL)
+  if(message != NULL && resolveRosoutFields(node, message) != 0)
   {
-    cRosMessageField* header_field = cRosMessageGetField(message, "header");
-    cRosMessage* header_msg = header_field->data.as_msg;
-    cRosMessageField* seq_id = cRosMessageGetField(header_msg, "seq");
-    seq_id->data.as_uint32 = node->log_last_id++;
-    cRosMessageField* time_field = cRosMessageGetField(header_msg, "stamp");
-    cRosMessage* time_msg = time_field->data.as_msg;
-    cRosMessageField* time_secs = cRosMessageGetField(time_msg, "secs");
-    time_secs->data.as_uint32 = log->secs;
-    cRosMessageField* time_nsecs = cRosMessageGetField(time_msg, "nsecs");
-    time_nsecs->data.as_uint32 = log->nsecs;
-    cRosMessageSetFieldValueString(cRosMessageGetField(header_msg, "frame_id"), "0");
-
-
-    cRosMessageField* level = cRosMessageGetField(message, "level");
-    level->data.as_uint8 = log->level;
-
-    cRosMessageField* name = cRosMessageGetField(message, "name"); // name of the node
-    cRosMessageSetFieldValueString(name, node->name);
-
-    cRosMessageField* msg = cRosMessageGetField(message, "msg"); // message
-    cRosMessageSetFieldValueString(msg, log->msg);
-
-    cRosMessageField* file = cRosMessageGetField(message, "file"); // file the message came from
-    cRosMessageSetFieldValueString(file, log->file);
+    cRosMessageFree(message);
+    message = NULL;
+  }
 
-    cRosMessageField* function = cRosMessageGetField(message, "function"); // function the message came from
-    cRosMessageSetFieldValueString(function, log->function);
+  if(message != NULL)
+  {
+    cRosMessageGetFieldByHandle(message, fields[ROSOUT_HEADER_SEQ])->data.as_uint32 = node->log_last_id++;
+    cRosMessageGetFieldByHandle(message, fields[ROSOUT_HEADER_SECS])->data.as_uint32 = log->secs;
+    cRosMessageGetFieldByHandle(message, fields[ROSOUT_HEADER_NSECS])->data.as_uint32 = log->nsecs;
+    cRosMessageHandleStringSet(message, fields[ROSOUT_HEADER_FRAME_ID], "0");
 
-    cRosMessageField* line = cRosMessageGetField(message, "line"); // line the message came from
-    line->data.as_uint32 = log->line;
+    cRosMessageGetFieldByHandle(message, fields[ROSOUT_LEVEL])->data.as_uint8 = log->level;
+    cRosMessageHandleStringSet(message, fields[ROSOUT_NAME], node->name); // name of the node
+    cRosMessageHandleStringSet(message, fields[ROSOUT_MSG], log->msg); // message
+    cRosMessageHandleStringSet(message, fields[ROSOUT_FILE], log->file); // file the message came from
+    cRosMessageHandleStringSet(message, fields[ROSOUT_FUNCTION], log->function); // function the message came from
+    cRosMessageGetFieldByHandle(message, fields[ROSOUT_LINE])->data.as_uint32 = log->line; // line the message came from
 
-    cRosMessageField* topics = cRosMessageGetField(message, "topics"); // topic names that the node publishes
+    cRosMessageField* topics = cRosMessageGetFieldByHandle(message, fields[ROSOUT_TOPICS]); // topic names that the node publishes
 
     cRosMessageFieldArrayClear(topics);
     for(pub_ind = 0; pub_ind < log->n_pubs; pub_ind++)
@@ -188,15 +219,13 @@ void cRosLogPrint(CrosNode* node,
 
       log->line = line;
 
-      log->n_pubs = node->n_pubs;
-      log->pubs = (char **)calloc(log->n_pubs,sizeof(char*));
+      log->n_pubs = 0;
+      log->pubs = (char **)calloc(node->n_pubs,sizeof(char*));
 
-      for(pub_ind = 0; pub_ind < node->n_pubs; pub_ind++)
+      for(pub_ind = 0; pub_ind < node->pub_slots.n_slots && log->n_pubs < (size_t)node->n_pubs; pub_ind++)
       {
-        if(node->pubs[pub_ind].topic_name != NULL)
-          log->pubs[pub_ind] = strdup(node->pubs[pub_ind].topic_name);
-        else
-          log->pubs[pub_ind] = NULL;
+        if(node->pubs[pub_ind]->topic_name != NULL) // Only the active publishers are listed
+          log->pubs[log->n_pubs++] = strdup(node->pubs[pub_ind]->topic_name);
       }
 
       log->msg = (char *)malloc((msg_str_size + 1)*sizeof(char));
@@ -220,8 +249,8 @@ void cRosLogPrint(CrosNode* node,
           // Check if the rossout publisher has any TCP process associated, that is, check if a node is subscribed to this topic
           int srv_proc_ind, subs_node;
           subs_node = 0;
-          for(srv_proc_ind=0;srv_proc_ind<CN_MAX_TCPROS_SERVER_CONNECTIONS && subs_node==0;srv_proc_ind++)
-            if(node->tcpros_server_proc[srv_proc_ind].topic_idx == rosout_pub_idx)
+          for(srv_proc_ind=0;srv_proc_ind<node->tcpros_server_slots.n_slots && subs_node==0;srv_proc_ind++)
+            if(node->tcpros_server_proc[srv_proc_ind]->topic_idx == rosout_pub_idx)
               subs_node = 1; // there is a subscriber
           // Only print the error message if there is a subscriber node, that is, if there is a node that should receive the rosout message
           if(subs_node == 1)
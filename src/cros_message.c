@@ -5,6 +5,7 @@
 #include "cros_message.h"
 #include "cros_message_internal.h"
 #include "cros_defs.h"
+#include "cros_atomic.h"
 #include "md5.h"
 
 #ifdef _WIN32
@@ -334,6 +335,8 @@ cRosErrCodePack initCrosMsg(cRosMessageDef* msg)
       msg->package = NULL;
       msg->plain_text = NULL;
       msg->root_dir = NULL;
+      msg->layout = NULL;
+      msg->ref_count = 1;
       ret_err = CROS_SUCCESS_ERR_PACK;
     }
     else
@@ -639,6 +642,9 @@ void cRosMessageInit(cRosMessage *message)
     message->fields = NULL;
     message->n_fields = 0;
     message->msgDef = NULL;
+    message->layout = NULL;
+    message->view_buffer = NULL;
+    message->lazy_state = NULL;
 
     message->md5sum = (char *)calloc(33, sizeof(char)); // 32 chars + '\0';
 }
@@ -674,6 +680,7 @@ void cRosMessageFieldInit(cRosMessageField *field)
         field->is_fixed_array = 0;
         field->array_size = -1;
         field->array_capacity = -1;
+        field->is_view = 0;
         memset(field->data.opaque, 0, sizeof(field->data.opaque));
     }
 }
@@ -1124,7 +1131,110 @@ cRosMessage *build_header_field(void)
   return header_msg;
 }
 
-cRosErrCodePack cRosMessageDefBuild(cRosMessageDef **msg_def_ptr, const char *msg_root_dir, const char *msg_type)
+// Process-wide cache of the message definitions loaded from files, so that each .msg file is read, parsed and
+// its MD5 sum computed only once. The cached definitions are never modified: the callers get references to them
+typedef struct MsgDefCacheEntry MsgDefCacheEntry;
+struct MsgDefCacheEntry
+{
+  char *file_path; //! Path of the .msg file: it is the key of the entry
+  cRosMessageDef *msg_def; //! Parsed definition, with its compiled layout (which holds the MD5 sum)
+  MsgDefCacheEntry *next;
+};
+
+static MsgDefCacheEntry *Msg_def_cache = NULL;
+static CrosMutex Msg_def_cache_lock; // The lock is only held while searching or linking entries
+static CrosOnce Msg_def_cache_once = CROS_ONCE_INIT;
+
+static void initMsgDefCacheLock(void)
+{
+  if(cRosMutexInit(&Msg_def_cache_lock) != 0)
+    PRINT_ERROR("initMsgDefCacheLock() : Can't initialize the lock of the message definition cache\n");
+}
+
+static void lockMsgDefCache(void)
+{
+  cRosOnceRun(&Msg_def_cache_once, initMsgDefCacheLock);
+  cRosMutexLock(&Msg_def_cache_lock);
+}
+
+static void unlockMsgDefCache(void)
+{
+  cRosMutexUnlock(&Msg_def_cache_lock);
+}
+
+// Returns a new reference to the cached definition of a file, or NULL if it is not cached
+static cRosMessageDef *findCachedMsgDef(const char *msg_file_path)
+{
+  MsgDefCacheEntry *entry;
+  cRosMessageDef *msg_def;
+
+  lockMsgDefCache();
+  for(entry = Msg_def_cache; entry != NULL && strcmp(entry->file_path, msg_file_path) != 0; entry = entry->next);
+  msg_def = (entry != NULL)? cRosMessageDefRetain(entry->msg_def) : NULL; // Retained before cRosMessageDefCacheClear() can free it
+  unlockMsgDefCache();
+  return msg_def;
+}
+
+// Insert msg_def in the cache, which takes the reference of the caller. If another thread has cached the same file in the
+// meantime, msg_def is freed instead. A new reference to the cached definition is returned, or NULL if there is no memory
+// for the entry (msg_def is not freed)
+static cRosMessageDef *addCachedMsgDef(const char *msg_file_path, cRosMessageDef *msg_def)
+{
+  MsgDefCacheEntry *new_entry, *entry;
+  cRosMessageDef *cached_def;
+
+  new_entry = (MsgDefCacheEntry *)malloc(sizeof(MsgDefCacheEntry));
+  if(new_entry == NULL)
+    return NULL;
+  new_entry->file_path = strdup(msg_file_path);
+  if(new_entry->file_path == NULL)
+  {
+    free(new_entry);
+    return NULL;
+  }
+  new_entry->msg_def = msg_def;
+
+  lockMsgDefCache();
+  for(entry = Msg_def_cache; entry != NULL && strcmp(entry->file_path, msg_file_path) != 0; entry = entry->next);
+  if(entry == NULL)
+  {
+    new_entry->next = Msg_def_cache;
+    Msg_def_cache = new_entry;
+    entry = new_entry;
+  }
+  else
+  {
+    free(new_entry->file_path);
+    free(new_entry);
+  }
+  cached_def = cRosMessageDefRetain(entry->msg_def);
+  unlockMsgDefCache();
+
+  if(cached_def != msg_def)
+    cRosMessageDefFree(msg_def);
+  return cached_def;
+}
+
+void cRosMessageDefCacheClear(void)
+{
+  MsgDefCacheEntry *entry;
+
+  lockMsgDefCache();
+  entry = Msg_def_cache;
+  Msg_def_cache = NULL;
+  unlockMsgDefCache();
+
+  while(entry != NULL)
+  {
+    MsgDefCacheEntry *next_entry = entry->next;
+    cRosMessageDefFree(entry->msg_def); // The definitions and messages already built keep their own references
+    free(entry->file_path);
+    free(entry);
+    entry = next_entry;
+  }
+}
+
+static cRosErrCodePack loadMsgDefFile(cRosMessageDef **msg_def_ptr, char *msg_file_path)
 {
   cRosErrCodePack ret;
   cRosMessageDef* msg_def = (cRosMessageDef *)malloc(sizeof(cRosMessageDef));
@@ -1134,37 +1244,67 @@ cRosErrCodePack cRosMessageDefBuild(cRosMessageDef **msg_def_ptr, const char *ms
   ret = initCrosMsg(msg_def);
   if(ret == CROS_SUCCESS_ERR_PACK)
   {
-    char* msg_file_path;
-    if(msg_root_dir != NULL) // If msg_root_dir parameter is not NULL, the file path is composed, otherwise, msg_type is used directly as file path
+    ret = loadFromFileMsg(msg_file_path, msg_def);
+    if (ret == CROS_SUCCESS_ERR_PACK)
+      *msg_def_ptr = msg_def;
+    else
+      cRosMessageDefFree(msg_def);
+  }
+  else
+    free(msg_def);
+
+  return ret;
+}
+
+cRosErrCodePack cRosMessageDefBuild(cRosMessageDef **msg_def_ptr, const char *msg_root_dir, const char *msg_type)
+{
+  cRosErrCodePack ret;
+  char* msg_file_path;
+
+  ret = CROS_SUCCESS_ERR_PACK;
+  if(msg_root_dir != NULL) // If msg_root_dir parameter is not NULL, the file path is composed, otherwise, msg_type is used directly as file path
+  {
+    msg_file_path = (char *)malloc(strlen(msg_root_dir) + strlen(DIR_SEPARATOR_STR) + strlen(msg_type) + strlen(FILEEXT_MSG) + 2);
+    if(msg_file_path != NULL)
     {
-      msg_file_path = (char *)malloc(strlen(msg_root_dir) + strlen(DIR_SEPARATOR_STR) + strlen(msg_type) + strlen(FILEEXT_MSG) + 2);
-      if(msg_file_path != NULL)
-      {
-        strcpy(msg_file_path, msg_root_dir);
-        strcat(msg_file_path, DIR_SEPARATOR_STR);
-        strcat(msg_file_path, msg_type);
-        strcat(msg_file_path, ".");
-        strcat(msg_file_path, FILEEXT_MSG);
-      }
-      else
-        ret = CROS_MEM_ALLOC_ERR;
+      strcpy(msg_file_path, msg_root_dir);
+      strcat(msg_file_path, DIR_SEPARATOR_STR);
+      strcat(msg_file_path, msg_type);
+      strcat(msg_file_path, ".");
+      strcat(msg_file_path, FILEEXT_MSG);
     }
     else
-      msg_file_path = (char *)msg_type;
-    if(ret == CROS_SUCCESS_ERR_PACK)
+      ret = CROS_MEM_ALLOC_ERR;
+  }
+  else
+    msg_file_path = (char *)msg_type;
+  if(ret == CROS_SUCCESS_ERR_PACK)
+  {
+    cRosMessageDef *cached_def;
+
+    cached_def = findCachedMsgDef(msg_file_path);
+    if(cached_def == NULL) // First time that this file is used: load it (and the files of its nested types) and cache it
     {
-      ret = loadFromFileMsg(msg_file_path, msg_def);
-      if(msg_root_dir != NULL)
-        free(msg_file_path);
+      cRosMessageDef *loaded_def;
 
-      if (ret == CROS_SUCCESS_ERR_PACK)
-        *msg_def_ptr = msg_def;
-      else
-        cRosMessageDefFree(msg_def);
+      ret = loadMsgDefFile(&loaded_def, msg_file_path);
+      if(ret == CROS_SUCCESS_ERR_PACK)
+      {
+        cRosMessageLayout *layout;
+        // The layout (and MD5 sum) is compiled now so that it is shared by all the copies of the cached definition.
+        // If it cannot be compiled, the definition is not cached and the error is reported when a message is built from it
+        if(cRosMessageLayoutGet(loaded_def, &layout) == CROS_SUCCESS_ERR_PACK)
+          cached_def = addCachedMsgDef(msg_file_path, loaded_def);
+        if(cached_def == NULL)
+          *msg_def_ptr = loaded_def; // The caller gets the loaded definition itself
+      }
     }
+    if(cached_def != NULL)
+      *msg_def_ptr = cached_def; // The caller shares the cached definition, which is never modified
+
+    if(msg_root_dir != NULL)
+      free(msg_file_path);
   }
-  else
-    free(msg_def);
 
   return ret;
 }
@@ -1549,6 +1689,7 @@ void cRosMessageFieldsPrint(cRosMessage *msg, int n_indent)
   printNSpaces(n_indent);
   if(msg != NULL)
   {
+    cRosMessageDecodePending(msg);
     fprintf(cRosOutStreamGet(), "MsgAt 0x%p: MD5:'%s' N.Flds:%i Flds:%s\n", msg, (msg->md5sum != NULL)? msg->md5sum: "NULL", msg->n_fields, (msg->fields != NULL)?"":"NULL");
     if(msg->fields != NULL)
     {
@@ -1592,7 +1733,22 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
   }
   else
     ret=-1;
-  if(ret == 0) // If no error copying MD5 field, continue
+  if(ret == 0 && m_src->layout != NULL) // The source message was built from a layout
+  {
+    // If the destination message is of the same type, its memory is reused. Otherwise it is rebuilt with the layout of the source
+    if(!cRosMessageLayoutIsSameType(m_dst->layout, m_src->layout))
+    {
+      cRosMessageFieldsFree(m_dst);
+      ret = (cRosMessageLayoutFieldsAlloc(m_dst, m_src->layout) == CROS_SUCCESS_ERR_PACK)?0:-1;
+    }
+    if(ret == 0)
+    {
+      ret = cRosMessageLayoutFieldsCopy(m_dst, m_src);
+      if(ret != 0)
+        cRosMessageFieldsFree(m_dst);
+    }
+  }
+  else if(ret == 0) // If no error copying MD5 field, continue
   {
     // Remove previous fields from destination message
     cRosMessageFieldsFree(m_dst);
@@ -1630,6 +1786,26 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
   return ret;
 }
 
+void cRosMessageFieldsSwap(cRosMessage *m1, cRosMessage *m2)
+{
+  cRosMessage tmp_msg;
+
+  tmp_msg = *m1;
+  // The field block, its layout, the packet its array views point to and its pending fields are moved together
+  m1->fields = m2->fields;
+  m1->n_fields = m2->n_fields;
+  m1->layout = m2->layout;
+  m1->view_buffer = m2->view_buffer;
+  m1->lazy_state = m2->lazy_state;
+  m1->md5sum = m2->md5sum;
+  m2->fields = tmp_msg.fields;
+  m2->n_fields = tmp_msg.n_fields;
+  m2->layout = tmp_msg.layout;
+  m2->view_buffer = tmp_msg.view_buffer;
+  m2->lazy_state = tmp_msg.lazy_state;
+  m2->md5sum = tmp_msg.md5sum;
+}
+
 cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src)
 {
   cRosMessage *m_dst;
@@ -1660,15 +1836,7 @@ cRosMessage *cRosMessageCopy(cRosMessage *m_src)
     if(m_dst != NULL)
     {
       if(cRosMessageFieldsCopy(m_dst, m_src) == 0)
-      {
-        cRosErrCodePack ret_err;
-        ret_err = cRosMessageDefCopy(&m_dst->msgDef, m_src->msgDef );
-        if(ret_err != CROS_SUCCESS_ERR_PACK)
-        {
-          cRosMessageFree(m_dst);
-          m_dst=NULL; // Return NULL (error indicator)
-        }
-      }
+        m_dst->msgDef = cRosMessageDefRetain(m_src->msgDef); // The definitions are shared, not copied
       else
       {
         // Error copying fields: free the new message
@@ -1682,6 +1850,79 @@ cRosMessage *cRosMessageCopy(cRosMessage *m_src)
   return m_dst;
 }
 
+cRosSharedMessage *cRosSharedMessageNewMove(cRosMessage *m)
+{
+  cRosSharedMessage *s_msg;
+
+  s_msg = (cRosSharedMessage *)malloc(sizeof(cRosSharedMessage));
+  if(s_msg == NULL)
+    return NULL;
+  s_msg->ref_count = 1;
+  cRosMessageInit(&s_msg->msg);
+
+  if(cRosMessageLayoutDecodePending(m) != CROS_SUCCESS_ERR_PACK)
+  {
+    free(s_msg);
+    return NULL;
+  }
+
+  if(m->layout != NULL) // m gets the new fields of the shared message in exchange for its current ones
+  {
+    if(cRosMessageLayoutFieldsAlloc(&s_msg->msg, m->layout) != CROS_SUCCESS_ERR_PACK || s_msg->msg.md5sum == NULL)
+    {
+      cRosMessageRelease(&s_msg->msg);
+      free(s_msg);
+      return NULL;
+    }
+    if(m->md5sum != NULL) // So that m keeps its MD5 sum after the swap
+      strcpy(s_msg->msg.md5sum, m->md5sum);
+    cRosMessageFieldsSwap(&s_msg->msg, m);
+  }
+  else if(cRosMessageFieldsCopy(&s_msg->msg, m) != 0)
+  {
+    cRosMessageRelease(&s_msg->msg);
+    free(s_msg);
+    return NULL;
+  }
+  return s_msg;
+}
+
+cRosSharedMessage *cRosSharedMessageNewCopy(cRosMessage *m)
+{
+  cRosSharedMessage *s_msg;
+
+  s_msg = (cRosSharedMessage *)malloc(sizeof(cRosSharedMessage));
+  if(s_msg == NULL)
+    return NULL;
+  s_msg->ref_count = 1;
+  cRosMessageInit(&s_msg->msg);
+
+  // The copy of a message received with lazy decoding is decoded as well, so that reading it does not modify it
+  if(cRosMessageFieldsCopy(&s_msg->msg, m) != 0 || cRosMessageLayoutDecodePending(&s_msg->msg) != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosMessageRelease(&s_msg->msg);
+    free(s_msg);
+    return NULL;
+  }
+  return s_msg;
+}
+
+cRosSharedMessage *cRosSharedMessageRetain(cRosSharedMessage *s_msg)
+{
+  if(s_msg != NULL)
+    CROS_ATOMIC_FETCH_ADD_INT(&s_msg->ref_count, 1);
+  return s_msg;
+}
+
+void cRosSharedMessageRelease(cRosSharedMessage *s_msg)
+{
+  if(s_msg == NULL || CROS_ATOMIC_FETCH_ADD_INT(&s_msg->ref_count, -1) != 1)
+    return;
+
+  cRosMessageRelease(&s_msg->msg);
+  free(s_msg);
+}
+
 cRosErrCodePack cRosFieldDefCopy(msgFieldDef* new_field_def, msgFieldDef* orig_field_def )
 {
   cRosErrCodePack ret;
@@ -1759,6 +2000,7 @@ cRosErrCodePack cRosMessageDefCopy(cRosMessageDef** ptr_new_msg_def, cRosMessage
     (*ptr_new_msg_def)->package = (orig_msg_def->package != NULL)? strdup(orig_msg_def->package):NULL;
     (*ptr_new_msg_def)->root_dir = (orig_msg_def->root_dir != NULL)? strdup(orig_msg_def->root_dir):NULL;
     (*ptr_new_msg_def)->plain_text = (orig_msg_def->plain_text != NULL)? strdup(orig_msg_def->plain_text):NULL;
+    (*ptr_new_msg_def)->layout = cRosMessageLayoutRetain(orig_msg_def->layout); // The compiled layout is shared by all the copies
 
     ret=CROS_SUCCESS_ERR_PACK; // Default return value: no error
     // Copy the first field
@@ -1878,171 +2120,21 @@ cRosErrCodePack cRosMessageNewBuild(const char *msg_root_dir, const char *msg_ty
 cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDef* msg_def )
 {
   cRosErrCodePack ret;
+  cRosMessageLayout *layout;
   cRosMessage* message;
 
-  ret = CROS_SUCCESS_ERR_PACK; // Default return value: success
-
-  message = cRosMessageNew();
-  if(message == NULL)
-    return CROS_MEM_ALLOC_ERR;
-
-  DynString output;
-  dynStringInit(&output);
-
-  cRosMessageDefFree(message->msgDef); // Just in case there was a previous message definition in the message
-  cRosMessageDefCopy(&message->msgDef, msg_def );
-
-  unsigned char* res = getMD5Msg(msg_def);
-  cRosMD5Readable(res, &output);
-  free(res);
-  strcpy(message->md5sum, dynStringGetData(&output));
-  dynStringRelease(&output);
-
-  msgFieldDef* field_def_itr =  msg_def->first_field;
-  while(field_def_itr->next != NULL)
-  {
-    message->n_fields++;
-    field_def_itr = field_def_itr->next;
-  }
-
-  message->fields = (cRosMessageField **)calloc(message->n_fields, sizeof(cRosMessageField*));
-
-  field_def_itr =  msg_def->first_field;
-  cRosMessageField** msg_field_itr = message->fields;
-
-  while(field_def_itr->next != NULL && ret == CROS_SUCCESS_ERR_PACK)
-  {
-    *msg_field_itr = (cRosMessageField *)malloc(sizeof(cRosMessageField));
-    cRosMessageField* field = *msg_field_itr;
-    cRosMessageFieldInit(field);
-
-    field->type = field_def_itr->type;
-    field->name = (char *)calloc(strlen(field_def_itr->name)+1,sizeof(char));
-    strcpy(field->name, field_def_itr->name);
-    if (field_def_itr->type_s != NULL)
-    {
-      field->type_s = (char *)calloc(strlen(field_def_itr->type_s)+1,sizeof(char));
-      strcpy(field->type_s, field_def_itr->type_s);
-    }
-
-    field->is_array = field_def_itr->is_array;
-    if(field_def_itr->is_array)
-    {
-      if (field_def_itr->array_size == -1) // Variable-length array
-      {
-        field->array_size = 0;
-        field->array_capacity = 1; // If we don't now the array length, allocate memory for at least one element
-      }
-      else // Fixed-length array
-      {
-        field->array_size = field_def_itr->array_size;
-        field->array_capacity = field_def_itr->array_size;
-        field->is_fixed_array = 1;
-      }
-    }
-    switch (field->type)
-    {
-      case CROS_STD_MSGS_INT8:
-      case CROS_STD_MSGS_UINT8:
-      case CROS_STD_MSGS_INT16:
-      case CROS_STD_MSGS_UINT16:
-      case CROS_STD_MSGS_INT32:
-      case CROS_STD_MSGS_UINT32:
-      case CROS_STD_MSGS_INT64:
-      case CROS_STD_MSGS_UINT64:
-      case CROS_STD_MSGS_FLOAT32:
-      case CROS_STD_MSGS_FLOAT64:
-      case CROS_STD_MSGS_BOOL:
-      case CROS_STD_MSGS_CHAR:
-      case CROS_STD_MSGS_BYTE:
-      {
-        field->size = getMessageTypeSizeOf(field->type);
-        if(field_def_itr->is_array)
-        {
-          field->data.as_array = calloc(field->array_capacity,field->size);
-          if(field->data.as_array == NULL)
-            ret=CROS_MEM_ALLOC_ERR;
-        }
-        break;
-      }
-      case CROS_STD_MSGS_STRING:
-      {
-        if(field_def_itr->is_array)
-        {
-          field->data.as_string_array = (char **)calloc(field->array_capacity,sizeof(char *));
-          if(field->data.as_string_array == NULL)
-            ret=CROS_MEM_ALLOC_ERR;
-        }
-        break;
-      }
-      case CROS_STD_MSGS_TIME:
-      case CROS_STD_MSGS_DURATION:
-      case CROS_STD_MSGS_HEADER:
-      case CROS_CUSTOM_TYPE:
-      {
-        cRosMessage *new_msg;
-        if(field_def_itr->is_array)
-        {
-          field->data.as_msg_array = (cRosMessage **)calloc(field->array_capacity,sizeof(cRosMessage *));
-          if(field->data.as_msg_array != NULL)
-          {
-            int msg_ind;
-
-            for(msg_ind=0;msg_ind<field->array_size && ret == CROS_SUCCESS_ERR_PACK;msg_ind++)
-            {
-              new_msg = NULL;
-              if(field->type == CROS_STD_MSGS_TIME)
-                new_msg = build_time_field();
-              else if(field->type == CROS_STD_MSGS_DURATION)
-                new_msg = build_duration_field();
-              else if(field->type == CROS_STD_MSGS_HEADER)
-                new_msg = build_header_field();
-              else if(field->type == CROS_CUSTOM_TYPE)
-              {
-                ret = cRosMessageBuildFromDef(&new_msg, field_def_itr->child_msg_def); // faster alternative to ret = cRosMessageNewBuild(msg_def->root_dir, field_def_itr->type_s, &new_msg)
-                ret = cRosAddErrCodeIfErr(ret, CROS_CREATE_CUSTOM_MSG_ERR); // If the message could not be created, add more info to the error code pack
-              }
-
-              if(new_msg != NULL) // New message created: insert it into the array
-                cRosMessageFieldArrayAtMsgSet(field, msg_ind, new_msg);
-              else // Error creating the new message
-              {
-                if(field->type == CROS_STD_MSGS_TIME || field->type == CROS_STD_MSGS_DURATION || field->type == CROS_STD_MSGS_HEADER)
-                  ret = CROS_MEM_ALLOC_ERR;
-              }
-            }
-          }
-          else
-            ret = CROS_MEM_ALLOC_ERR;
-        }
-        else
-        {
-          if(field->type == CROS_STD_MSGS_TIME)
-            field->data.as_msg = build_time_field();
-          else if(field->type == CROS_STD_MSGS_DURATION)
-            field->data.as_msg = build_duration_field();
-          else if(field->type == CROS_STD_MSGS_HEADER)
-            field->data.as_msg = build_header_field();
-          else if(field->type == CROS_CUSTOM_TYPE)
-          {
-            ret = cRosMessageBuildFromDef(&field->data.as_msg, field_def_itr->child_msg_def);
-            ret = cRosAddErrCodeIfErr(ret, CROS_CREATE_CUSTOM_MSG_ERR);
-          }
-
-          if(field->data.as_msg == NULL && (field->type == CROS_STD_MSGS_TIME || field->type == CROS_STD_MSGS_DURATION || field->type == CROS_STD_MSGS_HEADER))
-            ret = CROS_MEM_ALLOC_ERR;
-        }
-        break;
-      }
-    }
-    msg_field_itr++;
-    field_def_itr = field_def_itr->next;
-  }
+  // The layout of the message type is compiled the first time that a message is built from this definition (or from a copy of it).
+  // Nested messages are embedded in the memory block of the message, so they do not have their own definition copy
+  ret = cRosMessageLayoutGet(msg_def, &layout);
+  if(ret != CROS_SUCCESS_ERR_PACK)
+    return ret;
 
+  ret = cRosMessageLayoutNewMessage(&message, layout);
   if(ret == CROS_SUCCESS_ERR_PACK)
+  {
+    message->msgDef = cRosMessageDefRetain(msg_def); // The definitions are not modified once built, so they are shared
     *message_ptr = message;
-  else
-    cRosMessageFree(message);
+  }
 
   return ret;
 }
@@ -2074,11 +2166,21 @@ void cRosMessageFieldDefFree(msgFieldDef* msg_field)
   }
 }
 
+cRosMessageDef *cRosMessageDefRetain(cRosMessageDef *msgDef)
+{
+  if(msgDef != NULL)
+    CROS_ATOMIC_FETCH_ADD_INT(&msgDef->ref_count, 1);
+  return msgDef;
+}
+
 void cRosMessageDefFree(cRosMessageDef *msgDef)
 {
   if (msgDef == NULL)
     return;
 
+  if(CROS_ATOMIC_FETCH_ADD_INT(&msgDef->ref_count, -1) > 1) // Other owners still use the definition
+    return;
+
   free(msgDef->name);
   msgDef->name = NULL;
   free(msgDef->package);
@@ -2087,6 +2189,8 @@ void cRosMessageDefFree(cRosMessageDef *msgDef)
   msgDef->root_dir = NULL;
   free(msgDef->plain_text);
   msgDef->plain_text = NULL;
+  cRosMessageLayoutRelease(msgDef->layout);
+  msgDef->layout = NULL;
 
   msgConst* it_const = msgDef->first_const;
   while(it_const != NULL)
@@ -2114,9 +2218,19 @@ void cRosMessageFieldsFree(cRosMessage *message)
 {
   int i;
 
-  for(i = 0; i < message->n_fields; i++)
-    cRosMessageFieldFree(message->fields[i]);
-  free(message->fields);
+  if(message->layout != NULL)
+  {
+    cRosMessageLayoutFieldsRelease(message);
+    cRosMessageLayoutBlockFree(message->layout, message->fields); // The memory block that holds all the fields
+    cRosMessageLayoutRelease(message->layout);
+    message->layout = NULL;
+  }
+  else
+  {
+    for(i = 0; i < message->n_fields; i++)
+      cRosMessageFieldFree(message->fields[i]);
+    free(message->fields);
+  }
   message->fields = NULL;
   message->n_fields = 0;
 }
@@ -2162,7 +2276,8 @@ void cRosMessageFieldRelease(cRosMessageField *field)
     field->type != CROS_STD_MSGS_TIME && field->type != CROS_STD_MSGS_DURATION &&
     field->type != CROS_STD_MSGS_HEADER)
     {
-      free(field->data.as_array);
+      if(!field->is_view)
+        free(field->data.as_array);
       field->data.as_array = NULL;
     }
     else
@@ -2214,7 +2329,9 @@ cRosMessageField *cRosMessageGetField(cRosMessage *message, const char *field_na
     cRosMessageField* curr_field = message->fields[i];
     if(strcmp(curr_field->name, field_name) == 0)
     {
-      matching_field = curr_field;
+      // A field of a lazily deserialized message is decoded the first time that it is accessed
+      if(message->lazy_state == NULL || cRosMessageLayoutDecodeField(message, i) == CROS_SUCCESS_ERR_PACK)
+        matching_field = curr_field;
       break;
     }
   }
@@ -2241,11 +2358,36 @@ int cRosMessageSetFieldValueString(cRosMessageField* field, const char* value)
   return ret;
 }
 
+int arrayFieldDetachView(cRosMessageField *field)
+{
+  size_t elem_size;
+  int new_arr_cap;
+  void *new_location;
+
+  if(!field->is_view)
+    return 0;
+
+  elem_size = getMessageTypeSizeOf(field->type);
+  new_arr_cap = (field->array_size > 0)? field->array_size : 1;
+  new_location = malloc(new_arr_cap * elem_size);
+  if(new_location == NULL)
+    return -1;
+
+  memcpy(new_location, field->data.as_array, field->array_size * elem_size);
+  field->data.as_array = new_location;
+  field->array_capacity = new_arr_cap;
+  field->is_view = 0;
+  return 0;
+}
+
 int arrayFieldValuesPushBack(cRosMessageField *field, const void* data, int element_size, int n_new_elements)
 {
   if(field == NULL || !field->is_array || field->is_fixed_array)
     return -1;
 
+  if(arrayFieldDetachView(field) != 0)
+    return -1;
+
   if(field->array_capacity < field->array_size + n_new_elements)
   {
     void *new_location;
@@ -2408,6 +2550,9 @@ int cRosMessageFieldArrayPushBackZero(cRosMessage* msg, int n_field)
   if(n_field >= msg->n_fields || n_field < 0)
     return -1;
 
+  if(msg->lazy_state != NULL && cRosMessageLayoutDecodeField(msg, n_field) != CROS_SUCCESS_ERR_PACK)
+    return -1;
+
   field = msg->fields[n_field];
 
   if(!field->is_array || field->is_fixed_array)
@@ -2415,14 +2560,17 @@ int cRosMessageFieldArrayPushBackZero(cRosMessage* msg, int n_field)
 
   elem_type = field->type;
   elem_size = getMessageTypeSizeOf(elem_type);
+  if(arrayFieldDetachView(field) != 0)
+    return -1;
   if(field->array_capacity == field->array_size)
   {
     void *new_location;
-    new_location = realloc(field->data.as_array, 2 * field->array_capacity * elem_size);
+    int new_arr_cap = (field->array_capacity > 0)? 2 * field->array_capacity : 1;
+    new_location = realloc(field->data.as_array, new_arr_cap * elem_size);
     if(new_location != NULL)
     {
       field->data.as_array = new_location;
-      field->array_capacity *= 2;
+      field->array_capacity = new_arr_cap;
     }
     else
     {
@@ -2456,7 +2604,12 @@ int cRosMessageFieldArrayPushBackZero(cRosMessage* msg, int n_field)
     case CROS_STD_MSGS_HEADER:
     case CROS_CUSTOM_TYPE:
     {
-      if(msg->msgDef != NULL)
+      if(msg->layout != NULL)
+      {
+        if(cRosMessageLayoutNewMessage(&field->data.as_msg_array[field->array_size], msg->layout->fields[n_field].child) != CROS_SUCCESS_ERR_PACK)
+          return -1; // Error creating the message
+      }
+      else if(msg->msgDef != NULL)
       {
         msgFieldDef* field_def_itr;
         int field_ind;
@@ -2725,6 +2878,125 @@ int cRosMessageFieldArrayClear(cRosMessageField *field)
   return 0;
 }
 
+// Size of the elements of an array field of numbers (or bool, char or byte), or 0 if the field is not an array of these types
+static size_t numericArrayElemSize(cRosMessageField *field)
+{
+  if(field == NULL || !field->is_array || !isBuiltinMessageType(field->type) || field->type == CROS_STD_MSGS_STRING ||
+     field->type == CROS_STD_MSGS_TIME || field->type == CROS_STD_MSGS_DURATION)
+    return 0;
+
+  return getMessageTypeSizeOf(field->type);
+}
+
+// Change the memory of a variable-length numeric array to hold capacity elements, keeping the first n_keep ones.
+// An array view gets its own memory without copying the rest of the elements of the packet
+static int numericArraySetCapacity(cRosMessageField *field, size_t elem_size, int capacity, int n_keep)
+{
+  void *new_location;
+
+  if(capacity < 1)
+    capacity = 1;
+
+  if(field->is_view)
+  {
+    new_location = malloc(capacity * elem_size);
+    if(new_location != NULL && n_keep > 0)
+      memcpy(new_location, field->data.as_array, n_keep * elem_size);
+  }
+  else
+    new_location = realloc(field->data.as_array, capacity * elem_size);
+  if(new_location == NULL)
+    return -1;
+
+  field->data.as_array = new_location;
+  field->array_capacity = capacity;
+  field->is_view = 0;
+  return 0;
+}
+
+int cRosMessageFieldArrayReserve(cRosMessageField *field, int n_elems)
+{
+  size_t elem_size = numericArrayElemSize(field);
+
+  if(elem_size == 0 || field->is_fixed_array || n_elems < 0)
+    return -1;
+
+  if(n_elems <= field->array_capacity && !field->is_view)
+    return 0;
+
+  return numericArraySetCapacity(field, elem_size, (n_elems > field->array_size)? n_elems : field->array_size, field->array_size);
+}
+
+int cRosMessageFieldArrayResize(cRosMessageField *field, int n_elems)
+{
+  size_t elem_size = numericArrayElemSize(field);
+
+  if(elem_size == 0 || n_elems < 0)
+    return -1;
+
+  if(field->is_fixed_array)
+    return (n_elems == field->array_size)? 0 : -1;
+
+  // The elements are going to be written in place, so a view is copied into its own memory
+  if((n_elems > field->array_capacity || field->is_view) &&
+     numericArraySetCapacity(field, elem_size, n_elems, (n_elems < field->array_size)? n_elems : field->array_size) != 0)
+    return -1;
+
+  if(n_elems > field->array_size)
+    memset((char *)field->data.as_array + field->array_size * elem_size, 0, (n_elems - field->array_size) * elem_size);
+  field->array_size = n_elems;
+  return 0;
+}
+
+int cRosMessageFieldArrayAssign(cRosMessageField *field, const void *data, int n_elems)
+{
+  size_t elem_size = numericArrayElemSize(field);
+
+  if(elem_size == 0 || n_elems < 0 || (data == NULL && n_elems > 0))
+    return -1;
+
+  if(field->is_fixed_array)
+  {
+    if(n_elems != field->array_size)
+      return -1;
+  }
+  else if(n_elems > field->array_capacity || field->is_view)
+  {
+    // The previous elements are replaced, so they are not kept when the array is enlarged
+    if(!field->is_view)
+      free(field->data.as_array);
+    field->data.as_array = NULL;
+    field->array_capacity = 0;
+    field->is_view = 0;
+    if(numericArraySetCapacity(field, elem_size, n_elems, 0) != 0)
+    {
+      field->array_size = 0;
+      return -1;
+    }
+  }
+
+  if(n_elems > 0)
+    memcpy(field->data.as_array, data, n_elems * elem_size);
+  field->array_size = n_elems;
+  return 0;
+}
+
+int cRosMessageFieldArrayAdopt(cRosMessageField *field, void *data, int n_elems, int capacity)
+{
+  size_t elem_size = numericArrayElemSize(field);
+
+  if(elem_size == 0 || field->is_fixed_array || data == NULL || n_elems < 0 || capacity < n_elems || capacity < 1)
+    return -1;
+
+  if(!field->is_view)
+    free(field->data.as_array);
+  field->data.as_array = data;
+  field->array_size = n_elems;
+  field->array_capacity = capacity;
+  field->is_view = 0;
+  return 0;
+}
+
 void *arrayFieldValueAt(cRosMessageField *field, int position, size_t size)
 {
   if(!field->is_array)
@@ -2766,6 +3038,10 @@ size_t cRosMessageSize(cRosMessage* message)
     size_t ret = 0;
     cRosMessageField** fields_it = message->fields;
     int i;
+
+    if(message->layout != NULL && message->layout->is_fixed_size)
+      return message->layout->wire_size; // Computed when the layout was built
+    cRosMessageDecodePending(message);
     for( i = 0; i < message->n_fields; i++)
     {
       cRosMessageField* field = *fields_it;
@@ -2781,6 +3057,14 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
   cRosErrCodePack ret_err;
   int field_ind;
 
+  if(message->layout != NULL)
+  {
+    ret_err = cRosMessageDecodePending(message);
+    if(ret_err != CROS_SUCCESS_ERR_PACK)
+      return ret_err;
+    return cRosMessageLayoutSerialize(message, buffer);
+  }
+
   ret_err = CROS_SUCCESS_ERR_PACK; // default error value: success
   for (field_ind = 0; field_ind < message->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
   {
@@ -2876,6 +3160,19 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
   return ret_err;
 }
 
+cRosErrCodePack cRosMessageSerializeFrame(cRosMessage *message, TcprosFrame *frame, size_t min_ext_size)
+{
+  cRosErrCodePack ret_err;
+
+  if(message->layout == NULL)
+    return cRosMessageSerialize(message, &frame->packet);
+
+  ret_err = cRosMessageDecodePending(message);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+  return cRosMessageLayoutSerializeFrame(message, frame, min_ext_size);
+}
+
 // In this function we assume that the message is already build according to its definition.
 // Only when receiving a variable-length array, new elements if the message field may need to be created
 cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
@@ -2883,6 +3180,9 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
   int field_ind;
   cRosErrCodePack ret_err;
 
+  if(message->layout != NULL)
+    return cRosMessageLayoutDeserialize(message, buffer);
+
   ret_err = CROS_SUCCESS_ERR_PACK; // default error value: no error
 
   msgFieldDef* field_def_itr =  (message->msgDef != NULL)? message->msgDef->first_field : NULL; // Keep track of the message definition (if available) corresponding to the current message field in case we need to build a msg of type custom
@@ -3067,6 +3367,39 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
   return ret_err;
 }
 
+cRosErrCodePack cRosMessageDeserializeView(cRosMessage *message, SharedBuffer *packet)
+{
+  if(message == NULL || packet == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(message->layout == NULL) // Only the messages built from a layout can track the packet: copy the arrays
+    return cRosMessageDeserialize(message, &packet->buffer);
+
+  return cRosMessageLayoutDeserializeView(message, packet);
+}
+
+cRosErrCodePack cRosMessageDeserializeLazy(cRosMessage *message, SharedBuffer *packet)
+{
+  if(message == NULL || packet == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(message->layout == NULL) // Only the messages built from a layout know where their fields start: decode them now
+    return cRosMessageDeserialize(message, &packet->buffer);
+
+  return cRosMessageLayoutDeserializeLazy(message, packet);
+}
+
+cRosErrCodePack cRosMessageDecodePending(cRosMessage *message)
+{
+  if(message == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(message->lazy_state == NULL)
+    return CROS_SUCCESS_ERR_PACK;
+
+  return cRosMessageLayoutDecodePending(message);
+}
+
 const char *getMessageTypeDeclarationConst(msgConst *msgConst)
 {
   if (msgConst->type_s == NULL)
@@ -0,0 +1,1767 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cros_message.h"
+#include "cros_message_internal.h"
+#include "cros_atomic.h"
+#include "cros_defs.h"
+
+// Alignment of the field structs, arrays and nested messages stored in the memory block of a message
+#define LAYOUT_ALIGNMENT 8
+// Temporary type string offset of the fields without type string until the layout is finished
+#define LAYOUT_NO_TYPE_S ((size_t)-1)
+
+static size_t alignLayoutOffset(size_t offset)
+{
+  return (offset + LAYOUT_ALIGNMENT - 1) & ~((size_t)LAYOUT_ALIGNMENT - 1);
+}
+
+// The block starts with the field pointer array, followed by the field structs
+static size_t layoutFieldStructsOffset(int n_fields)
+{
+  return alignLayoutOffset(n_fields * sizeof(cRosMessageField *));
+}
+
+// A nested message embedded in the block of its parent is stored as: cRosMessage struct, MD5 sum and its own block
+static size_t embeddedMsgMd5Offset(void)
+{
+  return alignLayoutOffset(sizeof(cRosMessage));
+}
+
+static size_t embeddedMsgBlockOffset(void)
+{
+  return alignLayoutOffset(embeddedMsgMd5Offset() + sizeof(((cRosMessageLayout *)0)->md5sum));
+}
+
+// The pooled blocks store the link to the next one, so a block is never smaller than a pointer
+static size_t layoutBlockAllocSize(cRosMessageLayout *layout)
+{
+  return (layout->block_size > sizeof(void *))? layout->block_size : sizeof(void *);
+}
+
+static cRosMessageLayout *newLayout(int n_fields, size_t strings_size)
+{
+  cRosMessageLayout *layout = (cRosMessageLayout *)calloc(1, sizeof(cRosMessageLayout));
+  if(layout == NULL)
+    return NULL;
+
+  layout->fields = (msgLayoutField *)calloc((n_fields > 0)? n_fields : 1, sizeof(msgLayoutField));
+  layout->strings = (char *)malloc((strings_size > 0)? strings_size : 1);
+  if(layout->fields == NULL || layout->strings == NULL || cRosMutexInit(&layout->pool_lock) != 0)
+  {
+    free(layout->fields);
+    free(layout->strings);
+    free(layout);
+    return NULL;
+  }
+  layout->ref_count = 1;
+  layout->n_fields = n_fields;
+  layout->strings_size = strings_size;
+  return layout;
+}
+
+// Fill the description of a field. The child layout reference is transferred to the layout
+static void setLayoutField(cRosMessageLayout *layout, int field_ind, size_t *strings_len, CrosMessageType type,
+                           const char *name, const char *type_s, int is_array, int array_size, cRosMessageLayout *child)
+{
+  msgLayoutField *lf = &layout->fields[field_ind];
+
+  lf->type = type;
+  lf->child = child;
+  lf->array_size = (is_array)? array_size : 0;
+  switch(type)
+  {
+    case CROS_STD_MSGS_STRING:
+      lf->kind = (is_array)? CROS_LAYOUT_STRING_ARRAY : CROS_LAYOUT_STRING;
+      break;
+    case CROS_STD_MSGS_TIME:
+    case CROS_STD_MSGS_DURATION:
+    case CROS_STD_MSGS_HEADER:
+    case CROS_CUSTOM_TYPE:
+      lf->kind = (is_array)? CROS_LAYOUT_MSG_ARRAY : CROS_LAYOUT_MSG;
+      break;
+    default:
+      lf->elem_size = getMessageTypeSizeOf(type);
+      if(is_array)
+        lf->kind = (array_size >= 0)? CROS_LAYOUT_FIXED_ARRAY : CROS_LAYOUT_ARRAY;
+      else
+        lf->kind = CROS_LAYOUT_SCALAR;
+      break;
+  }
+
+  // Until the layout is finished, the string offsets are relative to the start of layout->strings
+  lf->name_offset = *strings_len;
+  strcpy(layout->strings + *strings_len, name);
+  *strings_len += strlen(name) + 1;
+  if(type_s != NULL)
+  {
+    lf->type_s_offset = *strings_len;
+    strcpy(layout->strings + *strings_len, type_s);
+    *strings_len += strlen(type_s) + 1;
+  }
+  else
+    lf->type_s_offset = LAYOUT_NO_TYPE_S;
+}
+
+// Compute the block offsets once all the fields have been set
+static void finishLayout(cRosMessageLayout *layout)
+{
+  size_t offset, run_size;
+  int field_ind;
+
+  offset = layoutFieldStructsOffset(layout->n_fields) + layout->n_fields * sizeof(cRosMessageField);
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+
+    offset = alignLayoutOffset(offset);
+    if(lf->kind == CROS_LAYOUT_FIXED_ARRAY)
+    {
+      lf->data_offset = offset;
+      offset += lf->array_size * lf->elem_size;
+    }
+    else if(lf->kind == CROS_LAYOUT_STRING_ARRAY && lf->array_size >= 0)
+    {
+      lf->data_offset = offset;
+      offset += lf->array_size * sizeof(char *);
+    }
+    else if(lf->kind == CROS_LAYOUT_MSG_ARRAY && lf->array_size >= 0)
+    {
+      lf->data_offset = offset;
+      offset += lf->array_size * sizeof(cRosMessage *);
+    }
+    else if(lf->kind == CROS_LAYOUT_MSG)
+    {
+      lf->data_offset = offset;
+      offset += embeddedMsgBlockOffset() + lf->child->block_size;
+    }
+  }
+  layout->strings_offset = offset;
+  layout->block_size = offset + layout->strings_size;
+
+  // The nested layouts are finished before their parents, so they are already classified
+  layout->is_fixed_size = 1;
+  layout->wire_size = 0;
+  for(field_ind = 0; field_ind < layout->n_fields && layout->is_fixed_size; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+
+    if(lf->kind == CROS_LAYOUT_SCALAR)
+      layout->wire_size += lf->elem_size;
+    else if(lf->kind == CROS_LAYOUT_FIXED_ARRAY)
+      layout->wire_size += lf->array_size * lf->elem_size;
+    else if(lf->kind == CROS_LAYOUT_MSG && lf->child->is_fixed_size)
+      layout->wire_size += lf->child->wire_size;
+    else if(lf->kind == CROS_LAYOUT_MSG_ARRAY && lf->array_size >= 0 && lf->child->is_fixed_size)
+      layout->wire_size += lf->array_size * lf->child->wire_size;
+    else
+      layout->is_fixed_size = 0;
+  }
+
+  run_size = 0;
+  for(field_ind = layout->n_fields - 1; field_ind >= 0; field_ind--)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+
+    lf->name_offset += layout->strings_offset;
+    lf->type_s_offset = (lf->type_s_offset != LAYOUT_NO_TYPE_S)? lf->type_s_offset + layout->strings_offset : 0;
+    run_size = (lf->kind == CROS_LAYOUT_SCALAR)? run_size + lf->elem_size : 0;
+    lf->scalar_run_size = run_size;
+  }
+}
+
+// Layouts of the builtin time, duration and header types (see build_time_field(), build_duration_field() and build_header_field())
+static cRosMessageLayout *buildBuiltinLayout(CrosMessageType type)
+{
+  cRosMessageLayout *layout;
+  size_t strings_len = 0;
+
+  if(type == CROS_STD_MSGS_HEADER)
+  {
+    cRosMessageLayout *stamp_layout = buildBuiltinLayout(CROS_STD_MSGS_TIME);
+    if(stamp_layout == NULL)
+      return NULL;
+
+    layout = newLayout(3, sizeof("seq") + sizeof("stamp") + sizeof("frame_id"));
+    if(layout == NULL)
+    {
+      cRosMessageLayoutRelease(stamp_layout);
+      return NULL;
+    }
+    setLayoutField(layout, 0, &strings_len, CROS_STD_MSGS_UINT32, "seq", NULL, 0, 0, NULL);
+    setLayoutField(layout, 1, &strings_len, CROS_STD_MSGS_TIME, "stamp", NULL, 0, 0, stamp_layout);
+    setLayoutField(layout, 2, &strings_len, CROS_STD_MSGS_STRING, "frame_id", NULL, 0, 0, NULL);
+  }
+  else
+  {
+    CrosMessageType secs_type = (type == CROS_STD_MSGS_TIME)? CROS_STD_MSGS_UINT32 : CROS_STD_MSGS_INT32;
+
+    layout = newLayout(2, sizeof("secs") + sizeof("nsecs"));
+    if(layout == NULL)
+      return NULL;
+    setLayoutField(layout, 0, &strings_len, secs_type, "secs", NULL, 0, 0, NULL);
+    setLayoutField(layout, 1, &strings_len, secs_type, "nsecs", NULL, 0, 0, NULL);
+  }
+  finishLayout(layout);
+  return layout;
+}
+
+static cRosErrCodePack buildLayoutFromDef(cRosMessageDef *msg_def, cRosMessageLayout **layout_ptr)
+{
+  cRosErrCodePack ret;
+  cRosMessageLayout *layout;
+  msgFieldDef *field_def_itr;
+  int n_fields, field_ind;
+  size_t strings_len;
+
+  n_fields = 0;
+  strings_len = 0;
+  for(field_def_itr = msg_def->first_field; field_def_itr->next != NULL; field_def_itr = field_def_itr->next)
+  {
+    n_fields++;
+    strings_len += strlen(field_def_itr->name) + 1;
+    if(field_def_itr->type_s != NULL)
+      strings_len += strlen(field_def_itr->type_s) + 1;
+  }
+
+  layout = newLayout(n_fields, strings_len);
+  if(layout == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret = CROS_SUCCESS_ERR_PACK;
+  strings_len = 0;
+  field_def_itr = msg_def->first_field;
+  for(field_ind = 0; field_ind < n_fields && ret == CROS_SUCCESS_ERR_PACK; field_ind++)
+  {
+    cRosMessageLayout *child = NULL;
+
+    if(field_def_itr->type == CROS_STD_MSGS_TIME || field_def_itr->type == CROS_STD_MSGS_DURATION ||
+       field_def_itr->type == CROS_STD_MSGS_HEADER)
+    {
+      child = buildBuiltinLayout(field_def_itr->type);
+      if(child == NULL)
+        ret = CROS_MEM_ALLOC_ERR;
+    }
+    else if(field_def_itr->type == CROS_CUSTOM_TYPE)
+    {
+      // The layout of the nested type is also kept in its definition, so it is compiled only once
+      ret = cRosMessageLayoutGet(field_def_itr->child_msg_def, &child);
+      ret = cRosAddErrCodeIfErr(ret, CROS_CREATE_CUSTOM_MSG_ERR);
+      if(ret == CROS_SUCCESS_ERR_PACK)
+        cRosMessageLayoutRetain(child);
+    }
+
+    if(ret == CROS_SUCCESS_ERR_PACK)
+      setLayoutField(layout, field_ind, &strings_len, field_def_itr->type, field_def_itr->name, field_def_itr->type_s,
+                     field_def_itr->is_array, field_def_itr->array_size, child);
+    field_def_itr = field_def_itr->next;
+  }
+
+  if(ret == CROS_SUCCESS_ERR_PACK)
+  {
+    unsigned char *md5_res;
+
+    finishLayout(layout);
+    // The layouts of the nested types are already compiled, so getMD5Msg() does not compile them again
+    md5_res = getMD5Msg(msg_def);
+    if(md5_res != NULL)
+    {
+      DynString md5_str;
+
+      dynStringInit(&md5_str);
+      cRosMD5Readable(md5_res, &md5_str);
+      free(md5_res);
+      strncpy(layout->md5sum, dynStringGetData(&md5_str), sizeof(layout->md5sum) - 1);
+      dynStringRelease(&md5_str);
+    }
+    else
+      ret = CROS_MEM_ALLOC_ERR;
+  }
+
+  if(ret == CROS_SUCCESS_ERR_PACK)
+    *layout_ptr = layout;
+  else
+    cRosMessageLayoutRelease(layout);
+
+  return ret;
+}
+
+cRosErrCodePack cRosMessageLayoutGet(cRosMessageDef *msg_def, cRosMessageLayout **layout_ptr)
+{
+  cRosErrCodePack ret;
+
+  if(msg_def == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(msg_def->layout == NULL)
+    ret = buildLayoutFromDef(msg_def, &msg_def->layout);
+  else
+    ret = CROS_SUCCESS_ERR_PACK;
+
+  *layout_ptr = msg_def->layout;
+  return ret;
+}
+
+cRosErrCodePack cRosMessageDefSetPoolSize(cRosMessageDef *msg_def, int n_blocks)
+{
+  cRosErrCodePack ret;
+  cRosMessageLayout *layout;
+
+  ret = cRosMessageLayoutGet(msg_def, &layout);
+  if(ret == CROS_SUCCESS_ERR_PACK)
+    cRosMessageLayoutSetPoolSize(layout, n_blocks);
+  return ret;
+}
+
+cRosErrCodePack cRosMessageDefReservePoolSize(cRosMessageDef *msg_def, int n_blocks)
+{
+  cRosErrCodePack ret;
+  cRosMessageLayout *layout;
+
+  ret = cRosMessageLayoutGet(msg_def, &layout);
+  if(ret == CROS_SUCCESS_ERR_PACK)
+    cRosMessageLayoutReservePoolSize(layout, n_blocks);
+  return ret;
+}
+
+cRosMessageLayout *cRosMessageLayoutRetain(cRosMessageLayout *layout)
+{
+  if(layout != NULL)
+    CROS_ATOMIC_FETCH_ADD_INT(&layout->ref_count, 1);
+  return layout;
+}
+
+void cRosMessageLayoutRelease(cRosMessageLayout *layout)
+{
+  int field_ind;
+
+  // Messages can be released by the callback worker threads, so the count is updated atomically
+  if(layout == NULL || CROS_ATOMIC_FETCH_ADD_INT(&layout->ref_count, -1) != 1)
+    return;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+    cRosMessageLayoutRelease(layout->fields[field_ind].child);
+  while(layout->pool_first != NULL) // No message uses the layout anymore, so the pool is not locked
+  {
+    void *block = layout->pool_first;
+    layout->pool_first = *(void **)block;
+    free(block);
+  }
+  cRosMutexRelease(&layout->pool_lock);
+  free(layout->fields);
+  free(layout->strings);
+  free(layout);
+}
+
+// Get a memory block filled with zeros for a new message, from the block pool if possible
+static char *allocLayoutBlock(cRosMessageLayout *layout)
+{
+  char *block = NULL;
+
+  if(CROS_ATOMIC_LOAD_INT(&layout->pool_size) > 0)
+  {
+    cRosMutexLock(&layout->pool_lock);
+    block = (char *)layout->pool_first;
+    if(block != NULL)
+    {
+      layout->pool_first = *(void **)block;
+      layout->n_pool_blocks--;
+    }
+    cRosMutexUnlock(&layout->pool_lock);
+  }
+
+  if(block != NULL)
+    memset(block, 0, layoutBlockAllocSize(layout));
+  else
+    block = (char *)calloc(1, layoutBlockAllocSize(layout));
+  return block;
+}
+
+void cRosMessageLayoutBlockFree(cRosMessageLayout *layout, void *block)
+{
+  if(block == NULL)
+    return;
+
+  if(CROS_ATOMIC_LOAD_INT(&layout->pool_size) > 0)
+  {
+    cRosMutexLock(&layout->pool_lock);
+    if(layout->n_pool_blocks < layout->pool_size)
+    {
+      *(void **)block = layout->pool_first;
+      layout->pool_first = block;
+      layout->n_pool_blocks++;
+      block = NULL;
+    }
+    cRosMutexUnlock(&layout->pool_lock);
+  }
+  free(block);
+}
+
+void cRosMessageLayoutSetPoolSize(cRosMessageLayout *layout, int pool_size)
+{
+  void *extra_blocks = NULL;
+  int field_ind;
+
+  cRosMutexLock(&layout->pool_lock);
+  CROS_ATOMIC_STORE_INT(&layout->pool_size, (pool_size > 0)? pool_size : 0);
+  while(layout->n_pool_blocks > layout->pool_size)
+  {
+    void *block = layout->pool_first;
+    layout->pool_first = *(void **)block;
+    layout->n_pool_blocks--;
+    *(void **)block = extra_blocks;
+    extra_blocks = block;
+  }
+  cRosMutexUnlock(&layout->pool_lock);
+
+  while(extra_blocks != NULL)
+  {
+    void *block = extra_blocks;
+    extra_blocks = *(void **)block;
+    free(block);
+  }
+
+  // The elements of the message arrays (at any depth) are messages with their own blocks
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+    if(layout->fields[field_ind].child != NULL)
+      cRosMessageLayoutSetPoolSize(layout->fields[field_ind].child, pool_size);
+}
+
+void cRosMessageLayoutReservePoolSize(cRosMessageLayout *layout, int pool_size)
+{
+  int field_ind;
+
+  // The size only grows, so no pooled block has to be freed
+  cRosMutexLock(&layout->pool_lock);
+  if(layout->pool_size < pool_size)
+    CROS_ATOMIC_STORE_INT(&layout->pool_size, pool_size);
+  cRosMutexUnlock(&layout->pool_lock);
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+    if(layout->fields[field_ind].child != NULL)
+      cRosMessageLayoutReservePoolSize(layout->fields[field_ind].child, pool_size);
+}
+
+int cRosMessageLayoutIsSameType(cRosMessageLayout *layout1, cRosMessageLayout *layout2)
+{
+  int field_ind;
+
+  if(layout1 == NULL || layout2 == NULL)
+    return 0;
+
+  if(layout1 == layout2)
+    return 1;
+
+  if(layout1->n_fields != layout2->n_fields || layout1->block_size != layout2->block_size ||
+     strcmp(layout1->md5sum, layout2->md5sum) != 0)
+    return 0;
+
+  for(field_ind = 0; field_ind < layout1->n_fields; field_ind++)
+  {
+    msgLayoutField *lf1 = &layout1->fields[field_ind], *lf2 = &layout2->fields[field_ind];
+    if(lf1->type != lf2->type || lf1->array_size != lf2->array_size)
+      return 0;
+  }
+  return 1;
+}
+
+// Initialize the fields of a message in its memory block (filled with zeros) and allocate its initial
+// variable-length arrays and the messages of its fixed-length message arrays.
+// On error, the memory allocated so far can be freed with cRosMessageLayoutFieldsRelease()
+static cRosErrCodePack initLayoutFields(cRosMessage *message, char *block, cRosMessageLayout *layout)
+{
+  cRosErrCodePack ret;
+  cRosMessageField *field_structs;
+  int field_ind;
+
+  message->fields = (cRosMessageField **)block;
+  message->n_fields = layout->n_fields;
+  message->layout = layout;
+  message->view_buffer = NULL;
+  message->lazy_state = NULL;
+  memcpy(block + layout->strings_offset, layout->strings, layout->strings_size);
+  field_structs = (cRosMessageField *)(block + layoutFieldStructsOffset(layout->n_fields));
+
+  ret = CROS_SUCCESS_ERR_PACK;
+  for(field_ind = 0; field_ind < layout->n_fields && ret == CROS_SUCCESS_ERR_PACK; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *field = &field_structs[field_ind];
+
+    cRosMessageFieldInit(field);
+    field->type = lf->type;
+    field->name = block + lf->name_offset;
+    field->type_s = (lf->type_s_offset != 0)? block + lf->type_s_offset : NULL;
+    if(lf->elem_size > 0)
+      field->size = (int)lf->elem_size;
+
+    if(lf->kind == CROS_LAYOUT_FIXED_ARRAY || lf->kind == CROS_LAYOUT_ARRAY ||
+       lf->kind == CROS_LAYOUT_STRING_ARRAY || lf->kind == CROS_LAYOUT_MSG_ARRAY)
+    {
+      field->is_array = 1;
+      if(lf->array_size >= 0)
+      {
+        field->is_fixed_array = 1;
+        field->array_size = lf->array_size;
+        field->array_capacity = lf->array_size;
+        field->data.as_array = block + lf->data_offset;
+      }
+      else
+      {
+        field->array_size = 0;
+        field->array_capacity = 1; // If we don't now the array length, allocate memory for at least one element
+        field->data.as_array = calloc(1, (lf->elem_size > 0)? lf->elem_size : sizeof(void *));
+        if(field->data.as_array == NULL)
+          ret = CROS_MEM_ALLOC_ERR;
+      }
+    }
+    message->fields[field_ind] = field; // The fields not set yet are skipped when releasing the message on error
+
+    if(ret == CROS_SUCCESS_ERR_PACK && lf->kind == CROS_LAYOUT_MSG)
+    {
+      cRosMessage *nested_msg = (cRosMessage *)(block + lf->data_offset);
+
+      nested_msg->msgDef = NULL;
+      nested_msg->md5sum = block + lf->data_offset + embeddedMsgMd5Offset();
+      strcpy(nested_msg->md5sum, lf->child->md5sum);
+      field->data.as_msg = nested_msg;
+      ret = initLayoutFields(nested_msg, block + lf->data_offset + embeddedMsgBlockOffset(), lf->child);
+    }
+    else if(ret == CROS_SUCCESS_ERR_PACK && lf->kind == CROS_LAYOUT_MSG_ARRAY)
+    {
+      int elem_ind;
+      for(elem_ind = 0; elem_ind < field->array_size && ret == CROS_SUCCESS_ERR_PACK; elem_ind++)
+        ret = cRosMessageLayoutNewMessage(&field->data.as_msg_array[elem_ind], lf->child);
+    }
+  }
+  return ret;
+}
+
+cRosErrCodePack cRosMessageLayoutFieldsAlloc(cRosMessage *message, cRosMessageLayout *layout)
+{
+  cRosErrCodePack ret;
+  char *block;
+
+  block = allocLayoutBlock(layout);
+  if(block == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret = initLayoutFields(message, block, cRosMessageLayoutRetain(layout));
+  if(ret != CROS_SUCCESS_ERR_PACK)
+    cRosMessageFieldsFree(message);
+  return ret;
+}
+
+cRosErrCodePack cRosMessageLayoutNewMessage(cRosMessage **message_ptr, cRosMessageLayout *layout)
+{
+  cRosErrCodePack ret;
+  cRosMessage *message;
+
+  message = cRosMessageNew();
+  if(message == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret = cRosMessageLayoutFieldsAlloc(message, layout);
+  if(ret == CROS_SUCCESS_ERR_PACK)
+  {
+    strcpy(message->md5sum, layout->md5sum);
+    *message_ptr = message;
+  }
+  else
+    cRosMessageFree(message);
+
+  return ret;
+}
+
+void cRosMessageLayoutFieldsRelease(cRosMessage *message)
+{
+  cRosMessageLayout *layout = message->layout;
+  int field_ind, elem_ind;
+
+  if(layout == NULL)
+    return;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *field = message->fields[field_ind];
+
+    if(field == NULL)
+      continue;
+
+    switch(lf->kind)
+    {
+      case CROS_LAYOUT_ARRAY:
+        if(!field->is_view)
+          free(field->data.as_array);
+        break;
+      case CROS_LAYOUT_STRING:
+        free(field->data.as_string);
+        break;
+      case CROS_LAYOUT_STRING_ARRAY:
+        if(field->data.as_string_array != NULL)
+          for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+            free(field->data.as_string_array[elem_ind]);
+        if(lf->array_size < 0)
+          free(field->data.as_string_array);
+        break;
+      case CROS_LAYOUT_MSG:
+        cRosMessageLayoutFieldsRelease(field->data.as_msg);
+        break;
+      case CROS_LAYOUT_MSG_ARRAY:
+        if(field->data.as_msg_array != NULL)
+          for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+            cRosMessageFree(field->data.as_msg_array[elem_ind]);
+        if(lf->array_size < 0)
+          free(field->data.as_msg_array);
+        break;
+      default:
+        break;
+    }
+  }
+  sharedBufferRelease(message->view_buffer);
+  message->view_buffer = NULL;
+  if(message->lazy_state != NULL)
+  {
+    sharedBufferRelease(message->lazy_state->packet);
+    free(message->lazy_state);
+    message->lazy_state = NULL;
+  }
+}
+
+// Make the message keep a reference to the packet that its array views point into (NULL if it has no views)
+static void setLayoutViewBuffer(cRosMessage *message, SharedBuffer *view_buffer)
+{
+  SharedBuffer *prev_buffer = message->view_buffer;
+
+  message->view_buffer = sharedBufferRetain(view_buffer);
+  sharedBufferRelease(prev_buffer);
+}
+
+// Empty the array views of a message that could not be completely filled, since they may point into
+// different packets, and release its packet
+static void dropLayoutViews(cRosMessage *message)
+{
+  int field_ind;
+
+  for(field_ind = 0; field_ind < message->n_fields; field_ind++)
+  {
+    cRosMessageField *field = message->fields[field_ind];
+
+    if(field->is_view)
+    {
+      field->is_view = 0;
+      field->array_size = 0;
+      field->data.as_array = calloc(1, getMessageTypeSizeOf(field->type));
+      field->array_capacity = (field->data.as_array != NULL)? 1 : 0;
+    }
+  }
+  setLayoutViewBuffer(message, NULL);
+}
+
+// Forget the pending fields of a lazily deserialized message whose fields are going to be overwritten, and release its packet
+static void discardLazyFields(cRosMessage *message)
+{
+  cRosMessageLazyState *lazy = message->lazy_state;
+
+  if(lazy == NULL || lazy->packet == NULL)
+    return;
+
+  sharedBufferRelease(lazy->packet);
+  lazy->packet = NULL;
+  lazy->n_pending = 0;
+  memset(lazy->pending, 0, lazy->n_fields);
+}
+
+// Get the lazy decoding state of a message, which is allocated the first time and then reused by the next packets.
+// The field offsets and pending flags are stored in the same allocation, after the struct
+static cRosMessageLazyState *getLazyState(cRosMessage *message)
+{
+  cRosMessageLazyState *lazy = message->lazy_state;
+
+  if(lazy == NULL)
+  {
+    lazy = (cRosMessageLazyState *)malloc(sizeof(cRosMessageLazyState) + message->n_fields * (sizeof(size_t) + 1));
+    if(lazy == NULL)
+      return NULL;
+    lazy->packet = NULL;
+    lazy->n_fields = message->n_fields;
+    lazy->n_pending = 0;
+    lazy->field_offsets = (size_t *)(lazy + 1);
+    lazy->pending = (unsigned char *)(lazy->field_offsets + message->n_fields);
+    memset(lazy->pending, 0, message->n_fields);
+    message->lazy_state = lazy;
+  }
+  return lazy;
+}
+
+static int copyLayoutString(char **dst_str, const char *src_str)
+{
+  if(src_str != NULL)
+  {
+    size_t str_len = strlen(src_str);
+    char *new_str = (char *)realloc(*dst_str, str_len + 1); // Reuse the memory of the previous string
+    if(new_str == NULL)
+      return -1;
+    memcpy(new_str, src_str, str_len + 1);
+    *dst_str = new_str;
+  }
+  else
+  {
+    free(*dst_str);
+    *dst_str = NULL;
+  }
+  return 0;
+}
+
+static int copyLayoutStringArray(cRosMessageField *dst_field, cRosMessageField *src_field)
+{
+  int elem_ind, ret;
+
+  ret = 0;
+  if(!dst_field->is_fixed_array)
+  {
+    // Remove the strings that are not needed and make room for the new ones
+    for(elem_ind = src_field->array_size; elem_ind < dst_field->array_size; elem_ind++)
+      free(dst_field->data.as_string_array[elem_ind]);
+    if(dst_field->array_size > src_field->array_size)
+      dst_field->array_size = src_field->array_size;
+
+    if(dst_field->array_capacity < src_field->array_size)
+    {
+      char **new_location = (char **)realloc(dst_field->data.as_string_array, src_field->array_size * sizeof(char *));
+      if(new_location == NULL)
+        return -1;
+      dst_field->data.as_string_array = new_location;
+      dst_field->array_capacity = src_field->array_size;
+    }
+    for(elem_ind = dst_field->array_size; elem_ind < src_field->array_size; elem_ind++)
+      dst_field->data.as_string_array[elem_ind] = NULL;
+    dst_field->array_size = src_field->array_size;
+  }
+
+  for(elem_ind = 0; elem_ind < src_field->array_size && ret == 0; elem_ind++)
+    ret = copyLayoutString(&dst_field->data.as_string_array[elem_ind], src_field->data.as_string_array[elem_ind]);
+
+  return ret;
+}
+
+static int copyLayoutMsgArray(cRosMessageField *dst_field, cRosMessageField *src_field)
+{
+  int elem_ind, ret;
+
+  if(!dst_field->is_fixed_array)
+    while(dst_field->array_size > src_field->array_size)
+      cRosMessageFree(cRosMessageFieldArrayRemoveLastMsg(dst_field));
+
+  ret = 0;
+  for(elem_ind = 0; elem_ind < src_field->array_size && ret == 0; elem_ind++)
+  {
+    cRosMessage *src_elem = src_field->data.as_msg_array[elem_ind];
+    cRosMessage *dst_elem = (elem_ind < dst_field->array_size)? dst_field->data.as_msg_array[elem_ind] : NULL;
+
+    if(dst_elem != NULL && src_elem != NULL && cRosMessageLayoutIsSameType(dst_elem->layout, src_elem->layout))
+      ret = cRosMessageLayoutFieldsCopy(dst_elem, src_elem); // Reuse the existing message
+    else
+    {
+      cRosMessage *new_elem = cRosMessageCopyWithoutDef(src_elem);
+      if(new_elem != NULL || src_elem == NULL)
+      {
+        ret = cRosMessageFieldArrayAtMsgSet(dst_field, elem_ind, new_elem);
+        if(ret != 0)
+          cRosMessageFree(new_elem);
+      }
+      else
+        ret = -1;
+    }
+  }
+  return ret;
+}
+
+int cRosMessageLayoutFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
+{
+  cRosMessageLayout *layout = m_dst->layout;
+  cRosMessageLazyState *src_lazy = m_src->lazy_state;
+  int field_ind, ret, n_views, src_pending;
+
+  // The fields of the source that have not been decoded yet are not copied: the copy decodes them from the same packet
+  src_pending = (src_lazy != NULL && src_lazy->packet != NULL);
+  discardLazyFields(m_dst);
+  if(src_pending && m_dst->view_buffer != NULL)
+    dropLayoutViews(m_dst);
+
+  ret = 0;
+  n_views = 0;
+  for(field_ind = 0; field_ind < layout->n_fields && ret == 0; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *dst_field = m_dst->fields[field_ind];
+    cRosMessageField *src_field = m_src->fields[field_ind];
+
+    if(src_pending && src_lazy->pending[field_ind])
+      continue;
+
+    switch(lf->kind)
+    {
+      case CROS_LAYOUT_SCALAR:
+        dst_field->data = src_field->data;
+        break;
+      case CROS_LAYOUT_FIXED_ARRAY:
+        memcpy(dst_field->data.as_array, src_field->data.as_array, lf->array_size * lf->elem_size);
+        break;
+      case CROS_LAYOUT_ARRAY:
+        if(src_field->is_view) // The copy shares the packet of the source message
+        {
+          if(!dst_field->is_view)
+            free(dst_field->data.as_array);
+          dst_field->data.as_array = src_field->data.as_array;
+          dst_field->array_size = src_field->array_size;
+          dst_field->array_capacity = src_field->array_capacity;
+          dst_field->is_view = 1;
+          n_views++;
+        }
+        else
+        {
+          dst_field->array_size = 0;
+          ret = arrayFieldValuesPushBack(dst_field, src_field->data.as_array, (int)lf->elem_size, src_field->array_size);
+        }
+        break;
+      case CROS_LAYOUT_STRING:
+        ret = copyLayoutString(&dst_field->data.as_string, src_field->data.as_string);
+        dst_field->size = src_field->size;
+        break;
+      case CROS_LAYOUT_STRING_ARRAY:
+        ret = copyLayoutStringArray(dst_field, src_field);
+        break;
+      case CROS_LAYOUT_MSG:
+        ret = cRosMessageLayoutFieldsCopy(dst_field->data.as_msg, src_field->data.as_msg);
+        break;
+      case CROS_LAYOUT_MSG_ARRAY:
+        ret = copyLayoutMsgArray(dst_field, src_field);
+        break;
+    }
+  }
+
+  if(ret == 0 && src_pending)
+  {
+    cRosMessageLazyState *dst_lazy = getLazyState(m_dst);
+    if(dst_lazy != NULL)
+    {
+      memcpy(dst_lazy->field_offsets, src_lazy->field_offsets, layout->n_fields * sizeof(size_t));
+      memcpy(dst_lazy->pending, src_lazy->pending, layout->n_fields);
+      dst_lazy->n_pending = src_lazy->n_pending;
+      dst_lazy->packet = sharedBufferRetain(src_lazy->packet);
+    }
+    else
+      ret = -1;
+  }
+
+  if(ret == 0)
+    setLayoutViewBuffer(m_dst, (n_views > 0)? m_src->view_buffer : NULL);
+  else
+    dropLayoutViews(m_dst);
+  return ret;
+}
+
+// Write a message of a fixed-size layout into dst (layout->wire_size bytes).
+// Returns -1 if an element of a nested message array was not built from the layout of the array
+static int packFixedLayout(cRosMessage *message, unsigned char *dst)
+{
+  cRosMessageLayout *layout = message->layout;
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *field = message->fields[field_ind];
+
+    switch(lf->kind)
+    {
+      case CROS_LAYOUT_SCALAR:
+        memcpy(dst, field->data.opaque, lf->elem_size);
+        dst += lf->elem_size;
+        break;
+      case CROS_LAYOUT_FIXED_ARRAY:
+        memcpy(dst, field->data.as_array, lf->array_size * lf->elem_size);
+        dst += lf->array_size * lf->elem_size;
+        break;
+      case CROS_LAYOUT_MSG:
+        packFixedLayout(field->data.as_msg, dst);
+        dst += lf->child->wire_size;
+        break;
+      case CROS_LAYOUT_MSG_ARRAY:
+        for(elem_ind = 0; elem_ind < lf->array_size; elem_ind++)
+        {
+          cRosMessage *elem = field->data.as_msg_array[elem_ind];
+          if(elem == NULL || !cRosMessageLayoutIsSameType(elem->layout, lf->child) || packFixedLayout(elem, dst) != 0)
+            return -1;
+          dst += lf->child->wire_size;
+        }
+        break;
+      default:
+        return -1;
+    }
+  }
+  return 0;
+}
+
+// Read a message of a fixed-size layout from src (layout->wire_size bytes).
+// Returns -1 if an element of a nested message array was not built from the layout of the array
+static int unpackFixedLayout(cRosMessage *message, const unsigned char *src)
+{
+  cRosMessageLayout *layout = message->layout;
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *field = message->fields[field_ind];
+
+    switch(lf->kind)
+    {
+      case CROS_LAYOUT_SCALAR:
+        memcpy(field->data.opaque, src, lf->elem_size);
+        src += lf->elem_size;
+        break;
+      case CROS_LAYOUT_FIXED_ARRAY:
+        memcpy(field->data.as_array, src, lf->array_size * lf->elem_size);
+        src += lf->array_size * lf->elem_size;
+        break;
+      case CROS_LAYOUT_MSG:
+        unpackFixedLayout(field->data.as_msg, src);
+        src += lf->child->wire_size;
+        break;
+      case CROS_LAYOUT_MSG_ARRAY:
+        for(elem_ind = 0; elem_ind < lf->array_size; elem_ind++)
+        {
+          cRosMessage *elem = field->data.as_msg_array[elem_ind];
+          if(elem == NULL || !cRosMessageLayoutIsSameType(elem->layout, lf->child) || unpackFixedLayout(elem, src) != 0)
+            return -1;
+          src += lf->child->wire_size;
+        }
+        break;
+      default:
+        return -1;
+    }
+  }
+  return 0;
+}
+
+// Hand the memory of a variable-length numeric array of at least min_ext_size bytes to the frame, which sends it after
+// the bytes already serialized into its packet and frees it when the frame is freed. The array of the message is left
+// empty. Returns 1 if the frame took the array, 0 if it must be copied into the packet and -1 on failure
+static int giveLayoutArrayToFrame(cRosMessageField *field, msgLayoutField *lf, TcprosFrame *frame, size_t min_ext_size)
+{
+  size_t arr_len = (size_t)field->array_size * lf->elem_size;
+
+  if(field->is_view || min_ext_size == 0 || arr_len < min_ext_size)
+    return 0;
+  if(dynBufferPushBackUInt32(&frame->packet, (uint32_t)field->array_size) < 0 ||
+     tcprosFrameAppendExternal(frame, field->data.as_array, arr_len, free, field->data.as_array) != 0)
+    return -1;
+  field->data.as_array = NULL;
+  field->array_size = 0;
+  field->array_capacity = 0;
+  return 1;
+}
+
+// Serialize the message into buffer. If frame is not NULL, buffer is its packet and the large variable-length numeric
+// arrays of the message (and of its nested messages) are given to the frame instead of copied
+static cRosErrCodePack serializeLayoutMessage(cRosMessage *message, DynBuffer *buffer, TcprosFrame *frame, size_t min_ext_size)
+{
+  cRosMessageLayout *layout = message->layout;
+  cRosErrCodePack ret_err;
+  int field_ind, elem_ind;
+
+  // A fixed-size message is written with a single buffer reservation. The reserved bytes are only committed
+  // if the whole message could be packed
+  if(layout->is_fixed_size)
+  {
+    unsigned char *msg_data = dynBufferReserve(buffer, layout->wire_size);
+    if(msg_data == NULL)
+      return CROS_MEM_ALLOC_ERR;
+    if(packFixedLayout(message, msg_data) == 0)
+    {
+      dynBufferCommit(buffer, layout->wire_size);
+      return CROS_SUCCESS_ERR_PACK;
+    }
+  }
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(field_ind = 0; field_ind < layout->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
+  {
+    msgLayoutField *lf = &layout->fields[field_ind];
+    cRosMessageField *field = message->fields[field_ind];
+
+    switch(lf->kind)
+    {
+      case CROS_LAYOUT_SCALAR:
+      {
+        // The whole run of consecutive scalar fields is written with a single buffer reservation
+        size_t run_size = lf->scalar_run_size, offset = 0;
+        unsigned char *run_data = dynBufferReserve(buffer, run_size);
+        if(run_data == NULL)
+        {
+          ret_err = CROS_MEM_ALLOC_ERR;
+          break;
+        }
+        for(;;)
+        {
+          memcpy(run_data + offset, message->fields[field_ind]->data.opaque, layout->fields[field_ind].elem_size);
+          offset += layout->fields[field_ind].elem_size;
+          if(offset >= run_size)
+            break;
+          field_ind++;
+        }
+        dynBufferCommit(buffer, run_size);
+        break;
+      }
+      case CROS_LAYOUT_FIXED_ARRAY:
+        ret_err = (dynBufferPushBackBuf(buffer, field->data.as_uint8_array, lf->array_size * lf->elem_size) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+        break;
+      case CROS_LAYOUT_ARRAY:
+      {
+        unsigned char *arr_data;
+        if(frame != NULL)
+        {
+          int given = giveLayoutArrayToFrame(field, lf, frame, min_ext_size);
+          if(given != 0)
+          {
+            ret_err = (given > 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+            break;
+          }
+        }
+        arr_data = dynBufferReserve(buffer, sizeof(uint32_t) + field->array_size * lf->elem_size);
+        if(arr_data != NULL)
+        {
+          uint32_t n_elems = (uint32_t)field->array_size;
+          memcpy(arr_data, &n_elems, sizeof(uint32_t));
+          memcpy(arr_data + sizeof(uint32_t), field->data.as_array, field->array_size * lf->elem_size);
+          dynBufferCommit(buffer, sizeof(uint32_t) + field->array_size * lf->elem_size);
+        }
+        else
+          ret_err = CROS_MEM_ALLOC_ERR;
+        break;
+      }
+      case CROS_LAYOUT_STRING:
+      case CROS_LAYOUT_STRING_ARRAY:
+      {
+        char **strings;
+        int n_strings;
+
+        if(lf->kind == CROS_LAYOUT_STRING)
+        {
+          strings = &field->data.as_string;
+          n_strings = 1;
+        }
+        else
+        {
+          strings = field->data.as_string_array;
+          n_strings = field->array_size;
+          if(lf->array_size < 0)
+            ret_err = (dynBufferPushBackUInt32(buffer, (uint32_t)n_strings) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+        }
+        for(elem_ind = 0; elem_ind < n_strings && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+        {
+          uint32_t str_len = (strings[elem_ind] != NULL)? (uint32_t)strlen(strings[elem_ind]) : 0;
+          unsigned char *str_data = dynBufferReserve(buffer, sizeof(uint32_t) + str_len);
+          if(str_data != NULL)
+          {
+            memcpy(str_data, &str_len, sizeof(uint32_t));
+            if(str_len > 0)
+              memcpy(str_data + sizeof(uint32_t), strings[elem_ind], str_len);
+            dynBufferCommit(buffer, sizeof(uint32_t) + str_len);
+          }
+          else
+            ret_err = CROS_MEM_ALLOC_ERR;
+        }
+        break;
+      }
+      case CROS_LAYOUT_MSG:
+        ret_err = serializeLayoutMessage(field->data.as_msg, buffer, frame, min_ext_size);
+        break;
+      case CROS_LAYOUT_MSG_ARRAY:
+      {
+        if(lf->array_size < 0)
+          ret_err = (dynBufferPushBackUInt32(buffer, (uint32_t)field->array_size) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+        for(elem_ind = 0; elem_ind < field->array_size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+        {
+          // The array elements may have been built by the user without layout
+          if(field->data.as_msg_array[elem_ind] != NULL)
+            ret_err = cRosMessageSerialize(field->data.as_msg_array[elem_ind], buffer);
+        }
+        break;
+      }
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosMessageLayoutSerialize(cRosMessage *message, DynBuffer *buffer)
+{
+  return serializeLayoutMessage(message, buffer, NULL, 0);
+}
+
+cRosErrCodePack cRosMessageLayoutSerializeFrame(cRosMessage *message, TcprosFrame *frame, size_t min_ext_size)
+{
+  return serializeLayoutMessage(message, &frame->packet, frame, min_ext_size);
+}
+
+// Read the number of elements of a variable-length array
+static cRosErrCodePack deserializeLayoutArraySize(DynBuffer *buffer, uint32_t *n_elems)
+{
+  if(dynBufferGetRemainingDataSize(buffer) < sizeof(uint32_t))
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  memcpy(n_elems, dynBufferGetCurrentData(buffer), sizeof(uint32_t));
+  dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack deserializeLayoutString(DynBuffer *buffer, char **str)
+{
+  cRosErrCodePack ret_err;
+  uint32_t str_len;
+  char *new_str;
+
+  ret_err = deserializeLayoutArraySize(buffer, &str_len);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  if(dynBufferGetRemainingDataSize(buffer) < str_len)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  new_str = (char *)realloc(*str, (size_t)str_len + 1); // Reuse the memory of the previous string
+  if(new_str == NULL)
+    return CROS_MEM_ALLOC_ERR;
+  memcpy(new_str, dynBufferGetCurrentData(buffer), str_len);
+  new_str[str_len] = '\0';
+  *str = new_str;
+  dynBufferMovePoseIndicator(buffer, (int)str_len);
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack deserializeLayoutStringArray(cRosMessageField *field, msgLayoutField *lf, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err;
+  uint32_t n_elems, elem_ind;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  if(lf->array_size < 0)
+  {
+    ret_err = deserializeLayoutArraySize(buffer, &n_elems);
+    if(ret_err != CROS_SUCCESS_ERR_PACK)
+      return ret_err;
+    // Each string takes at least its length in the packet
+    if(n_elems > dynBufferGetRemainingDataSize(buffer) / sizeof(uint32_t))
+      return CROS_DEPACK_INSUFF_DAT_ERR;
+
+    for(elem_ind = n_elems; (int)elem_ind < field->array_size; elem_ind++)
+      free(field->data.as_string_array[elem_ind]);
+    if(field->array_size > (int)n_elems)
+      field->array_size = (int)n_elems;
+
+    if(field->array_capacity < (int)n_elems)
+    {
+      char **new_location = (char **)realloc(field->data.as_string_array, n_elems * sizeof(char *));
+      if(new_location == NULL)
+        return CROS_MEM_ALLOC_ERR;
+      field->data.as_string_array = new_location;
+      field->array_capacity = (int)n_elems;
+    }
+    for(elem_ind = field->array_size; elem_ind < n_elems; elem_ind++)
+      field->data.as_string_array[elem_ind] = NULL;
+    field->array_size = (int)n_elems;
+  }
+  else
+    n_elems = (uint32_t)lf->array_size;
+
+  for(elem_ind = 0; elem_ind < n_elems && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+    ret_err = deserializeLayoutString(buffer, &field->data.as_string_array[elem_ind]);
+
+  return ret_err;
+}
+
+static cRosErrCodePack deserializeLayoutMessage(cRosMessage *message, DynBuffer *buffer, SharedBuffer *views);
+
+static cRosErrCodePack deserializeLayoutMsgArray(cRosMessageField *field, msgLayoutField *lf, DynBuffer *buffer, SharedBuffer *views)
+{
+  cRosErrCodePack ret_err;
+  int elem_ind;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  if(lf->array_size < 0)
+  {
+    uint32_t n_elems;
+
+    ret_err = deserializeLayoutArraySize(buffer, &n_elems);
+    // Adapt the array size of the message field to the received array length
+    while(ret_err == CROS_SUCCESS_ERR_PACK && field->array_size < (int)n_elems)
+    {
+      cRosMessage *new_msg;
+      ret_err = cRosMessageLayoutNewMessage(&new_msg, lf->child);
+      if(ret_err == CROS_SUCCESS_ERR_PACK && cRosMessageFieldArrayPushBackMsg(field, new_msg) != 0)
+      {
+        cRosMessageFree(new_msg);
+        ret_err = CROS_MEM_ALLOC_ERR;
+      }
+    }
+    while(ret_err == CROS_SUCCESS_ERR_PACK && field->array_size > (int)n_elems)
+      cRosMessageFree(cRosMessageFieldArrayRemoveLastMsg(field));
+  }
+
+  for(elem_ind = 0; elem_ind < field->array_size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+  {
+    cRosMessage *elem = field->data.as_msg_array[elem_ind];
+    if(elem->layout != NULL)
+      ret_err = deserializeLayoutMessage(elem, buffer, views);
+    else
+      ret_err = cRosMessageDeserialize(elem, buffer);
+  }
+
+  return ret_err;
+}
+
+// Point an array field to the elements stored in the packet instead of copying them.
+// Returns 0 if the elements are not aligned to their size in the packet, so they must be copied
+static int setLayoutArrayView(cRosMessageField *field, msgLayoutField *lf, const unsigned char *elems, uint32_t n_elems)
+{
+  if((uintptr_t)elems % lf->elem_size != 0)
+    return 0;
+
+  if(!field->is_view)
+    free(field->data.as_array);
+  field->data.as_array = (void *)elems;
+  field->array_size = (int)n_elems;
+  field->array_capacity = (int)n_elems;
+  field->is_view = 1;
+  return 1;
+}
+
+// Deserialize a field of a message. If views is not NULL, it is the packet that contains buffer and the variable-length
+// numeric arrays are left in it (n_views is increased for each one)
+static cRosErrCodePack deserializeLayoutField(cRosMessage *message, int field_ind, DynBuffer *buffer, SharedBuffer *views, int *n_views)
+{
+  msgLayoutField *lf = &message->layout->fields[field_ind];
+  cRosMessageField *field = message->fields[field_ind];
+  cRosErrCodePack ret_err;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  switch(lf->kind)
+  {
+    case CROS_LAYOUT_SCALAR:
+    {
+      if(dynBufferGetRemainingDataSize(buffer) >= lf->elem_size)
+      {
+        memcpy(field->data.opaque, dynBufferGetCurrentData(buffer), lf->elem_size);
+        dynBufferMovePoseIndicator(buffer, (int)lf->elem_size);
+      }
+      else
+        ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+      break;
+    }
+    case CROS_LAYOUT_FIXED_ARRAY:
+    {
+      size_t arr_size = lf->array_size * lf->elem_size;
+      if(dynBufferGetRemainingDataSize(buffer) >= arr_size)
+      {
+        memcpy(field->data.as_array, dynBufferGetCurrentData(buffer), arr_size);
+        dynBufferMovePoseIndicator(buffer, (int)arr_size);
+      }
+      else
+        ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+      break;
+    }
+    case CROS_LAYOUT_ARRAY:
+    {
+      uint32_t n_elems;
+      ret_err = deserializeLayoutArraySize(buffer, &n_elems);
+      if(ret_err == CROS_SUCCESS_ERR_PACK)
+      {
+        if(n_elems <= dynBufferGetRemainingDataSize(buffer) / lf->elem_size)
+        {
+          if(views != NULL && setLayoutArrayView(field, lf, dynBufferGetCurrentData(buffer), n_elems))
+            (*n_views)++;
+          else
+          {
+            field->array_size = 0;
+            ret_err = (arrayFieldValuesPushBack(field, dynBufferGetCurrentData(buffer), (int)lf->elem_size, (int)n_elems) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+          }
+          dynBufferMovePoseIndicator(buffer, (int)(n_elems * lf->elem_size));
+        }
+        else
+          ret_err = CROS_DEPACK_INSUFF_DAT_ERR; // Not enough data available in the packet buffer
+      }
+      break;
+    }
+    case CROS_LAYOUT_STRING:
+      ret_err = deserializeLayoutString(buffer, &field->data.as_string);
+      break;
+    case CROS_LAYOUT_STRING_ARRAY:
+      ret_err = deserializeLayoutStringArray(field, lf, buffer);
+      break;
+    case CROS_LAYOUT_MSG:
+      ret_err = deserializeLayoutMessage(field->data.as_msg, buffer, views);
+      break;
+    case CROS_LAYOUT_MSG_ARRAY:
+      ret_err = deserializeLayoutMsgArray(field, lf, buffer, views);
+      break;
+  }
+  return ret_err;
+}
+
+// Deserialize the fields of a message. If views is not NULL, it is the packet that contains buffer and the variable-length
+// numeric arrays are left in it
+static cRosErrCodePack deserializeLayoutMessage(cRosMessage *message, DynBuffer *buffer, SharedBuffer *views)
+{
+  cRosMessageLayout *layout = message->layout;
+  cRosErrCodePack ret_err;
+  int field_ind, n_views;
+
+  // A fixed-size message is read at once once the packet is known to contain it. It has no array views
+  if(layout->is_fixed_size && dynBufferGetRemainingDataSize(buffer) >= layout->wire_size &&
+     unpackFixedLayout(message, dynBufferGetCurrentData(buffer)) == 0)
+  {
+    dynBufferMovePoseIndicator(buffer, (int)layout->wire_size);
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  n_views = 0;
+  for(field_ind = 0; field_ind < layout->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
+  {
+    if(layout->fields[field_ind].kind == CROS_LAYOUT_SCALAR)
+    {
+      // The whole run of consecutive scalar fields is checked and read at once
+      size_t run_size = layout->fields[field_ind].scalar_run_size, offset = 0;
+      const unsigned char *run_data = dynBufferGetCurrentData(buffer);
+      if(dynBufferGetRemainingDataSize(buffer) < run_size)
+      {
+        ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+        break;
+      }
+      for(;;)
+      {
+        memcpy(message->fields[field_ind]->data.opaque, run_data + offset, layout->fields[field_ind].elem_size);
+        offset += layout->fields[field_ind].elem_size;
+        if(offset >= run_size)
+          break;
+        field_ind++;
+      }
+      dynBufferMovePoseIndicator(buffer, (int)run_size);
+    }
+    else
+      ret_err = deserializeLayoutField(message, field_ind, buffer, views, &n_views);
+  }
+
+  // All the array fields have been replaced, so none of them points into the previous packet anymore
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    setLayoutViewBuffer(message, (n_views > 0)? views : NULL);
+  else
+    dropLayoutViews(message);
+  return ret_err;
+}
+
+cRosErrCodePack cRosMessageLayoutDeserialize(cRosMessage *message, DynBuffer *buffer)
+{
+  discardLazyFields(message); // All the fields are overwritten
+  return deserializeLayoutMessage(message, buffer, NULL);
+}
+
+cRosErrCodePack cRosMessageLayoutDeserializeView(cRosMessage *message, SharedBuffer *packet)
+{
+  discardLazyFields(message);
+  return deserializeLayoutMessage(message, &packet->buffer, packet);
+}
+
+// Move the position indicator of buffer over a string, checking that the packet contains it
+static cRosErrCodePack skipLayoutString(DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err;
+  uint32_t str_len;
+
+  ret_err = deserializeLayoutArraySize(buffer, &str_len);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    if(dynBufferGetRemainingDataSize(buffer) >= str_len)
+      dynBufferMovePoseIndicator(buffer, (int)str_len);
+    else
+      ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+  }
+  return ret_err;
+}
+
+static cRosErrCodePack skipLayoutMessage(cRosMessageLayout *layout, DynBuffer *buffer);
+
+// Move the position indicator of buffer over a field without decoding it, checking that the packet contains it
+static cRosErrCodePack skipLayoutField(msgLayoutField *lf, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err;
+  uint32_t n_elems, elem_ind;
+  size_t skip_size;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  if(lf->kind == CROS_LAYOUT_SCALAR || lf->kind == CROS_LAYOUT_STRING || lf->kind == CROS_LAYOUT_MSG)
+    n_elems = 1;
+  else if(lf->array_size >= 0)
+    n_elems = (uint32_t)lf->array_size;
+  else
+  {
+    ret_err = deserializeLayoutArraySize(buffer, &n_elems);
+    if(ret_err != CROS_SUCCESS_ERR_PACK)
+      return ret_err;
+  }
+
+  switch(lf->kind)
+  {
+    case CROS_LAYOUT_SCALAR:
+    case CROS_LAYOUT_FIXED_ARRAY:
+    case CROS_LAYOUT_ARRAY:
+      skip_size = 0;
+      if(n_elems <= dynBufferGetRemainingDataSize(buffer) / lf->elem_size)
+        skip_size = n_elems * lf->elem_size;
+      else
+        ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+      dynBufferMovePoseIndicator(buffer, (int)skip_size);
+      break;
+    case CROS_LAYOUT_STRING:
+      ret_err = skipLayoutString(buffer);
+      break;
+    case CROS_LAYOUT_STRING_ARRAY:
+      for(elem_ind = 0; elem_ind < n_elems && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+        ret_err = skipLayoutString(buffer);
+      break;
+    case CROS_LAYOUT_MSG:
+    case CROS_LAYOUT_MSG_ARRAY:
+      if(lf->child->is_fixed_size)
+      {
+        skip_size = 0;
+        if(lf->child->wire_size == 0 || n_elems <= dynBufferGetRemainingDataSize(buffer) / lf->child->wire_size)
+          skip_size = n_elems * lf->child->wire_size;
+        else
+          ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+        dynBufferMovePoseIndicator(buffer, (int)skip_size);
+      }
+      else if(n_elems > dynBufferGetRemainingDataSize(buffer) / sizeof(uint32_t))
+        ret_err = CROS_DEPACK_INSUFF_DAT_ERR; // Each variable-size element takes at least the length of a string or array
+      else
+        for(elem_ind = 0; elem_ind < n_elems && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+          ret_err = skipLayoutMessage(lf->child, buffer);
+      break;
+  }
+  return ret_err;
+}
+
+static cRosErrCodePack skipLayoutMessage(cRosMessageLayout *layout, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err;
+  int field_ind;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(field_ind = 0; field_ind < layout->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
+    ret_err = skipLayoutField(&layout->fields[field_ind], buffer);
+  return ret_err;
+}
+
+cRosErrCodePack cRosMessageLayoutDeserializeLazy(cRosMessage *message, SharedBuffer *packet)
+{
+  cRosMessageLayout *layout = message->layout;
+  cRosMessageLazyState *lazy;
+  DynBuffer *buffer = &packet->buffer;
+  cRosErrCodePack ret_err;
+  int field_ind;
+
+  if(layout->is_fixed_size) // Decoding it at once costs less than finding its fields
+    return cRosMessageLayoutDeserializeView(message, packet);
+
+  discardLazyFields(message);
+  lazy = getLazyState(message);
+  if(lazy == NULL)
+    return CROS_MEM_ALLOC_ERR;
+  // The array views of the previous packet are dropped, since the pending fields must not point into it when it is released
+  if(message->view_buffer != NULL)
+    dropLayoutViews(message);
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(field_ind = 0; field_ind < layout->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
+  {
+    lazy->field_offsets[field_ind] = dynBufferGetCurrentData(buffer) - dynBufferGetData(buffer);
+    ret_err = skipLayoutField(&layout->fields[field_ind], buffer);
+  }
+
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    lazy->packet = sharedBufferRetain(packet);
+    lazy->n_pending = layout->n_fields;
+    memset(lazy->pending, 1, layout->n_fields);
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosMessageLayoutDecodeField(cRosMessage *message, int field_ind)
+{
+  cRosMessageLazyState *lazy = message->lazy_state;
+  cRosErrCodePack ret_err;
+  DynBuffer field_buffer;
+  int n_views;
+
+  if(lazy == NULL || lazy->packet == NULL || !lazy->pending[field_ind])
+    return CROS_SUCCESS_ERR_PACK;
+
+  // The field is read through a copy of the packet buffer, so that the shared packet is not modified
+  field_buffer = lazy->packet->buffer;
+  dynBufferSetPoseIndicator(&field_buffer, lazy->field_offsets[field_ind]);
+  n_views = 0;
+  ret_err = deserializeLayoutField(message, field_ind, &field_buffer, lazy->packet, &n_views);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  if(n_views > 0 && message->view_buffer != lazy->packet)
+    setLayoutViewBuffer(message, lazy->packet);
+  lazy->pending[field_ind] = 0;
+  if(--lazy->n_pending == 0) // The packet is only kept now by the array views
+  {
+    sharedBufferRelease(lazy->packet);
+    lazy->packet = NULL;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosMessageLayoutDecodePending(cRosMessage *message)
+{
+  cRosErrCodePack ret_err;
+  int field_ind;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(field_ind = 0; message->lazy_state != NULL && message->lazy_state->packet != NULL &&
+      field_ind < message->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; field_ind++)
+    ret_err = cRosMessageLayoutDecodeField(message, field_ind);
+  return ret_err;
+}
+
+// Search a field by name in a layout. name_len is the length of the name in the path
+static int findLayoutField(cRosMessageLayout *layout, const char *name, size_t name_len)
+{
+  int field_ind;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    const char *field_name = layout->strings + (layout->fields[field_ind].name_offset - layout->strings_offset);
+    if(strncmp(field_name, name, name_len) == 0 && field_name[name_len] == '\0')
+      return field_ind;
+  }
+  return -1;
+}
+
+cRosErrCodePack cRosMessageFieldHandleResolve(cRosMessageDef *msg_def, const char *path, cRosMessageFieldHandle **handle_ptr)
+{
+  cRosErrCodePack ret;
+  cRosMessageFieldHandle *handle;
+  cRosMessageLayout *root_layout, *layout;
+  const char *elem, *elem_end;
+  size_t block_offset;
+  int field_ind, depth;
+
+  if(path == NULL || handle_ptr == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  ret = cRosMessageLayoutGet(msg_def, &root_layout);
+  if(ret != CROS_SUCCESS_ERR_PACK)
+    return ret;
+
+  handle = (cRosMessageFieldHandle *)calloc(1, sizeof(cRosMessageFieldHandle));
+  if(handle == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  depth = 1;
+  for(elem = path; *elem != '\0'; elem++)
+    if(*elem == '.')
+      depth++;
+  handle->field_inds = (int *)malloc(depth * sizeof(int));
+  if(handle->field_inds == NULL)
+  {
+    free(handle);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  // The offset of the field struct is accumulated through the blocks of the embedded nested messages
+  layout = root_layout;
+  block_offset = 0;
+  elem = path;
+  for(handle->depth = 0; handle->depth < depth; handle->depth++)
+  {
+    msgLayoutField *lf;
+
+    elem_end = strchr(elem, '.');
+    if(elem_end == NULL)
+      elem_end = elem + strlen(elem);
+
+    field_ind = (layout != NULL)? findLayoutField(layout, elem, elem_end - elem) : -1;
+    if(field_ind < 0)
+      break;
+    handle->field_inds[handle->depth] = field_ind;
+
+    lf = &layout->fields[field_ind];
+    if(handle->depth == depth - 1)
+    {
+      handle->field_offset = block_offset + layoutFieldStructsOffset(layout->n_fields) + field_ind * sizeof(cRosMessageField);
+      handle->type = lf->type;
+      handle->is_array = (lf->array_size != 0);
+    }
+    else if(lf->kind == CROS_LAYOUT_MSG)
+    {
+      block_offset += lf->data_offset + embeddedMsgBlockOffset();
+      layout = lf->child;
+    }
+    else
+      layout = NULL; // Only nested non-array messages can be traversed
+
+    elem = elem_end + 1;
+  }
+
+  if(handle->depth < depth)
+  {
+    free(handle->field_inds);
+    free(handle);
+    return CROS_MSG_FIELD_PATH_ERR;
+  }
+
+  handle->layout = cRosMessageLayoutRetain(root_layout);
+  *handle_ptr = handle;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+void cRosMessageFieldHandleFree(cRosMessageFieldHandle *handle)
+{
+  if(handle == NULL)
+    return;
+
+  cRosMessageLayoutRelease(handle->layout);
+  free(handle->field_inds);
+  free(handle);
+}
+
+cRosMessageField *cRosMessageGetFieldByHandle(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  cRosMessageField *field;
+  int path_ind;
+
+  if(message == NULL || handle == NULL)
+    return NULL;
+
+  // The top-level field of the path is decoded first if the message was deserialized lazily
+  if(message->lazy_state != NULL && handle->field_inds[0] < message->n_fields &&
+     cRosMessageLayoutDecodeField(message, handle->field_inds[0]) != CROS_SUCCESS_ERR_PACK)
+    return NULL;
+
+  // Messages built from the same layout store the field at the same offset of their block
+  if(message->layout != NULL && cRosMessageLayoutIsSameType(message->layout, handle->layout))
+    return (cRosMessageField *)((char *)message->fields + handle->field_offset);
+
+  // Otherwise the field is found through the field indices of the path, checking the types on the way
+  field = NULL;
+  for(path_ind = 0; path_ind < handle->depth; path_ind++)
+  {
+    int field_ind = handle->field_inds[path_ind];
+
+    if(message == NULL || field_ind >= message->n_fields)
+      return NULL;
+
+    field = message->fields[field_ind];
+    if(path_ind < handle->depth - 1)
+    {
+      if(field->is_array || (field->type != CROS_CUSTOM_TYPE && field->type != CROS_STD_MSGS_TIME &&
+                             field->type != CROS_STD_MSGS_DURATION && field->type != CROS_STD_MSGS_HEADER))
+        return NULL;
+      message = field->data.as_msg;
+    }
+  }
+
+  if(field == NULL || field->type != handle->type || field->is_array != handle->is_array)
+    return NULL;
+
+  return field;
+}
+
+// Get the value storage of a non-array field of the specified type through a handle
+static void *handleValueAt(cRosMessage *message, const cRosMessageFieldHandle *handle, CrosMessageType type)
+{
+  cRosMessageField *field;
+
+  if(handle == NULL || handle->type != type || handle->is_array)
+    return NULL;
+
+  field = cRosMessageGetFieldByHandle(message, handle);
+  return (field != NULL)? &field->data : NULL;
+}
+
+int8_t *cRosMessageHandleAtInt8(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (int8_t *)handleValueAt(message, handle, CROS_STD_MSGS_INT8);
+}
+
+int16_t *cRosMessageHandleAtInt16(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (int16_t *)handleValueAt(message, handle, CROS_STD_MSGS_INT16);
+}
+
+int32_t *cRosMessageHandleAtInt32(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (int32_t *)handleValueAt(message, handle, CROS_STD_MSGS_INT32);
+}
+
+int64_t *cRosMessageHandleAtInt64(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (int64_t *)handleValueAt(message, handle, CROS_STD_MSGS_INT64);
+}
+
+uint8_t *cRosMessageHandleAtUInt8(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (uint8_t *)handleValueAt(message, handle, CROS_STD_MSGS_UINT8);
+}
+
+uint16_t *cRosMessageHandleAtUInt16(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (uint16_t *)handleValueAt(message, handle, CROS_STD_MSGS_UINT16);
+}
+
+uint32_t *cRosMessageHandleAtUInt32(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (uint32_t *)handleValueAt(message, handle, CROS_STD_MSGS_UINT32);
+}
+
+uint64_t *cRosMessageHandleAtUInt64(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (uint64_t *)handleValueAt(message, handle, CROS_STD_MSGS_UINT64);
+}
+
+float *cRosMessageHandleAtFloat32(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (float *)handleValueAt(message, handle, CROS_STD_MSGS_FLOAT32);
+}
+
+double *cRosMessageHandleAtFloat64(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  return (double *)handleValueAt(message, handle, CROS_STD_MSGS_FLOAT64);
+}
+
+const char *cRosMessageHandleStringGet(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  char **str = (char **)handleValueAt(message, handle, CROS_STD_MSGS_STRING);
+  return (str != NULL)? *str : NULL;
+}
+
+int cRosMessageHandleStringSet(cRosMessage *message, const cRosMessageFieldHandle *handle, const char *val)
+{
+  cRosMessageField *field;
+
+  if(handle == NULL || handle->type != CROS_STD_MSGS_STRING || handle->is_array)
+    return -1;
+
+  field = cRosMessageGetFieldByHandle(message, handle);
+  if(field == NULL)
+    return -1;
+
+  return cRosMessageSetFieldValueString(field, val);
+}
@@ -2,15 +2,114 @@
 #include <string.h>
 
 #include "cros_message_queue.h"
+#include "cros_message_internal.h"
+#include "cros_atomic.h"
 
 void cRosMessageQueueInit(cRosMessageQueue *q)
+{
+  q->msgs = NULL; // The messages are allocated when they are first needed, so that unused queues take no memory
+  q->shared = NULL;
+  q->capacity = MAX_QUEUE_LEN;
+  q->length = 0;
+  q->first_msg_ind = 0;
+}
+
+// Allocate the messages of the queue if they have not been allocated yet
+static int allocQueueMsgs(cRosMessageQueue *q)
 {
   unsigned int msg_ind;
+
+  if(q->msgs != NULL)
+    return 0;
+
+  q->msgs = (cRosMessage *)malloc(q->capacity * sizeof(cRosMessage));
+  q->shared = (cRosSharedMessage **)calloc(q->capacity, sizeof(cRosSharedMessage *));
+  if(q->msgs == NULL || q->shared == NULL)
+  {
+    free(q->msgs);
+    free(q->shared);
+    q->msgs = NULL;
+    q->shared = NULL;
+    return -1;
+  }
   // Initialize all messages in the queue so that the inserted messages only need to be copied over these ones
-  for(msg_ind=0;msg_ind<MAX_QUEUE_LEN;msg_ind++)
+  for(msg_ind=0;msg_ind<q->capacity;msg_ind++)
     cRosMessageInit(&q->msgs[msg_ind]);
-  q->length = 0;
+  return 0;
+}
+
+// Get the message at a position of the queue, which is a shared message if the position holds a reference to one
+static cRosMessage *queueMsg(cRosMessageQueue *q, unsigned int msg_ind)
+{
+  return (q->shared[msg_ind] != NULL)? &q->shared[msg_ind]->msg : &q->msgs[msg_ind];
+}
+
+// Delete the fields of the message at a position of the queue (or its reference to a shared message)
+static void freeQueueMsg(cRosMessageQueue *q, unsigned int msg_ind)
+{
+  if(q->shared[msg_ind] != NULL)
+  {
+    cRosSharedMessageRelease(q->shared[msg_ind]);
+    q->shared[msg_ind] = NULL;
+  }
+  else
+    cRosMessageFieldsFree(&q->msgs[msg_ind]);
+}
+
+int cRosMessageQueueSetCapacity(cRosMessageQueue *q, unsigned int capacity)
+{
+  cRosMessage *new_msgs;
+  cRosSharedMessage **new_shared;
+  unsigned int msg_ind;
+
+  if(capacity < 1)
+    return -2;
+
+  if(q->msgs == NULL)
+  {
+    q->capacity = capacity;
+    return 0;
+  }
+
+  new_msgs = (cRosMessage *)malloc(capacity * sizeof(cRosMessage));
+  new_shared = (cRosSharedMessage **)calloc(capacity, sizeof(cRosSharedMessage *));
+  if(new_msgs == NULL || new_shared == NULL)
+  {
+    free(new_msgs);
+    free(new_shared);
+    return -1;
+  }
+
+  while(q->length > capacity) // Keep the newest messages
+    cRosMessageQueueRemove(q);
+
+  // The queued messages are moved to the start of the new buffer and the rest of the old messages are released
+  for(msg_ind=0;msg_ind<q->capacity;msg_ind++)
+  {
+    unsigned int old_ind = (q->first_msg_ind + msg_ind) % q->capacity;
+    if(msg_ind < q->length)
+    {
+      new_msgs[msg_ind] = q->msgs[old_ind];
+      new_shared[msg_ind] = q->shared[old_ind];
+    }
+    else
+      cRosMessageRelease(&q->msgs[old_ind]);
+  }
+  for(msg_ind=q->length;msg_ind<capacity;msg_ind++)
+    cRosMessageInit(&new_msgs[msg_ind]);
+
+  free(q->msgs);
+  free(q->shared);
+  q->msgs = new_msgs;
+  q->shared = new_shared;
+  q->capacity = capacity;
   q->first_msg_ind = 0;
+  return 0;
+}
+
+unsigned int cRosMessageQueueCapacity(cRosMessageQueue *q)
+{
+  return q->capacity;
 }
 
 void cRosMessageQueueClear(cRosMessageQueue *q)
@@ -19,9 +118,9 @@ void cRosMessageQueueClear(cRosMessageQueue *q)
   while(q->length > 0)
   {
     // Delete fields from message to remove
-    cRosMessageFieldsFree(&q->msgs[q->first_msg_ind]);
+    freeQueueMsg(q, q->first_msg_ind);
     // The queue is internally implemented as a circular buffer
-    q->first_msg_ind = (q->first_msg_ind + 1) % MAX_QUEUE_LEN;
+    q->first_msg_ind = (q->first_msg_ind + 1) % q->capacity;
     q->length--;
   }
   q->first_msg_ind = 0;
@@ -29,7 +128,7 @@ void cRosMessageQueueClear(cRosMessageQueue *q)
 
 unsigned int cRosMessageQueueVacancies(cRosMessageQueue *q)
 {
-  return MAX_QUEUE_LEN - q->length;
+  return q->capacity - q->length;
 }
 
 unsigned int cRosMessageQueueUsage(cRosMessageQueue *q)
@@ -41,19 +140,27 @@ void cRosMessageQueueRelease(cRosMessageQueue *q)
 {
   unsigned int msg_ind;
   cRosMessageQueueClear(q);
+  if(q->msgs == NULL)
+    return;
   // Release the memory of all container messages in the queue
-  for(msg_ind=0;msg_ind<MAX_QUEUE_LEN;msg_ind++)
+  for(msg_ind=0;msg_ind<q->capacity;msg_ind++)
     cRosMessageRelease(&q->msgs[msg_ind]);
+  free(q->msgs);
+  free(q->shared);
+  q->msgs = NULL;
+  q->shared = NULL;
 }
 
 int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m)
 {
   int ret;
-  if(q->length < MAX_QUEUE_LEN)
+  if(q->length < q->capacity)
   {
     unsigned int next_msg_pos;
+    if(allocQueueMsgs(q) != 0)
+      return -1;
     // The queue is internally implemented as a circular buffer
-    next_msg_pos = (q->first_msg_ind + q->length) % MAX_QUEUE_LEN;
+    next_msg_pos = (q->first_msg_ind + q->length) % q->capacity;
     ret = cRosMessageFieldsCopy(&q->msgs[next_msg_pos], m);
     q->length++;
   }
@@ -69,7 +176,7 @@ int cRosMessageQueueGet(cRosMessageQueue *q, cRosMessage *m)
   if(q->length > 0)
   {
     cRosMessage *msg_to_peek;
-    msg_to_peek = &q->msgs[q->first_msg_ind];
+    msg_to_peek = queueMsg(q, q->first_msg_ind);
     ret = cRosMessageFieldsCopy(m, msg_to_peek);
   }
   else
@@ -84,12 +191,10 @@ int cRosMessageQueueRemove(cRosMessageQueue *q)
 
   if(q->length > 0)
   {
-    cRosMessage *msg_to_remove;
-    msg_to_remove = &q->msgs[q->first_msg_ind];
     // Delete fields from removed message
-    cRosMessageFieldsFree(msg_to_remove);
+    freeQueueMsg(q, q->first_msg_ind);
     // The queue is internally implemented as a circular buffer
-    q->first_msg_ind = (q->first_msg_ind + 1) % MAX_QUEUE_LEN;
+    q->first_msg_ind = (q->first_msg_ind + 1) % q->capacity;
     q->length--;
     ret=0;
   }
@@ -110,11 +215,96 @@ int cRosMessageQueueExtract(cRosMessageQueue *q, cRosMessage *m)
   return ret;
 }
 
+int cRosMessageQueueAddMove(cRosMessageQueue *q, cRosMessage *m)
+{
+  int ret;
+
+  if(m->layout == NULL) // Only the messages built from a layout can be refilled with a new field block of the same type
+    return cRosMessageQueueAdd(q, m);
+
+  if(q->length < q->capacity)
+  {
+    cRosMessage *next_msg;
+    if(allocQueueMsgs(q) != 0)
+      return -1;
+    // The queue is internally implemented as a circular buffer
+    next_msg = &q->msgs[(q->first_msg_ind + q->length) % q->capacity];
+    // The free slot gets the fields of a new message of the same type (taken from the block pool of the type if enabled),
+    // which are handed over to m in exchange for its current fields
+    cRosMessageFieldsFree(next_msg);
+    if(cRosMessageLayoutFieldsAlloc(next_msg, m->layout) == CROS_SUCCESS_ERR_PACK)
+    {
+      if(m->md5sum != NULL) // So that m keeps its MD5 sum after the swap
+      {
+        if(next_msg->md5sum != NULL)
+          strcpy(next_msg->md5sum, m->md5sum);
+        else
+          next_msg->md5sum = strdup(m->md5sum);
+      }
+      cRosMessageFieldsSwap(next_msg, m);
+      q->length++;
+      ret=0;
+    }
+    else
+      ret=-1;
+  }
+  else
+    ret=-2;
+
+  return ret;
+}
+
+int cRosMessageQueueAddShared(cRosMessageQueue *q, cRosSharedMessage *s_msg)
+{
+  int ret;
+  if(q->length < q->capacity)
+  {
+    unsigned int next_msg_pos;
+    if(allocQueueMsgs(q) != 0)
+      return -1;
+    // The queue is internally implemented as a circular buffer
+    next_msg_pos = (q->first_msg_ind + q->length) % q->capacity;
+    q->shared[next_msg_pos] = cRosSharedMessageRetain(s_msg);
+    q->length++;
+    ret=0;
+  }
+  else
+    ret=-2;
+
+  return ret;
+}
+
+int cRosMessageQueueExtractMove(cRosMessageQueue *q, cRosMessage *m)
+{
+  int ret;
+
+  if(q->length > 0)
+  {
+    cRosMessage *first_msg;
+    cRosSharedMessage *first_shared = q->shared[q->first_msg_ind];
+    first_msg = queueMsg(q, q->first_msg_ind);
+    if(first_shared != NULL && CROS_ATOMIC_LOAD_INT(&first_shared->ref_count) != 1) // Other holders still read it
+      ret = cRosMessageQueueExtract(q, m);
+    else if(first_msg->layout != NULL && (m->fields == NULL || cRosMessageLayoutIsSameType(m->layout, first_msg->layout)))
+    {
+      // m takes the fields of the first message and its previous fields are freed when removing the message from the queue
+      cRosMessageFieldsSwap(first_msg, m);
+      ret = cRosMessageQueueRemove(q);
+    }
+    else
+      ret = cRosMessageQueueExtract(q, m);
+  }
+  else
+    ret=-2;
+
+  return ret;
+}
+
 cRosMessage *cRosMessageQueuePeekFirst(cRosMessageQueue *q)
 {
   cRosMessage *first_msg;
   if(q->length > 0)
-    first_msg = &q->msgs[q->first_msg_ind];
+    first_msg = queueMsg(q, q->first_msg_ind);
   else
     first_msg = NULL;
 
@@ -128,8 +318,8 @@ cRosMessage *cRosMessageQueuePeekLast(cRosMessageQueue *q)
   {
     unsigned int last_msg_pos;
     // The queue is internally implemented as a circular buffer
-    last_msg_pos = (q->first_msg_ind + q->length - 1) % MAX_QUEUE_LEN;
-    last_msg = &q->msgs[last_msg_pos];
+    last_msg_pos = (q->first_msg_ind + q->length - 1) % q->capacity;
+    last_msg = queueMsg(q, last_msg_pos);
   }
   else
     last_msg = NULL;
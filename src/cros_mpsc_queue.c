@@ -0,0 +1,56 @@
+#include <stddef.h>
+
+#include "cros_mpsc_queue.h"
+#include "cros_atomic.h"
+
+void cRosMpscQueueInit( CrosMpscQueue *q )
+{
+  q->stub.next = NULL;
+  q->head = &(q->stub);
+  q->tail = &(q->stub);
+}
+
+void cRosMpscQueuePush( CrosMpscQueue *q, CrosMpscNode *n )
+{
+  CrosMpscNode *prev;
+
+  n->next = NULL;
+  prev = (CrosMpscNode *)CROS_ATOMIC_XCHG_PTR( &(q->head), n );
+  // Between the exchange and this store the element is not reachable from the tail yet
+  CROS_ATOMIC_STORE_PTR( &(prev->next), n );
+}
+
+CrosMpscNode *cRosMpscQueuePop( CrosMpscQueue *q )
+{
+  CrosMpscNode *tail = q->tail;
+  CrosMpscNode *next = (CrosMpscNode *)CROS_ATOMIC_LOAD_PTR( &(tail->next) );
+
+  if( tail == &(q->stub) ) // Skip the stub
+  {
+    if( next == NULL )
+      return NULL;
+    q->tail = next;
+    tail = next;
+    next = (CrosMpscNode *)CROS_ATOMIC_LOAD_PTR( &(tail->next) );
+  }
+
+  if( next != NULL )
+  {
+    q->tail = next;
+    return tail;
+  }
+
+  // tail is the last element: it can only be extracted if no push is in progress
+  if( tail != (CrosMpscNode *)CROS_ATOMIC_LOAD_PTR( &(q->head) ) )
+    return NULL;
+
+  // Put the stub behind the last element, so that the queue does not become empty
+  cRosMpscQueuePush( q, &(q->stub) );
+  next = (CrosMpscNode *)CROS_ATOMIC_LOAD_PTR( &(tail->next) );
+  if( next != NULL )
+  {
+    q->tail = next;
+    return tail;
+  }
+  return NULL;
+}
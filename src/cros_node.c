@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -19,7 +20,9 @@
 #include "cros_node_api.h"
 #include "cros_tcpros.h"
 #include "tcpip_socket.h"
+#include "dyn_string.h"
 #include "cros_log.h"
+#include "cros_atomic.h"
 
 static void initPublisherNode(PublisherNode *node);
 static void initSubscriberNode(SubscriberNode *node);
@@ -32,19 +35,266 @@ static int enqueueServiceAdvertise(CrosNode *node, int servivceidx);
 static int enqueueServiceLookup(CrosNode *node, int serviceidx);
 static int enqueueParameterSubscription(CrosNode *node, int parameteridx);
 static int enqueueParameterUnsubscription(CrosNode *node, int parameteridx);
-static void getIdleXmplrpcClients(CrosNode *node, int array[], size_t *count);
 static int enqueueSlaveApiCallInternal(CrosNode *node, RosApiCall *call);
 static int enqueueMasterApiCallInternal(CrosNode *node, RosApiCall *call);
 static void printNodeProcState( CrosNode *n );
+static int wakeUpServiceCaller( CrosNode *n, int caller_idx );
+static cRosErrCodePack processPostedMsgs( CrosNode *n );
+static cRosErrCodePack processIntraProcessMsgs( CrosNode *n );
+static void processFinishedServiceWorks( CrosNode *n );
+static void lockIntraProcessNodes(void);
+static void unlockIntraProcessNodes(void);
+static void removeIntraProcessLinks(CrosNode *node, SubscriberNode *sub);
+
+// Kinds of node process whose sockets are monitored by the event backend
+typedef enum
+{
+  CN_EVENT_XMLRPC_CLIENT = 1,
+  CN_EVENT_XMLRPC_LISTENER,
+  CN_EVENT_XMLRPC_SERVER,
+  CN_EVENT_TCPROS_CLIENT,
+  CN_EVENT_TCPROS_LISTENER,
+  CN_EVENT_TCPROS_SERVER,
+  CN_EVENT_RPCROS_CLIENT,
+  CN_EVENT_RPCROS_LISTENER,
+  CN_EVENT_RPCROS_SERVER,
+  CN_EVENT_WAKEUP,
+  CN_EVENT_WAIT_FD
+} CrosNodeEventSource;
+
+// An event-backend tag identifies a process by its kind (upper byte) and its index in the corresponding node array
+#define CN_EVENT_TAG(source, idx) (((uint32_t)(source) << 24) | ((uint32_t)(idx) & 0xFFFFFF))
+#define CN_EVENT_TAG_SOURCE(tag) ((CrosNodeEventSource)((tag) >> 24))
+#define CN_EVENT_TAG_INDEX(tag) ((int)((tag) & 0xFFFFFF))
+
+// Kinds of node timer. Timer tags are built like the event-backend tags (CN_EVENT_TAG() and CN_EVENT_TAG_INDEX())
+typedef enum
+{
+  CN_TIMER_PUBLISHER = 1,
+  CN_TIMER_SERVICE_CALLER,
+  CN_TIMER_XMLRPC_MASTER,
+  CN_TIMER_IO_TIMEOUT
+} CrosNodeTimerSource;
+
+#define CN_TIMER_TAG_SOURCE(tag) ((CrosNodeTimerSource)((tag) >> 24))
+
+#define CN_MSEC_TO_NSEC(msec) ((uint64_t)(msec) * 1000000ULL)
+
+// Message posted to a publisher from another thread (see cRosNodePostTopicMsg())
+typedef struct CrosPostedMsg CrosPostedMsg;
+struct CrosPostedMsg
+{
+  CrosMpscNode link; // First member, so that a pointer to the link is a pointer to the posted message
+  cRosMessage *msg;
+};
+
+// Reference to a message handed over to a subscriber by a publisher in the process (see deliverIntraProcessMsg())
+typedef struct CrosIntraProcessMsg CrosIntraProcessMsg;
+struct CrosIntraProcessMsg
+{
+  CrosMpscNode link; // First member, so that a pointer to the link is a pointer to the message reference
+  cRosSharedMessage *msg;
+};
+
+#define CN_POSTED_LINK_TO_PUB(link) ((PublisherNode *)((char *)(link) - offsetof(PublisherNode, posted_link)))
+#define CN_INTRA_LINK_TO_SUB(link) ((SubscriberNode *)((char *)(link) - offsetof(SubscriberNode, intra_link)))
 
 FILE *Msg_output = NULL; //! The pointer to file stream used to print local messages (except debug messages). If it is NULL (default value), stdout is used.
 
+static void attachXmlrpcProcess( CrosNode *n, XmlrpcProcess *proc, CrosNodeEventSource source, int i )
+{
+  proc->event_backend = &n->event_backend;
+  proc->event_tag = CN_EVENT_TAG(source, i);
+  if( source == CN_EVENT_XMLRPC_CLIENT )
+    proc->connect_slots = &n->xmlrpc_client_connects;
+}
+
+static void attachTcprosProcess( CrosNode *n, TcprosProcess *proc, CrosNodeEventSource source, int i )
+{
+  proc->event_backend = &n->event_backend;
+  proc->event_tag = CN_EVENT_TAG(source, i);
+  if( source == CN_EVENT_TCPROS_CLIENT )
+    proc->connect_slots = &n->tcpros_client_connects;
+  else if( source == CN_EVENT_RPCROS_CLIENT )
+    proc->connect_slots = &n->rpcros_client_connects;
+}
+
+// Add a new process to a node table. If idle_slots is not NULL, the process is reused each time it becomes idle
+static int newXmlrpcProcess( CrosNode *n, XmlrpcProcess ***table, CrosSlotTable *slots, CrosNodeEventSource source, CrosSlotTable *idle_slots )
+{
+  XmlrpcProcess *proc;
+  int idx;
+
+  idx = cRosSlotTableAdd( slots, (void ***)table, sizeof(XmlrpcProcess) );
+  if( idx < 0 )
+    return -1;
+
+  proc = (*table)[idx];
+  xmlrpcProcessInit( proc );
+  attachXmlrpcProcess( n, proc, source, idx );
+  proc->idle_slots = idle_slots;
+  proc->slot_idx = idx;
+  return idx;
+}
+
+static int newTcprosProcess( CrosNode *n, TcprosProcess ***table, CrosSlotTable *slots, CrosNodeEventSource source, CrosSlotTable *idle_slots )
+{
+  TcprosProcess *proc;
+  int idx;
+
+  idx = cRosSlotTableAdd( slots, (void ***)table, sizeof(TcprosProcess) );
+  if( idx < 0 )
+    return -1;
+
+  proc = (*table)[idx];
+  tcprosProcessInit( proc );
+  attachTcprosProcess( n, proc, source, idx );
+  proc->idle_slots = idle_slots;
+  proc->slot_idx = idx;
+  return idx;
+}
+
+/*
+ * Return the index of an idle process of a table without removing it from the idle slots, so
+ * the process is also considered idle until it leaves the idle state. Slots whose process is
+ * not idle anymore are discarded when they reach the top of the stack. If there is no idle
+ * process, the table is enlarged. Returns -1 if no more memory can be allocated
+ */
+static int peekIdleXmlrpcProcess( CrosNode *n, XmlrpcProcess ***table, CrosSlotTable *slots, CrosNodeEventSource source )
+{
+  int idx;
+
+  while( slots->n_free_slots > 0 )
+  {
+    idx = slots->free_slots[slots->n_free_slots - 1];
+    if( (*table)[idx]->state == XMLRPC_PROCESS_STATE_IDLE )
+      return idx;
+    cRosSlotTablePopFree( slots );
+    (*table)[idx]->in_idle_slots = 0;
+  }
+
+  idx = newXmlrpcProcess( n, table, slots, source, slots );
+  if( idx >= 0 )
+    xmlrpcProcessChangeState( (*table)[idx], XMLRPC_PROCESS_STATE_IDLE ); // Store it in the idle slots
+  return idx;
+}
+
+static int peekIdleTcprosProcess( CrosNode *n, TcprosProcess ***table, CrosSlotTable *slots, CrosNodeEventSource source )
+{
+  int idx;
+
+  while( slots->n_free_slots > 0 )
+  {
+    idx = slots->free_slots[slots->n_free_slots - 1];
+    if( (*table)[idx]->state == TCPROS_PROCESS_STATE_IDLE && (*table)[idx]->topic_idx == -1 )
+      return idx;
+    cRosSlotTablePopFree( slots );
+    (*table)[idx]->in_idle_slots = 0;
+  }
+
+  idx = newTcprosProcess( n, table, slots, source, slots );
+  if( idx >= 0 )
+    tcprosProcessChangeState( (*table)[idx], TCPROS_PROCESS_STATE_IDLE );
+  return idx;
+}
+
+// Make the event buffer large enough to hold an event for each socket of the node
+static int reserveReadyEvents( CrosNode *n )
+{
+  int n_sockets = 3 + n->xmlrpc_client_slots.n_slots + n->xmlrpc_server_slots.n_slots +
+                  n->tcpros_client_slots.n_slots + n->tcpros_server_slots.n_slots +
+                  n->rpcros_client_slots.n_slots + n->rpcros_server_slots.n_slots;
+
+  if( n_sockets > n->max_ready_events )
+  {
+    int new_max = 2 * n_sockets;
+    CrosEvent *new_events = (CrosEvent *)realloc(n->ready_events, new_max * sizeof(CrosEvent));
+    if( new_events == NULL )
+    {
+      PRINT_ERROR("reserveReadyEvents() : Can't allocate memory\n");
+      return -1;
+    }
+    n->ready_events = new_events;
+    n->max_ready_events = new_max;
+  }
+  return 0;
+}
+
+// Return the index of an unused element of a provider table. If no element can be reused, a new one
+// is added to the table and *is_new is set to 1. Returns -1 if no more memory can be allocated
+static int acquireProviderSlot( CrosSlotTable *slots, void ***table, size_t elem_size, int *is_new )
+{
+  int idx;
+
+  idx = cRosSlotTablePopFree( slots );
+  *is_new = (idx == -1);
+  if( idx == -1 )
+    idx = cRosSlotTableAdd( slots, table, elem_size );
+  return idx;
+}
+
+// Make the publisher slots added to the node table visible to the threads that post messages (see cRosNodePostTopicMsg()).
+// These threads may be reading the current post table, so a larger one replaces it and the replaced one is not freed
+static int updatePostTable( CrosNode *n )
+{
+  CrosPostTable *table = n->post_table;
+  int pub_idx, n_pubs = n->pub_slots.n_slots;
+
+  if( table != NULL && table->n_pubs >= n_pubs )
+    return 0;
+
+  if( table == NULL || table->max_pubs < n_pubs )
+  {
+    int max_pubs = n->pub_slots.max_slots;
+    CrosPostTable *new_table = (CrosPostTable *)malloc( sizeof(CrosPostTable) + max_pubs * sizeof(PublisherNode *) );
+    if( new_table == NULL )
+      return -1;
+
+    new_table->pubs = (PublisherNode **)(new_table + 1);
+    new_table->max_pubs = max_pubs;
+    new_table->n_pubs = (table != NULL)? table->n_pubs : 0;
+    if( table != NULL )
+      memcpy( new_table->pubs, table->pubs, table->n_pubs * sizeof(PublisherNode *) );
+    new_table->replaced = table;
+    CROS_ATOMIC_STORE_PTR( &n->post_table, new_table );
+    table = new_table;
+  }
+
+  // The new entries are filled in before they are counted as valid
+  for( pub_idx = table->n_pubs; pub_idx < n_pubs; pub_idx++ )
+    table->pubs[pub_idx] = n->pubs[pub_idx];
+  CROS_ATOMIC_STORE_INT( &table->n_pubs, n_pubs );
+  return 0;
+}
+
+// Free the current post table of a node and all the ones it replaced. No thread can post messages to the node anymore
+static void releasePostTables( CrosNode *n )
+{
+  while( n->post_table != NULL )
+  {
+    CrosPostTable *replaced = n->post_table->replaced;
+    free( n->post_table );
+    n->post_table = replaced;
+  }
+}
+
+// Stop other threads from posting messages to a publisher and wait for the ones that are posting right now.
+// The posting threads only push the already copied message, so the wait is short
+static void closePublisherPosting( PublisherNode *pub )
+{
+  // Read-modify-write operations are ordered with the ones of cRosNodePostTopicMsg(): either the posting thread sees the
+  // publisher closed or this thread sees it as a post user
+  CROS_ATOMIC_XCHG_INT( &pub->post_open, 0 );
+  while( CROS_ATOMIC_FETCH_ADD_INT( &pub->n_post_users, 0 ) != 0 )
+    cRosThreadYield();
+}
+
 static int openXmlrpcClientSocket( CrosNode *n, int i )
 {
   int ret;
-  if( !tcpIpSocketOpen( &(n->xmlrpc_client_proc[i].socket) ) ||
-      !tcpIpSocketSetReuse( &(n->xmlrpc_client_proc[i].socket) ) ||
-      !tcpIpSocketSetNonBlocking( &(n->xmlrpc_client_proc[i].socket) ) )
+  if( !tcpIpSocketOpen( &(n->xmlrpc_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetReuse( &(n->xmlrpc_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetNonBlocking( &(n->xmlrpc_client_proc[i]->socket) ) )
   {
     PRINT_ERROR("openXmlrpcClientSocket() at index %d failed", i);
     ret=-1;
@@ -59,9 +309,9 @@ static int openXmlrpcClientSocket( CrosNode *n, int i )
 static int openTcprosClientSocket( CrosNode *n, int i )
 {
   int ret;
-  if( !tcpIpSocketOpen( &(n->tcpros_client_proc[i].socket) ) ||
-      !tcpIpSocketSetReuse( &(n->tcpros_client_proc[i].socket) ) ||
-      !tcpIpSocketSetNonBlocking( &(n->tcpros_client_proc[i].socket) ) )
+  if( !tcpIpSocketOpen( &(n->tcpros_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetReuse( &(n->tcpros_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetNonBlocking( &(n->tcpros_client_proc[i]->socket) ) )
   {
     PRINT_ERROR("openTcprosClientSocket() at index %d failed", i);
     ret=-1;
@@ -76,9 +326,9 @@ static int openTcprosClientSocket( CrosNode *n, int i )
 static int openRpcrosClientSocket( CrosNode *n, int i )
 {
   int ret;
-  if( !tcpIpSocketOpen( &(n->rpcros_client_proc[i].socket) ) ||
-      !tcpIpSocketSetReuse( &(n->rpcros_client_proc[i].socket) ) ||
-      !tcpIpSocketSetNonBlocking( &(n->rpcros_client_proc[i].socket) ) )
+  if( !tcpIpSocketOpen( &(n->rpcros_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetReuse( &(n->rpcros_client_proc[i]->socket) ) ||
+      !tcpIpSocketSetNonBlocking( &(n->rpcros_client_proc[i]->socket) ) )
   {
     PRINT_ERROR("openRpcrosClientSocket() at index %d failed", i);
     ret=-1;
@@ -96,7 +346,7 @@ static int openXmlrpcListnerSocket( CrosNode *n )
   if( !tcpIpSocketOpen( &(n->xmlrpc_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->xmlrpc_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->xmlrpc_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->xmlrpc_listner_proc.socket), n->host, 0, CN_MAX_XMLRPC_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->xmlrpc_listner_proc.socket), n->host, 0, n->xmlrpc_server_slots.max_slots ) )
   {
     PRINT_ERROR("openXmlrpcListnerSocket() failed");
     ret=-1;
@@ -104,6 +354,9 @@ static int openXmlrpcListnerSocket( CrosNode *n )
   else
   {
     n->xmlrpc_port = tcpIpSocketGetPort( &(n->xmlrpc_listner_proc.socket) );
+    // The listener sockets are always monitored since a new server process is created when no one is idle
+    cRosEventBackendSetInterest( &(n->event_backend), &(n->xmlrpc_listner_proc.socket),
+                                 CROS_EVENT_READ | CROS_EVENT_EXCEPT, n->xmlrpc_listner_proc.event_tag );
     PRINT_VDEBUG ( "openXmlrpcListnerSocket () : Accepting xmlrpc connections at port %d\n", n->xmlrpc_port );
     ret=0; // success
   }
@@ -116,7 +369,7 @@ static int openRpcrosListnerSocket( CrosNode *n )
   if( !tcpIpSocketOpen( &(n->rpcros_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->rpcros_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->rpcros_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->rpcros_listner_proc.socket), n->host, 0, CN_MAX_RPCROS_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->rpcros_listner_proc.socket), n->host, 0, n->rpcros_server_slots.max_slots ) )
   {
     PRINT_ERROR("openRpcrosListnerSocket() failed");
     ret=-1;
@@ -124,6 +377,8 @@ static int openRpcrosListnerSocket( CrosNode *n )
   else
   {
     n->rpcros_port = tcpIpSocketGetPort( &(n->rpcros_listner_proc.socket) );
+    cRosEventBackendSetInterest( &(n->event_backend), &(n->rpcros_listner_proc.socket),
+                                 CROS_EVENT_READ | CROS_EVENT_EXCEPT, n->rpcros_listner_proc.event_tag );
     PRINT_VDEBUG ( "openRpcrosListnerSocket() : Accepting rcpros connections at port %d\n", n->rpcros_port );
     ret=0; // success
   }
@@ -136,7 +391,7 @@ static int openTcprosListnerSocket( CrosNode *n )
   if( !tcpIpSocketOpen( &(n->tcpros_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->tcpros_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->tcpros_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->tcpros_listner_proc.socket), n->host, 0, CN_MAX_TCPROS_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->tcpros_listner_proc.socket), n->host, 0, n->tcpros_server_slots.max_slots ) )
   {
     PRINT_ERROR("openTcprosListnerSocket() failed");
     ret=-1;
@@ -144,6 +399,8 @@ static int openTcprosListnerSocket( CrosNode *n )
   else
   {
     n->tcpros_port = tcpIpSocketGetPort( &(n->tcpros_listner_proc.socket) );
+    cRosEventBackendSetInterest( &(n->event_backend), &(n->tcpros_listner_proc.socket),
+                                 CROS_EVENT_READ | CROS_EVENT_EXCEPT, n->tcpros_listner_proc.event_tag );
     PRINT_VDEBUG ( "openTcprosListnerSocket() : Accepting tcpros connections at port %d\n", n->tcpros_port );
     ret=0; // success
   }
@@ -156,6 +413,66 @@ static void closeTcprosProcess(TcprosProcess *process)
   tcprosProcessReset(process);
 }
 
+// Close a connection of a publisher. If the kernel is still using frames sent through it with MSG_ZEROCOPY, its socket
+// and those frames are kept in n->zc_closed_procs until the kernel releases them (see releaseClosedZeroCopyFrames())
+static void closeTcprosServerProcess(CrosNode *n, TcprosProcess *process)
+{
+  if(tcprosProcessZeroCopyInUse(process))
+  {
+    TcprosProcess *closed_proc = (TcprosProcess *)malloc(sizeof(TcprosProcess));
+    if(closed_proc != NULL && n->n_zc_closed_procs == n->max_zc_closed_procs)
+    {
+      int new_max = (n->max_zc_closed_procs > 0)? 2 * n->max_zc_closed_procs: 4;
+      TcprosProcess **new_procs = (TcprosProcess **)realloc(n->zc_closed_procs, new_max * sizeof(TcprosProcess *));
+      if(new_procs != NULL)
+      {
+        n->zc_closed_procs = new_procs;
+        n->max_zc_closed_procs = new_max;
+      }
+    }
+
+    if(closed_proc != NULL && n->n_zc_closed_procs < n->max_zc_closed_procs)
+    {
+      tcprosProcessInit(closed_proc);
+      tcprosProcessDetachZeroCopyFrames(process, closed_proc);
+      n->zc_closed_procs[n->n_zc_closed_procs++] = closed_proc;
+    }
+    else
+    {
+      PRINT_ERROR("closeTcprosServerProcess() : Can't allocate memory. Frames still used by the kernel are freed\n");
+      free(closed_proc);
+    }
+  }
+  closeTcprosProcess(process);
+}
+
+// Free the frames of the closed publisher connections that the kernel has released, and close their sockets once all
+// of them are released. If force is 1, they are freed anyway (the node is being destroyed)
+static void releaseClosedZeroCopyFrames(CrosNode *n, int force)
+{
+  int i = 0;
+
+  while(i < n->n_zc_closed_procs)
+  {
+    TcprosProcess *closed_proc = n->zc_closed_procs[i];
+    tcprosProcessReleaseZeroCopyFrames(closed_proc);
+    if(closed_proc->zc_frames.count == 0 || force)
+    {
+      tcpIpSocketClose(&closed_proc->socket);
+      tcprosProcessRelease(closed_proc);
+      free(closed_proc);
+      n->zc_closed_procs[i] = n->zc_closed_procs[--n->n_zc_closed_procs];
+    }
+    else
+      i++;
+  }
+}
+
+static int closedZeroCopyFramesReleased(CrosNode *n)
+{
+  return (n->n_zc_closed_procs == 0);
+}
+
 static void closeXmlrpcProcess(XmlrpcProcess *process)
 {
   tcpIpSocketClose(&process->socket);
@@ -180,13 +497,20 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       if (call->provider_idx == -1)
         break;
 
-      PublisherNode *pub = &node->pubs[call->provider_idx];
+      PublisherNode *pub = node->pubs[call->provider_idx];
       status.state = CROS_STATUS_PUBLISHER_UNREGISTERED;
       cRosNodeStatusCallback(&status, pub->context); // calls the publisher application-defined callback function (if specified when creating the publisher)
 
-      // Finally release publisher
+      // Finally release publisher. No thread can post to it from now on, and the node queue of publishers with posted
+      // messages must not reference it anymore
+      closePublisherPosting(pub);
+      processPostedMsgs(node);
+      cRosMutexLock(&node->pubs_lock);
       cRosApiReleasePublisher(node, call->provider_idx);
       initPublisherNode(pub);
+      cRosSlotTablePushFree(&node->pub_slots, call->provider_idx); // The released slot can be reused by a new registration
+      cRosMutexUnlock(&node->pubs_lock);
+      node->n_pubs--;
       call->provider_idx = -1;
       break;
     }
@@ -195,13 +519,26 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       if (call->provider_idx == -1)
         break;
 
-      SubscriberNode *sub = &node->subs[call->provider_idx];
+      SubscriberNode *sub = node->subs[call->provider_idx];
+      // The publishers in the process may have linked the subscriber again after it was unregistered. Once they cannot
+      // hand over messages to it, the ones already handed over are delivered, so the node queue of subscribers with
+      // such messages does not reference it anymore
+      if(node->intra_process)
+      {
+        lockIntraProcessNodes();
+        removeIntraProcessLinks(node, sub);
+        unlockIntraProcessNodes();
+      }
+      processIntraProcessMsgs(node);
+
       status.state = CROS_STATUS_SUBSCRIBER_UNREGISTERED;
       cRosNodeStatusCallback(&status, sub->context);
 
       // Finally release subscriber
       cRosApiReleaseSubscriber(node, call->provider_idx);
       initSubscriberNode(sub);
+      cRosSlotTablePushFree(&node->sub_slots, call->provider_idx);
+      node->n_subs--;
       call->provider_idx = -1;
       break;
     }
@@ -210,13 +547,15 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       if (call->provider_idx == -1)
         break;
 
-      ServiceProviderNode *service = &node->service_providers[call->provider_idx];
+      ServiceProviderNode *service = node->service_providers[call->provider_idx];
       status.state = CROS_STATUS_SERVICE_PROVIDER_UNREGISTERED;
       cRosNodeStatusCallback(&status, service->context);
 
       // Finally release service provider
       cRosApiReleaseServiceProvider(node, call->provider_idx);
       initServiceProviderNode(service);
+      cRosSlotTablePushFree(&node->service_provider_slots, call->provider_idx);
+      node->n_service_providers--;
       call->provider_idx = -1;
       break;
     }
@@ -225,7 +564,7 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       if (call->provider_idx == -1)
         break;
 
-      ParameterSubscription *subscription = &node->paramsubs[call->provider_idx];
+      ParameterSubscription *subscription = node->paramsubs[call->provider_idx];
       status.state = CROS_STATUS_PARAM_UNSUBSCRIBED;
       status.parameter_key = subscription->parameter_key;
       subscription->status_api_callback(&status, subscription->context);
@@ -233,6 +572,8 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       // Finally release parameter subscription
       cRosNodeReleaseParameterSubscrition(subscription);
       initParameterSubscrition(subscription);
+      cRosSlotTablePushFree(&node->paramsub_slots, call->provider_idx);
+      node->n_paramsubs--;
       call->provider_idx = -1;
       break;
     }
@@ -261,7 +602,7 @@ static void cleanApiCallState(CrosNode *node, RosApiCall *call)
 
 static void handleXmlrpcClientError(CrosNode *node, int i)
 {
-  XmlrpcProcess *proc = &node->xmlrpc_client_proc[i];
+  XmlrpcProcess *proc = node->xmlrpc_client_proc[i];
   RosApiCall *call = proc->current_call;
 
   switch (call->method)
@@ -294,46 +635,50 @@ static void handleXmlrpcClientError(CrosNode *node, int i)
 
 static void handleTcprosClientError(CrosNode *n, int i)
 {
-  TcprosProcess *process = &n->tcpros_client_proc[i];
+  TcprosProcess *process = n->tcpros_client_proc[i];
   closeTcprosProcess(process);
   // CHECK-ME Riaccoda register subscriber?
 }
 
 static void handleXmlrpcServerError(CrosNode *n, int i)
 {
-  XmlrpcProcess *process = &n->xmlrpc_server_proc[i];
+  XmlrpcProcess *process = n->xmlrpc_server_proc[i];
   closeXmlrpcProcess(process);
 }
 
 static void handleTcprosServerError(CrosNode *n, int proc_idx)
 {
   int list_elem;
-  TcprosProcess *process = &n->tcpros_server_proc[proc_idx];
-  PublisherNode *pub = &n->pubs[process->topic_idx];
+  TcprosProcess *process = n->tcpros_server_proc[proc_idx];
 
-  // Look for the tcpros_server_proc index (proc_idx) in the publisher tcpros_server_proc list (to remove it)
-  for(list_elem=0;pub->tcpros_id_list[list_elem]!=-1 && pub->tcpros_id_list[list_elem] != proc_idx;list_elem++);
-  if(pub->tcpros_id_list[list_elem] != proc_idx) // tcpros_server_proc index (proc_idx) found
+  if(process->topic_idx >= 0) // The process has already been associated to a publisher (the subscription header has been received)
   {
-    // Remove index
-    for(;pub->tcpros_id_list[list_elem]!=-1;list_elem++)
-      pub->tcpros_id_list[list_elem] = pub->tcpros_id_list[list_elem+1];
+    PublisherNode *pub = n->pubs[process->topic_idx];
+
+    // Look for the tcpros_server_proc index (proc_idx) in the publisher tcpros_server_proc list (to remove it)
+    for(list_elem=0;pub->tcpros_id_list[list_elem]!=-1 && pub->tcpros_id_list[list_elem] != proc_idx;list_elem++);
+    if(pub->tcpros_id_list[list_elem] == proc_idx) // tcpros_server_proc index (proc_idx) found
+    {
+      // Remove index
+      for(;pub->tcpros_id_list[list_elem]!=-1;list_elem++)
+        pub->tcpros_id_list[list_elem] = pub->tcpros_id_list[list_elem+1];
+    }
+    else
+      PRINT_ERROR("handleTcprosServerError() : TcprosProcess index %i has not been found in Publisher %i\n", proc_idx, process->topic_idx);
   }
-  else
-    PRINT_ERROR("handleTcprosServerError() : TcprosProcess index %i has not been found in Publisher %i", proc_idx, process->topic_idx);
 
-  closeTcprosProcess(process);
+  closeTcprosServerProcess(n, process);
 }
 
 static void handleRpcrosClientError(CrosNode *n, int i)
 {
-  TcprosProcess *process = &n->rpcros_client_proc[i];
+  TcprosProcess *process = n->rpcros_client_proc[i];
   closeTcprosProcess(process);
 }
 
 static void handleRpcrosServerError(CrosNode *n, int i)
 {
-  TcprosProcess *process = &n->rpcros_server_proc[i];
+  TcprosProcess *process = n->rpcros_server_proc[i];
   closeTcprosProcess(process);
 }
 
@@ -343,7 +688,7 @@ static cRosErrCodePack xmlrpcClientConnect(CrosNode *n, int i)
   PRINT_VVDEBUG ( "xmlrpcClientConnect()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  XmlrpcProcess *client_proc = &(n->xmlrpc_client_proc[i]);
+  XmlrpcProcess *client_proc = n->xmlrpc_client_proc[i];
 
   PRINT_VDEBUG ( "xmlrpcClientConnect() : Connecting\n" );
 
@@ -407,7 +752,7 @@ static cRosErrCodePack doWithXmlrpcClientSocket(CrosNode *n, int i)
   PRINT_VVDEBUG ( "doWithXmlrpcClientSocket()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  client_proc = &(n->xmlrpc_client_proc[i]);
+  client_proc = n->xmlrpc_client_proc[i];
 
   switch( client_proc->state )
   {
@@ -548,7 +893,7 @@ static cRosErrCodePack doWithXmlrpcServerSocket( CrosNode *n, int i )
   PRINT_VVDEBUG ( "doWithXmlrpcServerSocket()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  XmlrpcProcess *server_proc = &(n->xmlrpc_server_proc[i]);
+  XmlrpcProcess *server_proc = n->xmlrpc_server_proc[i];
 
   if( server_proc->state == XMLRPC_PROCESS_STATE_READING )
   {
@@ -572,9 +917,9 @@ static cRosErrCodePack doWithXmlrpcServerSocket( CrosNode *n, int i )
         break;
 
       case TCPIPSOCKET_DISCONNECTED:
-        xmlrpcProcessReset( &(n->xmlrpc_server_proc[i]) );
-        xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[i]), XMLRPC_PROCESS_STATE_IDLE );
-        tcpIpSocketClose( &(n->xmlrpc_server_proc[i].socket) );
+        xmlrpcProcessReset( n->xmlrpc_server_proc[i] );
+        xmlrpcProcessChangeState( n->xmlrpc_server_proc[i], XMLRPC_PROCESS_STATE_IDLE );
+        tcpIpSocketClose( &(n->xmlrpc_server_proc[i]->socket) );
         break;
       case TCPIPSOCKET_FAILED:
       default:
@@ -646,7 +991,7 @@ static cRosErrCodePack tcprosClientConnect( CrosNode *n, int client_idx)
   PRINT_VVDEBUG ( "tcprosClientConnect()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  TcprosProcess *client_proc = &(n->tcpros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
 
   if(!client_proc->socket.open)
     openTcprosClientSocket(n, client_idx);
@@ -691,13 +1036,217 @@ static cRosErrCodePack tcprosClientConnect( CrosNode *n, int client_idx)
   return ret_err;
 }
 
+// Returns 1 if a subscriber connection holds at least one complete message (in its receive buffer or, if the message
+// is too large for it, in its packet). Otherwise 0
+static int tcprosClientHasBufferedMsg( TcprosProcess *client_proc )
+{
+  uint32_t msg_size;
+
+  if( client_proc->state == TCPROS_PROCESS_STATE_READING ) // The body of a large message is received into packet
+    return ( client_proc->left_to_recv == 0 );
+
+  if( ringBufferPeek( &(client_proc->recv_buffer), 0, &msg_size, sizeof(uint32_t) ) != 0 )
+    return 0;
+
+  return ( ringBufferGetSize( &(client_proc->recv_buffer) ) - sizeof(uint32_t) >= ROS_TO_HOST_UINT32(msg_size) );
+}
+
+// Returns 1 if a subscriber connection must not be read because the queue of its subscriber is full and its policy is
+// CROS_SUB_QUEUE_BLOCK. Otherwise 0
+static int tcprosClientIsBlocked( CrosNode *n, TcprosProcess *client_proc )
+{
+  SubscriberNode *sub_node = n->subs[client_proc->topic_idx];
+
+  return ( sub_node->msg_queue_policy == CROS_SUB_QUEUE_BLOCK && cRosMessageQueueVacancies( &(sub_node->msg_queue) ) == 0 );
+}
+
+// Move up to n bytes from the receive buffer of a subscriber connection to the end of its packet and return the number
+// of moved bytes
+static size_t moveTcprosClientBufferedData( TcprosProcess *client_proc, size_t n )
+{
+  RingBuffer *r_buf = &(client_proc->recv_buffer);
+  size_t n_moved = 0;
+
+  while( n_moved < n )
+  {
+    size_t region_len;
+    const unsigned char *region = ringBufferGetReadRegion( r_buf, &region_len );
+    if( region_len == 0 )
+      break;
+    if( region_len > n - n_moved )
+      region_len = n - n_moved;
+    dynBufferPushBackBuf( &(client_proc->packet), region, region_len );
+    ringBufferConsume( r_buf, region_len );
+    n_moved += region_len;
+  }
+
+  return n_moved;
+}
+
+// Dispatch the complete message at the beginning of the receive buffer of a subscriber connection
+static cRosErrCodePack dispatchBufferedTcprosClientMsg( CrosNode *n, int client_idx )
+{
+  cRosErrCodePack ret_err;
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
+  SubscriberNode *sub_node = n->subs[client_proc->topic_idx];
+  RingBuffer *r_buf = &(client_proc->recv_buffer);
+  const unsigned char *region;
+  size_t region_len;
+  uint32_t msg_size;
+
+  ringBufferPeek( r_buf, 0, &msg_size, sizeof(uint32_t) );
+  msg_size = ROS_TO_HOST_UINT32(msg_size);
+
+  tcprosProcessClear( client_proc );
+  if( dynBufferReserve( &(client_proc->packet), msg_size ) == NULL )
+    return CROS_MEM_ALLOC_ERR; // The message stays in the receive buffer
+  ringBufferConsume( r_buf, sizeof(uint32_t) );
+
+  // The zero-copy views and the lazy decoding keep the packet memory, so only the other messages can be parsed in place
+  region = ringBufferGetReadRegion( r_buf, &region_len );
+  if( !sub_node->zerocopy_views && !sub_node->lazy_decoding && region_len >= msg_size )
+  {
+    DynBuffer body;
+
+    dynBufferInitView( &body, region, msg_size );
+    ret_err = cRosMessageParsePublicationPacket( n, client_idx, &body );
+    ringBufferConsume( r_buf, msg_size );
+    return ret_err;
+  }
+
+  // Otherwise the message (which may wrap around the end of the receive buffer) is moved to packet
+  moveTcprosClientBufferedData( client_proc, msg_size );
+  return cRosMessageParsePublicationPacket( n, client_idx, &(client_proc->packet) );
+}
+
+// Frame and dispatch the complete messages stored in the receive buffer of a subscriber connection
+// (up to CN_TCPROS_MAX_MSGS_PER_EVENT messages, so that the other connections are attended too)
+static cRosErrCodePack dispatchTcprosClientMsgs( CrosNode *n, int client_idx )
+{
+  cRosErrCodePack ret_err, new_err;
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
+  RingBuffer *r_buf = &(client_proc->recv_buffer);
+  uint32_t msg_size;
+  int n_msgs;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for( n_msgs = 0; n_msgs < CN_TCPROS_MAX_MSGS_PER_EVENT && tcprosClientHasBufferedMsg( client_proc ); n_msgs++ )
+  {
+    if( tcprosClientIsBlocked( n, client_proc ) )
+      break; // The message stays in the receive buffer (or in packet) until there is room in the subscriber queue
+
+    if( client_proc->state == TCPROS_PROCESS_STATE_READING ) // A large message has been received into packet
+    {
+      new_err = cRosMessageParsePublicationPacket( n, client_idx, &(client_proc->packet) );
+      tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING_SIZE );
+    }
+    else
+      new_err = dispatchBufferedTcprosClientMsg( n, client_idx );
+    ret_err = cRosAddErrCodePackIfErr( ret_err, new_err );
+  }
+  if( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE ) // Otherwise packet holds part of a large message
+    tcprosProcessClear( client_proc );
+
+  // A message that does not fit in the receive buffer is not framed there: the bytes already received are moved to
+  // packet and the rest of its body is received straight into packet by receiveTcprosClientMsgs()
+  if( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE &&
+      ringBufferPeek( r_buf, 0, &msg_size, sizeof(uint32_t) ) == 0 &&
+      sizeof(uint32_t) + ROS_TO_HOST_UINT32(msg_size) > CN_TCPROS_RECV_BUFFER_SIZE )
+  {
+    msg_size = ROS_TO_HOST_UINT32(msg_size);
+    if( dynBufferReserve( &(client_proc->packet), msg_size ) == NULL )
+    {
+      handleTcprosClientError( n, client_idx );
+      return cRosAddErrCodePackIfErr( ret_err, CROS_MEM_ALLOC_ERR );
+    }
+    ringBufferConsume( r_buf, sizeof(uint32_t) );
+    client_proc->left_to_recv = msg_size - moveTcprosClientBufferedData( client_proc, msg_size );
+    tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING );
+  }
+
+  // The socket is not read while the subscriber is blocked, so the publisher is stopped by TCP flow control
+  tcprosProcessPauseReading( client_proc, tcprosClientIsBlocked( n, client_proc ) );
+
+  // The node attends the connection again in the next cycles until its buffer is empty and it can be read again
+  if( ( client_proc->read_paused || tcprosClientHasBufferedMsg( client_proc ) ) && !client_proc->in_pending_slots &&
+      cRosSlotListPush( &n->tcpros_client_pending, client_idx ) == 0 )
+    client_proc->in_pending_slots = 1;
+
+  return ret_err;
+}
+
+// Read all the available data of a subscriber connection and dispatch the complete messages received
+static cRosErrCodePack receiveTcprosClientMsgs( CrosNode *n, int client_idx )
+{
+  cRosErrCodePack ret_err, new_err;
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
+  RingBuffer *r_buf = &(client_proc->recv_buffer);
+  TcpIpSocketState sock_state;
+  int n_regions;
+
+  // The buffer keeps its size: the messages that do not fit in it are received into packet
+  if( ringBufferReserve( r_buf, CN_TCPROS_RECV_BUFFER_SIZE ) != 0 )
+  {
+    handleTcprosClientError( n, client_idx );
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  sock_state = TCPIPSOCKET_DONE;
+  if( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE )
+  {
+    // The free space may wrap around the end of the buffer, so it is filled with up to two reads
+    for( n_regions = 0; n_regions < 2 && sock_state == TCPIPSOCKET_DONE; n_regions++ )
+    {
+      size_t region_len, n_reads;
+      unsigned char *region = ringBufferGetWriteRegion( r_buf, &region_len );
+      if( region_len == 0 )
+        break;
+
+      sock_state = tcpIpSocketReadData( &(client_proc->socket), region, region_len, &n_reads );
+      if( sock_state == TCPIPSOCKET_DONE )
+      {
+        ringBufferCommit( r_buf, n_reads );
+        if( n_reads < region_len ) // No more data available by now
+          break;
+      }
+    }
+
+    // The received messages are dispatched even if the connection has just been closed
+    ret_err = dispatchTcprosClientMsgs( n, client_idx );
+  }
+
+  // The rest of the body of a large message is received without copying it
+  if( client_proc->state == TCPROS_PROCESS_STATE_READING && client_proc->left_to_recv > 0 &&
+      sock_state == TCPIPSOCKET_DONE && !client_proc->read_paused )
+  {
+    size_t n_reads;
+
+    sock_state = tcpIpSocketReadBufferEx( &(client_proc->socket), &(client_proc->packet), client_proc->left_to_recv, &n_reads );
+    if( sock_state == TCPIPSOCKET_DONE )
+    {
+      client_proc->left_to_recv -= n_reads;
+      if( client_proc->left_to_recv == 0 )
+      {
+        new_err = dispatchTcprosClientMsgs( n, client_idx );
+        ret_err = cRosAddErrCodePackIfErr( ret_err, new_err );
+      }
+    }
+  }
+
+  if( sock_state == TCPIPSOCKET_DISCONNECTED || sock_state == TCPIPSOCKET_FAILED )
+    handleTcprosClientError( n, client_idx );
+
+  return ret_err;
+}
+
 static cRosErrCodePack doWithTcprosClientSocket( CrosNode *n, int client_idx)
 {
   cRosErrCodePack ret_err;
   PRINT_VVDEBUG ( "doWithTcprosClientSocket()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  TcprosProcess *client_proc = &(n->tcpros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
 
   switch ( client_proc->state )
   {
@@ -817,67 +1366,10 @@ static cRosErrCodePack doWithTcprosClientSocket( CrosNode *n, int client_idx)
       break; // To avoid blocking ???
     }
     case TCPROS_PROCESS_STATE_READING_SIZE:
-    {
-      size_t n_reads;
-      TcpIpSocketState sock_state = tcpIpSocketReadBufferEx( &(client_proc->socket),
-                                                          &(client_proc->packet),
-                                                          client_proc->left_to_recv,
-                                                          &n_reads);
-
-      switch ( sock_state )
-      {
-        case TCPIPSOCKET_DONE:
-          client_proc->left_to_recv -= n_reads;
-          if (client_proc->left_to_recv == 0)
-          {
-            const unsigned char *data = dynBufferGetCurrentData(&client_proc->packet);
-            uint32_t msg_size = 0;
-            msg_size = ROS_TO_HOST_UINT32(*(uint32_t *)data);
-            tcprosProcessClear( client_proc );
-            client_proc->left_to_recv = msg_size;
-            tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING);
-            goto read_msg;
-          }
-          break;
-        case TCPIPSOCKET_IN_PROGRESS:
-          break;
-        case TCPIPSOCKET_DISCONNECTED:
-        case TCPIPSOCKET_FAILED:
-        default:
-          handleTcprosClientError( n, client_idx );
-          break;
-      }
-      break;
-    }
-    read_msg:
     case TCPROS_PROCESS_STATE_READING:
     {
-      size_t n_reads;
-      TcpIpSocketState sock_state = tcpIpSocketReadBufferEx( &(client_proc->socket),
-                                                          &(client_proc->packet),
-                                                          client_proc->left_to_recv,
-                                                          &n_reads);
-
-      switch ( sock_state )
-      {
-        case TCPIPSOCKET_DONE:
-          client_proc->left_to_recv -= n_reads;
-          if (client_proc->left_to_recv == 0)
-          {
-              ret_err = cRosMessageParsePublicationPacket(n, client_idx);
-              tcprosProcessClear( client_proc );
-              client_proc->left_to_recv = sizeof(uint32_t);
-              tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING_SIZE );
-          }
-          break;
-        case TCPIPSOCKET_IN_PROGRESS:
-          break;
-        case TCPIPSOCKET_DISCONNECTED:
-        case TCPIPSOCKET_FAILED:
-        default:
-          handleTcprosClientError( n, client_idx );
-          break;
-      }
+      // Several messages may be received and dispatched at once
+      ret_err = receiveTcprosClientMsgs( n, client_idx );
       break;
     }
     default:
@@ -895,7 +1387,7 @@ static cRosErrCodePack doWithTcprosServerSocket( CrosNode *n, int i )
   PRINT_VVDEBUG ( "doWithTcprosServerSocket()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK; // Default return value
-  TcprosProcess *server_proc = &(n->tcpros_server_proc[i]);
+  TcprosProcess *server_proc = n->tcpros_server_proc[i];
 
   if( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER)
   {
@@ -946,21 +1438,30 @@ static cRosErrCodePack doWithTcprosServerSocket( CrosNode *n, int i )
            server_proc->state == TCPROS_PROCESS_STATE_WRITING ) // It is time to write a message or header
   {
     PRINT_VDEBUG ( "doWithTcprosServerSocket() : writing. Tcpros server index: %d \n", i );
+    TcpIpSocketState sock_state;
     if( server_proc->state == TCPROS_PROCESS_STATE_START_WRITING ) // Start to publish a message
     {
-      tcprosProcessClear( server_proc );
-      ret_err = cRosMessagePreparePublicationPacket( n, i );
+      // The message has already been serialized in the shared frame by cRosNodeTriggerPublishersWriting()
       tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
     }
-    TcpIpSocketState sock_state =  tcpIpSocketWriteBuffer( &(server_proc->socket),
-                                                           &(server_proc->packet) );
+    if( server_proc->socket.zerocopy )
+      tcprosProcessReleaseZeroCopyFrames( server_proc );
+
+    if( server_proc->frame != NULL ) // Writing a message
+      sock_state = tcpIpSocketWriteIov( &(server_proc->socket), server_proc->frame->iov, server_proc->frame->iov_cnt,
+                                        &(server_proc->frame_offset), server_proc->zerocopy_min_size );
+    else // Writing the header
+      sock_state = tcpIpSocketWriteBuffer( &(server_proc->socket), &(server_proc->packet) );
 
     switch ( sock_state )
     {
       case TCPIPSOCKET_DONE:
         PRINT_VDEBUG ( "doWithTcprosServerSocket() : Done writing with no error\n" );
         tcprosProcessClear( server_proc );
-        tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING ); // Wait before publishing a new message
+        if( tcprosProcessNextFrame( server_proc ) ) // Release the sent frame and take the next queued one, if any
+          tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_START_WRITING );
+        else
+          tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING ); // Wait before publishing a new message
         break;
 
       case TCPIPSOCKET_IN_PROGRESS:
@@ -983,12 +1484,12 @@ static cRosErrCodePack rpcrosClientConnect(CrosNode *n, int client_idx)
   PRINT_VVDEBUG ( "rpcrosClientConnect()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
 
   if(!client_proc->socket.open)
     openRpcrosClientSocket(n, client_idx);
 
-  ServiceCallerNode *service_caller = &(n->service_callers[client_proc->service_idx]);
+  ServiceCallerNode *service_caller = n->service_callers[client_proc->service_idx];
   tcprosProcessClear( client_proc );
   TcpIpSocketState conn_state = tcpIpSocketConnect( &(client_proc->socket), service_caller->service_host, service_caller->service_port );
   switch (conn_state)
@@ -1034,7 +1535,7 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
   PRINT_VVDEBUG ( "doWithRpcrosClientSocket()\n" );
 
   ret_err = CROS_SUCCESS_ERR_PACK;
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
 
   switch ( client_proc->state )
   {
@@ -1148,6 +1649,7 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
         case TCPROS_PARSER_DONE:
           tcprosProcessClear( client_proc );
           tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+          wakeUpServiceCaller( n, client_proc->service_idx );
           break;
         case TCPROS_PARSER_HEADER_INCOMPLETE:
           break;
@@ -1252,6 +1754,7 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
               {
                 tcprosProcessClear( client_proc );
                 tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+                wakeUpServiceCaller( n, client_proc->service_idx );
               }
               else
               {
@@ -1289,20 +1792,53 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
   return ret_err;
 }
 
-static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
+// Generate the response to the request received by a RPCROS server process and start sending it. If the node has a
+// worker pool, the request is handed to it instead and the process waits for the response (see processFinishedServiceWorks())
+static cRosErrCodePack attendServiceRequest(CrosNode *n, int i)
 {
   cRosErrCodePack ret_err;
-  PRINT_VVDEBUG ( "doWithRpcrosServerSocket()\n" );
-
-  ret_err = CROS_SUCCESS_ERR_PACK;
-  TcprosProcess *server_proc = &(n->rpcros_server_proc[i]);
+  TcprosProcess *server_proc = n->rpcros_server_proc[i];
+  ServiceProviderNode *service = n->service_providers[server_proc->service_idx];
 
-  switch (server_proc->state)
+  if(service->callback_strand.pool != NULL)
   {
-    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    server_proc->svc_work_seq = ++n->last_svc_work_seq;
+    ret_err = cRosNodePostServiceProviderCallback(n, &service->callback_strand, &server_proc->packet, i,
+                                                  server_proc->svc_work_seq, service->context);
+    if(ret_err == CROS_SUCCESS_ERR_PACK)
     {
-      size_t n_reads;
-      if (server_proc->left_to_recv == 0)
+      tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+      return ret_err;
+    }
+
+    cRosMessageSetServiceResponsePacket(n, i, ret_err, NULL); // The request cannot be attended: answer with a failure
+    if(ret_err == CROS_CALLBACK_QUEUE_FULL_ERR) // The callbacks are lagging behind: it is not an error of the node
+    {
+      PRINT_VDEBUG ( "attendServiceRequest() : Service provider callback queue full. Request rejected\n" );
+      ret_err = CROS_SUCCESS_ERR_PACK;
+    }
+  }
+  else
+    ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
+
+  tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
+  return ret_err;
+}
+
+static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
+{
+  cRosErrCodePack ret_err;
+  PRINT_VVDEBUG ( "doWithRpcrosServerSocket()\n" );
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  TcprosProcess *server_proc = n->rpcros_server_proc[i];
+
+  switch (server_proc->state)
+  {
+    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    {
+      size_t n_reads;
+      if (server_proc->left_to_recv == 0)
         server_proc->left_to_recv = sizeof(uint32_t);
 
       TcpIpSocketState sock_state = tcpIpSocketReadBufferEx( &(server_proc->socket),
@@ -1454,9 +1990,9 @@ static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
             if (msg_size == 0)
             {
               PRINT_VDEBUG ( "doWithRpcrosServerSocket() : Done reading size with no error\n" );
-              ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
-              tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING);
-              goto write_msg;
+              ret_err = attendServiceRequest(n, i);
+              if( server_proc->state == TCPROS_PROCESS_STATE_WRITING )
+                goto write_msg;
             }
             else
             {
@@ -1494,8 +2030,7 @@ static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
           if (server_proc->left_to_recv == 0)
           {
               PRINT_VDEBUG ( "doWithRpcrosServerSocket() : Done reading with no error\n" );
-              ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
-              tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
+              ret_err = attendServiceRequest(n, i);
           }
           break;
         case TCPIPSOCKET_IN_PROGRESS:
@@ -1729,10 +2264,21 @@ int cRosInitializeLibrary(void)
   return(ret);
 }
 
+// Initial number of elements of a node table: the capacity hint if it is valid, the default value otherwise
+#define CN_CAPACITY_HINT(hints, field, default_value) \
+  (((hints) != NULL && (hints)->field > 0)? (hints)->field : (default_value))
+
 CrosNode *cRosNodeCreate (const char *node_name, const char *node_host, const char *roscore_host, unsigned short roscore_port,
                           const char *message_root_path)
+{
+  return cRosNodeCreateEx(node_name, node_host, roscore_host, roscore_port, message_root_path, NULL);
+}
+
+CrosNode *cRosNodeCreateEx (const char *node_name, const char *node_host, const char *roscore_host, unsigned short roscore_port,
+                            const char *message_root_path, const CrosNodeCapacityHints *hints)
 {
   CrosNode *new_n; // Value to be returned by this function. NULL on failure
+  int field_ind;
   PRINT_VVDEBUG ( "cRosNodeCreate()\n" );
 
   if(node_name == NULL || node_host == NULL || roscore_host == NULL )
@@ -1746,14 +2292,75 @@ CrosNode *cRosNodeCreate (const char *node_name, const char *node_host, const ch
 
   new_n = ( CrosNode * ) malloc ( sizeof ( CrosNode ) );
 
-  if ( new_n == NULL )
+  if ( new_n == NULL || cRosMutexInit( &new_n->pubs_lock ) != 0 )
   {
     PRINT_ERROR ( "cRosNodeCreate() : Can't allocate memory\n" );
+    free( new_n );
     return NULL;
   }
 
   new_n->name = new_n->host = new_n->roscore_host = NULL;
 
+  // The tables are empty until they are reserved, so the node can be destroyed at any point
+  new_n->xmlrpc_client_proc = new_n->xmlrpc_server_proc = NULL;
+  new_n->tcpros_client_proc = new_n->tcpros_server_proc = NULL;
+  new_n->rpcros_client_proc = new_n->rpcros_server_proc = NULL;
+  new_n->pubs = NULL;
+  new_n->post_table = NULL;
+  new_n->subs = NULL;
+  new_n->service_providers = NULL;
+  new_n->service_callers = NULL;
+  new_n->paramsubs = NULL;
+  cRosSlotTableInit( &new_n->xmlrpc_client_slots );
+  cRosSlotTableInit( &new_n->xmlrpc_server_slots );
+  cRosSlotTableInit( &new_n->tcpros_client_slots );
+  cRosSlotTableInit( &new_n->tcpros_server_slots );
+  cRosSlotTableInit( &new_n->rpcros_client_slots );
+  cRosSlotTableInit( &new_n->rpcros_server_slots );
+  cRosSlotTableInit( &new_n->pub_slots );
+  cRosSlotTableInit( &new_n->sub_slots );
+  cRosSlotTableInit( &new_n->service_provider_slots );
+  cRosSlotTableInit( &new_n->service_caller_slots );
+  cRosSlotTableInit( &new_n->paramsub_slots );
+  cRosSlotListInit( &new_n->xmlrpc_client_connects );
+  cRosSlotListInit( &new_n->tcpros_client_connects );
+  cRosSlotListInit( &new_n->tcpros_client_pending );
+  cRosSlotListInit( &new_n->rpcros_client_connects );
+  new_n->n_pubs = 0;
+  new_n->n_subs = 0;
+  new_n->n_service_providers = 0;
+  new_n->n_service_callers = 0;
+  new_n->n_paramsubs = 0;
+  new_n->zc_closed_procs = NULL;
+  new_n->n_zc_closed_procs = 0;
+  new_n->max_zc_closed_procs = 0;
+  new_n->ready_events = NULL;
+  new_n->max_ready_events = 0;
+  new_n->callback_pool = NULL;
+  new_n->callback_queue_size = CN_CALLBACK_QUEUE_SIZE;
+  new_n->last_svc_work_seq = 0;
+  for( field_ind = 0; field_ind < CN_ROSOUT_N_FIELDS; field_ind++ )
+    new_n->rosout_field_handles[field_ind] = NULL;
+
+  cRosEventBackendInit( &(new_n->event_backend), CROS_EVENT_BACKEND_DEFAULT );
+
+  // Other threads wake up the node through this notifier when they post messages
+  tcpIpSocketInit( &(new_n->wakeup_notifier) );
+  new_n->waiting_set = NULL;
+  new_n->intra_process = 0;
+  new_n->next_intra_process_node = NULL;
+  cRosMpscQueueInit( &(new_n->posted_pubs) );
+  cRosMpscQueueInit( &(new_n->intra_subs) );
+  cRosMpscQueueInit( &(new_n->finished_svc_works) );
+  if( tcpIpSocketOpenNotifier( &(new_n->wakeup_notifier) ) )
+    cRosEventBackendSetInterest( &(new_n->event_backend), &(new_n->wakeup_notifier), CROS_EVENT_READ, CN_EVENT_TAG(CN_EVENT_WAKEUP, 0) );
+  else
+    PRINT_ERROR ( "cRosNodeCreate() : Can't open the wake-up notifier. Posted messages are only sent when the node wakes up for another reason\n" );
+
+  cRosTimerHeapInit( &(new_n->timers) );
+  cRosTimerInit( &(new_n->xmlrpc_master_timer), CN_EVENT_TAG(CN_TIMER_XMLRPC_MASTER, 0) );
+  cRosTimerInit( &(new_n->io_timeout_timer), CN_EVENT_TAG(CN_TIMER_IO_TIMEOUT, 0) );
+
   new_n->name = cRosNamespaceBuild(NULL, node_name);
   new_n->host = ( char * ) malloc ( ( strlen ( node_host ) + 1 ) *sizeof ( char ) );
   new_n->roscore_host = ( char * ) malloc ( ( strlen ( roscore_host ) + 1 ) *sizeof ( char ) );
@@ -1777,56 +2384,74 @@ CrosNode *cRosNodeCreate (const char *node_name, const char *node_host, const ch
   new_n->roscore_port = roscore_port;
   new_n->roscore_pid = -1;
 
-  xmlrpcProcessInit( &(new_n->xmlrpc_listner_proc) );
-
   new_n->next_call_id = 0;
   initApiCallQueue(&new_n->master_api_queue);
   initApiCallQueue(&new_n->slave_api_queue);
 
-  new_n->xmlrpc_master_wake_up_time = 0;
-
-  int i, fn_ret;
-  for (i = 0 ; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++)
-    xmlrpcProcessInit( &(new_n->xmlrpc_server_proc[i]) );
-
-  for ( i = 0 ; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
-    xmlrpcProcessInit( &(new_n->xmlrpc_client_proc[i]) );
+  // The master is pinged as soon as the node starts running
+  if( cRosTimerHeapSchedule( &(new_n->timers), &(new_n->xmlrpc_master_timer), 0 ) != 0 ||
+      cRosTimerHeapSchedule( &(new_n->timers), &(new_n->io_timeout_timer),
+                             cRosClockGetTimeNs() + CN_MSEC_TO_NSEC(CN_IO_TIMEOUT_CHECK_PERIOD) ) != 0 )
+  {
+    PRINT_ERROR ( "cRosNodeCreate() : Can't allocate memory\n" );
+    cRosNodeDestroy ( new_n );
+    return NULL;
+  }
 
+  xmlrpcProcessInit( &(new_n->xmlrpc_listner_proc) );
   tcprosProcessInit( &(new_n->tcpros_listner_proc) );
-
-  for ( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->tcpros_server_proc[i]) );
-
-  for ( i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->tcpros_client_proc[i]) );
-
   tcprosProcessInit( &(new_n->rpcros_listner_proc) );
 
-  for ( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->rpcros_server_proc[i]) );
+  // The sockets of all the processes are monitored by the node event backend
+  attachXmlrpcProcess( new_n, &(new_n->xmlrpc_listner_proc), CN_EVENT_XMLRPC_LISTENER, 0 );
+  attachTcprosProcess( new_n, &(new_n->tcpros_listner_proc), CN_EVENT_TCPROS_LISTENER, 0 );
+  attachTcprosProcess( new_n, &(new_n->rpcros_listner_proc), CN_EVENT_RPCROS_LISTENER, 0 );
 
-  for ( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->rpcros_client_proc[i]) );
-
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
-    initPublisherNode(&new_n->pubs[i]);
-  new_n->n_pubs = 0;
-
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS; i++)
-    initSubscriberNode(&new_n->subs[i]);
-  new_n->n_subs = 0;
-
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS; i++)
-    initServiceProviderNode(&new_n->service_providers[i]);
-  new_n->n_service_providers = 0;
+  // Only the tables are allocated here: their elements are created when they are first needed
+  int fn_ret;
+  fn_ret = cRosSlotTableReserve( &new_n->xmlrpc_server_slots, (void ***)&new_n->xmlrpc_server_proc,
+                                 CN_CAPACITY_HINT(hints, xmlrpc_server_connections, CN_MAX_XMLRPC_SERVER_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->xmlrpc_client_slots, (void ***)&new_n->xmlrpc_client_proc,
+                                   CN_CAPACITY_HINT(hints, xmlrpc_client_connections, CN_MAX_XMLRPC_CLIENT_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->tcpros_server_slots, (void ***)&new_n->tcpros_server_proc,
+                                   CN_CAPACITY_HINT(hints, tcpros_server_connections, CN_MAX_TCPROS_SERVER_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->tcpros_client_slots, (void ***)&new_n->tcpros_client_proc,
+                                   CN_CAPACITY_HINT(hints, tcpros_client_connections, CN_MAX_TCPROS_CLIENT_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->rpcros_server_slots, (void ***)&new_n->rpcros_server_proc,
+                                   CN_CAPACITY_HINT(hints, rpcros_server_connections, CN_MAX_RPCROS_SERVER_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->rpcros_client_slots, (void ***)&new_n->rpcros_client_proc,
+                                   CN_CAPACITY_HINT(hints, service_callers, CN_MAX_RPCROS_CLIENT_CONNECTIONS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->pub_slots, (void ***)&new_n->pubs,
+                                   CN_CAPACITY_HINT(hints, published_topics, CN_MAX_PUBLISHED_TOPICS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->sub_slots, (void ***)&new_n->subs,
+                                   CN_CAPACITY_HINT(hints, subscribed_topics, CN_MAX_SUBSCRIBED_TOPICS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->service_provider_slots, (void ***)&new_n->service_providers,
+                                   CN_CAPACITY_HINT(hints, service_providers, CN_MAX_SERVICE_PROVIDERS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->service_caller_slots, (void ***)&new_n->service_callers,
+                                   CN_CAPACITY_HINT(hints, service_callers, CN_MAX_SERVICE_CALLERS) );
+  if(fn_ret == 0)
+    fn_ret = cRosSlotTableReserve( &new_n->paramsub_slots, (void ***)&new_n->paramsubs,
+                                   CN_CAPACITY_HINT(hints, parameter_subscriptions, CN_MAX_PARAMETER_SUBSCRIPTIONS) );
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
-    initServiceCallerNode(&new_n->service_callers[i]);
-  new_n->n_service_callers = 0;
+  // The XMLRPC client 0 is reserved for the calls to the ROS master, so it is never reused for other calls
+  if(fn_ret == 0 && newXmlrpcProcess( new_n, &new_n->xmlrpc_client_proc, &new_n->xmlrpc_client_slots, CN_EVENT_XMLRPC_CLIENT, NULL ) != 0)
+    fn_ret = -1;
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS; i++)
-    initParameterSubscrition(&new_n->paramsubs[i]);
-  new_n->n_paramsubs = 0;
+  if(fn_ret != 0)
+  {
+    PRINT_ERROR ( "cRosNodeCreate() : Can't allocate memory\n" );
+    cRosNodeDestroy ( new_n );
+    return NULL;
+  }
 
 #ifdef _WIN32
   new_n->pid = (int)GetCurrentProcessId();
@@ -1834,21 +2459,7 @@ CrosNode *cRosNodeCreate (const char *node_name, const char *node_host, const ch
   new_n->pid = (int)getpid();
 #endif
 
-  fn_ret = 0;
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openXmlrpcClientSocket( new_n, i );
-  }
-
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openTcprosClientSocket( new_n, i );
-  }
-
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openRpcrosClientSocket( new_n, i );
-  }
+  fn_ret = openXmlrpcClientSocket( new_n, 0 );
   if(fn_ret == 0)
     fn_ret = openXmlrpcListnerSocket( new_n );
   if(fn_ret == 0)
@@ -1905,20 +2516,20 @@ int cRosUnregistrationCompleted(CrosNode *n)
 
   unreg_finished = 1;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS && unreg_finished == 1; i++)
-    if(n->pubs[i].topic_name != NULL)
+  for ( i = 0; i < n->pub_slots.n_slots && unreg_finished == 1; i++)
+    if(n->pubs[i]->topic_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS && unreg_finished == 1; i++)
-    if(n->subs[i].topic_name != NULL)
+  for ( i = 0; i < n->sub_slots.n_slots && unreg_finished == 1; i++)
+    if(n->subs[i]->topic_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS && unreg_finished == 1; i++)
-    if(n->service_providers[i].service_name != NULL)
+  for ( i = 0; i < n->service_provider_slots.n_slots && unreg_finished == 1; i++)
+    if(n->service_providers[i]->service_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS && unreg_finished == 1; i++)
-    if(n->paramsubs[i].parameter_key != NULL)
+  for ( i = 0; i < n->paramsub_slots.n_slots && unreg_finished == 1; i++)
+    if(n->paramsubs[i]->parameter_key != NULL)
       unreg_finished = 0;
 
   return(unreg_finished);
@@ -1930,12 +2541,12 @@ int cRosOutputQueuesEmpty(CrosNode *n)
 
   queues_empty = 1;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS && queues_empty == 1; i++)
-    if(n->pubs[i].topic_name != NULL && cRosMessageQueueUsage(&n->pubs[i].msg_queue) > 0)
+  for ( i = 0; i < n->pub_slots.n_slots && queues_empty == 1; i++)
+    if(n->pubs[i]->topic_name != NULL && cRosMessageQueueUsage(&n->pubs[i]->msg_queue) > 0)
       queues_empty = 0;
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS && queues_empty == 1; i++)
-    if(n->service_callers[i].service_name != NULL && cRosMessageQueueUsage(&n->service_callers[i].msg_queue) > 0)
+  for ( i = 0; i < n->service_caller_slots.n_slots && queues_empty == 1; i++)
+    if(n->service_callers[i]->service_name != NULL && cRosMessageQueueUsage(&n->service_callers[i]->msg_queue) > 0)
       queues_empty = 0;
 
   return(queues_empty);
@@ -1962,13 +2573,13 @@ void cRosNodePauseAllCallersPublishers(CrosNode *n)
 {
   int i;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
-    if(n->pubs[i].topic_name != NULL)
-      n->pubs[i].loop_period = -1;
+  for ( i = 0; i < n->pub_slots.n_slots; i++)
+    if(n->pubs[i]->topic_name != NULL)
+      n->pubs[i]->loop_period = -1;
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
-    if(n->service_callers[i].service_name != NULL)
-      n->service_callers[i].loop_period = -1;
+  for ( i = 0; i < n->service_caller_slots.n_slots; i++)
+    if(n->service_callers[i]->service_name != NULL)
+      n->service_callers[i]->loop_period = -1;
 }
 
 cRosErrCodePack cRosNodeUnregisterAll(CrosNode *n)
@@ -1976,20 +2587,20 @@ cRosErrCodePack cRosNodeUnregisterAll(CrosNode *n)
   int i;
   cRosErrCodePack ret_err=CROS_SUCCESS_ERR_PACK;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
-    if(n->pubs[i].topic_name != NULL)
+  for ( i = 0; i < n->pub_slots.n_slots && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+    if(n->pubs[i]->topic_name != NULL)
       ret_err = cRosApiUnregisterPublisher(n, i);
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
-    if(n->subs[i].topic_name != NULL)
+  for ( i = 0; i < n->sub_slots.n_slots && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+    if(n->subs[i]->topic_name != NULL)
       ret_err = cRosApiUnregisterSubscriber(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
-    if(n->service_providers[i].service_name != NULL)
+  for ( i = 0; i < n->service_provider_slots.n_slots && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+    if(n->service_providers[i]->service_name != NULL)
       ret_err = cRosApiUnregisterServiceProvider(n, i);
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
-    if(n->paramsubs[i].parameter_key != NULL)
+  for ( i = 0; i < n->paramsub_slots.n_slots && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+    if(n->paramsubs[i]->parameter_key != NULL)
       ret_err = cRosApiUnsubscribeParam(n, i);
 
   return ret_err;
@@ -2011,50 +2622,101 @@ cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
   if(ret_err == CROS_SUCCESS_ERR_PACK)
     ret_err = cRosNodeWaitUntilFnRetTrue(n, cRosUnregistrationCompleted); // Wait until all roles have been unsuscribed
 
+  cRosNodeSetIntraProcess(n, 0); // The other nodes of the process must not deliver messages to this one anymore
+
+  cRosNodeWaitUntilFnRetTrue(n, closedZeroCopyFramesReleased); // Wait until the kernel has sent the frames of the closed connections
+  releaseClosedZeroCopyFrames(n, 1);
+  free(n->zc_closed_procs);
+  n->zc_closed_procs = NULL;
+  n->max_zc_closed_procs = 0;
+
   xmlrpcProcessRelease( &(n->xmlrpc_listner_proc) );
 
   releaseApiCallQueue(&n->master_api_queue);
   releaseApiCallQueue(&n->slave_api_queue);
 
   int i;
-  for (i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++)
-    xmlrpcProcessRelease( &(n->xmlrpc_server_proc[i]) );
+  for (i = 0; i < n->xmlrpc_server_slots.n_slots; i++)
+    xmlrpcProcessRelease( n->xmlrpc_server_proc[i] );
 
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
-    xmlrpcProcessRelease( &(n->xmlrpc_client_proc[i]) );
+  for(i = 0; i < n->xmlrpc_client_slots.n_slots; i++)
+    xmlrpcProcessRelease( n->xmlrpc_client_proc[i] );
 
   tcprosProcessRelease( &(n->tcpros_listner_proc) );
 
-  for ( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessRelease( &(n->tcpros_server_proc[i]) );
+  for ( i = 0; i < n->tcpros_server_slots.n_slots; i++)
+    tcprosProcessRelease( n->tcpros_server_proc[i] );
 
-  for ( i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessRelease( &(n->tcpros_client_proc[i]) );
+  for ( i = 0; i < n->tcpros_client_slots.n_slots; i++)
+    tcprosProcessRelease( n->tcpros_client_proc[i] );
 
-  for ( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessRelease( &(n->rpcros_server_proc[i]) );
+  for ( i = 0; i < n->rpcros_server_slots.n_slots; i++)
+    tcprosProcessRelease( n->rpcros_server_proc[i] );
 
-  for ( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessRelease( &(n->rpcros_client_proc[i]) );
+  for ( i = 0; i < n->rpcros_client_slots.n_slots; i++)
+    tcprosProcessRelease( n->rpcros_client_proc[i] );
+
+  cRosSlotTableRelease( &n->xmlrpc_server_slots, (void ***)&n->xmlrpc_server_proc );
+  cRosSlotTableRelease( &n->xmlrpc_client_slots, (void ***)&n->xmlrpc_client_proc );
+  cRosSlotTableRelease( &n->tcpros_server_slots, (void ***)&n->tcpros_server_proc );
+  cRosSlotTableRelease( &n->tcpros_client_slots, (void ***)&n->tcpros_client_proc );
+  cRosSlotTableRelease( &n->rpcros_server_slots, (void ***)&n->rpcros_server_proc );
+  cRosSlotTableRelease( &n->rpcros_client_slots, (void ***)&n->rpcros_client_proc );
+  cRosSlotListRelease( &n->xmlrpc_client_connects );
+  cRosSlotListRelease( &n->tcpros_client_connects );
+  cRosSlotListRelease( &n->tcpros_client_pending );
+  cRosSlotListRelease( &n->rpcros_client_connects );
 
   if ( n->name != NULL ) free ( n->name );
   if ( n->host != NULL ) free ( n->host );
   if ( n->roscore_host != NULL ) free ( n->roscore_host );
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
+  for ( i = 0; i < n->pub_slots.n_slots; i++)
     cRosApiReleasePublisher(n, i);
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS; i++)
+  for ( i = 0; i < n->sub_slots.n_slots; i++)
     cRosApiReleaseSubscriber(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS; i++)
+  for ( i = 0; i < n->service_provider_slots.n_slots; i++)
     cRosApiReleaseServiceProvider(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
+  for ( i = 0; i < n->service_caller_slots.n_slots; i++)
     cRosApiReleaseServiceCaller(n, i);
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS; i++)
-    cRosNodeReleaseParameterSubscrition(&n->paramsubs[i]);
+  for ( i = 0; i < n->paramsub_slots.n_slots; i++)
+    cRosNodeReleaseParameterSubscrition(n->paramsubs[i]);
+
+  // The strands have been released with their roles, so no worker uses the node anymore
+  processFinishedServiceWorks(n);
+  if(n->callback_pool != NULL)
+  {
+    cRosWorkerPoolRelease(n->callback_pool);
+    free(n->callback_pool);
+    n->callback_pool = NULL;
+  }
+
+  cRosSlotTableRelease( &n->pub_slots, (void ***)&n->pubs );
+  releasePostTables( n );
+  cRosSlotTableRelease( &n->sub_slots, (void ***)&n->subs );
+  cRosSlotTableRelease( &n->service_provider_slots, (void ***)&n->service_providers );
+  cRosSlotTableRelease( &n->service_caller_slots, (void ***)&n->service_callers );
+  cRosSlotTableRelease( &n->paramsub_slots, (void ***)&n->paramsubs );
+
+  for ( i = 0; i < CN_ROSOUT_N_FIELDS; i++)
+  {
+    cRosMessageFieldHandleFree(n->rosout_field_handles[i]);
+    n->rosout_field_handles[i] = NULL;
+  }
+
+  free( n->ready_events );
+  n->ready_events = NULL;
+  n->max_ready_events = 0;
+
+  tcpIpSocketClose( &(n->wakeup_notifier) );
+  cRosEventBackendRelease( &(n->event_backend) );
+
+  cRosTimerHeapRelease( &(n->timers) );
+  cRosMutexRelease( &(n->pubs_lock) );
 
   tcpIpSocketCleanUp();
 
@@ -2066,13 +2728,6 @@ cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
 {
   PRINT_VVDEBUG ( "cRosNodeRegisterPublisher()\n" );
 
-  if ( node->n_pubs >= CN_MAX_PUBLISHED_TOPICS )
-  {
-    PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't register a new publisher: \
-                 reached the maximum number of published topics\n");
-    return -1;
-  }
-
   char *pub_message_definition = ( char * ) malloc ( ( strlen ( message_definition ) + 1 ) * sizeof ( char ) );
   char *pub_topic_name = cRosNamespaceBuild(node, topic_name);
   char *pub_topic_type = ( char * ) malloc ( ( strlen ( topic_type ) + 1 ) * sizeof ( char ) );
@@ -2091,27 +2746,53 @@ cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
 
   PRINT_INFO ( "Publishing topic %s type %s \n", pub_topic_name, pub_topic_type );
 
-  int pubidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_PUBLISHED_TOPICS; it++)
+  int is_new;
+  cRosMutexLock(&node->pubs_lock); // The table can be reallocated while the other intra-process nodes look for publishers
+  int pubidx = acquireProviderSlot( &node->pub_slots, (void ***)&node->pubs, sizeof(PublisherNode), &is_new );
+  if (pubidx == -1)
   {
-    if (node->pubs[it].topic_name == NULL)
-    {
-      pubidx = it;
-      break;
-    }
+    cRosMutexUnlock(&node->pubs_lock);
+    PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't allocate memory\n" );
+    return -1;
+  }
+  if (is_new)
+  {
+    initPublisherNode(node->pubs[pubidx]);
+    // The posting state is not reset when the publisher is released, since other threads may still be checking it
+    node->pubs[pubidx]->post_open = 0;
+    node->pubs[pubidx]->n_post_users = 0;
+  }
+  if (updatePostTable(node) != 0)
+  {
+    cRosSlotTablePushFree(&node->pub_slots, pubidx);
+    cRosMutexUnlock(&node->pubs_lock);
+    PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't allocate memory\n" );
+    return -1;
   }
 
-  PublisherNode *pub = &node->pubs[pubidx];
+  PublisherNode *pub = node->pubs[pubidx];
+  pub->tcpros_id_list = (int *)malloc(2 * sizeof(int));
+  if (pub->tcpros_id_list == NULL)
+  {
+    cRosSlotTablePushFree(&node->pub_slots, pubidx);
+    cRosMutexUnlock(&node->pubs_lock);
+    PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't allocate memory\n" );
+    return -1;
+  }
+  pub->max_tcpros_ids = 2;
+  pub->tcpros_id_list[0] = -1; // Empty list of TcprosProcess indices
   pub->message_definition = pub_message_definition;
   pub->topic_name = pub_topic_name;
   pub->topic_type = pub_topic_type;
   pub->md5sum = pub_md5sum;
 
   pub->loop_period = loop_period;
-  pub->wake_up_time = 0;
+  pub->next_period_time = 0; // The first periodic message is sent as soon as a subscriber connects
+  pub->timer.tag = CN_EVENT_TAG(CN_TIMER_PUBLISHER, pubidx);
   pub->context = data_context;
   cRosMessageQueueClear(&pub->msg_queue);
+  CROS_ATOMIC_STORE_INT(&pub->post_open, 1); // Other threads can post messages to the publisher from now on
+  cRosMutexUnlock(&node->pubs_lock);
 
   node->n_pubs++;
 
@@ -2127,13 +2808,6 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
 {
   PRINT_VVDEBUG ( "cRosNodeRegisterServiceProvider()\n" );
 
-  if (node->n_service_providers >= CN_MAX_SERVICE_PROVIDERS)
-  {
-    PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't register a new service provider: \
-                 reached the maximum number of service providers\n");
-    return -1;
-  }
-
   char *srv_service_name =  cRosNamespaceBuild(node, service_name);
   char *srv_service_type = ( char * ) malloc ( ( strlen ( service_type ) + 1 ) * sizeof ( char ) );
   char *srv_servicerequest_type = ( char * ) malloc ( ( strlen ( service_type ) + strlen("Request") + 1 ) * sizeof ( char ) );
@@ -2156,18 +2830,22 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
 
   PRINT_INFO ( "Registering service provider %s type %s \n", srv_service_name, srv_service_type);
 
-  int serviceidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_SERVICE_PROVIDERS; it++)
+  int is_new;
+  int serviceidx = acquireProviderSlot( &node->service_provider_slots, (void ***)&node->service_providers, sizeof(ServiceProviderNode), &is_new );
+  if (serviceidx == -1)
   {
-    if (node->service_providers[it].service_name == NULL)
-    {
-      serviceidx = it;
-      break;
-    }
+    PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't allocate memory\n" );
+    return -1;
   }
+  if (is_new)
+    initServiceProviderNode(node->service_providers[serviceidx]);
 
-  ServiceProviderNode *service = &(node->service_providers[serviceidx]);
+  ServiceProviderNode *service = node->service_providers[serviceidx];
+  if (node->callback_pool != NULL && cRosWorkStrandInit(&service->callback_strand, node->callback_pool, node->callback_queue_size) != 0)
+  {
+    PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't allocate memory\n" );
+    return -1;
+  }
 
   service->service_name = srv_service_name;
   service->service_type = srv_service_type;
@@ -2185,6 +2863,202 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
   return serviceidx;
 }
 
+int cRosNodePublisherAddTcprosProc(PublisherNode *pub, int server_idx)
+{
+  int list_elem;
+
+  for(list_elem=0;pub->tcpros_id_list[list_elem]!=-1;list_elem++); // Locate the list end
+  if(list_elem + 2 > pub->max_tcpros_ids) // There is no room for the new index and the sentinel
+  {
+    int new_max = 2 * pub->max_tcpros_ids;
+    int *new_list = (int *)realloc(pub->tcpros_id_list, new_max * sizeof(int));
+    if(new_list == NULL)
+    {
+      PRINT_ERROR ( "cRosNodePublisherAddTcprosProc() : Can't allocate memory\n" );
+      return -1;
+    }
+    pub->tcpros_id_list = new_list;
+    pub->max_tcpros_ids = new_max;
+  }
+  pub->tcpros_id_list[list_elem] = server_idx;
+  pub->tcpros_id_list[list_elem+1] = -1; // Set a new list end (sentinel)
+  return 0;
+}
+
+// Nodes of the process that connect their publishers and subscribers without sockets (see cRosNodeSetIntraProcess()).
+// The links of a publisher are modified while holding both the registry lock and the pubs_lock of the publisher node
+// (in this order), so the thread of the publisher node only needs its pubs_lock to hand over the messages
+static CrosNode *Intra_process_nodes = NULL;
+static CrosMutex Intra_process_nodes_lock; // The lock is only held while searching or modifying the registered nodes and their links
+static CrosOnce Intra_process_nodes_once = CROS_ONCE_INIT;
+
+static void initIntraProcessNodesLock(void)
+{
+  if(cRosMutexInit(&Intra_process_nodes_lock) != 0)
+    PRINT_ERROR ( "initIntraProcessNodesLock() : Can't initialize the lock of the intra-process node registry\n" );
+}
+
+static void lockIntraProcessNodes(void)
+{
+  cRosOnceRun(&Intra_process_nodes_once, initIntraProcessNodesLock);
+  cRosMutexLock(&Intra_process_nodes_lock);
+}
+
+static void unlockIntraProcessNodes(void)
+{
+  cRosMutexUnlock(&Intra_process_nodes_lock);
+}
+
+// Make the thread of a node attend a publisher through the posted_pubs queue, which can be done from any thread.
+// The publisher must not be released meanwhile: the caller holds the pubs_lock of the node or is one of its post users
+static void notifyPostedPublisher(CrosNode *node, PublisherNode *pub)
+{
+  // Only the first notification since the node last attended the publisher has to wake up the node
+  if(CROS_ATOMIC_XCHG_INT(&pub->post_pending, 1) == 0)
+  {
+    cRosMpscQueuePush(&node->posted_pubs, &pub->posted_link);
+    tcpIpSocketNotify(&node->wakeup_notifier);
+  }
+}
+
+// Remove the links from the publishers of the registered nodes to a subscriber of node (to all of them if sub is NULL).
+// The registry must be locked. Once it returns, no publisher hands messages to the subscribers anymore
+static void removeIntraProcessLinks(CrosNode *node, SubscriberNode *sub)
+{
+  CrosNode *pub_node;
+  int pub_idx, link_ind, n_links;
+
+  for(pub_node = Intra_process_nodes; pub_node != NULL; pub_node = pub_node->next_intra_process_node)
+  {
+    cRosMutexLock(&pub_node->pubs_lock);
+    for(pub_idx = 0; pub_idx < pub_node->pub_slots.n_slots; pub_idx++)
+    {
+      PublisherNode *pub = pub_node->pubs[pub_idx];
+      n_links = 0;
+      for(link_ind = 0; link_ind < pub->n_intra_links; link_ind++)
+      {
+        CrosIntraProcessLink *link = &pub->intra_links[link_ind];
+        // Keep the order of the remaining links, which is the order of delivery
+        if(link->node != node || (sub != NULL && link->sub != sub))
+          pub->intra_links[n_links++] = *link;
+      }
+      CROS_ATOMIC_STORE_INT(&pub->n_intra_links, n_links);
+    }
+    cRosMutexUnlock(&pub_node->pubs_lock);
+  }
+}
+
+// Link a subscriber to a publisher of a node in the process registry, so that it receives the messages without sockets.
+// The registry and the pubs_lock of the publisher node must be held
+static int addIntraProcessLink(PublisherNode *pub, CrosNode *sub_node, SubscriberNode *sub)
+{
+  int link_ind;
+
+  for(link_ind = 0; link_ind < pub->n_intra_links; link_ind++)
+    if(pub->intra_links[link_ind].node == sub_node && pub->intra_links[link_ind].sub == sub)
+      return 0; // Already linked (e.g., the master has notified the same publisher again)
+
+  if(pub->n_intra_links == pub->max_intra_links)
+  {
+    int new_max = (pub->max_intra_links > 0)? 2 * pub->max_intra_links: 4;
+    CrosIntraProcessLink *new_links = (CrosIntraProcessLink *)realloc(pub->intra_links, new_max * sizeof(CrosIntraProcessLink));
+    if(new_links == NULL)
+    {
+      PRINT_ERROR ( "addIntraProcessLink() : Can't allocate memory\n" );
+      return -1;
+    }
+    pub->intra_links = new_links;
+    pub->max_intra_links = new_max;
+  }
+  pub->intra_links[pub->n_intra_links].node = sub_node;
+  pub->intra_links[pub->n_intra_links].sub = sub;
+  CROS_ATOMIC_STORE_INT(&pub->n_intra_links, pub->n_intra_links + 1);
+  return 0;
+}
+
+// If the publisher node at host:port is in the process registry, link the subscriber to its publisher of the topic instead
+// of requesting the topic through XMLRPC. Returns 1 if the subscriber has been linked, 0 if the topic must be requested or -1 on error
+static int linkIntraProcessPublisher(CrosNode *node, int subidx, const char *host, int port)
+{
+  SubscriberNode *sub = node->subs[subidx];
+  CrosNode *pub_node;
+  int pub_idx, ret = 0;
+
+  if(!node->intra_process || cRosNodeContextIsTyped(sub->context))
+    return 0;
+
+  lockIntraProcessNodes();
+  pub_node = Intra_process_nodes;
+  while(pub_node != NULL && (pub_node->xmlrpc_port != port || strcmp(pub_node->host, host) != 0))
+    pub_node = pub_node->next_intra_process_node;
+
+  if(pub_node != NULL)
+  {
+    // The publisher node can be run by another thread, which (un)registers publishers meanwhile
+    cRosMutexLock(&pub_node->pubs_lock);
+    for(pub_idx = 0; pub_idx < pub_node->pub_slots.n_slots && ret == 0; pub_idx++)
+    {
+      PublisherNode *pub = pub_node->pubs[pub_idx];
+      // The typed publishers and the ones of other message type are left to TCPROS, which serializes or rejects the messages
+      if(pub->topic_name != NULL && strcmp(pub->topic_name, sub->topic_name) == 0 &&
+         strcmp(pub->md5sum, sub->md5sum) == 0 && !cRosNodeContextIsTyped(pub->context))
+      {
+        if(addIntraProcessLink(pub, node, sub) == 0)
+        {
+          notifyPostedPublisher(pub_node, pub); // The publisher may be waiting for a subscriber to send its queued messages
+          ret = 1;
+        }
+        else
+          ret = -1;
+      }
+    }
+    cRosMutexUnlock(&pub_node->pubs_lock);
+  }
+  unlockIntraProcessNodes();
+
+  if(ret > 0)
+    PRINT_VDEBUG ( "linkIntraProcessPublisher() : Topic %s connected inside the process\n", sub->topic_name );
+  return ret;
+}
+
+cRosErrCodePack cRosNodeSetIntraProcess( CrosNode *node, int enable )
+{
+  CrosNode **node_ptr;
+  int pub_idx;
+  PRINT_VVDEBUG ( "cRosNodeSetIntraProcess ()\n" );
+
+  if(node == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  enable = (enable != 0);
+  if(node->intra_process == enable)
+    return CROS_SUCCESS_ERR_PACK;
+
+  lockIntraProcessNodes();
+  if(enable)
+  {
+    node->next_intra_process_node = Intra_process_nodes;
+    Intra_process_nodes = node;
+  }
+  else
+  {
+    // Drop the connections of the node in both directions before delisting it
+    removeIntraProcessLinks(node, NULL);
+    cRosMutexLock(&node->pubs_lock);
+    for(pub_idx = 0; pub_idx < node->pub_slots.n_slots; pub_idx++)
+      CROS_ATOMIC_STORE_INT(&node->pubs[pub_idx]->n_intra_links, 0);
+    cRosMutexUnlock(&node->pubs_lock);
+
+    for(node_ptr = &Intra_process_nodes; *node_ptr != node; node_ptr = &(*node_ptr)->next_intra_process_node);
+    *node_ptr = node->next_intra_process_node;
+    node->next_intra_process_node = NULL;
+  }
+  node->intra_process = (unsigned char)enable;
+  unlockIntraProcessNodes();
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 int cRosNodeRecruitTcprosClientProc(CrosNode *node, int subidx)
 {
   int ret; // Return value: -1 on error, or the recruited proc index on success
@@ -2192,20 +3066,14 @@ int cRosNodeRecruitTcprosClientProc(CrosNode *node, int subidx)
   SubscriberNode *sub;
   TcprosProcess *client_proc;
 
-  // Look for a free Tcpros client proc
-  int clientidx;
-  client_proc=NULL;
-  sub = &node->subs[subidx];
-  ret=-1; // Default return value (No free Tcpros client proc is available)
-  for(clientidx=0;clientidx<CN_MAX_TCPROS_CLIENT_CONNECTIONS && ret==-1;clientidx++)
+  // Look for a free Tcpros client proc (a new one is created if all of them are in use)
+  sub = node->subs[subidx];
+  ret = peekIdleTcprosProcess( node, &node->tcpros_client_proc, &node->tcpros_client_slots, CN_EVENT_TCPROS_CLIENT );
+  if(ret != -1)
   {
-    client_proc = &node->tcpros_client_proc[clientidx];
-    if(client_proc->topic_idx == -1) // A free Tcpros client proc has been found
-    {
-      client_proc->topic_idx = subidx;
-      client_proc->tcp_nodelay = (unsigned char)sub->tcp_nodelay;
-      ret=clientidx; // Exit loop
-    }
+    client_proc = node->tcpros_client_proc[ret];
+    client_proc->topic_idx = subidx;
+    client_proc->tcp_nodelay = (unsigned char)sub->tcp_nodelay;
   }
   return ret;
 }
@@ -2217,9 +3085,9 @@ int cRosNodeFindFirstTcprosClientProc(CrosNode *node, int subidx, const char *tc
 
   // Look for the first Tcpros client proc that was recruited for subidx subscriber and a specific publisher host and port
   ret=-1;
-  for(clientidx=0;clientidx<CN_MAX_TCPROS_CLIENT_CONNECTIONS && ret==-1;clientidx++)
+  for(clientidx=0;clientidx<node->tcpros_client_slots.n_slots && ret==-1;clientidx++)
   {
-    TcprosProcess *cur_cli = &node->tcpros_client_proc[clientidx];
+    TcprosProcess *cur_cli = node->tcpros_client_proc[clientidx];
     if((subidx == -1 || cur_cli->topic_idx == subidx) &&
        (tcpros_port == -1 || cur_cli->sub_tcpros_port == tcpros_port) &&
        (tcpros_hostname == NULL || strcmp(cur_cli->sub_tcpros_host,tcpros_hostname)==0)
@@ -2234,13 +3102,6 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition, c
 {
   PRINT_VVDEBUG ( "cRosNodeRegisterSubscriber()\n" );
 
-  if (node->n_subs >= CN_MAX_SUBSCRIBED_TOPICS)
-  {
-    PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't register a new subscriber: \
-                  reached the maximum number of published topics\n");
-    return -1;
-  }
-
   char *pub_message_definition = ( char * ) malloc ( ( strlen ( message_definition ) + 1 ) * sizeof ( char ) );
   char *pub_topic_name = cRosNamespaceBuild(node, topic_name);
   char *pub_topic_type = ( char * ) malloc ( ( strlen ( topic_type ) + 1 ) * sizeof ( char ) );
@@ -2259,18 +3120,22 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition, c
 
   PRINT_INFO ( "Subscribing to topic %s type %s \n", pub_topic_name, pub_topic_type );
 
-  int subidx = node->n_subs;
-  int it = 0;
-  for (; it < CN_MAX_SUBSCRIBED_TOPICS; it++)
+  int is_new;
+  int subidx = acquireProviderSlot( &node->sub_slots, (void ***)&node->subs, sizeof(SubscriberNode), &is_new );
+  if (subidx == -1)
   {
-    if (node->subs[it].topic_name == NULL)
-    {
-      subidx = it;
-      break;
-    }
+    PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't allocate memory\n" );
+    return -1;
   }
+  if (is_new)
+    initSubscriberNode(node->subs[subidx]);
 
-  SubscriberNode *sub = &node->subs[subidx];
+  SubscriberNode *sub = node->subs[subidx];
+  if (node->callback_pool != NULL && cRosWorkStrandInit(&sub->callback_strand, node->callback_pool, node->callback_queue_size) != 0)
+  {
+    PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't allocate memory\n" );
+    return -1;
+  }
   sub->message_definition = pub_message_definition;
   sub->topic_name = pub_topic_name;
   sub->topic_type = pub_topic_type;
@@ -2278,6 +3143,10 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition, c
   sub->context = data_context;
   sub->tcp_nodelay = (unsigned char)tcp_nodelay;
   sub->msg_queue_overflow = 0;
+  sub->msg_queue_policy = CROS_SUB_QUEUE_DROP_NEWEST;
+  sub->msg_queue_n_dropped = 0;
+  sub->zerocopy_views = 0;
+  sub->lazy_decoding = 0;
   cRosMessageQueueClear(&sub->msg_queue);
 
   node->n_subs++;
@@ -2295,13 +3164,6 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 {
   PRINT_VVDEBUG ( "cRosNodeRegisterServiceCaller()\n" );
 
-  if (node->n_service_callers >= CN_MAX_SERVICE_CALLERS)
-  {
-    PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't register a new service caller: \
-                 reached the maximum number of service callers\n");
-    return -1;
-  }
-
   char *srv_message_definition = ( char * ) malloc ( ( strlen ( message_definition ) + 1 ) * sizeof ( char ) );
   char *srv_service_name =  cRosNamespaceBuild(node, service_name);
   char *srv_service_type = ( char * ) malloc ( ( strlen ( service_type ) + 1 ) * sizeof ( char ) );
@@ -2326,18 +3188,17 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 
   PRINT_INFO ( "Starting service caller %s type %s \n", srv_service_name, srv_service_type);
 
-  int serviceidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_SERVICE_CALLERS; it++)
+  int is_new;
+  int serviceidx = acquireProviderSlot( &node->service_caller_slots, (void ***)&node->service_callers, sizeof(ServiceCallerNode), &is_new );
+  if (serviceidx == -1)
   {
-    if (node->service_callers[it].service_name == NULL)
-    {
-      serviceidx = it;
-      break;
-    }
+    PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't allocate memory\n" );
+    return -1;
   }
+  if (is_new)
+    initServiceCallerNode(node->service_callers[serviceidx]);
 
-  ServiceCallerNode *service = &(node->service_callers[serviceidx]);
+  ServiceCallerNode *service = node->service_callers[serviceidx];
   service->message_definition = srv_message_definition;
   service->service_name = srv_service_name;
   service->service_type = srv_service_type;
@@ -2346,14 +3207,25 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
   service->md5sum = srv_md5sum;
   service->context = data_context;
   service->loop_period = loop_period;
-  service->wake_up_time = 0; // cRosClockGetTimeMs() + 10;
+  service->next_period_time = 0; // The first periodic call is made as soon as the caller process is ready
+  service->timer.tag = CN_EVENT_TAG(CN_TIMER_SERVICE_CALLER, serviceidx);
   service->persistent = (unsigned char)persistent;
   service->tcp_nodelay = (unsigned char)tcp_nodelay;
 
   int clientidx = serviceidx; // node->service_callers[0] is assigned node->rpcros_client_proc[0] and so on
   service->rpcros_id = clientidx;
 
-  TcprosProcess *client_proc = &node->rpcros_client_proc[clientidx];
+  // So both tables grow together
+  while (node->rpcros_client_slots.n_slots <= clientidx)
+  {
+    if (newTcprosProcess(node, &node->rpcros_client_proc, &node->rpcros_client_slots, CN_EVENT_RPCROS_CLIENT, NULL) == -1)
+    {
+      PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't allocate memory\n" );
+      return -1;
+    }
+  }
+
+  TcprosProcess *client_proc = node->rpcros_client_proc[clientidx];
   client_proc->service_idx = serviceidx;
   client_proc->persistent = (unsigned char)persistent;
   client_proc->tcp_nodelay = (unsigned char)tcp_nodelay;
@@ -2371,10 +3243,10 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
 {
   int client_tcpros_ind, client_xmlrpc_ind;
-  if (subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if (subidx < 0 || subidx >= node->sub_slots.n_slots)
     return -1;
 
-  SubscriberNode *sub = &node->subs[subidx];
+  SubscriberNode *sub = node->subs[subidx];
   if (sub->topic_name == NULL)
     return -1;
 
@@ -2387,20 +3259,27 @@ int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
 
   while((client_tcpros_ind=cRosNodeFindFirstTcprosClientProc(node, subidx, NULL, -1)) != -1)
   {
-    TcprosProcess *tcprosProc = &node->tcpros_client_proc[client_tcpros_ind];
+    TcprosProcess *tcprosProc = node->tcpros_client_proc[client_tcpros_ind];
     closeTcprosProcess(tcprosProc);
   }
 
+  if(node->intra_process) // Disconnect the subscriber from the publishers in the process
+  {
+    lockIntraProcessNodes();
+    removeIntraProcessLinks(node, sub);
+    unlockIntraProcessNodes();
+  }
+
   // Check if any xmlrpc_client_proc is working for the subscriber being unregistered and if so, close them
-  for(client_xmlrpc_ind=0;client_xmlrpc_ind < CN_MAX_XMLRPC_CLIENT_CONNECTIONS;client_xmlrpc_ind++)
+  for(client_xmlrpc_ind=0;client_xmlrpc_ind < node->xmlrpc_client_slots.n_slots;client_xmlrpc_ind++)
   {
-    XmlrpcProcess *xmlrpcProc = &node->xmlrpc_client_proc[client_xmlrpc_ind];
+    XmlrpcProcess *xmlrpcProc = node->xmlrpc_client_proc[client_xmlrpc_ind];
     if(xmlrpcProc->state != XMLRPC_PROCESS_STATE_IDLE && xmlrpcProc->current_call != NULL &&
        xmlrpcProc->current_call->method == CROS_API_REQUEST_TOPIC && xmlrpcProc->current_call->provider_idx == subidx)
      closeXmlrpcProcess(xmlrpcProc);
   }
 
-  XmlrpcProcess *coreproc = &node->xmlrpc_client_proc[0];
+  XmlrpcProcess *coreproc = node->xmlrpc_client_proc[0];
   if (coreproc->current_call != NULL
       && coreproc->current_call->method == CROS_API_REGISTER_SUBSCRIBER
       && coreproc->current_call->provider_idx == subidx)
@@ -2429,10 +3308,10 @@ int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
 int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
 {
   int list_elem;
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if (pubidx < 0 || pubidx >= node->pub_slots.n_slots)
     return -1;
 
-  PublisherNode *pub = &node->pubs[pubidx];
+  PublisherNode *pub = node->pubs[pubidx];
   if (pub->topic_name == NULL)
     return -1;
 
@@ -2445,11 +3324,15 @@ int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
 
   for(list_elem=0;pub->tcpros_id_list[list_elem]!=-1;list_elem++)
   {
-    TcprosProcess *tcprosProc = &node->tcpros_server_proc[pub->tcpros_id_list[list_elem]];
-    closeTcprosProcess(tcprosProc);
+    TcprosProcess *tcprosProc = node->tcpros_server_proc[pub->tcpros_id_list[list_elem]];
+    closeTcprosServerProcess(node, tcprosProc);
   }
 
-  XmlrpcProcess *coreproc = &node->xmlrpc_client_proc[0];
+  cRosMutexLock(&node->pubs_lock);
+  CROS_ATOMIC_STORE_INT(&pub->n_intra_links, 0); // Disconnect the subscribers in the process
+  cRosMutexUnlock(&node->pubs_lock);
+
+  XmlrpcProcess *coreproc = node->xmlrpc_client_proc[0];
   if (coreproc->current_call != NULL
       && coreproc->current_call->method == CROS_API_REGISTER_PUBLISHER
       && coreproc->current_call->provider_idx == pubidx)
@@ -2477,10 +3360,10 @@ int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
 
 int cRosNodeUnregisterServiceProvider(CrosNode *node, int serviceidx)
 {
-  if (serviceidx < 0 || serviceidx >= CN_MAX_SERVICE_PROVIDERS)
+  if (serviceidx < 0 || serviceidx >= node->service_provider_slots.n_slots)
     return -1;
 
-  ServiceProviderNode *svc = &node->service_providers[serviceidx];
+  ServiceProviderNode *svc = node->service_providers[serviceidx];
   if (svc->service_name == NULL)
     return -1;
 
@@ -2491,7 +3374,7 @@ int cRosNodeUnregisterServiceProvider(CrosNode *node, int serviceidx)
     return -1;
   }
 
-  XmlrpcProcess *coreproc = &node->xmlrpc_client_proc[0];
+  XmlrpcProcess *coreproc = node->xmlrpc_client_proc[0];
   if (coreproc->current_call != NULL
       && coreproc->current_call->method == CROS_API_REGISTER_SERVICE
       && coreproc->current_call->provider_idx == serviceidx)
@@ -2524,13 +3407,6 @@ cRosErrCodePack cRosApiSubscribeParam(CrosNode *node, const char *key, NodeStatu
   PRINT_VVDEBUG ( "cRosApiSubscribeParam()\n" );
   PRINT_INFO ( "Subscribing to parameter %s\n", key);
 
-  if (node->n_paramsubs >= CN_MAX_PARAMETER_SUBSCRIPTIONS)
-  {
-    PRINT_ERROR ( "cRosApiSubscribeParam() : Can't register a new parameter subscription: \
-                  reached the maximum number of parameters\n");
-    return CROS_MANY_PARAM_ERR;
-  }
-
   char *parameter_key = ( char * ) malloc ( ( strlen ( key ) + 1 ) * sizeof ( char ) );
   if (parameter_key == NULL)
   {
@@ -2540,18 +3416,18 @@ cRosErrCodePack cRosApiSubscribeParam(CrosNode *node, const char *key, NodeStatu
 
   strcpy (parameter_key, key);
 
-  int paramsubidx = -1; // This value should never be used
-  int it;
-  for (it = 0; it < CN_MAX_PARAMETER_SUBSCRIPTIONS; it++)
+  int is_new;
+  int paramsubidx = acquireProviderSlot( &node->paramsub_slots, (void ***)&node->paramsubs, sizeof(ParameterSubscription), &is_new );
+  if (paramsubidx == -1)
   {
-    if (node->paramsubs[it].parameter_key == NULL)
-    {
-      paramsubidx = it;
-      break;
-    }
-  }
-
-  ParameterSubscription *sub = &node->paramsubs[paramsubidx];
+    PRINT_ERROR ( "cRosApiSubscribeParam() : Can't allocate memory\n" );
+    free(parameter_key);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  if (is_new)
+    initParameterSubscrition(node->paramsubs[paramsubidx]);
+
+  ParameterSubscription *sub = node->paramsubs[paramsubidx];
   sub->parameter_key = parameter_key;
   sub->context = context;
   sub->status_api_callback = callback;
@@ -2563,6 +3439,7 @@ cRosErrCodePack cRosApiSubscribeParam(CrosNode *node, const char *key, NodeStatu
   {
     free(parameter_key);
     sub->parameter_key = NULL;
+    cRosSlotTablePushFree(&node->paramsub_slots, paramsubidx);
     node->n_paramsubs--;
     return CROS_MEM_ALLOC_ERR;
   }
@@ -2577,14 +3454,14 @@ cRosErrCodePack cRosApiUnsubscribeParam(CrosNode *node, int paramsubidx)
 {
   int caller_id;
 
-  if (paramsubidx < 0 || paramsubidx >= CN_MAX_PARAMETER_SUBSCRIPTIONS)
+  if (paramsubidx < 0 || paramsubidx >= node->paramsub_slots.n_slots)
     return CROS_BAD_PARAM_ERR;
 
-  ParameterSubscription *sub = &node->paramsubs[paramsubidx];
+  ParameterSubscription *sub = node->paramsubs[paramsubidx];
   if (sub->parameter_key == NULL)
     return CROS_PARAM_SUB_IND_ERR;
 
-  XmlrpcProcess *coreproc = &node->xmlrpc_client_proc[0];
+  XmlrpcProcess *coreproc = node->xmlrpc_client_proc[0];
   if (coreproc->current_call != NULL
       && coreproc->current_call->method == CROS_API_SUBSCRIBE_PARAM
       && coreproc->current_call->provider_idx == paramsubidx)
@@ -2598,887 +3475,1425 @@ cRosErrCodePack cRosApiUnsubscribeParam(CrosNode *node, int paramsubidx)
   return (caller_id != -1)? CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
 }
 
-cRosErrCodePack cRosNodeTriggerPublishersWriting( CrosNode *n, uint64_t cur_time )
+int cRosNodeWakeUpPublisher( CrosNode *n, int pub_idx )
 {
-  cRosErrCodePack ret_err;
-  int pub_idx;
-
-  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
-  // Check whether it is time to send a new topic message and trigger the corresponding TcprosProcesses
-  for(pub_idx = 0; pub_idx < CN_MAX_PUBLISHED_TOPICS; pub_idx++)
-  {
-    PublisherNode *cur_pub = &n->pubs[pub_idx];
-    if(cur_pub->topic_name != NULL) // Is this publisher active?
-    {
-      if((cur_pub->loop_period >= 0 && cur_pub->wake_up_time <= cur_time) || cRosMessageQueueUsage(&cur_pub->msg_queue) > 0) // Is it time to publish a message (periodic or immediate)?
-      {
-        int list_elem, all_procs_ready;
-        // Check whether all tcpProcess are ready to start writing a new message (or idle)
-        all_procs_ready = 1;
-        for(list_elem=0;cur_pub->tcpros_id_list[list_elem]!=-1;list_elem++)
-        {
-          TcprosProcess *server_proc = &n->tcpros_server_proc[cur_pub->tcpros_id_list[list_elem]];
-          if(server_proc->state != TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // server_proc->state != TCPROS_PROCESS_STATE_IDLE &&
-          {
-            all_procs_ready = 0;
-            break;
-          }
-        }
-        if(all_procs_ready && cur_pub->tcpros_id_list[0]!=-1) // All associated processes are ready to write and there is at least one associated process
-        {
-          if(cRosMessageQueueUsage(&cur_pub->msg_queue) == 0) // There is no immediate message waiting, so a periodic message must be sent
-            cur_pub->wake_up_time = cur_time + cur_pub->loop_period;
+  return cRosTimerHeapSchedule( &(n->timers), &(n->pubs[pub_idx]->timer), 0 );
+}
 
-          // The next function will store the next message to be sent in cur_pub->context->outgoing
-          ret_err = cRosNodePublisherCallback(cur_pub->context); // Calls the publisher application-defined callback
+// Make the node check a service caller as soon as possible (e.g., when its process becomes ready for a new call)
+static int wakeUpServiceCaller( CrosNode *n, int caller_idx )
+{
+  return cRosTimerHeapSchedule( &(n->timers), &(n->service_callers[caller_idx]->timer), 0 );
+}
 
-          // Make all the waiting processes start writing
-          for(list_elem=0;cur_pub->tcpros_id_list[list_elem]!=-1;list_elem++)
-          {
-            TcprosProcess *server_proc = &n->tcpros_server_proc[cur_pub->tcpros_id_list[list_elem]];
-            // if(server_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
-              tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_START_WRITING );
-          }
-        }
-      }
-    }
-  }
-  return(ret_err);
+// Calculate the time of the next periodic operation, skipping the periods that have already been missed
+static uint64_t nextPeriodTime( uint64_t prev_period_time, int loop_period, uint64_t cur_time )
+{
+  uint64_t next_time = prev_period_time + CN_MSEC_TO_NSEC(loop_period);
+  if( next_time <= cur_time )
+    next_time = cur_time + CN_MSEC_TO_NSEC(loop_period);
+  return next_time;
 }
 
+// Schedule a timer that is attended by processExpiredTimers(). The expiration time must be after cur_time,
+// so that a timer is attended at most once in each loop cycle
+static int rescheduleTimer( CrosNode *n, CrosTimer *timer, uint64_t expiry, uint64_t cur_time )
+{
+  return cRosTimerHeapSchedule( &(n->timers), timer, (expiry > cur_time)? expiry : cur_time + 1 );
+}
 
-cRosErrCodePack cRosNodeTriggerServiceCallersWriting( CrosNode *n, uint64_t cur_time )
+// Free the messages posted to a publisher from other threads that have not been moved to its queue
+static void discardPostedMsgs( PublisherNode *pub )
 {
-  cRosErrCodePack ret_err;
-  int caller_idx;
+  CrosMpscNode *link;
 
-  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
-  // Check whether it is time to make a service call, and if so, trigger the corresponding TcprosProcesses
-  for(caller_idx = 0; caller_idx < CN_MAX_SERVICE_CALLERS; caller_idx++)
+  while((link = cRosMpscQueuePop(&pub->posted_msgs)) != NULL)
   {
-    ServiceCallerNode *cur_caller = &n->service_callers[caller_idx];
-    if(cur_caller->service_name != NULL) // Is this caller active?
-    {
-      if((cur_caller->loop_period >= 0 && cur_caller->wake_up_time <= cur_time) || cRosMessageQueueUsage(&cur_caller->msg_queue) == 1) // Is it time to make a call (periodic or immediate)?
-      {
-        // Check whether the corresponding process is ready to start making a new call
-        TcprosProcess *caller_proc = &n->rpcros_client_proc[cur_caller->rpcros_id];
-        if(caller_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // caller_proc->state == TCPROS_PROCESS_STATE_IDLE ||
-        {
-          if(cRosMessageQueueUsage(&cur_caller->msg_queue) == 0) // There is no immediate call waiting, so a periodic call will be made
-            cur_caller->wake_up_time = cur_time + cur_caller->loop_period;
-
-          // Now the service-call parameters are stored in cur_caller->context->outgoing
-          ret_err = cRosNodeServiceCallerCallback( 0, cur_caller->context); // calls the service-caller application-defined callback function to generate the service request
-
-          //if(caller_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
-          {
-            tcprosProcessChangeState( caller_proc, TCPROS_PROCESS_STATE_START_WRITING );
-          }
-        }
-      }
-    }
+    cRosMessageFree(((CrosPostedMsg *)link)->msg);
+    free(link);
+    CROS_ATOMIC_FETCH_ADD_INT(&pub->n_posted_msgs, -1);
   }
-  return(ret_err);
 }
 
-#define NODE_STATUS_STR_MAX_LEN (CN_MAX_XMLRPC_CLIENT_CONNECTIONS+CN_MAX_XMLRPC_SERVER_CONNECTIONS+CN_MAX_TCPROS_CLIENT_CONNECTIONS+CN_MAX_TCPROS_SERVER_CONNECTIONS+CN_MAX_RPCROS_CLIENT_CONNECTIONS+CN_MAX_RPCROS_SERVER_CONNECTIONS+6*3+3*4+2)
-void printNodeProcState( CrosNode *n )
+// Move the messages posted from other threads to the queue of a publisher, as long as there is room in it
+static void pullPostedMsgs( PublisherNode *pub )
 {
-  static char prev_stat_str[NODE_STATUS_STR_MAX_LEN]="\0";
-  char stat_str[NODE_STATUS_STR_MAX_LEN];
-  int i;
-
-  sprintf(stat_str, "XL%X XC",n->xmlrpc_listner_proc.state);
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->xmlrpc_client_proc[i].state);
-
-  sprintf(stat_str+strlen(stat_str), " XS");
-  for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->xmlrpc_server_proc[i].state);
+  CrosMpscNode *link;
 
-  sprintf(stat_str+strlen(stat_str), " TL%X TC",n->tcpros_listner_proc.state);
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->tcpros_client_proc[i].state);
-
-  sprintf(stat_str+strlen(stat_str), " TS");
-  for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->tcpros_server_proc[i].state);
-
-  sprintf(stat_str+strlen(stat_str), " RL%X RC",n->rpcros_listner_proc.state);
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->rpcros_client_proc[i].state);
-
-  sprintf(stat_str+strlen(stat_str), " RS");
-  for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
-    sprintf(stat_str+strlen(stat_str), "%X",n->rpcros_server_proc[i].state);
-
-  if (strcmp(prev_stat_str, stat_str) != 0) // If the node status has changed:
+  while(cRosMessageQueueVacancies(&pub->msg_queue) > 0 && (link = cRosMpscQueuePop(&pub->posted_msgs)) != NULL)
   {
-    // Print a compact string indicating the state of all the node processed for debug purposes
-    PRINT_DEBUG("Node status: %s\n", stat_str);
-    strcpy(prev_stat_str, stat_str);
+    CrosPostedMsg *posted = (CrosPostedMsg *)link;
+    if(cRosMessageQueueAddMove(&pub->msg_queue, posted->msg) != 0)
+      PRINT_ERROR("pullPostedMsgs() : Can't queue a message posted to topic %s\n", pub->topic_name);
+    cRosMessageFree(posted->msg);
+    free(posted);
+    CROS_ATOMIC_FETCH_ADD_INT(&pub->n_posted_msgs, -1);
   }
 }
 
-uint64_t cRosNodeCalculateSelectTimeout(CrosNode *n, uint64_t max_timeout)
+// Attend the publishers to which other threads have posted messages
+static cRosErrCodePack processPostedMsgs( CrosNode *n )
 {
-  uint64_t wakeup_timeout, select_timeout, cur_time;
-  int pub_idx, svc_idx;
-
-  select_timeout =  max_timeout;
-  cur_time = cRosClockGetTimeMs();
-
-  if( n->xmlrpc_master_wake_up_time > cur_time )
-    wakeup_timeout = n->xmlrpc_master_wake_up_time - cur_time;
-  else
-    wakeup_timeout = 0;
-
-  if( wakeup_timeout < select_timeout )
-    select_timeout = wakeup_timeout;
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  CrosMpscNode *link;
 
-  for (pub_idx = 0;pub_idx < CN_MAX_PUBLISHED_TOPICS;pub_idx++) // < n_pubs?
+  while((link = cRosMpscQueuePop(&n->posted_pubs)) != NULL)
   {
-    PublisherNode *cur_pub = &n->pubs[pub_idx];
-    if(cur_pub->topic_name != NULL && cur_pub->loop_period >= 0) // Is this publisher active and automatically publishing messages?
+    PublisherNode *pub = CN_POSTED_LINK_TO_PUB(link);
+    // The flag is cleared before pulling the messages, so a message posted from now on notifies the node again
+    CROS_ATOMIC_XCHG_INT(&pub->post_pending, 0);
+    if(pub->topic_name == NULL) // The publisher has been released: its messages cannot be sent
     {
-      if( cur_pub->wake_up_time > cur_time ) // Is not it time to publish a new message yet?
-        wakeup_timeout = cur_pub->wake_up_time - cur_time;
-      else
-        wakeup_timeout = 0;
-
-      if( wakeup_timeout < select_timeout )
-        select_timeout = wakeup_timeout;
+      discardPostedMsgs(pub);
+      continue;
     }
-  }
 
-  for (svc_idx = 0;svc_idx < CN_MAX_SERVICE_CALLERS;svc_idx++) // <n_service_callers?
-  {
-    ServiceCallerNode *cur_svc_caller = &n->service_callers[svc_idx];
-    if(cur_svc_caller->service_name != NULL && cur_svc_caller->loop_period >= 0) // Is this service caller active and automatically publishing messages?
-    {
-      if( cur_svc_caller->wake_up_time > cur_time ) // Is not it time to make a service call yet?
-        wakeup_timeout = cur_svc_caller->wake_up_time - cur_time;
-      else
-        wakeup_timeout = 0;
-
-      if( wakeup_timeout < select_timeout )
-      {
-        //printf("[i:%i cur time: %lu wake:%lu new timeout: %lu prev timeout:%lu]", i, cur_time,  cur_svc_caller->wake_up_time, wakeup_timeout, select_timeout);
-        select_timeout = wakeup_timeout;
-      }
-    }
+    pullPostedMsgs(pub);
+    if(cRosTimerHeapSchedule(&n->timers, &pub->timer, 0) != 0)
+      ret_err = CROS_MEM_ALLOC_ERR;
   }
-
-  return(select_timeout);
+  return ret_err;
 }
 
-cRosErrCodePack cRosNodeDoEventsLoop( CrosNode *n, uint64_t max_timeout )
+// Free the messages handed over to a subscriber by publishers in the process that have not been delivered
+static void discardIntraProcessMsgs( SubscriberNode *sub )
 {
-  cRosErrCodePack ret_err, new_errors;
-  uint64_t cur_time, select_timeout;
-  int nfds = -1;
-  fd_set r_fds, w_fds, err_fds;
-  int i;
-
-  PRINT_VVDEBUG ( "cRosNodeDoEventsLoop ()\n" );
-
-  if(n == NULL)
-    return CROS_BAD_PARAM_ERR;
-
-  #if CROS_DEBUG_LEVEL >= 2
-  PRINT_DEBUG("*");
-  FLUSH_PRINT();
-  printNodeProcState( n );
-  #endif
+  CrosMpscNode *link;
 
-  cur_time = cRosClockGetTimeMs();
-
-  ret_err = cRosNodeTriggerPublishersWriting( n, cur_time );
-
-  new_errors = cRosNodeTriggerServiceCallersWriting( n, cur_time );
-  ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-
-  FD_ZERO( &r_fds );
-  FD_ZERO( &w_fds );
-  FD_ZERO( &err_fds );
-
-  int xmlrpc_listner_fd = tcpIpSocketGetFD( &(n->xmlrpc_listner_proc.socket) );
-  int tcpros_listner_fd = tcpIpSocketGetFD( &(n->tcpros_listner_proc.socket) );
-  int rpcros_listner_fd = tcpIpSocketGetFD( &(n->rpcros_listner_proc.socket) );
-
-  XmlrpcProcess *coreproc = &n->xmlrpc_client_proc[0];
-  if (coreproc->state == XMLRPC_PROCESS_STATE_IDLE && !isQueueEmpty(&n->master_api_queue))
+  while((link = cRosMpscQueuePop(&sub->intra_msgs)) != NULL)
   {
-    RosApiCall *call = dequeueApiCall(&n->master_api_queue);
-    coreproc->current_call = call;
-    xmlrpcProcessChangeState( coreproc, XMLRPC_PROCESS_STATE_CONNECTING );
+    cRosSharedMessageRelease(((CrosIntraProcessMsg *)link)->msg);
+    free(link);
+    CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_msgs, -1);
   }
+}
 
-  size_t idle_client_count;
-  int idle_clients[CN_MAX_XMLRPC_CLIENT_CONNECTIONS];
-  getIdleXmplrpcClients(n, idle_clients, &idle_client_count);
+// Deliver the messages handed over by publishers in the process (see deliverIntraProcessMsg()) to the subscribers of the node
+static cRosErrCodePack processIntraProcessMsgs( CrosNode *n )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  CrosMpscNode *link, *msg_link;
 
-  int next_idle_client_idx = 0;
-  while (!isQueueEmpty(&n->slave_api_queue) && next_idle_client_idx != idle_client_count)
+  while((link = cRosMpscQueuePop(&n->intra_subs)) != NULL)
   {
-    int idle_client_idx = idle_clients[next_idle_client_idx];
-    RosApiCall *call = dequeueApiCall(&n->slave_api_queue);
-
-    XmlrpcProcess *proc =  &n->xmlrpc_client_proc[idle_client_idx];
-    proc->current_call = call;
-    xmlrpcProcessChangeState( proc, XMLRPC_PROCESS_STATE_CONNECTING );
-
-    next_idle_client_idx++;
-  }
+    SubscriberNode *sub = CN_INTRA_LINK_TO_SUB(link);
+    int n_dropped;
+    // The flag is cleared before delivering the messages, so a message handed over from now on notifies the node again
+    CROS_ATOMIC_XCHG_INT(&sub->intra_pending, 0);
+    if(sub->topic_name == NULL)
+    {
+      discardIntraProcessMsgs(sub);
+      continue;
+    }
 
-  /* If active (not idle state), add to the tcpIpSocketSelect() the XMLRPC clients */
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
-  {
-    fd_set *fdset = NULL;
-    if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_CONNECTING )
+    n_dropped = CROS_ATOMIC_XCHG_INT(&sub->n_intra_dropped, 0);
+    if(n_dropped > 0) // This node could not keep up with the publishers
     {
-      new_errors =  xmlrpcClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      fdset = &w_fds; // tcpIpSocketSelect() will acknowledge the socket connection completion in the file descriptors checked for writing
+      sub->msg_queue_n_dropped += n_dropped;
+      sub->msg_queue_overflow = 1;
     }
-    else if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_WRITING )
-      fdset = &w_fds;
-    else if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_READING )
-      fdset = &r_fds;
 
-    if (fdset != NULL)
+    while((msg_link = cRosMpscQueuePop(&sub->intra_msgs)) != NULL)
     {
-      int xmlrpc_client_fd = tcpIpSocketGetFD( &(n->xmlrpc_client_proc[i].socket) );
-      if(xmlrpc_client_fd != -1)
+      CrosIntraProcessMsg *intra_msg = (CrosIntraProcessMsg *)msg_link;
+      CrosWorkStrand *strand;
+      cRosErrCodePack sub_err;
+
+      CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_msgs, -1);
+      cRosNodeApplySubscriberQueuePolicy(sub);
+      strand = (sub->callback_strand.pool != NULL)? &sub->callback_strand: NULL;
+      sub_err = cRosNodeDeliverIntraProcessMsg(intra_msg->msg, sub->context, strand);
+      if(sub_err == CROS_CALLBACK_QUEUE_FULL_ERR) // The callbacks are lagging behind: the message is only queued
       {
-        if( xmlrpc_client_fd > nfds )
-          nfds = xmlrpc_client_fd;
-
-        FD_SET( xmlrpc_client_fd, fdset);
-        FD_SET( xmlrpc_client_fd, &err_fds);
+        sub->msg_queue_overflow = 1;
+        sub_err = CROS_SUCCESS_ERR_PACK;
       }
+      ret_err = cRosAddErrCodePackIfErr(ret_err, sub_err);
+      cRosSharedMessageRelease(intra_msg->msg);
+      free(intra_msg);
     }
   }
+  return ret_err;
+}
 
-  //printf("FD_SET COUNT. R: %d W: %d\n", r_count, w_count);
+// Send the service responses generated by the worker pool
+static void processFinishedServiceWorks( CrosNode *n )
+{
+  CrosMpscNode *link;
 
-  /* Add to the tcpIpSocketSelect() the active XMLRPC servers */
-  int next_xmlrpc_server_i = -1;
-  for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
+  while((link = cRosMpscQueuePop(&n->finished_svc_works)) != NULL)
   {
-    int server_fd = tcpIpSocketGetFD( &(n->xmlrpc_server_proc[i].socket) );
+    ServiceProviderWork *work = (ServiceProviderWork *)link;
+    TcprosProcess *server_proc = (work->server_idx < n->rpcros_server_slots.n_slots)? n->rpcros_server_proc[work->server_idx] : NULL;
 
-    if( next_xmlrpc_server_i < 0 &&
-        n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_IDLE )
-    {
-      next_xmlrpc_server_i = i;
-    }
-    else if( n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_READING )
-    {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
-    }
-    else if( n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_WRITING )
+    // The connection may have been closed (and even reused for another request) while the worker was busy
+    if(server_proc != NULL && server_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING && server_proc->svc_work_seq == work->seq)
     {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      cRosMessageSetServiceResponsePacket(n, work->server_idx, work->result, &work->response_data);
+      tcprosProcessChangeState(server_proc, TCPROS_PROCESS_STATE_WRITING);
     }
+    dynBufferRelease(&work->response_data);
+    free(work);
   }
+}
+
+void cRosNodePublishFrame( CrosNode *n, int pub_idx, TcprosFrame *frame )
+{
+  PublisherNode *cur_pub = n->pubs[pub_idx];
+  int list_elem;
 
-  /* If one XMLRPC server is active at least, add to the tcpIpSocketSelect() the listener socket */
-  if( next_xmlrpc_server_i >= 0)
+  // Queue the frame in every process and make the waiting processes start writing
+  for(list_elem=0;cur_pub->tcpros_id_list[list_elem]!=-1;)
   {
-    if(xmlrpc_listner_fd != -1) // If the listener socket is still opened, add it to the tcpIpSocketSelect() file descriptors
+    int server_idx = cur_pub->tcpros_id_list[list_elem];
+    TcprosProcess *server_proc = n->tcpros_server_proc[server_idx];
+    if(tcprosFrameQueuePush( &(server_proc->frame_queue), frame ) < 0)
     {
-      FD_SET( xmlrpc_listner_fd, &r_fds);
-      FD_SET( xmlrpc_listner_fd, &err_fds);
-      if( xmlrpc_listner_fd > nfds ) nfds = xmlrpc_listner_fd;
+      PRINT_INFO("cRosNodePublishFrame() : Outgoing queue of subscriber %s full. Closing connection\n",
+                 dynStringGetData(&(server_proc->caller_id)));
+      handleTcprosServerError( n, server_idx ); // The process is removed from tcpros_id_list
+      continue;
     }
+    if(server_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING && tcprosProcessNextFrame( server_proc ))
+      tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_START_WRITING );
+    list_elem++;
   }
+}
 
-  /*
-   *
-   * TCPROS PROCESSES tcpIpSocketSelect() MANAGEMENT
-   *
-   */
+// Hand the message generated by a publisher to each of its subscribers in the process, without serializing it. All the
+// subscribers get a reference to the same shared message, which takes the fields of the outgoing message if move_msg is
+// not 0 (otherwise it is a copy of them). The references wait in the subscribers until the threads of their nodes deliver
+// the message (see processIntraProcessMsgs())
+static cRosErrCodePack deliverIntraProcessMsg( CrosNode *n, int pub_idx, int move_msg )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  PublisherNode *cur_pub = n->pubs[pub_idx];
+  cRosMessage *msg = cRosNodeContextOutgoingMsg(cur_pub->context);
+  cRosSharedMessage *s_msg;
+  int link_ind;
+
+  // The message is built before taking the lock, which the subscriber nodes need to add and remove links
+  s_msg = (move_msg)? cRosSharedMessageNewMove(msg) : cRosSharedMessageNewCopy(msg);
+  if(s_msg == NULL)
+  {
+    PRINT_ERROR ( "deliverIntraProcessMsg() : Can't allocate memory\n" );
+    return CROS_MEM_ALLOC_ERR;
+  }
 
-  /* If active (not idle state), add to the tcpIpSocketSelect() the TCPROS clients */
-  int next_tcpros_client_i = -1; // Unused ???
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
+  cRosMutexLock(&n->pubs_lock); // The threads of the subscriber nodes add and remove links meanwhile
+  for(link_ind = 0; link_ind < cur_pub->n_intra_links; link_ind++)
   {
-    TcprosProcess *client_proc = &(n->tcpros_client_proc[i]);
-    int tcpros_client_fd;
+    CrosIntraProcessLink *link = &cur_pub->intra_links[link_ind];
+    SubscriberNode *sub = link->sub;
+    CrosIntraProcessMsg *intra_msg;
 
-    if( next_tcpros_client_i < 0 &&
-        i != 0 && //the zero-index is reserved to the roscore communications
-        client_proc->state == TCPROS_PROCESS_STATE_IDLE )
+    // The counter bounds the memory used by the messages when the subscriber node cannot deliver them
+    if(CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_msgs, 1) >= CN_SUBSCRIBER_INTRA_QUEUE_SIZE)
     {
-      next_tcpros_client_i = i;
+      CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_msgs, -1);
+      CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_dropped, 1);
+      continue;
     }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_CONNECTING)
-    {
-      new_errors =  tcprosClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
 
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &w_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
-    }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER)
+    intra_msg = (CrosIntraProcessMsg *)malloc(sizeof(CrosIntraProcessMsg));
+    if(intra_msg == NULL)
     {
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &w_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
+      PRINT_ERROR ( "deliverIntraProcessMsg() : Can't allocate memory\n" );
+      CROS_ATOMIC_FETCH_ADD_INT(&sub->n_intra_msgs, -1);
+      ret_err = cRosAddErrCodePackIfErr(ret_err, CROS_MEM_ALLOC_ERR);
+      continue;
     }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING)
+    intra_msg->msg = cRosSharedMessageRetain(s_msg);
+
+    cRosMpscQueuePush(&sub->intra_msgs, &intra_msg->link);
+    // Only the first message handed over since the subscriber node last attended the subscriber has to notify the node
+    if(CROS_ATOMIC_XCHG_INT(&sub->intra_pending, 1) == 0)
     {
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &r_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
+      cRosMpscQueuePush(&link->node->intra_subs, &sub->intra_link);
+      tcpIpSocketNotify(&link->node->wakeup_notifier);
     }
   }
+  cRosMutexUnlock(&n->pubs_lock);
+  cRosSharedMessageRelease(s_msg); // Now the message is only referenced by the subscribers
+  return ret_err;
+}
+
+// Called when the timer of a publisher expires: send a queued (immediate) message or a periodic message if it is time to
+static cRosErrCodePack triggerPublisherWriting( CrosNode *n, int pub_idx, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err;
+  PublisherNode *cur_pub = n->pubs[pub_idx];
 
-  /* Add to the tcpIpSocketSelect() the active TCPROS servers */
-  int next_tcpros_server_i = -1; // Index of the first server that is idle (ready to be activated). -1 = no one is idle
-  for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
+  pullPostedMsgs(cur_pub);
+  // Each process has its own queue, so the message is published as soon as there is at least one associated process
+  // (or subscriber in this process). Until then the timer is not rescheduled: cRosNodeWakeUpPublisher() is called when
+  // a subscriber connects (the subscribers in the process wake up the publisher through the posted_pubs queue)
+  if(cur_pub->topic_name == NULL || (cur_pub->tcpros_id_list[0] == -1 && CROS_ATOMIC_LOAD_INT(&cur_pub->n_intra_links) == 0))
+    return ret_err;
+
+  if((cur_pub->loop_period >= 0 && cur_pub->next_period_time <= cur_time) || cRosMessageQueueUsage(&cur_pub->msg_queue) > 0) // Is it time to publish a message (periodic or immediate)?
   {
-    int server_fd = tcpIpSocketGetFD( &(n->tcpros_server_proc[i].socket) );
+    int immediate_msg = (cRosMessageQueueUsage(&cur_pub->msg_queue) > 0);
+    if(!immediate_msg) // There is no immediate message waiting, so a periodic message must be sent
+      cur_pub->next_period_time = nextPeriodTime(cur_pub->next_period_time, cur_pub->loop_period, cur_time);
 
-    if( next_tcpros_server_i < 0 &&
-        n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_IDLE )
-    {
-      next_tcpros_server_i = i;
-    }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER )
-    {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
-    }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_START_WRITING ||
-             n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING )
+    // The next function will store the next message to be sent in cur_pub->context->outgoing
+    ret_err = cRosNodePublisherCallback(cur_pub->context); // Calls the publisher application-defined callback
+
+    // The subscribers in the process get the message itself instead of a frame. The fields of a queued message are moved
+    // to them unless the periodic callback of the publisher may use them later or they must be serialized for TCPROS
+    if(CROS_ATOMIC_LOAD_INT(&cur_pub->n_intra_links) > 0)
     {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      int move_msg = (immediate_msg && cur_pub->loop_period < 0 && cur_pub->tcpros_id_list[0] == -1);
+      ret_err = cRosAddErrCodePackIfErr(ret_err, deliverIntraProcessMsg(n, pub_idx, move_msg));
     }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING )
+
+    if(cur_pub->tcpros_id_list[0] != -1)
     {
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      // Serialize the message once: all the connections of this publisher send the same frame. The large arrays of
+      // a queued message are sent from its memory, unless the periodic callback of the publisher may use them later
+      TcprosFrame *frame;
+      cRosErrCodePack frame_err = cRosMessagePreparePublicationFrame( n, pub_idx, immediate_msg && cur_pub->loop_period < 0, &frame );
+      if(frame_err == CROS_SUCCESS_ERR_PACK)
+      {
+        cRosNodePublishFrame( n, pub_idx, frame );
+        tcprosFrameRelease( frame ); // The frame is now owned by the processes only
+      }
+      else
+      {
+        PRINT_ERROR("triggerPublisherWriting() : Error serializing the message of topic %s\n", cur_pub->topic_name);
+        ret_err = cRosAddErrCodePackIfErr(ret_err, frame_err);
+      }
     }
   }
 
-  /* If one TCPROS server is available at least, add to the tcpIpSocketSelect() the listener socket */
-  if( next_tcpros_server_i >= 0)
+  pullPostedMsgs(cur_pub); // Make room for the messages that did not fit in the queue
+  if(cur_pub->tcpros_id_list[0] != -1 || CROS_ATOMIC_LOAD_INT(&cur_pub->n_intra_links) > 0)
   {
-    if(tcpros_listner_fd != -1) // If the listener socket is still opened
-    {
-      FD_SET( tcpros_listner_fd, &r_fds);
-      FD_SET( tcpros_listner_fd, &err_fds);
-      if( tcpros_listner_fd > nfds ) nfds = tcpros_listner_fd;
-    }
+    int sched_ret = 0;
+    if(cRosMessageQueueUsage(&cur_pub->msg_queue) > 0) // A queued message is published in each loop cycle
+      sched_ret = rescheduleTimer(n, &cur_pub->timer, cur_time + 1, cur_time);
+    else if(cur_pub->loop_period >= 0)
+      sched_ret = rescheduleTimer(n, &cur_pub->timer, cur_pub->next_period_time, cur_time);
+    if(sched_ret != 0)
+      ret_err = cRosAddErrCodePackIfErr(ret_err, CROS_MEM_ALLOC_ERR);
   }
+  return(ret_err);
+}
 
+// Called when the timer of a service caller expires: make a queued (immediate) call or a periodic call if it is time to
+static cRosErrCodePack triggerServiceCallerWriting( CrosNode *n, int caller_idx, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err;
+  ServiceCallerNode *cur_caller = n->service_callers[caller_idx];
+  TcprosProcess *caller_proc;
 
-  /*
-   *
-   * RPCROS PROCESSES tcpIpSocketSelect() MANAGEMENT
-   *
-   */
+  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
+  if(cur_caller->service_name == NULL) // Is this caller active?
+    return ret_err;
+
+  // Check whether the corresponding process is ready to start making a new call. If it is not, the
+  // timer is not rescheduled: wakeUpServiceCaller() is called when the process finishes the current call
+  caller_proc = n->rpcros_client_proc[cur_caller->rpcros_id];
+  if(caller_proc->state != TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
+    return ret_err;
 
-  /* If active (not idle state), add to the tcpIpSocketSelect() the TCPROS clients */
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
+  if((cur_caller->loop_period >= 0 && cur_caller->next_period_time <= cur_time) || cRosMessageQueueUsage(&cur_caller->msg_queue) == 1) // Is it time to make a call (periodic or immediate)?
   {
-    int rpcros_client_fd;
+    if(cRosMessageQueueUsage(&cur_caller->msg_queue) == 0) // There is no immediate call waiting, so a periodic call will be made
+      cur_caller->next_period_time = nextPeriodTime(cur_caller->next_period_time, cur_caller->loop_period, cur_time);
 
-    rpcros_client_fd = tcpIpSocketGetFD( &(n->rpcros_client_proc[i].socket) );
-    if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_CONNECTING)
-    {
-      new_errors =  rpcrosClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+    // Now the service-call parameters are stored in cur_caller->context->outgoing
+    ret_err = cRosNodeServiceCallerCallback( 0, cur_caller->context); // calls the service-caller application-defined callback function to generate the service request
 
-      rpcros_client_fd = tcpIpSocketGetFD( &(n->rpcros_client_proc[i].socket) ); // update file descriptor after connecting
-      FD_SET( rpcros_client_fd, &w_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
-    }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING_HEADER ||
-       n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_START_WRITING ||
-       n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING)
-    {
-      FD_SET( rpcros_client_fd, &w_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
-    }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_SIZE ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING)
-    {
-      FD_SET( rpcros_client_fd, &r_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
-    }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
-    {
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
-    }
+    tcprosProcessChangeState( caller_proc, TCPROS_PROCESS_STATE_START_WRITING );
   }
+  else if(cur_caller->loop_period >= 0 && rescheduleTimer(n, &cur_caller->timer, cur_caller->next_period_time, cur_time) != 0)
+    ret_err = CROS_MEM_ALLOC_ERR;
 
+  return(ret_err);
+}
 
-  /* Add to the tcpIpSocketSelect() the active RPCROS servers */
-  int next_rpcros_server_i = -1;
+// Called when the timer of the master ping cycle expires: ping the ROS master and look up the pending services
+static cRosErrCodePack triggerXmlrpcMasterCycle( CrosNode *n, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  uint64_t wake_up_delay;
+  int i;
 
-  for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
+  XmlrpcProcess *rosproc = n->xmlrpc_client_proc[0];
+  PRINT_VDEBUG("triggerXmlrpcMasterCycle() : It is time to wake up the Master XML RPC process\n");
+  if(rosproc->state == XMLRPC_PROCESS_STATE_IDLE)
   {
-    int server_fd = tcpIpSocketGetFD( &(n->rpcros_server_proc[i].socket) );
+    // Prepare to ping roscore ...
+    PRINT_VDEBUG("triggerXmlrpcMasterCycle() : Sending ping to ROS Master\n");
 
-    if( next_rpcros_server_i < 0 &&
-        n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_IDLE )
-    {
-    	next_rpcros_server_i = i;
-    }
-    else if (n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_SIZE ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING)
+    RosApiCall *call = newRosApiCall();
+    if (call != NULL)
     {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      call->method = CROS_API_GET_PID;
+      int rc = xmlrpcParamVectorPushBackString(&call->params, n->name);
+      if(rc >= 0)
+      {
+        rosproc->message_type = XMLRPC_MESSAGE_REQUEST;
+        generateXmlrpcMessage( n->roscore_host, n->roscore_port, rosproc->message_type,
+                              getMethodName(call->method), &call->params, &rosproc->message );
+
+        rosproc->current_call = call;
+        xmlrpcProcessChangeState(rosproc, XMLRPC_PROCESS_STATE_CONNECTING );
+      }
+      else
+      {
+        PRINT_ERROR ( "triggerXmlrpcMasterCycle() : Can't allocate memory\n");
+        ret_err=CROS_MEM_ALLOC_ERR;
+      }
+
+      // The ROS master does not warn us when a new service is registered, so we have to
+      // continuously check for the required service
+      for(i = 0; i < n->rpcros_client_slots.n_slots; i++ )
+      {
+         TcprosProcess *client_proc = n->rpcros_client_proc[i];
+         if( client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_CONNECTING)
+         {
+           tcprosProcessChangeState(client_proc, TCPROS_PROCESS_STATE_IDLE);
+           enqueueServiceLookup(n, client_proc->service_idx);
+         }
+      }
+      wake_up_delay = CN_PING_LOOP_PERIOD; // The process completed doing what it should, so wake up again CN_PING_LOOP_PERIOD milliseconds later
     }
-    else if( n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING_HEADER ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING )
+    else
     {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      PRINT_ERROR ( "triggerXmlrpcMasterCycle() : Can't allocate memory\n");
+      ret_err=CROS_MEM_ALLOC_ERR;
+      wake_up_delay = CN_PING_LOOP_PERIOD/50;
     }
   }
+  else
+    wake_up_delay = CN_PING_LOOP_PERIOD/50; // The process is busy, so try to wake up again soon (CN_PING_LOOP_PERIOD/50 milliseconds later) to do what is pending
+
+  if(rescheduleTimer(n, &n->xmlrpc_master_timer, cur_time + CN_MSEC_TO_NSEC(wake_up_delay), cur_time) != 0)
+    ret_err = CROS_MEM_ALLOC_ERR;
+
+  return ret_err;
+}
+
+// Called periodically to close the connections whose I/O operations have not progressed in CN_IO_TIMEOUT
+static cRosErrCodePack checkIoTimeouts( CrosNode *n, uint64_t cur_time )
+{
+  uint64_t cur_time_ms = cRosClockGetTimeMs(); // last_change_time is updated when changing process state (in msec, since the Epoch)
+  int i;
+
+  XmlrpcProcess *rosproc = n->xmlrpc_client_proc[0];
+  if( rosproc->state != XMLRPC_PROCESS_STATE_IDLE && cur_time_ms - rosproc->last_change_time > CN_IO_TIMEOUT )
+  {
+    // Timeout between I/O operations... close the socket and re-advertise
+    PRINT_VDEBUG ( "checkIoTimeouts() : XMLRPC client I/O timeout\n");
+    handleXmlrpcClientError( n, 0 );
+  }
 
-  /* If one RPCROS server is available at least, add to the tcpIpSocketSelect() the listner socket */
-  if( next_rpcros_server_i >= 0)
+  for( i = 0; i < n->tcpros_server_slots.n_slots; i++ )
   {
-    if(rpcros_listner_fd != -1) // If the listener socket is still opened
+    if( (n->tcpros_server_proc[i]->state == TCPROS_PROCESS_STATE_READING_HEADER ||
+              n->tcpros_server_proc[i]->state == TCPROS_PROCESS_STATE_WRITING ) &&
+             cur_time_ms - n->tcpros_server_proc[i]->last_change_time > CN_IO_TIMEOUT )
     {
-      FD_SET( rpcros_listner_fd, &r_fds);
-      FD_SET( rpcros_listner_fd, &err_fds);
-      if( rpcros_listner_fd > nfds ) nfds = rpcros_listner_fd;
+      // Timeout between I/O operations
+      PRINT_VDEBUG ( "checkIoTimeouts() : TCPROS server I/O timeout\n");
+      handleTcprosServerError( n, i );
     }
   }
 
-  if (nfds + 1 == 0)
+  for( i = 0; i < n->rpcros_client_slots.n_slots; i++ )
   {
-    PRINT_VDEBUG("cRosNodeDoEventsLoop() : Warning: tcpIpSocketSelect() is being called with no file descriptors to monitor.\n");
+    if( (n->rpcros_client_proc[i]->state == TCPROS_PROCESS_STATE_READING_HEADER || // Add more states to the condition???
+              n->rpcros_client_proc[i]->state == TCPROS_PROCESS_STATE_WRITING ) &&
+             cur_time_ms - n->rpcros_client_proc[i]->last_change_time > CN_IO_TIMEOUT )
+    {
+      // Timeout between I/O operations
+      PRINT_VDEBUG ( "checkIoTimeouts() : RPCROS client I/O timeout\n");
+      handleRpcrosClientError( n, i );
+    }
   }
 
-  select_timeout = cRosNodeCalculateSelectTimeout(n, max_timeout);
+  releaseClosedZeroCopyFrames( n, 0 );
 
-  // The node waits here until the specified file descriptors become ready for the corresponding I/O operation or the timeout is up
-  // ------------------------------------------------------------------------------------------------------------------------------
-  int n_set = tcpIpSocketSelect(nfds + 1, &r_fds, &w_fds, &err_fds, select_timeout);
+  if(rescheduleTimer(n, &n->io_timeout_timer, cur_time + CN_MSEC_TO_NSEC(CN_IO_TIMEOUT_CHECK_PERIOD), cur_time) != 0)
+    return CROS_MEM_ALLOC_ERR;
 
-  cur_time = cRosClockGetTimeMs(); // Update current time after select()
-  if (n_set == -1)
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+// Attend the node timers that have expired. Only the expired timers are visited, so the cost does not
+// depend on the number of publishers and service callers that are waiting
+static cRosErrCodePack processExpiredTimers( CrosNode *n )
+{
+  cRosErrCodePack ret_err, new_errors;
+  uint64_t cur_time;
+  CrosTimer *timer;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  cur_time = cRosClockGetTimeNs();
+  while((timer = cRosTimerHeapPopExpired(&n->timers, cur_time)) != NULL)
   {
-    PRINT_ERROR("cRosNodeDoEventsLoop() : tcpIpSocketSelect() function failed.\n");
-    ret_err = CROS_SELECT_FD_ERR;
+    int idx = CN_EVENT_TAG_INDEX(timer->tag);
+    switch(CN_TIMER_TAG_SOURCE(timer->tag))
+    {
+      case CN_TIMER_PUBLISHER:
+        new_errors = triggerPublisherWriting(n, idx, cur_time);
+        break;
+      case CN_TIMER_SERVICE_CALLER:
+        new_errors = triggerServiceCallerWriting(n, idx, cur_time);
+        break;
+      case CN_TIMER_XMLRPC_MASTER:
+        new_errors = triggerXmlrpcMasterCycle(n, cur_time);
+        break;
+      case CN_TIMER_IO_TIMEOUT:
+        new_errors = checkIoTimeouts(n, cur_time);
+        break;
+      default:
+        PRINT_ERROR("processExpiredTimers() : Unknown timer tag: %X\n", (unsigned int)timer->tag);
+        new_errors = CROS_SUCCESS_ERR_PACK;
+        break;
+    }
+    ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
   }
-  else if( n_set == 0 )
-  {
-    PRINT_VDEBUG ("cRosNodeDoEventsLoop() : tcpIpSocketSelect() finished due to timeout (parameter: %llu ms) or it was interrupted\n", (long long unsigned)select_timeout);
+  return(ret_err);
+}
 
-    XmlrpcProcess *rosproc = &n->xmlrpc_client_proc[0];
-    if(n->xmlrpc_master_wake_up_time <= cur_time ) // It's time to wakeup, ping master, and maybe look up in master for pending services
-    {
-      PRINT_VDEBUG("cRosNodeDoEventsLoop() : It is ime to wake up the Master XML RPC process. Current time: %lu Wake up time: %lu\n", cur_time, n->xmlrpc_master_wake_up_time);
-      if(rosproc->state == XMLRPC_PROCESS_STATE_IDLE)
-      {
-        // Prepare to ping roscore ...
-        PRINT_VDEBUG("cRosNodeDoEventsLoop() : Sending ping to ROS Master\n");
+// Append a process state (one hexadecimal digit) to the node status string
+static void pushBackProcState( DynString *stat_str, int state )
+{
+  dynStringPushBackChar(stat_str, "0123456789ABCDEF"[state & 0xF]);
+}
 
-        RosApiCall *call = newRosApiCall();
-        if (call != NULL)
-        {
-          call->method = CROS_API_GET_PID;
-          int rc = xmlrpcParamVectorPushBackString(&call->params, n->name);
-          if(rc >= 0)
-          {
-            rosproc->message_type = XMLRPC_MESSAGE_REQUEST;
-            generateXmlrpcMessage( n->roscore_host, n->roscore_port, rosproc->message_type,
-                                  getMethodName(call->method), &call->params, &rosproc->message );
+void printNodeProcState( CrosNode *n )
+{
+  static DynString prev_stat_str; // Zero-initialized, which is equivalent to dynStringInit()
+  DynString stat_str; // The string length depends on the current size of the node tables
+  int i;
 
-            rosproc->current_call = call;
-            xmlrpcProcessChangeState(rosproc, XMLRPC_PROCESS_STATE_CONNECTING );
-          }
-          else
-          {
-            PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
-            ret_err=CROS_MEM_ALLOC_ERR;
-          }
+  dynStringInit(&stat_str);
 
-          // The ROS master does not warn us when a new service is registered, so we have to
-          // continuously check for the required service
-          for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
-          {
-             TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
-             if( client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_CONNECTING)
-             {
-               tcprosProcessChangeState(client_proc, TCPROS_PROCESS_STATE_IDLE);
-               enqueueServiceLookup(n, client_proc->service_idx);
-             }
-          }
-          n->xmlrpc_master_wake_up_time = cur_time + CN_PING_LOOP_PERIOD; // The process completed doing what it should, so wake up again CN_PING_LOOP_PERIOD milliseconds later
-        }
-        else
-        {
-          PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
-          ret_err=CROS_MEM_ALLOC_ERR;
-        }
-      }
-      else
-        n->xmlrpc_master_wake_up_time = cur_time + CN_PING_LOOP_PERIOD/50; // The process is busy, so try to wake up again soon (CN_PING_LOOP_PERIOD/50 milliseconds later) to do what is pending
-    }
-    if( rosproc->state != XMLRPC_PROCESS_STATE_IDLE && cRosClockGetTimeMs() - rosproc->last_change_time > CN_IO_TIMEOUT ) // last_change_time is updated when changing process state
-    {
-      // Timeout between I/O operations... close the socket and re-advertise
-      PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : XMLRPC client I/O timeout\n");
-      handleXmlrpcClientError( n, 0 );
-    }
+  dynStringPushBackStr(&stat_str, "XL");
+  pushBackProcState(&stat_str, n->xmlrpc_listner_proc.state);
+  dynStringPushBackStr(&stat_str, " XC");
+  for(i = 0; i < n->xmlrpc_client_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->xmlrpc_client_proc[i]->state);
 
+  dynStringPushBackStr(&stat_str, " XS");
+  for( i = 0; i < n->xmlrpc_server_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->xmlrpc_server_proc[i]->state);
 
-    for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS && ret_err==CROS_SUCCESS_ERR_PACK; i++ )
-    {
-      if( (n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-                n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
-               cur_time - n->tcpros_server_proc[i].last_change_time > CN_IO_TIMEOUT )
-      {
-        // Timeout between I/O operations
-        PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : TCPROS server I/O timeout\n");
-        handleTcprosServerError( n, i );
-      }
-    }
+  dynStringPushBackStr(&stat_str, " TL");
+  pushBackProcState(&stat_str, n->tcpros_listner_proc.state);
+  dynStringPushBackStr(&stat_str, " TC");
+  for(i = 0; i < n->tcpros_client_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->tcpros_client_proc[i]->state);
 
-    for( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS && ret_err==CROS_SUCCESS_ERR_PACK; i++ )
-    {
-      if( (n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER || // Add more states to the condition???
-                n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
-               cur_time - n->rpcros_client_proc[i].last_change_time > CN_IO_TIMEOUT )
-      {
-        // Timeout between I/O operations
-        PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : TCPROS server I/O timeout\n");
-        handleTcprosServerError( n, i );
-      }
-    }
+  dynStringPushBackStr(&stat_str, " TS");
+  for( i = 0; i < n->tcpros_server_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->tcpros_server_proc[i]->state);
+
+  dynStringPushBackStr(&stat_str, " RL");
+  pushBackProcState(&stat_str, n->rpcros_listner_proc.state);
+  dynStringPushBackStr(&stat_str, " RC");
+  for(i = 0; i < n->rpcros_client_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->rpcros_client_proc[i]->state);
+
+  dynStringPushBackStr(&stat_str, " RS");
+  for( i = 0; i < n->rpcros_server_slots.n_slots; i++ )
+    pushBackProcState(&stat_str, n->rpcros_server_proc[i]->state);
+
+  if (dynStringGetLen(&prev_stat_str) == 0 || strcmp(dynStringGetData(&prev_stat_str), dynStringGetData(&stat_str)) != 0) // If the node status has changed:
+  {
+    // Print a compact string indicating the state of all the node processed for debug purposes
+    PRINT_DEBUG("Node status: %s\n", dynStringGetData(&stat_str));
+    dynStringRelease(&prev_stat_str);
+    prev_stat_str = stat_str; // Keep the current string buffer for the next comparison
   }
   else
+    dynStringRelease(&stat_str);
+}
+
+// Calculate the time (in ns) that the node can wait for socket events. max_timeout is expressed in msec
+uint64_t cRosNodeCalculateSelectTimeout(CrosNode *n, uint64_t max_timeout)
+{
+  uint64_t wakeup_timeout, select_timeout, cur_time;
+  CrosTimer *next_timer;
+  int k;
+
+  select_timeout = (max_timeout > UINT64_MAX / CN_MSEC_TO_NSEC(1))? UINT64_MAX : CN_MSEC_TO_NSEC(max_timeout);
+
+  next_timer = cRosTimerHeapPeek(&n->timers); // The node timer that expires first
+  if(next_timer != NULL)
   {
-    PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : tcpIpSocketSelect() finished with num. fd set: %i (timeout parameter was: %llu ms)\n", n_set, (long long unsigned)select_timeout);
-    for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++ )
-    {
-      XmlrpcProcess *client_proc;
-      int xmlrpc_client_fd;
+    cur_time = cRosClockGetTimeNs();
+    if( next_timer->expiry > cur_time )
+      wakeup_timeout = next_timer->expiry - cur_time;
+    else
+      wakeup_timeout = 0;
 
-      client_proc = &n->xmlrpc_client_proc[i];
-      xmlrpc_client_fd = tcpIpSocketGetFD( &client_proc->socket );
-      if( client_proc->state != XMLRPC_PROCESS_STATE_IDLE && FD_ISSET(xmlrpc_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
-        handleXmlrpcClientError( n, i );
-      }
-      /* Check what is the socket unblocked by tcpIpSocketSelect(), and start the requested operations */
-      else if( ( client_proc->state == XMLRPC_PROCESS_STATE_CONNECTING && FD_ISSET(xmlrpc_client_fd, &w_fds) ) ||
-          ( client_proc->state == XMLRPC_PROCESS_STATE_WRITING && FD_ISSET(xmlrpc_client_fd, &w_fds) ) ||
-          ( client_proc->state == XMLRPC_PROCESS_STATE_READING && FD_ISSET(xmlrpc_client_fd, &r_fds) ) )
-      {
-        new_errors = doWithXmlrpcClientSocket( n, i );;
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+    if( wakeup_timeout < select_timeout )
+      select_timeout = wakeup_timeout;
+  }
 
-    if ( next_xmlrpc_server_i >= 0 && xmlrpc_listner_fd != -1) // Check that there is an available free (idle) xmlrpx process and that the listener socket is still open
-    {
-      if( FD_ISSET( xmlrpc_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket error\n" );
-      }
-      else if( FD_ISSET( xmlrpc_listner_fd, &r_fds) )
-      {
-        PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket ready\n" );
-        if( tcpIpSocketAccept( &(n->xmlrpc_listner_proc.socket),
-            &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket ) ) )
+  // Only the subscriber connections stored by dispatchTcprosClientMsgs() can have received messages waiting to be dispatched
+  for (k = 0;k < n->tcpros_client_pending.n_slots && select_timeout > 0;k++)
+  {
+    TcprosProcess *client_proc = n->tcpros_client_proc[n->tcpros_client_pending.slots[k]];
+    if((client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE || client_proc->state == TCPROS_PROCESS_STATE_READING) &&
+       tcprosClientHasBufferedMsg(client_proc) && !tcprosClientIsBlocked(n, client_proc))
+      select_timeout = 0;
+  }
 
-          xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]), XMLRPC_PROCESS_STATE_READING );
-      }
-    }
+  return(select_timeout);
+}
+
+cRosErrCodePack cRosNodeDoEventsLoop( CrosNode *n, uint64_t max_timeout )
+{
+  cRosErrCodePack ret_err, new_errors;
+  uint64_t select_timeout;
+  CrosEvent *events;
+  int i, k, n_pending, ev_idx;
+
+  PRINT_VVDEBUG ( "cRosNodeDoEventsLoop ()\n" );
+
+  if(n == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  #if CROS_DEBUG_LEVEL >= 2
+  PRINT_DEBUG("*");
+  FLUSH_PRINT();
+  printNodeProcState( n );
+  #endif
+
+  // Messages posted from other threads since the previous cycle
+  ret_err = processPostedMsgs( n );
+  // Messages handed over by publishers in the process since the previous cycle
+  new_errors = processIntraProcessMsgs( n );
+  ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+  // Service responses generated by the worker pool since the previous cycle
+  processFinishedServiceWorks( n );
 
-    for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
+  // Publishers, service callers, master ping cycle and I/O timeout check
+  new_errors = processExpiredTimers( n );
+  ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+
+  XmlrpcProcess *coreproc = n->xmlrpc_client_proc[0];
+  if (coreproc->state == XMLRPC_PROCESS_STATE_IDLE && !isQueueEmpty(&n->master_api_queue))
+  {
+    RosApiCall *call = dequeueApiCall(&n->master_api_queue);
+    coreproc->current_call = call;
+    xmlrpcProcessChangeState( coreproc, XMLRPC_PROCESS_STATE_CONNECTING );
+  }
+
+  // Each slave API call is assigned to an idle XMLRPC client (a new client is created if all of them are busy)
+  while (!isQueueEmpty(&n->slave_api_queue))
+  {
+    int idle_client_idx = peekIdleXmlrpcProcess( n, &n->xmlrpc_client_proc, &n->xmlrpc_client_slots, CN_EVENT_XMLRPC_CLIENT );
+    if (idle_client_idx == -1)
     {
-      XmlrpcProcess *server_proc;
-      int server_fd;
+      ret_err = cRosAddErrCodePackIfErr(ret_err, CROS_MEM_ALLOC_ERR);
+      break;
+    }
 
-      server_proc = &n->xmlrpc_server_proc[i];
-      server_fd = tcpIpSocketGetFD( &server_proc->socket );
-      if( server_proc->state != XMLRPC_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server socket error\n" );
-        tcpIpSocketClose( &(n->xmlrpc_server_proc[i].socket) );
-        xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]), XMLRPC_PROCESS_STATE_IDLE ); // maybe server_proc instead of &(n->xmlrpc_server_proc[next_xmlrpc_server_i]) ???
-      }
-      else if( ( server_proc->state == XMLRPC_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) ||
-               ( server_proc->state == XMLRPC_PROCESS_STATE_READING && FD_ISSET(server_fd, &r_fds) ) )
-      {
-        new_errors = doWithXmlrpcServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
+    RosApiCall *call = dequeueApiCall(&n->slave_api_queue);
+
+    XmlrpcProcess *proc =  n->xmlrpc_client_proc[idle_client_idx];
+    proc->current_call = call;
+    xmlrpcProcessChangeState( proc, XMLRPC_PROCESS_STATE_CONNECTING );
+  }
+
+  /*
+   * The sockets of the processes are registered in the event backend when the processes change
+   * their state (see tcprosProcessUpdateEvents() and xmlrpcProcessUpdateEvents()), so here we only
+   * have to start the connections of the processes that entered the connecting state since the previous cycle.
+   * A connection completion is acknowledged by the backend through the write-ready event.
+   * The processes that enter the connecting state again while they are attended are stored after n_pending
+   */
+  n_pending = n->xmlrpc_client_connects.n_slots;
+  for(k = 0; k < n_pending; k++)
+  {
+    i = n->xmlrpc_client_connects.slots[k];
+    n->xmlrpc_client_proc[i]->in_connect_slots = 0;
+    if( n->xmlrpc_client_proc[i]->state == XMLRPC_PROCESS_STATE_CONNECTING )
+    {
+      new_errors = xmlrpcClientConnect(n, i);
+      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+      xmlrpcProcessUpdateEvents( n->xmlrpc_client_proc[i] ); // The socket may have been (re)opened
     }
+  }
+  cRosSlotListConsume( &n->xmlrpc_client_connects, n_pending );
 
-    for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++ )
+  n_pending = n->tcpros_client_connects.n_slots;
+  for(k = 0; k < n_pending; k++)
+  {
+    i = n->tcpros_client_connects.slots[k];
+    n->tcpros_client_proc[i]->in_connect_slots = 0;
+    if( n->tcpros_client_proc[i]->state == TCPROS_PROCESS_STATE_CONNECTING )
     {
-      TcprosProcess *client_proc = &(n->tcpros_client_proc[i]);
-      int tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
+      new_errors = tcprosClientConnect(n, i);
+      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+      tcprosProcessUpdateEvents( n->tcpros_client_proc[i] );
+    }
+  }
+  cRosSlotListConsume( &n->tcpros_client_connects, n_pending );
 
-      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(tcpros_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
-        handleTcprosClientError( n, i );
-      }
+  // Dispatch the received messages that were left in the buffers of the subscriber connections in the previous cycle
+  // and resume reading the connections whose subscriber queue is not full anymore
+  n_pending = n->tcpros_client_pending.n_slots;
+  for(k = 0; k < n_pending; k++)
+  {
+    TcprosProcess *client_proc;
 
-      if( (client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && FD_ISSET(tcpros_client_fd, &w_fds) ) || // tcpIpSocketSelect() indicates connection completion through write-fd
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(tcpros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(tcpros_client_fd, &r_fds) ) )
-      {
-        new_errors = doWithTcprosClientSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
+    i = n->tcpros_client_pending.slots[k];
+    client_proc = n->tcpros_client_proc[i];
+    client_proc->in_pending_slots = 0;
+    if( client_proc->state != TCPROS_PROCESS_STATE_READING_SIZE && client_proc->state != TCPROS_PROCESS_STATE_READING )
+      continue;
+
+    // The connections that still cannot be attended are stored again by dispatchTcprosClientMsgs()
+    new_errors = dispatchTcprosClientMsgs(n, i);
+    ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+  }
+  cRosSlotListConsume( &n->tcpros_client_pending, n_pending );
+
+  n_pending = n->rpcros_client_connects.n_slots;
+  for(k = 0; k < n_pending; k++)
+  {
+    i = n->rpcros_client_connects.slots[k];
+    n->rpcros_client_proc[i]->in_connect_slots = 0;
+    if( n->rpcros_client_proc[i]->state == TCPROS_PROCESS_STATE_CONNECTING )
+    {
+      new_errors = rpcrosClientConnect(n, i);
+      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+      tcprosProcessUpdateEvents( n->rpcros_client_proc[i] );
     }
+  }
+  cRosSlotListConsume( &n->rpcros_client_connects, n_pending );
+
+  if( reserveReadyEvents( n ) != 0 )
+    return cRosAddErrCodePackIfErr(ret_err, CROS_MEM_ALLOC_ERR);
+  events = n->ready_events;
+
+  select_timeout = cRosNodeCalculateSelectTimeout(n, max_timeout);
+
+  // The node waits here until the monitored sockets become ready for the corresponding I/O operation or the timeout is up
+  // ---------------------------------------------------------------------------------------------------------------------
+  int n_set = cRosEventBackendWait(&(n->event_backend), events, n->max_ready_events, select_timeout);
 
-    if ( next_tcpros_server_i >= 0 && tcpros_listner_fd != -1)
+  if (n_set == -1)
+  {
+    PRINT_ERROR("cRosNodeDoEventsLoop() : cRosEventBackendWait() function failed.\n");
+    ret_err = CROS_SELECT_FD_ERR;
+  }
+  else if( n_set == 0 )
+  {
+    // The expired timers are attended in the next call to this function
+    PRINT_VDEBUG ("cRosNodeDoEventsLoop() : cRosEventBackendWait() finished due to timeout (parameter: %llu ns) or it was interrupted\n", (long long unsigned)select_timeout);
+  }
+  else
+  {
+    PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : cRosEventBackendWait() finished with num. ready sockets: %i (timeout parameter was: %llu ns)\n", n_set, (long long unsigned)select_timeout);
+
+    // Only the processes whose sockets are ready are attended
+    for(ev_idx = 0; ev_idx < n_set; ev_idx++)
     {
-      if( FD_ISSET( tcpros_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
-      }
-      else if( FD_ISSET( tcpros_listner_fd, &r_fds) )
+      unsigned int ready = events[ev_idx].events;
+      i = CN_EVENT_TAG_INDEX(events[ev_idx].tag);
+
+      switch(CN_EVENT_TAG_SOURCE(events[ev_idx].tag))
       {
-        PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : TCPROS listener ready\n" );
-        if( tcpIpSocketAccept( &(n->tcpros_listner_proc.socket),
-            &(n->tcpros_server_proc[next_tcpros_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->tcpros_server_proc[next_tcpros_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->tcpros_server_proc[next_tcpros_server_i].socket ) ) &&
-            tcpIpSocketSetKeepAlive( &(n->tcpros_server_proc[next_tcpros_server_i].socket ), 60, 10, 9 ) )
+        case CN_EVENT_XMLRPC_CLIENT:
+        {
+          XmlrpcProcess *client_proc = n->xmlrpc_client_proc[i];
+
+          if( client_proc->state != XMLRPC_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
+            handleXmlrpcClientError( n, i );
+          }
+          /* Check what is the socket unblocked by the event backend, and start the requested operations */
+          else if( ( client_proc->state == XMLRPC_PROCESS_STATE_CONNECTING && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == XMLRPC_PROCESS_STATE_WRITING && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == XMLRPC_PROCESS_STATE_READING && (ready & CROS_EVENT_READ) ) )
+          {
+            new_errors = doWithXmlrpcClientSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
+        }
+        case CN_EVENT_XMLRPC_LISTENER:
+        {
+          // Idle process that will attend the new connection
+          int next_xmlrpc_server_i = peekIdleXmlrpcProcess( n, &n->xmlrpc_server_proc, &n->xmlrpc_server_slots, CN_EVENT_XMLRPC_SERVER );
+          if ( next_xmlrpc_server_i < 0 )
+            break;
+
+          if( ready & CROS_EVENT_EXCEPT )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket error\n" );
+          }
+          else if( ready & CROS_EVENT_READ )
+          {
+            PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket ready\n" );
+            if( tcpIpSocketAccept( &(n->xmlrpc_listner_proc.socket),
+                &(n->xmlrpc_server_proc[next_xmlrpc_server_i]->socket) ) == TCPIPSOCKET_DONE &&
+                tcpIpSocketSetReuse( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]->socket) ) &&
+                tcpIpSocketSetNonBlocking( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]->socket ) ) )
+
+              xmlrpcProcessChangeState( n->xmlrpc_server_proc[next_xmlrpc_server_i], XMLRPC_PROCESS_STATE_READING );
+          }
+          break;
+        }
+        case CN_EVENT_XMLRPC_SERVER:
+        {
+          XmlrpcProcess *server_proc = n->xmlrpc_server_proc[i];
+
+          if( server_proc->state != XMLRPC_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server socket error\n" );
+            tcpIpSocketClose( &(server_proc->socket) );
+            xmlrpcProcessChangeState( server_proc, XMLRPC_PROCESS_STATE_IDLE );
+          }
+          else if( ( server_proc->state == XMLRPC_PROCESS_STATE_WRITING && (ready & CROS_EVENT_WRITE) ) ||
+                   ( server_proc->state == XMLRPC_PROCESS_STATE_READING && (ready & CROS_EVENT_READ) ) )
+          {
+            new_errors = doWithXmlrpcServerSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
+        }
+        case CN_EVENT_TCPROS_CLIENT:
         {
-          tcprosProcessChangeState( &(n->tcpros_server_proc[next_tcpros_server_i]), TCPROS_PROCESS_STATE_READING_HEADER ); // A TCPROS process has been activated to attend the connection
+          TcprosProcess *client_proc = n->tcpros_client_proc[i];
+
+          if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS client socket error\n" );
+            handleTcprosClientError( n, i );
+          }
+
+          if( (client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && (ready & CROS_EVENT_WRITE) ) || // The event backend indicates connection completion through write readiness
+              ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (ready & CROS_EVENT_READ) ) )
+          {
+            new_errors = doWithTcprosClientSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
         }
+        case CN_EVENT_TCPROS_LISTENER:
+        {
+          int next_tcpros_server_i = peekIdleTcprosProcess( n, &n->tcpros_server_proc, &n->tcpros_server_slots, CN_EVENT_TCPROS_SERVER );
+          if ( next_tcpros_server_i < 0 )
+            break;
+
+          if( ready & CROS_EVENT_EXCEPT )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
+          }
+          else if( ready & CROS_EVENT_READ )
+          {
+            PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : TCPROS listener ready\n" );
+            if( tcpIpSocketAccept( &(n->tcpros_listner_proc.socket),
+                &(n->tcpros_server_proc[next_tcpros_server_i]->socket) ) == TCPIPSOCKET_DONE &&
+                tcpIpSocketSetReuse( &(n->tcpros_server_proc[next_tcpros_server_i]->socket) ) &&
+                tcpIpSocketSetNonBlocking( &(n->tcpros_server_proc[next_tcpros_server_i]->socket ) ) &&
+                tcpIpSocketSetKeepAlive( &(n->tcpros_server_proc[next_tcpros_server_i]->socket ), 60, 10, 9 ) )
+            {
+              tcprosProcessChangeState( n->tcpros_server_proc[next_tcpros_server_i], TCPROS_PROCESS_STATE_READING_HEADER ); // A TCPROS process has been activated to attend the connection
+            }
+          }
+          break;
+        }
+        case CN_EVENT_TCPROS_SERVER:
+        {
+          TcprosProcess *server_proc = n->tcpros_server_proc[i];
+
+          // The zero-copy completion notifications are reported by the event backend as socket errors
+          if( server_proc->socket.zerocopy && tcprosProcessReleaseZeroCopyFrames( server_proc ) > 0 )
+            ready &= ~CROS_EVENT_EXCEPT;
+
+          if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
+            handleTcprosServerError( n, i );
+          }
+          else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (ready & CROS_EVENT_READ) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_START_WRITING && (ready & CROS_EVENT_WRITE) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && (ready & CROS_EVENT_WRITE) ) )
+          {
+            new_errors = doWithTcprosServerSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
+        }
+        case CN_EVENT_RPCROS_CLIENT:
+        {
+          TcprosProcess *client_proc = n->rpcros_client_proc[i];
+
+          if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS client socket error\n" );
+            handleRpcrosClientError( n, i );
+          }
+
+          if( ( client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (ready & CROS_EVENT_READ) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_START_WRITING && (ready & CROS_EVENT_WRITE) ) ||
+              ( client_proc->state == TCPROS_PROCESS_STATE_WRITING && (ready & CROS_EVENT_WRITE) ) )
+          {
+            new_errors = doWithRpcrosClientSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
+        }
+        case CN_EVENT_RPCROS_LISTENER:
+        {
+          int next_rpcros_server_i = peekIdleTcprosProcess( n, &n->rpcros_server_proc, &n->rpcros_server_slots, CN_EVENT_RPCROS_SERVER );
+          if ( next_rpcros_server_i < 0 )
+            break;
+
+          if( ready & CROS_EVENT_EXCEPT )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS listener-socket error\n" );
+          }
+          else if( ready & CROS_EVENT_READ )
+          {
+            PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : RPCROS listener ready\n" );
+            if( tcpIpSocketAccept( &(n->rpcros_listner_proc.socket),
+                &(n->rpcros_server_proc[next_rpcros_server_i]->socket) ) == TCPIPSOCKET_DONE &&
+                tcpIpSocketSetReuse( &(n->rpcros_server_proc[next_rpcros_server_i]->socket) ) &&
+                tcpIpSocketSetNonBlocking( &(n->rpcros_server_proc[next_rpcros_server_i]->socket ) ) &&
+                tcpIpSocketSetKeepAlive( &(n->rpcros_server_proc[next_rpcros_server_i]->socket ), 60, 10, 9 ) )
+            {
+              tcprosProcessChangeState( n->rpcros_server_proc[next_rpcros_server_i], TCPROS_PROCESS_STATE_READING_HEADER_SIZE );
+            }
+          }
+          break;
+        }
+        case CN_EVENT_RPCROS_SERVER:
+        {
+          TcprosProcess *server_proc = n->rpcros_server_proc[i];
+
+          if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && (ready & CROS_EVENT_EXCEPT) )
+          {
+            PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS server socket error\n" );
+            handleRpcrosServerError( n, i );
+          }
+          else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (ready & CROS_EVENT_READ) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (ready & CROS_EVENT_READ) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (ready & CROS_EVENT_READ) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_READING && (ready & CROS_EVENT_READ) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (ready & CROS_EVENT_WRITE) ) ||
+            ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && (ready & CROS_EVENT_WRITE) ) )
+          {
+            new_errors = doWithRpcrosServerSocket( n, i );
+            ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          }
+          break;
+        }
+        case CN_EVENT_WAKEUP:
+        {
+          // The notifications are consumed before attending the publishers, so no posted message is missed
+          tcpIpSocketClearNotifications( &(n->wakeup_notifier) );
+          new_errors = processPostedMsgs( n );
+          ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          new_errors = processIntraProcessMsgs( n );
+          ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+          processFinishedServiceWorks( n );
+          break;
+        }
+        case CN_EVENT_WAIT_FD:
+        {
+          // The descriptors of a wait set are only monitored while cRosWaitSetWait() runs the node
+          if( n->waiting_set != NULL && i < n->waiting_set->n_members )
+            n->waiting_set->members[i].ready = 1;
+          break;
+        }
+        default:
+          PRINT_ERROR ( "cRosNodeDoEventsLoop() : Unknown event source in tag %X\n", events[ev_idx].tag );
       }
     }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeStart( CrosNode *n, unsigned long time_out, unsigned char *exit_flag )
+{
+  uint64_t start_time, elapsed_time;
+  cRosErrCodePack ret_err;
+  PRINT_VVDEBUG ( "cRosNodeStart ()\n" );
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  while(ret_err == CROS_SUCCESS_ERR_PACK && (exit_flag==NULL || !(*exit_flag)) && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+    ret_err = cRosNodeDoEventsLoop( n, (time_out == CROS_INFINITE_TIMEOUT)? UINT64_MAX : time_out-elapsed_time);
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeReceiveTopicMsg( CrosNode *node, int subidx, cRosMessage *msg, unsigned char *buff_overflow, unsigned long time_out )
+{
+  cRosErrCodePack ret_err;
+  SubscriberNode *subs_node;
+  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  PRINT_VVDEBUG ( "cRosNodeReceiveTopicMsg ()\n" );
+
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
+
+  subs_node = node->subs[subidx];
+  if(subs_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(buff_overflow != NULL)
+    *buff_overflow = subs_node->msg_queue_overflow;
+  subs_node->msg_queue_overflow = 0; // Reset overflow flag
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
+  // While the buffer is empty and the timeout is not reached wait
+  while(cRosMessageQueueUsage(&subs_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+  {
+    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+  }
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    if(cRosMessageQueueUsage(&subs_node->msg_queue) > 0) // If no error and there is at least one message in the queue, get the message
+      ret_err = (cRosMessageQueueExtractMove(&subs_node->msg_queue, msg) == 0)? CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+    else
+      ret_err = CROS_RCV_TOP_TIMEOUT_ERR;
+  }
+  return ret_err;
+}
 
-    for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+cRosErrCodePack cRosNodeReceiveTopicMsgs( CrosNode *node, int subidx, cRosMessage **msgs, int max_msgs, int min_msgs, int *n_msgs, unsigned char *buff_overflow, unsigned long time_out )
+{
+  cRosErrCodePack ret_err;
+  SubscriberNode *subs_node;
+  unsigned int min_usage;
+  int n_extracted;
+  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  PRINT_VVDEBUG ( "cRosNodeReceiveTopicMsgs ()\n" );
+
+  if(n_msgs != NULL)
+    *n_msgs = 0;
+
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots || msgs == NULL || max_msgs < 1 || min_msgs < 0 || min_msgs > max_msgs)
+    return CROS_BAD_PARAM_ERR;
+
+  subs_node = node->subs[subidx];
+  if(subs_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(buff_overflow != NULL)
+    *buff_overflow = subs_node->msg_queue_overflow;
+  subs_node->msg_queue_overflow = 0; // Reset overflow flag
+
+  // The queue cannot hold more messages than its capacity, so waiting for more would always end in a timeout
+  min_usage = (unsigned int)min_msgs;
+  if(min_usage > cRosMessageQueueCapacity(&subs_node->msg_queue))
+    min_usage = cRosMessageQueueCapacity(&subs_node->msg_queue);
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
+  // While the buffer does not hold min_msgs messages and the timeout is not reached wait
+  while(cRosMessageQueueUsage(&subs_node->msg_queue) < min_usage && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+  {
+    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+  }
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  // Each message takes the fields of a queue slot in exchange for its own ones, so no message is copied
+  for(n_extracted = 0; n_extracted < max_msgs && cRosMessageQueueUsage(&subs_node->msg_queue) > 0; n_extracted++)
+  {
+    if(cRosMessageQueueExtractMove(&subs_node->msg_queue, msgs[n_extracted]) != 0)
     {
-      TcprosProcess *server_proc;
-      int server_fd;
+      ret_err = CROS_MEM_ALLOC_ERR;
+      break;
+    }
+  }
+  if(n_msgs != NULL)
+    *n_msgs = n_extracted;
 
-      server_proc = &n->tcpros_server_proc[i];
-      server_fd = tcpIpSocketGetFD( &server_proc->socket );
-      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
-        tcpIpSocketClose( &(server_proc->socket) );
-        tcprosProcessChangeState( &(n->tcpros_server_proc[next_tcpros_server_i]), TCPROS_PROCESS_STATE_IDLE );
-      }
-      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_START_WRITING && FD_ISSET(server_fd, &w_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) )
-      {
-        new_errors = doWithTcprosServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
+  if(ret_err == CROS_SUCCESS_ERR_PACK && n_extracted < (int)min_usage)
+    ret_err = CROS_RCV_TOP_TIMEOUT_ERR;
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeQueueTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg )
+{
+  cRosErrCodePack ret_err;
+  PublisherNode *pub_node;
+
+  pub_node = node->pubs[pubidx];
+  {
+    if(cRosMessageQueueVacancies(&pub_node->msg_queue) > 0) // If no error and there is space in the queue, put the new message
+    {
+      if(cRosMessageQueueAdd(&pub_node->msg_queue, msg) == 0 && cRosNodeWakeUpPublisher(node, pubidx) == 0)
+        ret_err = CROS_SUCCESS_ERR_PACK;
+      else
+        ret_err = CROS_MEM_ALLOC_ERR;
     }
+    else
+      ret_err = CROS_SEND_TOP_TIMEOUT_ERR;
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodePostTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg )
+{
+  cRosErrCodePack ret_err;
+  CrosPostTable *post_table;
+  PublisherNode *pub_node;
+  CrosPostedMsg *posted;
 
-    for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
+  if(node == NULL || pubidx < 0 || msg == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  // The message is copied before the publisher is looked up, so the node thread never waits for the copy
+  posted = (CrosPostedMsg *)malloc(sizeof(CrosPostedMsg));
+  if(posted != NULL)
+    posted->msg = cRosMessageCopyWithoutDef(msg);
+  if(posted == NULL || posted->msg == NULL)
+  {
+    PRINT_ERROR ( "cRosNodePostTopicMsg() : Can't allocate memory\n" );
+    free(posted);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  // The node thread can enlarge the table of publishers or release this publisher meanwhile, so the publisher is
+  // found through the post table and it is only used while it is open and this thread is counted as one of its users
+  post_table = (CrosPostTable *)CROS_ATOMIC_LOAD_PTR(&node->post_table);
+  if(post_table == NULL || pubidx >= CROS_ATOMIC_LOAD_INT(&post_table->n_pubs))
+    ret_err = CROS_TOPIC_PUB_IND_ERR;
+  else
+  {
+    pub_node = post_table->pubs[pubidx];
+    CROS_ATOMIC_FETCH_ADD_INT(&pub_node->n_post_users, 1);
+    // Read-modify-write operations are ordered with the ones of closePublisherPosting()
+    if(CROS_ATOMIC_FETCH_ADD_INT(&pub_node->post_open, 0) == 0)
+      ret_err = CROS_TOPIC_PUB_IND_ERR;
+    // The counter bounds the memory used by the posted messages when the node cannot send them
+    else if(CROS_ATOMIC_FETCH_ADD_INT(&pub_node->n_posted_msgs, 1) < CN_PUBLISHER_POST_QUEUE_SIZE)
+    {
+      cRosMpscQueuePush(&pub_node->posted_msgs, &posted->link);
+      posted = NULL;
+      notifyPostedPublisher(node, pub_node);
+      ret_err = CROS_SUCCESS_ERR_PACK;
+    }
+    else
     {
-      TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
-      int rpcros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
+      CROS_ATOMIC_FETCH_ADD_INT(&pub_node->n_posted_msgs, -1);
+      ret_err = CROS_POST_QUEUE_FULL_ERR;
+    }
+    CROS_ATOMIC_FETCH_ADD_INT(&pub_node->n_post_users, -1);
+  }
+
+  if(posted != NULL) // The message was not posted
+  {
+    cRosMessageFree(posted->msg);
+    free(posted);
+  }
+  return ret_err;
+}
+
+static void releaseCallbackStrands( CrosNode *node )
+{
+  int i;
+
+  for(i = 0; i < node->sub_slots.n_slots; i++)
+    cRosWorkStrandRelease(&node->subs[i]->callback_strand);
+
+  for(i = 0; i < node->service_provider_slots.n_slots; i++)
+    cRosWorkStrandRelease(&node->service_providers[i]->callback_strand);
+}
+
+cRosErrCodePack cRosNodeSetCallbackThreads( CrosNode *node, int n_threads, int queue_size )
+{
+  CrosWorkerPool *pool;
+  int i, ret = 0;
+
+  if(node == NULL || n_threads < 0)
+    return CROS_BAD_PARAM_ERR;
+
+  if(queue_size < 1)
+    queue_size = CN_CALLBACK_QUEUE_SIZE;
+
+  // Stop the current pool. The running callbacks finish first and the waiting requests are answered with a failure
+  if(node->callback_pool != NULL)
+  {
+    releaseCallbackStrands(node);
+    cRosWorkerPoolRelease(node->callback_pool);
+    free(node->callback_pool);
+    node->callback_pool = NULL;
+  }
+
+  if(n_threads == 0)
+    return CROS_SUCCESS_ERR_PACK;
+
+  pool = (CrosWorkerPool *)malloc(sizeof(CrosWorkerPool));
+  if(pool == NULL || cRosWorkerPoolInit(pool, n_threads) != 0)
+  {
+    PRINT_ERROR ( "cRosNodeSetCallbackThreads() : Can't start the worker threads\n" );
+    free(pool);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  node->callback_pool = pool;
+  node->callback_queue_size = queue_size;
+
+  // The roles already registered start to use the pool too
+  for(i = 0; i < node->sub_slots.n_slots && ret == 0; i++)
+    if(node->subs[i]->topic_name != NULL)
+      ret = cRosWorkStrandInit(&node->subs[i]->callback_strand, pool, queue_size);
+
+  for(i = 0; i < node->service_provider_slots.n_slots && ret == 0; i++)
+    if(node->service_providers[i]->service_name != NULL)
+      ret = cRosWorkStrandInit(&node->service_providers[i]->callback_strand, pool, queue_size);
+
+  if(ret != 0)
+  {
+    PRINT_ERROR ( "cRosNodeSetCallbackThreads() : Can't allocate memory\n" );
+    cRosNodeSetCallbackThreads(node, 0, queue_size);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosNodeSendTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg, unsigned long time_out )
+{
+  cRosErrCodePack ret_err;
+  PublisherNode *pub_node;
+  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  PRINT_VVDEBUG ( "cRosNodeSendTopicMsg ()\n" );
+
+  if(pubidx < 0 || pubidx >= node->pub_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node = node->pubs[pubidx];
+  if(pub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
+  // While the buffer is full and the timeout is not reached wait
+  while(cRosMessageQueueVacancies(&pub_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+  {
+    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+  }
+
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+     cRosNodeQueueTopicMsg( node, pubidx, msg );
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeSetPublisherConnQueue( CrosNode *node, int pubidx, int queue_size, TcprosFrameQueuePolicy policy )
+{
+  cRosErrCodePack ret_err;
+  PublisherNode *pub_node;
+  int list_elem;
+  PRINT_VVDEBUG ( "cRosNodeSetPublisherConnQueue ()\n" );
+
+  if(pubidx < 0 || pubidx >= node->pub_slots.n_slots || queue_size <= 0)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node = node->pubs[pubidx];
+  if(pub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node->conn_queue_size = queue_size;
+  pub_node->conn_queue_policy = policy;
+
+  // Apply the new settings to the already established connections
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(list_elem=0;pub_node->tcpros_id_list[list_elem]!=-1;list_elem++)
+  {
+    TcprosProcess *server_proc = node->tcpros_server_proc[pub_node->tcpros_id_list[list_elem]];
+    server_proc->frame_queue.policy = policy;
+    if(tcprosFrameQueueSetCapacity( &(server_proc->frame_queue), queue_size ) != 0)
+      ret_err = CROS_MEM_ALLOC_ERR;
+  }
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeSetPublisherZeroCopy( CrosNode *node, int pubidx, size_t min_size )
+{
+  PublisherNode *pub_node;
+  int list_elem;
+  PRINT_VVDEBUG ( "cRosNodeSetPublisherZeroCopy ()\n" );
+
+  if(pubidx < 0 || pubidx >= node->pub_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node = node->pubs[pubidx];
+  if(pub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node->zerocopy_min_size = min_size;
+
+  // Apply the new setting to the already established connections
+  for(list_elem=0;pub_node->tcpros_id_list[list_elem]!=-1;list_elem++)
+  {
+    TcprosProcess *server_proc = node->tcpros_server_proc[pub_node->tcpros_id_list[list_elem]];
+    if(min_size > 0 && (server_proc->socket.zerocopy || tcpIpSocketSetZeroCopy( &(server_proc->socket) )))
+      server_proc->zerocopy_min_size = min_size;
+    else
+      server_proc->zerocopy_min_size = 0;
+  }
 
-      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(rpcros_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS client socket error\n" );
-        handleRpcrosClientError( n, i );
-      }
+  return CROS_SUCCESS_ERR_PACK;
+}
 
-      if( ( client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_START_WRITING && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(rpcros_client_fd, &w_fds) ) )
-      {
-        new_errors = doWithRpcrosClientSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+cRosErrCodePack cRosNodeSetSubscriberZeroCopy( CrosNode *node, int subidx, int enable )
+{
+  SubscriberNode *sub_node;
+  PRINT_VVDEBUG ( "cRosNodeSetSubscriberZeroCopy ()\n" );
 
-    if ( next_rpcros_server_i >= 0 && rpcros_listner_fd != -1)
-    {
-      if( FD_ISSET( rpcros_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
-      }
-      else if( next_rpcros_server_i >= 0 && FD_ISSET( rpcros_listner_fd, &r_fds) )
-      {
-        PRINT_VDEBUG ( "cRosNodeDoEventsLoop() : TCPROS listener ready\n" );
-        if( tcpIpSocketAccept( &(n->rpcros_listner_proc.socket),
-            &(n->rpcros_server_proc[next_rpcros_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->rpcros_server_proc[next_rpcros_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->rpcros_server_proc[next_rpcros_server_i].socket ) ) &&
-            tcpIpSocketSetKeepAlive( &(n->rpcros_server_proc[next_rpcros_server_i].socket ), 60, 10, 9 ) )
-        {
-          tcprosProcessChangeState( &(n->rpcros_server_proc[next_rpcros_server_i]), TCPROS_PROCESS_STATE_READING_HEADER_SIZE );
-        }
-      }
-    }
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
 
-    for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
-    {
-      TcprosProcess *server_proc = &(n->rpcros_server_proc[i]);
-      int server_fd = tcpIpSocketGetFD( &(server_proc->socket) );
+  sub_node = node->subs[subidx];
+  if(sub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
 
-      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
-        tcpIpSocketClose( &(server_proc->socket) );
-        tcprosProcessChangeState( &(n->rpcros_server_proc[next_rpcros_server_i]), TCPROS_PROCESS_STATE_IDLE );
-      }
-      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(server_fd, &w_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) )
-      {
-        new_errors = doWithRpcrosServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
-  }
-  return ret_err;
+  sub_node->zerocopy_views = (enable != 0);
+  return CROS_SUCCESS_ERR_PACK;
 }
 
-cRosErrCodePack cRosNodeStart( CrosNode *n, unsigned long time_out, unsigned char *exit_flag )
+cRosErrCodePack cRosNodeSetSubscriberLazy( CrosNode *node, int subidx, int enable )
 {
-  uint64_t start_time, elapsed_time;
-  cRosErrCodePack ret_err;
-  PRINT_VVDEBUG ( "cRosNodeStart ()\n" );
+  SubscriberNode *sub_node;
+  PRINT_VVDEBUG ( "cRosNodeSetSubscriberLazy ()\n" );
 
-  start_time = cRosClockGetTimeMs();
-  ret_err = CROS_SUCCESS_ERR_PACK;
-  while(ret_err == CROS_SUCCESS_ERR_PACK && (exit_flag==NULL || !(*exit_flag)) && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
-    ret_err = cRosNodeDoEventsLoop( n, (time_out == CROS_INFINITE_TIMEOUT)? UINT64_MAX : time_out-elapsed_time);
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
 
-  return ret_err;
+  sub_node = node->subs[subidx];
+  if(sub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  sub_node->lazy_decoding = (enable != 0);
+  return CROS_SUCCESS_ERR_PACK;
 }
 
-cRosErrCodePack cRosNodeReceiveTopicMsg( CrosNode *node, int subidx, cRosMessage *msg, unsigned char *buff_overflow, unsigned long time_out )
+cRosErrCodePack cRosNodeSetSubscriberQueueSize( CrosNode *node, int subidx, int queue_size )
 {
-  cRosErrCodePack ret_err;
-  SubscriberNode *subs_node;
-  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
-  PRINT_VVDEBUG ( "cRosNodeReceiveTopicMsg ()\n" );
+  SubscriberNode *sub_node;
+  unsigned int n_queued;
+  int ret;
+  PRINT_VVDEBUG ( "cRosNodeSetSubscriberQueueSize ()\n" );
 
-  if(subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots || queue_size < 1)
     return CROS_BAD_PARAM_ERR;
 
-  subs_node = &node->subs[subidx];
-  if(subs_node->topic_name == NULL)
+  sub_node = node->subs[subidx];
+  if(sub_node->topic_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
-  if(buff_overflow != NULL)
-    *buff_overflow = subs_node->msg_queue_overflow;
-  subs_node->msg_queue_overflow = 0; // Reset overflow flag
+  n_queued = cRosMessageQueueUsage(&sub_node->msg_queue);
+  ret = cRosMessageQueueSetCapacity(&sub_node->msg_queue, (unsigned int)queue_size);
+  if(ret != 0)
+    return CROS_MEM_ALLOC_ERR;
 
-  start_time = cRosClockGetTimeMs();
-  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
-  // While the buffer is empty and the timeout is not reached wait
-  while(cRosMessageQueueUsage(&subs_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
-  {
-    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
-  }
-  if(ret_err == CROS_SUCCESS_ERR_PACK)
-  {
-    if(cRosMessageQueueUsage(&subs_node->msg_queue) > 0) // If no error and there is at least one message in the queue, get the message
-      ret_err = (cRosMessageQueueExtract(&subs_node->msg_queue, msg) == 0)? CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
-    else
-      ret_err = CROS_RCV_TOP_TIMEOUT_ERR;
-  }
-  return ret_err;
+  sub_node->msg_queue_n_dropped += n_queued - cRosMessageQueueUsage(&sub_node->msg_queue); // The messages that did not fit
+  if(cRosMessageQueueVacancies(&sub_node->msg_queue) > 0)
+    sub_node->msg_queue_overflow = 0;
+  // A full queue holds a block of the message type per message, plus the one of the message being received
+  return cRosNodeContextReservePool(sub_node->context, queue_size + 1);
 }
 
-cRosErrCodePack cRosNodeQueueTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg )
+void cRosNodeApplySubscriberQueuePolicy( SubscriberNode *sub_node )
 {
-  cRosErrCodePack ret_err;
-  PublisherNode *pub_node;
+  cRosMessageQueue *q = &sub_node->msg_queue;
+  unsigned int n_queued = cRosMessageQueueUsage(q);
 
-  pub_node = &node->pubs[pubidx];
+  if(sub_node->msg_queue_policy == CROS_SUB_QUEUE_KEEP_LATEST)
   {
-    if(cRosMessageQueueVacancies(&pub_node->msg_queue) > 0) // If no error and there is space in the queue, put the new message
+    if(n_queued > 0) // The received message replaces the queued ones
     {
-      if(cRosMessageQueueAdd(&pub_node->msg_queue, msg) == 0)
-        ret_err = CROS_SUCCESS_ERR_PACK;
-      else
-        ret_err = CROS_MEM_ALLOC_ERR;
+      cRosMessageQueueClear(q);
+      sub_node->msg_queue_n_dropped += n_queued;
+      sub_node->msg_queue_overflow = 1;
     }
-    else
-      ret_err = CROS_SEND_TOP_TIMEOUT_ERR;
+    return;
   }
-  return ret_err;
+
+  if(cRosMessageQueueVacancies(q) > 0)
+    return;
+
+  sub_node->msg_queue_overflow = 1; // No space in the queue for the new message
+  sub_node->msg_queue_n_dropped++;
+  // A blocked subscriber does not read messages while its queue is full, so it only gets here if the policy has just
+  // been changed or if the message comes from a publisher in the process, which cannot be blocked. Then, as with
+  // CROS_SUB_QUEUE_DROP_NEWEST, the new message is not queued
+  if(sub_node->msg_queue_policy == CROS_SUB_QUEUE_DROP_OLDEST)
+    cRosMessageQueueRemove(q);
 }
 
-cRosErrCodePack cRosNodeSendTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg, unsigned long time_out )
+cRosErrCodePack cRosNodeSetSubscriberQueuePolicy( CrosNode *node, int subidx, CrosSubscriberQueuePolicy policy )
 {
-  cRosErrCodePack ret_err;
-  PublisherNode *pub_node;
-  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
-  PRINT_VVDEBUG ( "cRosNodeSendTopicMsg ()\n" );
+  SubscriberNode *sub_node;
+  PRINT_VVDEBUG ( "cRosNodeSetSubscriberQueuePolicy ()\n" );
 
-  if(pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots ||
+     policy < CROS_SUB_QUEUE_DROP_NEWEST || policy > CROS_SUB_QUEUE_BLOCK)
     return CROS_BAD_PARAM_ERR;
 
-  pub_node = &node->pubs[pubidx];
-  if(pub_node->topic_name == NULL)
+  sub_node = node->subs[subidx];
+  if(sub_node->topic_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
-  start_time = cRosClockGetTimeMs();
-  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
-  // While the buffer is full and the timeout is not reached wait
-  while(cRosMessageQueueVacancies(&pub_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
-  {
-    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
-  }
+  sub_node->msg_queue_policy = policy;
+  return CROS_SUCCESS_ERR_PACK;
+}
 
-  if(ret_err == CROS_SUCCESS_ERR_PACK)
-     cRosNodeQueueTopicMsg( node, pubidx, msg );
+cRosErrCodePack cRosNodeGetSubscriberDroppedMsgs( CrosNode *node, int subidx, unsigned long *n_dropped )
+{
+  SubscriberNode *sub_node;
+  PRINT_VVDEBUG ( "cRosNodeGetSubscriberDroppedMsgs ()\n" );
 
-  return ret_err;
+  if(subidx < 0 || subidx >= node->sub_slots.n_slots || n_dropped == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  sub_node = node->subs[subidx];
+  if(sub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  *n_dropped = sub_node->msg_queue_n_dropped;
+  return CROS_SUCCESS_ERR_PACK;
 }
 
+cRosErrCodePack cRosNodeSetPublisherQueueSize( CrosNode *node, int pubidx, int queue_size )
+{
+  PublisherNode *pub_node;
+  PRINT_VVDEBUG ( "cRosNodeSetPublisherQueueSize ()\n" );
+
+  if(pubidx < 0 || pubidx >= node->pub_slots.n_slots || queue_size < 1)
+    return CROS_BAD_PARAM_ERR;
+
+  pub_node = node->pubs[pubidx];
+  if(pub_node->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(cRosMessageQueueSetCapacity(&pub_node->msg_queue, (unsigned int)queue_size) != 0)
+    return CROS_MEM_ALLOC_ERR;
+  // A full queue holds a block of the message type per message, plus the one of the message being sent
+  return cRosNodeContextReservePool(pub_node->context, queue_size + 1);
+}
 
 cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *req_msg, cRosMessage *resp_msg, unsigned long time_out)
 {
@@ -3488,14 +4903,14 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
   PRINT_VVDEBUG ( "cRosNodeServiceCall ()\n" );
 
-  if(svcidx < 0 || svcidx >= CN_MAX_SERVICE_CALLERS)
+  if(svcidx < 0 || svcidx >= node->service_caller_slots.n_slots)
     return CROS_BAD_PARAM_ERR;
 
-  caller_node = &node->service_callers[svcidx];
+  caller_node = node->service_callers[svcidx];
   if(caller_node->service_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
-  svc_client_proc = &node->rpcros_client_proc[caller_node->rpcros_id];
+  svc_client_proc = node->rpcros_client_proc[caller_node->rpcros_id];
 
   start_time = cRosClockGetTimeMs();
   // Wait until the RPCROS process has finished the current call and the timeout is not reached wait
@@ -3516,7 +4931,7 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
     cRosMessageQueueClear(&caller_node->msg_queue);
   }
 
-  if(cRosMessageQueueAdd(&caller_node->msg_queue, req_msg) != 0) // Put service-call request msg in the queue
+  if(cRosMessageQueueAdd(&caller_node->msg_queue, req_msg) != 0 || wakeUpServiceCaller(node, svcidx) != 0) // Put service-call request msg in the queue
     ret_err = CROS_MEM_ALLOC_ERR;
 
   // Wait while the buffer is full and the timeout is not reached
@@ -3526,29 +4941,242 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   }
 
   if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosNodeServiceCallFinish(node, svcidx, resp_msg);
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeServiceCallStart( CrosNode *node, int svcidx, cRosMessage *req_msg )
+{
+  ServiceCallerNode *caller_node;
+  PRINT_VVDEBUG ( "cRosNodeServiceCallStart ()\n" );
+
+  if(svcidx < 0 || svcidx >= node->service_caller_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
+
+  caller_node = node->service_callers[svcidx];
+  if(caller_node->service_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(cRosMessageQueueUsage(&caller_node->msg_queue) > 0) // The previous call has not been finished
+    return CROS_CALL_INI_TIMEOUT_ERR;
+
+  // The request is sent as soon as the RPCROS process finishes the current (periodic) call, if any
+  if(cRosMessageQueueAdd(&caller_node->msg_queue, req_msg) != 0 || wakeUpServiceCaller(node, svcidx) != 0)
+  {
+    cRosMessageQueueClear(&caller_node->msg_queue);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosNodeServiceCallFinish( CrosNode *node, int svcidx, cRosMessage *resp_msg )
+{
+  cRosErrCodePack ret_err;
+  ServiceCallerNode *caller_node;
+  PRINT_VVDEBUG ( "cRosNodeServiceCallFinish ()\n" );
+
+  if(svcidx < 0 || svcidx >= node->service_caller_slots.n_slots)
+    return CROS_BAD_PARAM_ERR;
+
+  caller_node = node->service_callers[svcidx];
+  if(caller_node->service_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(cRosMessageQueueUsage(&caller_node->msg_queue) > 1) // If the response is in the buffer
   {
-    if(cRosMessageQueueUsage(&caller_node->msg_queue) > 1) // If no error and the response is in the buffer
+    cRosMessageQueueRemove(&caller_node->msg_queue); // Remove request msg from queue
+    if(resp_msg != NULL)
     {
-      cRosMessageQueueRemove(&caller_node->msg_queue); // Remove request msg from queue
-      if(resp_msg != NULL)
-      {
-        int queue_ret_val;
-        queue_ret_val = cRosMessageQueueExtract(&caller_node->msg_queue, resp_msg); // Extract response msg from queue
-        if(queue_ret_val == 0)
-          ret_err = CROS_SUCCESS_ERR_PACK;
-        else
-          ret_err = CROS_MEM_ALLOC_ERR;
-      }
-      else // The user is not interested in the service response, just remove the msg from queue
-        cRosMessageQueueRemove(&caller_node->msg_queue);
+      int queue_ret_val;
+      queue_ret_val = cRosMessageQueueExtractMove(&caller_node->msg_queue, resp_msg); // Extract response msg from queue
+      if(queue_ret_val == 0)
+        ret_err = CROS_SUCCESS_ERR_PACK;
+      else
+        ret_err = CROS_MEM_ALLOC_ERR;
     }
-    else
-      ret_err = CROS_CALL_SVC_TIMEOUT_ERR;
+    else // The user is not interested in the service response, just remove the msg from queue
+    {
+      cRosMessageQueueRemove(&caller_node->msg_queue);
+      ret_err = CROS_SUCCESS_ERR_PACK;
+    }
+  }
+  else
+    ret_err = CROS_CALL_SVC_TIMEOUT_ERR;
+
+  return ret_err;
+}
+
+void cRosWaitSetInit( CrosWaitSet *ws, CrosNode *node )
+{
+  ws->node = node;
+  ws->members = NULL;
+  ws->n_members = 0;
+  ws->max_members = 0;
+}
+
+void cRosWaitSetRelease( CrosWaitSet *ws )
+{
+  free(ws->members);
+  cRosWaitSetInit(ws, ws->node);
+}
+
+// Append a member to a wait set and return its index, or -1 if memory cannot be allocated
+static int addWaitSetMember( CrosWaitSet *ws, CrosWaitSetMemberType type, int idx )
+{
+  CrosWaitSetMember *member;
+
+  if(ws->n_members == ws->max_members)
+  {
+    int new_max = (ws->max_members == 0)? 4 : 2 * ws->max_members;
+    CrosWaitSetMember *new_members = (CrosWaitSetMember *)realloc(ws->members, new_max * sizeof(CrosWaitSetMember));
+    if(new_members == NULL)
+    {
+      PRINT_ERROR ( "addWaitSetMember() : Can't allocate memory\n" );
+      return -1;
+    }
+    ws->members = new_members;
+    ws->max_members = new_max;
+  }
+
+  member = &ws->members[ws->n_members];
+  member->type = type;
+  member->idx = idx;
+  tcpIpSocketInit( &(member->fd_socket) );
+  member->ready = 0;
+  return ws->n_members++;
+}
+
+cRosErrCodePack cRosWaitSetAddSubscriber( CrosWaitSet *ws, int subidx, int *member_idx_ptr )
+{
+  int member_idx;
+
+  if(subidx < 0 || subidx >= ws->node->sub_slots.n_slots || ws->node->subs[subidx]->topic_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  member_idx = addWaitSetMember(ws, CROS_WAIT_SUBSCRIBER, subidx);
+  if(member_idx < 0)
+    return CROS_MEM_ALLOC_ERR;
+  if(member_idx_ptr != NULL)
+    *member_idx_ptr = member_idx;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosWaitSetAddServiceCall( CrosWaitSet *ws, int svcidx, int *member_idx_ptr )
+{
+  int member_idx;
+
+  if(svcidx < 0 || svcidx >= ws->node->service_caller_slots.n_slots || ws->node->service_callers[svcidx]->service_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  member_idx = addWaitSetMember(ws, CROS_WAIT_SERVICE_CALL, svcidx);
+  if(member_idx < 0)
+    return CROS_MEM_ALLOC_ERR;
+  if(member_idx_ptr != NULL)
+    *member_idx_ptr = member_idx;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosWaitSetAddFd( CrosWaitSet *ws, int fd, int *member_idx_ptr )
+{
+  int member_idx;
+
+  if(fd < 0)
+    return CROS_BAD_PARAM_ERR;
+
+  member_idx = addWaitSetMember(ws, CROS_WAIT_FD, -1);
+  if(member_idx < 0)
+    return CROS_MEM_ALLOC_ERR;
+  ws->members[member_idx].fd_socket.fd = fd; // The descriptor is only monitored (never closed) by the node
+  if(member_idx_ptr != NULL)
+    *member_idx_ptr = member_idx;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+// Update the ready flag of the subscriber and service-call members of a wait set and return the number of ready members
+static int checkWaitSetMembers( CrosWaitSet *ws )
+{
+  CrosNode *n = ws->node;
+  int i, n_ready;
+
+  n_ready = 0;
+  for(i = 0; i < ws->n_members; i++)
+  {
+    CrosWaitSetMember *member = &ws->members[i];
+    switch(member->type)
+    {
+      case CROS_WAIT_SUBSCRIBER:
+        member->ready = (n->subs[member->idx]->topic_name != NULL && cRosMessageQueueUsage(&n->subs[member->idx]->msg_queue) > 0);
+        break;
+      case CROS_WAIT_SERVICE_CALL: // The caller queue holds the request and, once received, the response
+        member->ready = (n->service_callers[member->idx]->service_name != NULL && cRosMessageQueueUsage(&n->service_callers[member->idx]->msg_queue) > 1);
+        break;
+      case CROS_WAIT_FD: // Set by cRosNodeDoEventsLoop()
+        break;
+    }
+    n_ready += member->ready;
+  }
+  return n_ready;
+}
+
+// Start or stop monitoring the file descriptors of a wait set in the node event backend
+static void monitorWaitSetFds( CrosWaitSet *ws, int monitor )
+{
+  int i;
+
+  for(i = 0; i < ws->n_members; i++)
+  {
+    if(ws->members[i].type == CROS_WAIT_FD)
+      cRosEventBackendSetInterest( &(ws->node->event_backend), &(ws->members[i].fd_socket),
+                                   (monitor)? CROS_EVENT_READ : 0, CN_EVENT_TAG(CN_EVENT_WAIT_FD, i) );
+  }
+  ws->node->waiting_set = (monitor)? ws : NULL;
+}
+
+cRosErrCodePack cRosWaitSetWait( CrosWaitSet *ws, int *n_ready_ptr, unsigned long time_out )
+{
+  cRosErrCodePack ret_err;
+  CrosNode *node = ws->node;
+  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  int i, n_ready;
+  PRINT_VVDEBUG ( "cRosWaitSetWait ()\n" );
+
+  if(n_ready_ptr != NULL)
+    *n_ready_ptr = 0;
+  if(node->waiting_set != NULL) // Another wait set is being waited for (e.g., from a callback)
+    return CROS_BAD_PARAM_ERR;
+
+  for(i = 0; i < ws->n_members; i++)
+    ws->members[i].ready = 0;
+  monitorWaitSetFds(ws, 1);
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
+  n_ready = checkWaitSetMembers(ws);
+  // The node loop returns as soon as any socket (including the descriptors of the set) has been attended, so
+  // the members are checked again after each iteration
+  while(n_ready == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+  {
+    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+    n_ready = checkWaitSetMembers(ws);
   }
 
+  monitorWaitSetFds(ws, 0);
+
+  if(n_ready_ptr != NULL)
+    *n_ready_ptr = n_ready;
+  if(ret_err == CROS_SUCCESS_ERR_PACK && n_ready == 0)
+    ret_err = CROS_WAIT_SET_TIMEOUT_ERR;
   return ret_err;
 }
 
+int cRosWaitSetIsReady( CrosWaitSet *ws, int member_idx )
+{
+  if(member_idx < 0 || member_idx >= ws->n_members)
+    return 0;
+  return ws->members[member_idx].ready;
+}
+
 int enqueueSubscriberAdvertise(CrosNode *node, int subidx)
 {
   RosApiCall *call = newRosApiCall();
@@ -3561,7 +5189,7 @@ int enqueueSubscriberAdvertise(CrosNode *node, int subidx)
   call->provider_idx= subidx;
   call->method = CROS_API_REGISTER_SUBSCRIBER;
 
-  SubscriberNode *sub = &node->subs[subidx];
+  SubscriberNode *sub = node->subs[subidx];
   xmlrpcParamVectorPushBackString( &call->params, node->name );
   xmlrpcParamVectorPushBackString( &call->params, sub->topic_name );
   xmlrpcParamVectorPushBackString( &call->params, sub->topic_type );
@@ -3584,7 +5212,7 @@ int enqueuePublisherAdvertise(CrosNode *node, int pubidx)
   call->provider_idx= pubidx;
   call->method = CROS_API_REGISTER_PUBLISHER;
 
-  PublisherNode *publiser = &node->pubs[pubidx];
+  PublisherNode *publiser = node->pubs[pubidx];
   xmlrpcParamVectorPushBackString( &call->params, node->name);
   xmlrpcParamVectorPushBackString( &call->params, publiser->topic_name );
   xmlrpcParamVectorPushBackString( &call->params, publiser->topic_type );
@@ -3607,7 +5235,7 @@ int enqueueServiceAdvertise(CrosNode *node, int serviceidx)
   call->provider_idx = serviceidx;
   call->method = CROS_API_REGISTER_SERVICE;
 
-  ServiceProviderNode *service = &node->service_providers[serviceidx];
+  ServiceProviderNode *service = node->service_providers[serviceidx];
   xmlrpcParamVectorPushBackString( &call->params, node->name );
   xmlrpcParamVectorPushBackString( &call->params, service->service_name );
   char uri[256];
@@ -3631,7 +5259,7 @@ int enqueueServiceLookup(CrosNode *node, int serviceidx)
   call->provider_idx= serviceidx;
   call->method = CROS_API_LOOKUP_SERVICE;
 
-  ServiceCallerNode *service = &node->service_callers[serviceidx];
+  ServiceCallerNode *service = node->service_callers[serviceidx];
   xmlrpcParamVectorPushBackString( &call->params, node->name );
   xmlrpcParamVectorPushBackString( &call->params, service->service_name );
 
@@ -3650,7 +5278,7 @@ int enqueueParameterSubscription(CrosNode *node, int parameteridx)
   call->provider_idx = parameteridx;
   call->method = CROS_API_SUBSCRIBE_PARAM;
 
-  ParameterSubscription *subscrition = &node->paramsubs[parameteridx];
+  ParameterSubscription *subscrition = node->paramsubs[parameteridx];
   xmlrpcParamVectorPushBackString( &call->params, node->name );
   char node_uri[256];
   snprintf( node_uri, 256, "http://%s:%d/", node->host, node->xmlrpc_port);
@@ -3672,7 +5300,7 @@ int enqueueParameterUnsubscription(CrosNode *node, int parameteridx)
   call->method = CROS_API_UNSUBSCRIBE_PARAM;
   call->provider_idx = parameteridx;
 
-  ParameterSubscription *subscrition = &node->paramsubs[parameteridx];
+  ParameterSubscription *subscrition = node->paramsubs[parameteridx];
   xmlrpcParamVectorPushBackString( &call->params, node->name);
   char node_uri[256];
   snprintf( node_uri, 256, "http://%s:%d/", node->host, node->xmlrpc_port);
@@ -3685,6 +5313,21 @@ int enqueueParameterUnsubscription(CrosNode *node, int parameteridx)
 
 int enqueueRequestTopic(CrosNode *node, int subidx, const char *host, int port)
 {
+  int intra_ret;
+  SubscriberNode *sub = node->subs[subidx];
+
+  CrosNodeStatusUsr status;
+  initCrosNodeStatus(&status);
+  status.provider_idx = subidx;
+  status.xmlrpc_host = host;
+  status.xmlrpc_port = port;
+  cRosNodeStatusCallback(&status, sub->context); // calls the subscriber-status application-defined callback function (if specified when creating the subscriber). Undocumented status callback?
+
+  // A publisher of a node in this process is connected directly: no requestTopic call and no TCPROS connection
+  intra_ret = linkIntraProcessPublisher(node, subidx, host, port);
+  if(intra_ret != 0)
+    return (intra_ret > 0)? 0: -1;
+
   RosApiCall *call = newRosApiCall();
   if (call == NULL)
   {
@@ -3695,15 +5338,6 @@ int enqueueRequestTopic(CrosNode *node, int subidx, const char *host, int port)
   call->provider_idx = subidx;
   call->method = CROS_API_REQUEST_TOPIC;
 
-  SubscriberNode *sub = &node->subs[subidx];
-
-  CrosNodeStatusUsr status;
-  initCrosNodeStatus(&status);
-  status.provider_idx = subidx;
-  status.xmlrpc_host = host;
-  status.xmlrpc_port = port;
-  cRosNodeStatusCallback(&status, sub->context); // calls the subscriber-status application-defined callback function (if specified when creating the subscriber). Undocumented status callback?
-
   xmlrpcParamVectorPushBackString(&call->params, node->name );
   xmlrpcParamVectorPushBackString(&call->params, sub->topic_name );
   xmlrpcParamVectorPushBackArray(&call->params);
@@ -3717,25 +5351,25 @@ int enqueueRequestTopic(CrosNode *node, int subidx, const char *host, int port)
 void restartAdversing(CrosNode* n)
 {
   int it;
-  for(it = 0; it < n->n_pubs; it++)
+  for(it = 0; it < n->pub_slots.n_slots; it++)
   {
-    if (n->pubs[it].topic_name == NULL)
+    if (n->pubs[it]->topic_name == NULL)
       continue;
 
     enqueuePublisherAdvertise(n, it);
   }
 
-  for(it = 0; it < n->n_subs; it++)
+  for(it = 0; it < n->sub_slots.n_slots; it++)
   {
-    if (n->subs[it].topic_name == NULL)
+    if (n->subs[it]->topic_name == NULL)
       continue;
 
     enqueueSubscriberAdvertise(n, it);
   }
 
-  for(it = 0; it < n->n_service_providers; it++)
+  for(it = 0; it < n->service_provider_slots.n_slots; it++)
   {
-    if (n->service_providers[it].service_name == NULL)
+    if (n->service_providers[it]->service_name == NULL)
       continue;
 
     enqueueServiceAdvertise(n, it);
@@ -3749,10 +5383,22 @@ void initPublisherNode(PublisherNode *pub)
   pub->topic_type = NULL;
   pub->md5sum = NULL;
   pub->context = NULL;
-  pub->tcpros_id_list[0] = -1; // Empty list of TcprosProcess indices
+  pub->tcpros_id_list = NULL; // The list is allocated when the publisher is registered
+  pub->max_tcpros_ids = 0;
   pub->loop_period = -1; // Publication paused
-  pub->wake_up_time = 0;
+  pub->next_period_time = 0;
+  cRosTimerInit(&pub->timer, 0);
   cRosMessageQueueInit(&pub->msg_queue);
+  pub->conn_queue_size = CN_PUBLISHER_CONN_QUEUE_SIZE;
+  pub->conn_queue_policy = TCPROS_FRAME_QUEUE_DROP_OLDEST;
+  pub->zerocopy_min_size = 0;
+  cRosMpscQueueInit(&pub->posted_msgs);
+  pub->n_posted_msgs = 0;
+  pub->post_pending = 0;
+  pub->posted_link.next = NULL;
+  pub->intra_links = NULL;
+  pub->n_intra_links = 0;
+  pub->max_intra_links = 0;
 }
 
 void initSubscriberNode(SubscriberNode *sub)
@@ -3764,7 +5410,17 @@ void initSubscriberNode(SubscriberNode *sub)
   sub->context = NULL;
   sub->tcp_nodelay = 0;
   sub->msg_queue_overflow = 0;
+  sub->msg_queue_policy = CROS_SUB_QUEUE_DROP_NEWEST;
+  sub->msg_queue_n_dropped = 0;
+  sub->zerocopy_views = 0;
+  sub->lazy_decoding = 0;
   cRosMessageQueueInit(&sub->msg_queue);
+  sub->callback_strand.pool = NULL;
+  cRosMpscQueueInit(&sub->intra_msgs);
+  sub->n_intra_msgs = 0;
+  sub->n_intra_dropped = 0;
+  sub->intra_pending = 0;
+  sub->intra_link.next = NULL;
 }
 
 void initServiceProviderNode(ServiceProviderNode *srv_prov)
@@ -3775,6 +5431,7 @@ void initServiceProviderNode(ServiceProviderNode *srv_prov)
   srv_prov->context = NULL;
   srv_prov->servicerequest_type = NULL;
   srv_prov->serviceresponse_type = NULL;
+  srv_prov->callback_strand.pool = NULL;
 }
 
 void initServiceCallerNode(ServiceCallerNode *srv_caller)
@@ -3792,7 +5449,8 @@ void initServiceCallerNode(ServiceCallerNode *srv_caller)
   srv_caller->persistent = 0;
   srv_caller->tcp_nodelay = 0;
   srv_caller->loop_period = -1; // Calling paused
-  srv_caller->wake_up_time = 0;
+  srv_caller->next_period_time = 0;
+  cRosTimerInit(&srv_caller->timer, 0);
   cRosMessageQueueInit(&srv_caller->msg_queue);
 }
 
@@ -3810,7 +5468,15 @@ void cRosNodeReleasePublisher(PublisherNode *node)
   free(node->topic_name);
   free(node->topic_type);
   free(node->md5sum);
+  free(node->tcpros_id_list);
+  node->tcpros_id_list = NULL;
+  node->max_tcpros_ids = 0;
+  free(node->intra_links);
+  node->intra_links = NULL;
+  node->n_intra_links = 0;
+  node->max_intra_links = 0;
   cRosMessageQueueRelease(&node->msg_queue);
+  discardPostedMsgs(node); // The posted messages that were not sent
 }
 
 void cRosNodeReleaseSubscriber(SubscriberNode *node)
@@ -3820,6 +5486,7 @@ void cRosNodeReleaseSubscriber(SubscriberNode *node)
   free(node->topic_type);
   free(node->md5sum);
   cRosMessageQueueRelease(&node->msg_queue);
+  discardIntraProcessMsgs(node); // The messages of publishers in the process that were not delivered
 }
 
 void cRosNodeReleaseServiceProvider(ServiceProviderNode *node)
@@ -3858,22 +5525,6 @@ void cRosNodeReleaseParameterSubscrition(ParameterSubscription *subscription)
   xmlrpcParamRelease(&subscription->parameter_value);
 }
 
-void getIdleXmplrpcClients(CrosNode *node, int idle_clients[], size_t *idle_client_count)
-{
-  int client_it = 1; // client_it = 0 is for roscore only
-  int idle_it = 0;
-  *idle_client_count = 0;
-  for(; client_it < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; client_it++)
-  {
-    if (node->xmlrpc_client_proc[client_it].state == XMLRPC_PROCESS_STATE_IDLE)
-    {
-      idle_clients[idle_it] = client_it;
-      (*idle_client_count)++;
-      idle_it++;
-    }
-  }
-}
-
 int enqueueMasterApiCall(CrosNode *node, RosApiCall *call)
 {
   call->user_call = 1;
@@ -3941,13 +5592,13 @@ void getSrvFilePath(CrosNode *node, char *buffer, size_t bufsize, const char *se
 XmlrpcParam * cRosNodeGetParameterValue( CrosNode *node, const char *key)
 {
   int it = 0;
-  for (it = 0 ; it < node->n_paramsubs; it++)
+  for (it = 0 ; it < node->paramsub_slots.n_slots; it++)
   {
-    if (node->paramsubs[it].parameter_key == NULL)
+    if (node->paramsubs[it]->parameter_key == NULL)
       continue;
 
-    if (strcmp(node->paramsubs[it].parameter_key, key) == 0)
-      return &node->paramsubs[it].parameter_value;
+    if (strcmp(node->paramsubs[it]->parameter_key, key) == 0)
+      return &node->paramsubs[it]->parameter_value;
   }
 
   return NULL;
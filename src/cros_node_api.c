@@ -119,7 +119,7 @@ void cRosApiPrepareRequest( CrosNode *n, int client_idx )
 {
   PRINT_VVDEBUG ( "cRosApiPrepareRequest()\n" );
 
-  XmlrpcProcess *client_proc = &(n->xmlrpc_client_proc[client_idx]);
+  XmlrpcProcess *client_proc = n->xmlrpc_client_proc[client_idx];
 
   client_proc->message_type = XMLRPC_MESSAGE_REQUEST;
 
@@ -158,7 +158,7 @@ void cRosApiPrepareRequest( CrosNode *n, int client_idx )
 int cRosApiParseResponse( CrosNode *n, int client_idx )
 {
   PRINT_VVDEBUG ( "cRosApiParseResponse()\n" );
-  XmlrpcProcess *client_proc = &(n->xmlrpc_client_proc[client_idx]);
+  XmlrpcProcess *client_proc = n->xmlrpc_client_proc[client_idx];
   int ret = -1;
 
   if( client_proc->current_call == NULL )
@@ -266,9 +266,9 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
         }
 
         int srvcalleridx = call->provider_idx;
-        ServiceCallerNode* requesting_service_caller = &(n->service_callers[srvcalleridx]);
+        ServiceCallerNode* requesting_service_caller = n->service_callers[srvcalleridx];
 
-        TcprosProcess* rpcros_proc = &n->rpcros_client_proc[requesting_service_caller->rpcros_id];
+        TcprosProcess* rpcros_proc = n->rpcros_client_proc[requesting_service_caller->rpcros_id];
         rpcros_proc->service_idx = call->provider_idx;
 
         if(checkResponseValue( &client_proc->response ) == 1)
@@ -338,7 +338,7 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
       case CROS_API_SUBSCRIBE_PARAM:
       {
         int paramsubidx = call->provider_idx;
-        ParameterSubscription *subscription = &n->paramsubs[paramsubidx];
+        ParameterSubscription *subscription = n->paramsubs[paramsubidx];
 
         if(checkResponseValue( &client_proc->response ) )
         {
@@ -351,7 +351,7 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
           if (rc < 0)
             break;
 
-          subscription = &n->paramsubs[paramsubidx];
+          subscription = n->paramsubs[paramsubidx];
 
           CrosNodeStatusUsr status;
           initCrosNodeStatus(&status);
@@ -515,7 +515,7 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
           int sub_ind = call->provider_idx;
 
           int tcp_port_print = tcp_port->data.as_int;
-          SubscriberNode* sub = &n->subs[sub_ind];
+          SubscriberNode* sub = n->subs[sub_ind];
 
           PRINT_VDEBUG( "cRosApiParseResponse() : requestTopic response [tcp port: %d]\n", tcp_port_print);
           xmlrpcProcessChangeState(client_proc,XMLRPC_PROCESS_STATE_IDLE);
@@ -530,7 +530,7 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
               client_tcpros_ind = cRosNodeRecruitTcprosClientProc(n, sub_ind);
               if(client_tcpros_ind != -1) // A Tcpros client has been recruited to be used
               {
-                TcprosProcess* tcpros_proc = &n->tcpros_client_proc[client_tcpros_ind];
+                TcprosProcess* tcpros_proc = n->tcpros_client_proc[client_tcpros_ind];
                 tcpros_proc->topic_idx = sub_ind;
 
                 // need to be checked because maybe the connection went down suddenly.
@@ -584,7 +584,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
   int ret;
   PRINT_VDEBUG ( "cRosApiParseRequestPrepareResponse()\n" );
 
-  XmlrpcProcess *server_proc = &(n->xmlrpc_server_proc[server_idx]);
+  XmlrpcProcess *server_proc = n->xmlrpc_server_proc[server_idx];
 
   if( server_proc->message_type != XMLRPC_MESSAGE_REQUEST)
   {
@@ -644,12 +644,12 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
         topic_name_param = xmlrpcParamGetString( topic_param );
         array_size = xmlrpcParamArrayGetSize( publishers_param );
 
-        for(i = 0; i < n->n_subs; i++)
+        for(i = 0; i < n->sub_slots.n_slots; i++)
         {
-          if (n->subs[i].topic_name == NULL)
+          if (n->subs[i]->topic_name == NULL)
             continue;
 
-          if( strcmp( topic_name_param, n->subs[i].topic_name ) == 0)
+          if( strcmp( topic_name_param, n->subs[i]->topic_name ) == 0)
           {
             sub_idx = i;
             break;
@@ -761,9 +761,9 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
         XmlrpcParam *proto, *proto_name;
         int i = 0, topic_found = 0, protocol_found = 0;
 
-        for( i = 0 ; i < n->n_pubs; i++)
+        for( i = 0 ; i < n->pub_slots.n_slots; i++)
         {
-          PublisherNode *pub = &n->pubs[i];
+          PublisherNode *pub = n->pubs[i];
           if (pub->topic_name == NULL)
             continue;
 
@@ -847,9 +847,9 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       else
         ret=-1;
 
-      for(proc_idx=0;proc_idx<CN_MAX_TCPROS_CLIENT_CONNECTIONS && ret==0;proc_idx++)
+      for(proc_idx=0;proc_idx<n->tcpros_client_slots.n_slots && ret==0;proc_idx++)
       {
-        TcprosProcess *cur_cli_proc = &n->tcpros_client_proc[proc_idx];
+        TcprosProcess *cur_cli_proc = n->tcpros_client_proc[proc_idx];
         if(cur_cli_proc->topic_idx != -1)
         {
           ret_connect_arr = xmlrpcParamArrayPushBackArray(ret_businfo_arr);
@@ -878,9 +878,9 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
         }
       }
 
-      for(proc_idx=0;proc_idx<CN_MAX_TCPROS_SERVER_CONNECTIONS && ret==0;proc_idx++)
+      for(proc_idx=0;proc_idx<n->tcpros_server_slots.n_slots && ret==0;proc_idx++)
       {
-        TcprosProcess *cur_ser_proc = &n->tcpros_server_proc[proc_idx];
+        TcprosProcess *cur_ser_proc = n->tcpros_server_proc[proc_idx];
         if(cur_ser_proc->topic_idx != -1)
         {
           ret_connect_arr = xmlrpcParamArrayPushBackArray(ret_businfo_arr);
@@ -949,12 +949,12 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       int paramsubidx = -1;
       char *parameter_key = xmlrpcParamGetString(key_param);
       int it = 0;
-      for (it = 0 ; it < n->n_paramsubs; it++)
+      for (it = 0 ; it < n->paramsub_slots.n_slots; it++)
       {
-        if (n->paramsubs[it].parameter_key == NULL)
+        if (n->paramsubs[it]->parameter_key == NULL)
           continue;
 
-        if (strncmp(parameter_key, n->paramsubs[it].parameter_key, strlen(n->paramsubs[it].parameter_key)) == 0)
+        if (strncmp(parameter_key, n->paramsubs[it]->parameter_key, strlen(n->paramsubs[it]->parameter_key)) == 0)
         {
           paramsubidx = it;
 
@@ -964,7 +964,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
 
       if (paramsubidx != -1)
       {
-        subscription = &n->paramsubs[it];
+        subscription = n->paramsubs[it];
         CrosNodeStatusUsr status;
         initCrosNodeStatus(&status);
         status.state = CROS_STATUS_PARAM_UPDATE;
@@ -1002,11 +1002,14 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       XmlrpcParam* param_array = xmlrpcParamArrayPushBackArray(array);
 
       int i = 0;
-      for(i = 0; i < n->n_subs; i++)
+      for(i = 0; i < n->sub_slots.n_slots; i++)
       {
+        if (n->subs[i]->topic_name == NULL)
+          continue;
+
         XmlrpcParam* sub_array = xmlrpcParamArrayPushBackArray(param_array);
-        xmlrpcParamArrayPushBackString(sub_array, n->subs[i].topic_name);
-        xmlrpcParamArrayPushBackString(sub_array, n->subs[i].topic_type);
+        xmlrpcParamArrayPushBackString(sub_array, n->subs[i]->topic_name);
+        xmlrpcParamArrayPushBackString(sub_array, n->subs[i]->topic_type);
       }
 
       break;
@@ -1020,11 +1023,14 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       XmlrpcParam* param_array = xmlrpcParamArrayPushBackArray(array);
 
       int i = 0;
-      for(i = 0; i < n->n_pubs; i++)
+      for(i = 0; i < n->pub_slots.n_slots; i++)
       {
+        if (n->pubs[i]->topic_name == NULL)
+          continue;
+
         XmlrpcParam* sub_array = xmlrpcParamArrayPushBackArray(param_array);
-        xmlrpcParamArrayPushBackString(sub_array, n->pubs[i].topic_name);
-        xmlrpcParamArrayPushBackString(sub_array, n->pubs[i].topic_type);
+        xmlrpcParamArrayPushBackString(sub_array, n->pubs[i]->topic_name);
+        xmlrpcParamArrayPushBackString(sub_array, n->pubs[i]->topic_type);
       }
 
       break;
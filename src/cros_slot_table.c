@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_slot_table.h"
+#include "cros_defs.h"
+
+enum { SLOT_TABLE_INIT_SLOTS = 4 };
+
+void cRosSlotTableInit( CrosSlotTable *t )
+{
+  t->n_slots = 0;
+  t->max_slots = 0;
+  t->free_slots = NULL;
+  t->n_free_slots = 0;
+}
+
+int cRosSlotTableReserve( CrosSlotTable *t, void ***table, int max_slots )
+{
+  void **new_table;
+  int *new_free_slots;
+
+  if( max_slots <= t->max_slots )
+    return 0;
+
+  new_table = (void **)realloc(*table, max_slots * sizeof(void *));
+  if( new_table == NULL )
+  {
+    PRINT_ERROR("cRosSlotTableReserve() : Can't allocate memory\n");
+    return -1;
+  }
+  *table = new_table;
+
+  // Every slot can be free at the same time, so the stack is as large as the table
+  new_free_slots = (int *)realloc(t->free_slots, max_slots * sizeof(int));
+  if( new_free_slots == NULL )
+  {
+    PRINT_ERROR("cRosSlotTableReserve() : Can't allocate memory\n");
+    return -1;
+  }
+  t->free_slots = new_free_slots;
+  t->max_slots = max_slots;
+
+  return 0;
+}
+
+int cRosSlotTableAdd( CrosSlotTable *t, void ***table, size_t elem_size )
+{
+  void *elem;
+
+  if( t->n_slots == t->max_slots &&
+      cRosSlotTableReserve( t, table, (t->max_slots == 0)? SLOT_TABLE_INIT_SLOTS : 2 * t->max_slots ) != 0 )
+    return -1;
+
+  elem = malloc(elem_size);
+  if( elem == NULL )
+  {
+    PRINT_ERROR("cRosSlotTableAdd() : Can't allocate memory\n");
+    return -1;
+  }
+
+  (*table)[t->n_slots] = elem;
+  return t->n_slots++;
+}
+
+int cRosSlotTablePushFree( CrosSlotTable *t, int idx )
+{
+  if( idx < 0 || idx >= t->n_slots || t->n_free_slots >= t->max_slots )
+    return -1;
+
+  t->free_slots[t->n_free_slots++] = idx;
+  return 0;
+}
+
+int cRosSlotTablePopFree( CrosSlotTable *t )
+{
+  if( t->n_free_slots == 0 )
+    return -1;
+
+  return t->free_slots[--t->n_free_slots];
+}
+
+void cRosSlotTableRelease( CrosSlotTable *t, void ***table )
+{
+  int i;
+
+  if( *table != NULL )
+  {
+    for( i = 0; i < t->n_slots; i++ )
+      free((*table)[i]);
+    free(*table);
+    *table = NULL;
+  }
+  free(t->free_slots);
+  cRosSlotTableInit( t );
+}
+
+void cRosSlotListInit( CrosSlotList *l )
+{
+  l->slots = NULL;
+  l->n_slots = 0;
+  l->max_slots = 0;
+}
+
+int cRosSlotListPush( CrosSlotList *l, int idx )
+{
+  if( l->n_slots == l->max_slots )
+  {
+    int new_max = (l->max_slots == 0)? SLOT_TABLE_INIT_SLOTS : 2 * l->max_slots;
+    int *new_slots = (int *)realloc(l->slots, new_max * sizeof(int));
+    if( new_slots == NULL )
+    {
+      PRINT_ERROR("cRosSlotListPush() : Can't allocate memory\n");
+      return -1;
+    }
+    l->slots = new_slots;
+    l->max_slots = new_max;
+  }
+
+  l->slots[l->n_slots++] = idx;
+  return 0;
+}
+
+void cRosSlotListConsume( CrosSlotList *l, int n_slots )
+{
+  if( n_slots >= l->n_slots )
+  {
+    l->n_slots = 0;
+    return;
+  }
+
+  memmove(l->slots, l->slots + n_slots, (l->n_slots - n_slots) * sizeof(int));
+  l->n_slots -= n_slots;
+}
+
+void cRosSlotListRelease( CrosSlotList *l )
+{
+  free(l->slots);
+  cRosSlotListInit( l );
+}
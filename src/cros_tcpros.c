@@ -4,6 +4,7 @@
 #include <ctype.h>
 
 #include "cros_api.h"
+#include "cros_api_internal.h"
 #include "cros_tcpros.h"
 #include "cros_defs.h"
 #include "tcpros_tags.h"
@@ -295,7 +296,7 @@ TcprosParserState cRosMessageParseSubcriptionHeader( CrosNode *n, int server_idx
 {
   PRINT_VVDEBUG("cRosMessageParseSubcriptionHeader()\n");
 
-  TcprosProcess *server_proc = &(n->tcpros_server_proc[server_idx]);
+  TcprosProcess *server_proc = n->tcpros_server_proc[server_idx];
   DynBuffer *packet = &(server_proc->packet);
 
   // Save position indicator: it will be restored
@@ -316,9 +317,9 @@ TcprosParserState cRosMessageParseSubcriptionHeader( CrosNode *n, int server_idx
   {
     int topic_found = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_pubs; i++)
+    for( i = 0 ; i < n->pub_slots.n_slots; i++)
     {
-      PublisherNode *pub = &n->pubs[i];
+      PublisherNode *pub = n->pubs[i];
       if (pub->topic_name == NULL)
         continue;
 
@@ -328,14 +329,17 @@ TcprosParserState cRosMessageParseSubcriptionHeader( CrosNode *n, int server_idx
           (strcmp(pub->topic_type, dynStringGetData(&(server_proc->type))) == 0 || strcmp(dynStringGetData(&(server_proc->type)), "*") == 0) &&
           (strcmp(pub->md5sum, dynStringGetData(&(server_proc->md5sum))) == 0 || strcmp(dynStringGetData(&(server_proc->md5sum)), "*") == 0))
       {
-        int list_elem;
-
         topic_found = 1;
-        server_proc->topic_idx = i; // Assign a topic (publisher index) to the TCPROS process
-        // Add the TcprosProcess index to the Publisher
-        for(list_elem=0;pub->tcpros_id_list[list_elem]!=-1;list_elem++); // Locate the list end
-        pub->tcpros_id_list[list_elem] = server_idx;
-        pub->tcpros_id_list[list_elem+1] = -1; // Set a new list end (sentinel)
+        // Set up the outgoing queue of the connection and add the TcprosProcess index to the Publisher
+        server_proc->frame_queue.policy = pub->conn_queue_policy;
+        if( pub->zerocopy_min_size > 0 && tcpIpSocketSetZeroCopy( &(server_proc->socket) ) )
+          server_proc->zerocopy_min_size = pub->zerocopy_min_size;
+        if( tcprosFrameQueueSetCapacity( &(server_proc->frame_queue), pub->conn_queue_size ) == 0 &&
+            cRosNodeWakeUpPublisher(n, i) == 0 && // The pending messages can be sent as soon as the process is added
+            cRosNodePublisherAddTcprosProc(pub, server_idx) == 0 )
+          server_proc->topic_idx = i; // Assign a topic (publisher index) to the TCPROS process
+        else
+          ret = TCPROS_PARSER_ERROR;
         break;
       }
     }
@@ -365,7 +369,7 @@ TcprosParserState cRosMessageParsePublicationHeader( CrosNode *n, int client_idx
 {
   PRINT_VVDEBUG("cRosMessageParsePublicationHeader()\n");
 
-  TcprosProcess *client_proc = &(n->tcpros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
   DynBuffer *packet = &(client_proc->packet);
 
   /* Save position indicator: it will be restored */
@@ -386,9 +390,9 @@ TcprosParserState cRosMessageParsePublicationHeader( CrosNode *n, int client_idx
   {
     int subscriber_found = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_subs; i++)
+    for( i = 0 ; i < n->sub_slots.n_slots; i++)
     {
-      SubscriberNode *sub = &n->subs[i];
+      SubscriberNode *sub = n->subs[i];
       if (sub->topic_name == NULL)
         continue;
 
@@ -422,18 +426,18 @@ void cRosMessagePrepareSubcriptionHeader( CrosNode *n, int client_idx )
 {
   PRINT_VVDEBUG("cRosMessagePrepareSubcriptionHeader()\n");
 
-  TcprosProcess *client_proc = &(n->tcpros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->tcpros_client_proc[client_idx];
   int sub_idx = client_proc->topic_idx;
   DynBuffer *packet = &(client_proc->packet);
   uint32_t header_len = 0, header_out_len = 0;
   dynBufferPushBackUInt32( packet, header_out_len );
 
-  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->subs[sub_idx].message_definition );
+  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->subs[sub_idx]->message_definition );
   header_len += pushBackField( packet, &TCPROS_CALLERID_TAG, n->name );
-  header_len += pushBackField( packet, &TCPROS_TOPIC_TAG, n->subs[sub_idx].topic_name );
-  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->subs[sub_idx].md5sum );
-  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->subs[sub_idx].topic_type );
-  if(n->subs[sub_idx].tcp_nodelay)
+  header_len += pushBackField( packet, &TCPROS_TOPIC_TAG, n->subs[sub_idx]->topic_name );
+  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->subs[sub_idx]->md5sum );
+  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->subs[sub_idx]->topic_type );
+  if(n->subs[sub_idx]->tcp_nodelay)
     header_len += pushBackField( packet, &TCPROS_TCP_NODELAY_TAG, "1" );
 
   header_out_len= HOST_TO_ROS_UINT32( header_len );
@@ -441,25 +445,50 @@ void cRosMessagePrepareSubcriptionHeader( CrosNode *n, int client_idx )
   *header_len_p = header_out_len;
 }
 
-cRosErrCodePack cRosMessageParsePublicationPacket( CrosNode *n, int client_idx )
+cRosErrCodePack cRosMessageParsePublicationPacket( CrosNode *n, int client_idx, DynBuffer *packet )
 {
   cRosErrCodePack ret_err;
   SubscriberNode *sub_node;
   TcprosProcess *client_proc;
-  DynBuffer *packet;
   void *data_context;
 
-  client_proc = &(n->tcpros_client_proc[client_idx]);
-  packet = &(client_proc->packet);
-  sub_node = &n->subs[client_proc->topic_idx];
+  client_proc = n->tcpros_client_proc[client_idx];
+  sub_node = n->subs[client_proc->topic_idx];
   data_context = sub_node->context;
 
-  if(cRosMessageQueueVacancies(&sub_node->msg_queue) == 0)
-    sub_node->msg_queue_overflow = 1; // No space in the queue for the new message
-
-  ret_err = cRosNodeDeserializeIncomingPacket(packet, data_context);
+  if(sub_node->zerocopy_views || sub_node->lazy_decoding)
+  {
+    // The packet memory is handed over to the received message, so the next packet is received in new memory
+    SharedBuffer *shared_packet = sharedBufferNewFrom(packet);
+    if(shared_packet != NULL)
+    {
+      if(sub_node->lazy_decoding)
+        ret_err = cRosNodeDeserializeIncomingLazy(shared_packet, data_context);
+      else
+        ret_err = cRosNodeDeserializeIncomingView(shared_packet, data_context);
+      sharedBufferRelease(shared_packet);
+    }
+    else
+      ret_err = CROS_MEM_ALLOC_ERR;
+  }
+  else
+    ret_err = cRosNodeDeserializeIncomingPacket(packet, data_context);
   if(ret_err == CROS_SUCCESS_ERR_PACK)
-    ret_err = cRosNodeSubscriberCallback(data_context); // Calls the subscriber application-defined callback
+  {
+    cRosNodeApplySubscriberQueuePolicy(sub_node);
+    if(sub_node->callback_strand.pool != NULL) // The node has a worker pool: hand the message to it
+    {
+      ret_err = cRosNodePostSubscriberCallback(&sub_node->callback_strand, data_context);
+      if(ret_err == CROS_CALLBACK_QUEUE_FULL_ERR) // The callbacks are lagging behind: the message is only queued
+      {
+        PRINT_VDEBUG("cRosMessageParsePublicationPacket() : Subscriber callback queue full. Message not passed to the callback\n");
+        sub_node->msg_queue_overflow = 1;
+        ret_err = CROS_SUCCESS_ERR_PACK;
+      }
+    }
+    else
+      ret_err = cRosNodeSubscriberCallback(data_context); // Calls the subscriber application-defined callback
+  }
   else
     cRosPrintErrCodePack(ret_err, "cRosNodeSubscriberCallback() failed decoding the received packet");
 
@@ -470,7 +499,7 @@ void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx )
 {
   PRINT_VVDEBUG("cRosMessagePreparePublicationHeader()\n");
 
-  TcprosProcess *server_proc = &(n->tcpros_server_proc[server_idx]);
+  TcprosProcess *server_proc = n->tcpros_server_proc[server_idx];
   int pub_idx = server_proc->topic_idx;
   DynBuffer *packet = &(server_proc->packet);
   uint32_t header_len = 0, header_out_len = 0;
@@ -478,12 +507,12 @@ void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx )
 
   // http://wiki.ros.org/ROS/TCPROS doesn't mention to send message_definition and topic_name
   // but they are sent anyway in ros groovy
-  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->pubs[pub_idx].message_definition );
+  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->pubs[pub_idx]->message_definition );
   header_len += pushBackField( packet, &TCPROS_CALLERID_TAG, n->name );
   header_len += pushBackField( packet, &TCPROS_LATCHING_TAG, "1" );
-  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->pubs[pub_idx].md5sum );
-  header_len += pushBackField( packet, &TCPROS_TOPIC_TAG, n->pubs[pub_idx].topic_name );
-  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->pubs[pub_idx].topic_type );
+  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->pubs[pub_idx]->md5sum );
+  header_len += pushBackField( packet, &TCPROS_TOPIC_TAG, n->pubs[pub_idx]->topic_name );
+  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->pubs[pub_idx]->topic_type );
   header_len += pushBackField( packet, &TCPROS_TCP_NODELAY_TAG, (server_proc->tcp_nodelay)?"1":"0" );
 
   header_out_len = HOST_TO_ROS_UINT32( header_len );
@@ -491,30 +520,32 @@ void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx )
   *header_len_p = header_out_len;
 }
 
-cRosErrCodePack cRosMessagePreparePublicationPacket( CrosNode *node, int server_idx )
+cRosErrCodePack cRosMessagePreparePublicationFrame( CrosNode *node, int pub_idx, int take_arrays, TcprosFrame **frame_ptr )
 {
   cRosErrCodePack ret_err;
   PublisherNode *pub_node;
-  TcprosProcess *server_proc;
-  int pub_idx;
-  DynBuffer *packet;
-  uint32_t *packet_data_size_ptr;
-  uint32_t packet_size;
-  PRINT_VVDEBUG("cRosMessagePreparePublicationPacket()\n");
+  TcprosFrame *frame;
+  PRINT_VVDEBUG("cRosMessagePreparePublicationFrame()\n");
 
-  server_proc = &(node->tcpros_server_proc[server_idx]);
-  pub_idx = server_proc->topic_idx;
-  packet = &(server_proc->packet);
-  dynBufferPushBackUInt32( packet, 0 ); // Placeholder for packet size
+  *frame_ptr = NULL;
+  frame = tcprosFrameNew();
+  if( frame == NULL )
+    return CROS_MEM_ALLOC_ERR;
 
-  pub_node = &node->pubs[pub_idx];
+  pub_node = node->pubs[pub_idx];
 
-  ret_err = cRosNodeSerializeOutgoingMessage(packet, pub_node->context);
+  // The packet size field is not serialized in the packet: the frame sends it as a separate region
+  ret_err = cRosNodeSerializeOutgoingFrame( frame, pub_node->context, (take_arrays)? CN_PUBLISHER_EXTERNAL_ARRAY_MIN_SIZE : 0 );
+  if( ret_err == CROS_SUCCESS_ERR_PACK && tcprosFrameSeal( frame ) != 0 )
+    ret_err = CROS_MEM_ALLOC_ERR;
 
-  packet_size = (uint32_t)dynBufferGetSize(packet) - sizeof(uint32_t);
-  packet_data_size_ptr = (uint32_t *)dynBufferGetData(packet);
-  *packet_data_size_ptr = packet_size;
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+  {
+    tcprosFrameRelease( frame );
+    return ret_err;
+  }
 
+  *frame_ptr = frame;
   return ret_err;
 }
 
@@ -641,7 +672,7 @@ TcprosParserState cRosMessageParseServiceCallerHeader( CrosNode *n, int server_i
 {
   PRINT_VVDEBUG("cRosMessageParseServiceCallerHeader()\n");
 
-  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
+  TcprosProcess *server_proc = n->rpcros_server_proc[server_idx];
   DynBuffer *packet = &(server_proc->packet);
 
   /* Save position indicator: it will be restored */
@@ -659,12 +690,15 @@ TcprosParserState cRosMessageParseServiceCallerHeader( CrosNode *n, int server_i
   {
     int svc_name_match = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_service_providers; i++)
+    for( i = 0 ; i < n->service_provider_slots.n_slots; i++)
     {
-      if( strcmp( n->service_providers[i].service_name, dynStringGetData(&(server_proc->service))) == 0)
+      if( n->service_providers[i]->service_name == NULL )
+        continue;
+
+      if( strcmp( n->service_providers[i]->service_name, dynStringGetData(&(server_proc->service))) == 0)
       {
         svc_name_match = 1;
-        if(strcmp( n->service_providers[i].md5sum, dynStringGetData(&(server_proc->md5sum))) == 0)
+        if(strcmp( n->service_providers[i]->md5sum, dynStringGetData(&(server_proc->md5sum))) == 0)
         {
           service_found = 1;
           server_proc->service_idx = i;
@@ -683,9 +717,12 @@ TcprosParserState cRosMessageParseServiceCallerHeader( CrosNode *n, int server_i
   else if( header_flags == ( header_flags & TCPROS_SERVICEPROBE_HEADER_FLAGS) || header_flags == ( header_flags & TCPROS_SERVICEPROBE_MATLAB_HEADER_FLAGS) )
   {
     int i = 0;
-    for( i = 0 ; i < n->n_service_providers; i++)
+    for( i = 0 ; i < n->service_provider_slots.n_slots; i++)
     {
-      if( strcmp( n->service_providers[i].service_name, dynStringGetData(&(server_proc->service))) == 0)
+      if( n->service_providers[i]->service_name == NULL )
+        continue;
+
+      if( strcmp( n->service_providers[i]->service_name, dynStringGetData(&(server_proc->service))) == 0)
       {
         service_found = 1;
         server_proc->service_idx = i;
@@ -838,7 +875,7 @@ TcprosParserState cRosMessageParseServiceProviderHeader( CrosNode *n, int client
 {
   PRINT_VVDEBUG("cRosMessageParseServiceProviderHeader()\n");
 
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
   DynBuffer *packet = &(client_proc->packet);
 
   /* Save position indicator: it will be restored */
@@ -857,7 +894,7 @@ TcprosParserState cRosMessageParseServiceProviderHeader( CrosNode *n, int client
   }
   else
   {
-    ServiceCallerNode *svc_caller = &n->service_callers[client_proc->service_idx];
+    ServiceCallerNode *svc_caller = n->service_callers[client_proc->service_idx];
 
     if (header_flags&TCPROS_SERVICE_FLAG && strcmp(svc_caller->service_name, dynStringGetData(&(client_proc->service))) != 0)
     {
@@ -898,25 +935,25 @@ void cRosMessagePrepareServiceCallHeader(CrosNode *n, int client_idx)
 {
   PRINT_VVDEBUG("cRosMessagePrepareServiceCallHeader()\n");
 
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
   int srv_idx = client_proc->service_idx;
   DynBuffer *packet = &(client_proc->packet);
   uint32_t header_len = 0, header_out_len = 0;
   dynBufferPushBackUInt32( packet, header_out_len );
 
   // Same format as MATLAB second header (not the probe one)
-  header_len += pushBackField( packet, &TCPROS_SERVICE_TAG, n->service_callers[srv_idx].service_name );
-  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->service_callers[srv_idx].message_definition );
+  header_len += pushBackField( packet, &TCPROS_SERVICE_TAG, n->service_callers[srv_idx]->service_name );
+  header_len += pushBackField( packet, &TCPROS_MESSAGE_DEFINITION_TAG, n->service_callers[srv_idx]->message_definition );
   header_len += pushBackField( packet, &TCPROS_CALLERID_TAG, n->name );
-  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->service_callers[srv_idx].md5sum );
+  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->service_callers[srv_idx]->md5sum );
   if(client_proc->persistent)
     header_len += pushBackField( packet, &TCPROS_PERSISTENT_TAG, "1" );
   if(client_proc->tcp_nodelay)
     header_len += pushBackField( packet, &TCPROS_TCP_NODELAY_TAG, "1" );
 
- //header_len += pushBackField( packet, &TCPROS_SERVICE_REQUESTTYPE_TAG, n->service_callers[srv_idx].servicerequest_type );
- //header_len += pushBackField( packet, &TCPROS_SERVICE_RESPONSETYPE_TAG, n->service_callers[srv_idx].serviceresponse_type );
-  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->service_callers[srv_idx].service_type );
+ //header_len += pushBackField( packet, &TCPROS_SERVICE_REQUESTTYPE_TAG, n->service_callers[srv_idx]->servicerequest_type );
+ //header_len += pushBackField( packet, &TCPROS_SERVICE_RESPONSETYPE_TAG, n->service_callers[srv_idx]->serviceresponse_type );
+  header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->service_callers[srv_idx]->service_type );
 
   header_out_len = HOST_TO_ROS_UINT32( header_len );
   uint32_t *header_len_p = (uint32_t *)dynBufferGetData( packet );
@@ -928,12 +965,12 @@ cRosErrCodePack cRosMessagePrepareServiceCallPacket( CrosNode *n, int client_idx
   cRosErrCodePack ret_err;
 
   PRINT_VVDEBUG("cRosMessagePrepareServiceCallPacket()\n");
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
   int svc_idx = client_proc->service_idx;
   DynBuffer *packet = &(client_proc->packet);
   dynBufferPushBackUInt32( packet, 0 ); // Placehoder for packet size
 
-  void* data_context = n->service_callers[svc_idx].context;
+  void* data_context = n->service_callers[svc_idx]->context;
   ret_err = cRosNodeSerializeOutgoingMessage(packet, data_context); // Serialize the call outgoing message into the outgoing packet
 
   uint32_t data_size = (uint32_t)dynBufferGetSize(packet) - sizeof(uint32_t);
@@ -947,12 +984,12 @@ cRosErrCodePack cRosMessageParseServiceResponsePacket( CrosNode *n, int client_i
 {
   cRosErrCodePack ret_err;
 
-  TcprosProcess *client_proc = &(n->rpcros_client_proc[client_idx]);
+  TcprosProcess *client_proc = n->rpcros_client_proc[client_idx];
   DynBuffer *packet = &(client_proc->packet);
   if(client_proc->ok_byte == TCPROS_OK_BYTE_SUCCESS)
   {
     int svc_idx = client_proc->service_idx;
-    void* data_context = n->service_callers[svc_idx].context;
+    void* data_context = n->service_callers[svc_idx]->context;
 
     ret_err = cRosNodeDeserializeIncomingPacket(packet, data_context); // Deserialize the message response
 
@@ -978,7 +1015,7 @@ void cRosMessagePrepareServiceProviderHeader( CrosNode *n, int server_idx)
 {
   PRINT_VVDEBUG("cRosMessagePreparePublicationHeader()\n");
 
-  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
+  TcprosProcess *server_proc = n->rpcros_server_proc[server_idx];
   int srv_idx = server_proc->service_idx;
   DynBuffer *packet = &(server_proc->packet);
   uint32_t header_len = 0, header_out_len = 0;
@@ -987,13 +1024,13 @@ void cRosMessagePrepareServiceProviderHeader( CrosNode *n, int server_idx)
   // http://wiki.ros.org/ROS/TCPROS doesn't mention to send message_definition and topic_name
   // but they are sent anyway in ros groovy
   header_len += pushBackField( packet, &TCPROS_CALLERID_TAG, n->name );
-  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->service_providers[srv_idx].md5sum );
+  header_len += pushBackField( packet, &TCPROS_MD5SUM_TAG, n->service_providers[srv_idx]->md5sum );
 
   //if(server_proc->probe)
   //{
-    header_len += pushBackField( packet, &TCPROS_SERVICE_REQUESTTYPE_TAG, n->service_providers[srv_idx].servicerequest_type );
-    header_len += pushBackField( packet, &TCPROS_SERVICE_RESPONSETYPE_TAG, n->service_providers[srv_idx].serviceresponse_type );
-    header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->service_providers[srv_idx].service_type );
+    header_len += pushBackField( packet, &TCPROS_SERVICE_REQUESTTYPE_TAG, n->service_providers[srv_idx]->servicerequest_type );
+    header_len += pushBackField( packet, &TCPROS_SERVICE_RESPONSETYPE_TAG, n->service_providers[srv_idx]->serviceresponse_type );
+    header_len += pushBackField( packet, &TCPROS_TYPE_TAG, n->service_providers[srv_idx]->service_type );
   //}
 
   header_out_len = HOST_TO_ROS_UINT32( header_len );
@@ -1001,16 +1038,44 @@ void cRosMessagePrepareServiceProviderHeader( CrosNode *n, int server_idx)
   *header_len_p = header_out_len;
 }
 
+// Replace the packet content with the response to a service call: the serialized response if the call succeeded,
+// or a failure otherwise
+static void packServiceResponse( DynBuffer *packet, cRosErrCodePack call_err, DynBuffer *service_response )
+{
+  uint8_t ok_byte; // OK field (byte size) of the service response packet
+
+  dynBufferClear(packet); // clear packet buffer
+
+  if(call_err == CROS_SUCCESS_ERR_PACK)
+  {
+    ok_byte = TCPROS_OK_BYTE_SUCCESS;
+    dynBufferPushBackBuf( packet, &ok_byte, sizeof(uint8_t) );
+    dynBufferPushBackUInt32( packet, dynBufferGetSize(service_response)); // data size field
+    dynBufferPushBackBuf( packet, dynBufferGetData(service_response), dynBufferGetSize(service_response)); // Response data
+  }
+  else
+  {
+    ok_byte = TCPROS_OK_BYTE_FAIL;
+    dynBufferPushBackBuf( packet, &ok_byte, sizeof(uint8_t) );
+    dynBufferPushBackUInt32( packet, 0); // Serialize an error string of size 0: Just add the data size field
+  }
+}
+
+void cRosMessageSetServiceResponsePacket( CrosNode *n, int server_idx, cRosErrCodePack call_err, DynBuffer *service_response )
+{
+  TcprosProcess *server_proc = n->rpcros_server_proc[server_idx];
+  packServiceResponse( &(server_proc->packet), call_err, service_response );
+}
+
 cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server_idx)
 {
   cRosErrCodePack ret_err;
-  uint8_t ok_byte; // OK field (byte size) of the service response packet
 
   PRINT_VVDEBUG("cRosMessageParseServiceArgumentsPacket()\n");
-  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
+  TcprosProcess *server_proc = n->rpcros_server_proc[server_idx];
   DynBuffer *packet = &(server_proc->packet);
   int srv_idx = server_proc->service_idx;
-  void* service_context = n->service_providers[srv_idx].context;
+  void* service_context = n->service_providers[srv_idx]->context;
   DynBuffer service_response;
   dynBufferInit(&service_response);
 
@@ -1027,22 +1092,7 @@ cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server
       cRosPrintErrCodePack(ret_err, "cRosNodeServiceProviderCallback() failed encoding the packet to send");
   }
 
-  dynBufferClear(packet); // clear packet buffer
-
-  if(ret_err == CROS_SUCCESS_ERR_PACK)
-  {
-    ok_byte = TCPROS_OK_BYTE_SUCCESS;
-    dynBufferPushBackBuf( packet, &ok_byte, sizeof(uint8_t) );
-    dynBufferPushBackUInt32( packet, dynBufferGetSize(&service_response)); // data size field
-    dynBufferPushBackBuf( packet, dynBufferGetData(&service_response), dynBufferGetSize(&service_response)); // Response data
-  }
-  else
-  {
-    ok_byte = TCPROS_OK_BYTE_FAIL;
-    dynBufferPushBackBuf( packet, &ok_byte, sizeof(uint8_t) );
-    dynBufferPushBackUInt32( packet, 0); // Serialize an error string of size 0: Just add the data size field
-  }
-
+  packServiceResponse( packet, ret_err, &service_response );
   dynBufferRelease(&service_response);
 
   return ret_err;
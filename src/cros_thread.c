@@ -0,0 +1,181 @@
+#ifndef _WIN32
+#  include <sched.h>
+#endif
+
+#include "cros_thread.h"
+#include "cros_defs.h"
+
+#ifdef _WIN32
+
+static DWORD WINAPI threadEntry( LPVOID param )
+{
+  CrosThread *t = (CrosThread *)param;
+  t->func( t->arg );
+  return 0;
+}
+
+int cRosThreadCreate( CrosThread *t, CrosThreadFunc func, void *arg )
+{
+  t->func = func;
+  t->arg = arg;
+  t->handle = CreateThread( NULL, 0, threadEntry, t, 0, NULL );
+  if( t->handle == NULL )
+  {
+    PRINT_ERROR("cRosThreadCreate() : Can't create the thread\n");
+    return -1;
+  }
+  return 0;
+}
+
+void cRosThreadJoin( CrosThread *t )
+{
+  WaitForSingleObject( t->handle, INFINITE );
+  CloseHandle( t->handle );
+  t->handle = NULL;
+}
+
+void cRosThreadYield( void )
+{
+  SwitchToThread();
+}
+
+int cRosMutexInit( CrosMutex *m )
+{
+  InitializeCriticalSection( &(m->cs) );
+  return 0;
+}
+
+void cRosMutexRelease( CrosMutex *m )
+{
+  DeleteCriticalSection( &(m->cs) );
+}
+
+void cRosMutexLock( CrosMutex *m )
+{
+  EnterCriticalSection( &(m->cs) );
+}
+
+void cRosMutexUnlock( CrosMutex *m )
+{
+  LeaveCriticalSection( &(m->cs) );
+}
+
+static BOOL CALLBACK onceEntry( PINIT_ONCE once, PVOID param, PVOID *context )
+{
+  ((CrosOnceFunc)param)();
+  return TRUE;
+}
+
+void cRosOnceRun( CrosOnce *once, CrosOnceFunc func )
+{
+  InitOnceExecuteOnce( once, onceEntry, (PVOID)func, NULL );
+}
+
+int cRosCondInit( CrosCond *c )
+{
+  InitializeConditionVariable( &(c->cond) );
+  return 0;
+}
+
+void cRosCondRelease( CrosCond *c )
+{
+  // Win32 condition variables do not hold resources
+}
+
+void cRosCondWait( CrosCond *c, CrosMutex *m )
+{
+  SleepConditionVariableCS( &(c->cond), &(m->cs), INFINITE );
+}
+
+void cRosCondSignal( CrosCond *c )
+{
+  WakeConditionVariable( &(c->cond) );
+}
+
+void cRosCondBroadcast( CrosCond *c )
+{
+  WakeAllConditionVariable( &(c->cond) );
+}
+
+#else
+
+static void *threadEntry( void *param )
+{
+  CrosThread *t = (CrosThread *)param;
+  t->func( t->arg );
+  return NULL;
+}
+
+int cRosThreadCreate( CrosThread *t, CrosThreadFunc func, void *arg )
+{
+  t->func = func;
+  t->arg = arg;
+  if( pthread_create( &(t->handle), NULL, threadEntry, t ) != 0 )
+  {
+    PRINT_ERROR("cRosThreadCreate() : Can't create the thread\n");
+    return -1;
+  }
+  return 0;
+}
+
+void cRosThreadJoin( CrosThread *t )
+{
+  pthread_join( t->handle, NULL );
+}
+
+void cRosThreadYield( void )
+{
+  sched_yield();
+}
+
+int cRosMutexInit( CrosMutex *m )
+{
+  return (pthread_mutex_init( &(m->mutex), NULL ) == 0)? 0 : -1;
+}
+
+void cRosMutexRelease( CrosMutex *m )
+{
+  pthread_mutex_destroy( &(m->mutex) );
+}
+
+void cRosMutexLock( CrosMutex *m )
+{
+  pthread_mutex_lock( &(m->mutex) );
+}
+
+void cRosMutexUnlock( CrosMutex *m )
+{
+  pthread_mutex_unlock( &(m->mutex) );
+}
+
+void cRosOnceRun( CrosOnce *once, CrosOnceFunc func )
+{
+  pthread_once( once, func );
+}
+
+int cRosCondInit( CrosCond *c )
+{
+  return (pthread_cond_init( &(c->cond), NULL ) == 0)? 0 : -1;
+}
+
+void cRosCondRelease( CrosCond *c )
+{
+  pthread_cond_destroy( &(c->cond) );
+}
+
+void cRosCondWait( CrosCond *c, CrosMutex *m )
+{
+  pthread_cond_wait( &(c->cond), &(m->mutex) );
+}
+
+void cRosCondSignal( CrosCond *c )
+{
+  pthread_cond_signal( &(c->cond) );
+}
+
+void cRosCondBroadcast( CrosCond *c )
+{
+  pthread_cond_broadcast( &(c->cond) );
+}
+
+#endif
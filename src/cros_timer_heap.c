@@ -0,0 +1,144 @@
+#include <stdlib.h>
+
+#include "cros_timer_heap.h"
+#include "cros_defs.h"
+
+enum { TIMER_HEAP_INIT_TIMERS = 8 };
+
+void cRosTimerInit( CrosTimer *t, uint32_t tag )
+{
+  t->expiry = 0;
+  t->tag = tag;
+  t->heap_idx = -1;
+}
+
+int cRosTimerIsScheduled( const CrosTimer *t )
+{
+  return (t->heap_idx >= 0);
+}
+
+void cRosTimerHeapInit( CrosTimerHeap *h )
+{
+  h->timers = NULL;
+  h->n_timers = 0;
+  h->max_timers = 0;
+}
+
+void cRosTimerHeapRelease( CrosTimerHeap *h )
+{
+  int i;
+
+  for( i = 0; i < h->n_timers; i++ )
+    h->timers[i]->heap_idx = -1;
+  free( h->timers );
+  cRosTimerHeapInit( h );
+}
+
+static void placeTimer( CrosTimerHeap *h, CrosTimer *t, int idx )
+{
+  h->timers[idx] = t;
+  t->heap_idx = idx;
+}
+
+static void siftUp( CrosTimerHeap *h, int idx )
+{
+  CrosTimer *t = h->timers[idx];
+
+  while( idx > 0 )
+  {
+    int parent = (idx - 1) / 2;
+    if( h->timers[parent]->expiry <= t->expiry )
+      break;
+    placeTimer( h, h->timers[parent], idx );
+    idx = parent;
+  }
+  placeTimer( h, t, idx );
+}
+
+static void siftDown( CrosTimerHeap *h, int idx )
+{
+  CrosTimer *t = h->timers[idx];
+
+  for(;;)
+  {
+    int child = 2 * idx + 1;
+    if( child >= h->n_timers )
+      break;
+    if( child + 1 < h->n_timers && h->timers[child + 1]->expiry < h->timers[child]->expiry )
+      child++;
+    if( t->expiry <= h->timers[child]->expiry )
+      break;
+    placeTimer( h, h->timers[child], idx );
+    idx = child;
+  }
+  placeTimer( h, t, idx );
+}
+
+int cRosTimerHeapSchedule( CrosTimerHeap *h, CrosTimer *t, uint64_t expiry )
+{
+  if( t->heap_idx >= 0 )
+  {
+    uint64_t prev_expiry = t->expiry;
+    t->expiry = expiry;
+    if( expiry < prev_expiry )
+      siftUp( h, t->heap_idx );
+    else
+      siftDown( h, t->heap_idx );
+    return 0;
+  }
+
+  if( h->n_timers == h->max_timers )
+  {
+    int new_max = (h->max_timers == 0)? TIMER_HEAP_INIT_TIMERS : 2 * h->max_timers;
+    CrosTimer **new_timers = (CrosTimer **)realloc( h->timers, new_max * sizeof(CrosTimer *) );
+    if( new_timers == NULL )
+    {
+      PRINT_ERROR("cRosTimerHeapSchedule() : Can't allocate memory\n");
+      return -1;
+    }
+    h->timers = new_timers;
+    h->max_timers = new_max;
+  }
+
+  t->expiry = expiry;
+  placeTimer( h, t, h->n_timers++ );
+  siftUp( h, t->heap_idx );
+  return 0;
+}
+
+void cRosTimerHeapCancel( CrosTimerHeap *h, CrosTimer *t )
+{
+  int idx = t->heap_idx;
+  CrosTimer *last;
+
+  if( idx < 0 || idx >= h->n_timers || h->timers[idx] != t )
+    return;
+
+  t->heap_idx = -1;
+  last = h->timers[--h->n_timers];
+  if( last == t )
+    return;
+
+  // Move the last timer to the freed position and restore the heap order
+  placeTimer( h, last, idx );
+  if( idx > 0 && h->timers[(idx - 1) / 2]->expiry > last->expiry )
+    siftUp( h, idx );
+  else
+    siftDown( h, idx );
+}
+
+CrosTimer *cRosTimerHeapPeek( CrosTimerHeap *h )
+{
+  return (h->n_timers > 0)? h->timers[0] : NULL;
+}
+
+CrosTimer *cRosTimerHeapPopExpired( CrosTimerHeap *h, uint64_t now )
+{
+  CrosTimer *t = cRosTimerHeapPeek( h );
+
+  if( t == NULL || t->expiry > now )
+    return NULL;
+
+  cRosTimerHeapCancel( h, t );
+  return t;
+}
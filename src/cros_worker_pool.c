@@ -0,0 +1,245 @@
+#include <stdlib.h>
+
+#include "cros_worker_pool.h"
+#include "cros_defs.h"
+
+// The pool lock must be held by the callers of the list functions
+static void appendReadyStrand( CrosWorkerPool *p, CrosWorkStrand *s )
+{
+  s->next_ready = NULL;
+  if( p->ready_last != NULL )
+    p->ready_last->next_ready = s;
+  else
+    p->ready_first = s;
+  p->ready_last = s;
+}
+
+static CrosWorkStrand *popReadyStrand( CrosWorkerPool *p )
+{
+  CrosWorkStrand *s = p->ready_first;
+  if( s != NULL )
+  {
+    p->ready_first = s->next_ready;
+    if( p->ready_first == NULL )
+      p->ready_last = NULL;
+    s->next_ready = NULL;
+  }
+  return s;
+}
+
+static void removeReadyStrand( CrosWorkerPool *p, CrosWorkStrand *s )
+{
+  CrosWorkStrand *prev = NULL, *cur;
+
+  for( cur = p->ready_first; cur != NULL && cur != s; cur = cur->next_ready )
+    prev = cur;
+
+  if( cur == NULL )
+    return;
+
+  if( prev != NULL )
+    prev->next_ready = s->next_ready;
+  else
+    p->ready_first = s->next_ready;
+  if( p->ready_last == s )
+    p->ready_last = prev;
+  s->next_ready = NULL;
+}
+
+static void workerThread( void *arg )
+{
+  CrosWorkerPool *p = (CrosWorkerPool *)arg;
+  CrosWorkStrand *s;
+  CrosWorkItem item;
+
+  cRosMutexLock( &(p->lock) );
+  for(;;)
+  {
+    while( !p->stopping && p->ready_first == NULL )
+      cRosCondWait( &(p->work_ready), &(p->lock) );
+    if( p->stopping )
+      break;
+
+    s = popReadyStrand( p );
+    item = s->items[s->first];
+    s->first = (s->first + 1) % s->capacity;
+    s->count--;
+    s->running = 1;
+    cRosMutexUnlock( &(p->lock) );
+
+    item.func( item.arg, 0 );
+
+    cRosMutexLock( &(p->lock) );
+    s->running = 0;
+    // Only one item of the strand is run at a time. The strand goes back to the end of the ready list,
+    // so that a busy strand does not monopolize the thread
+    if( s->count > 0 )
+    {
+      appendReadyStrand( p, s );
+      cRosCondSignal( &(p->work_ready) );
+    }
+    else
+      s->scheduled = 0;
+    cRosCondBroadcast( &(p->strand_done) );
+  }
+  cRosMutexUnlock( &(p->lock) );
+}
+
+int cRosWorkerPoolInit( CrosWorkerPool *p, int n_threads )
+{
+  int i;
+
+  if( n_threads <= 0 )
+    return -1;
+
+  p->ready_first = NULL;
+  p->ready_last = NULL;
+  p->stopping = 0;
+  p->n_threads = 0;
+  p->threads = (CrosThread *)malloc( n_threads * sizeof(CrosThread) );
+  if( p->threads == NULL )
+  {
+    PRINT_ERROR("cRosWorkerPoolInit() : Can't allocate memory\n");
+    return -1;
+  }
+
+  if( cRosMutexInit( &(p->lock) ) != 0 )
+  {
+    free( p->threads );
+    return -1;
+  }
+  if( cRosCondInit( &(p->work_ready) ) != 0 )
+  {
+    cRosMutexRelease( &(p->lock) );
+    free( p->threads );
+    return -1;
+  }
+  if( cRosCondInit( &(p->strand_done) ) != 0 )
+  {
+    cRosCondRelease( &(p->work_ready) );
+    cRosMutexRelease( &(p->lock) );
+    free( p->threads );
+    return -1;
+  }
+
+  for( i = 0; i < n_threads; i++ )
+  {
+    if( cRosThreadCreate( &(p->threads[i]), workerThread, p ) != 0 )
+    {
+      cRosWorkerPoolRelease( p ); // Stop the threads already started
+      return -1;
+    }
+    p->n_threads++;
+  }
+
+  return 0;
+}
+
+void cRosWorkerPoolRelease( CrosWorkerPool *p )
+{
+  int i;
+
+  cRosMutexLock( &(p->lock) );
+  p->stopping = 1;
+  cRosCondBroadcast( &(p->work_ready) );
+  cRosMutexUnlock( &(p->lock) );
+
+  for( i = 0; i < p->n_threads; i++ )
+    cRosThreadJoin( &(p->threads[i]) );
+
+  cRosCondRelease( &(p->strand_done) );
+  cRosCondRelease( &(p->work_ready) );
+  cRosMutexRelease( &(p->lock) );
+  free( p->threads );
+  p->threads = NULL;
+  p->n_threads = 0;
+}
+
+int cRosWorkStrandInit( CrosWorkStrand *s, CrosWorkerPool *p, int capacity )
+{
+  if( capacity <= 0 )
+    return -1;
+
+  s->items = (CrosWorkItem *)malloc( capacity * sizeof(CrosWorkItem) );
+  if( s->items == NULL )
+  {
+    PRINT_ERROR("cRosWorkStrandInit() : Can't allocate memory\n");
+    return -1;
+  }
+
+  s->pool = p;
+  s->capacity = capacity;
+  s->first = 0;
+  s->count = 0;
+  s->scheduled = 0;
+  s->running = 0;
+  s->next_ready = NULL;
+  s->n_rejected = 0;
+  return 0;
+}
+
+void cRosWorkStrandRelease( CrosWorkStrand *s )
+{
+  CrosWorkerPool *p = s->pool;
+  CrosWorkItem *items;
+  int first, count, i;
+
+  if( p == NULL )
+    return;
+
+  cRosMutexLock( &(p->lock) );
+  // The waiting items are taken from the strand before waiting for the running one, otherwise the pool threads
+  // would keep starting them and the strand would only be released when its queue is empty
+  if( s->scheduled )
+    removeReadyStrand( p, s );
+  items = s->items;
+  first = s->first;
+  count = s->count;
+  s->count = 0;
+  while( s->running )
+    cRosCondWait( &(p->strand_done), &(p->lock) );
+  cRosMutexUnlock( &(p->lock) );
+
+  // No pool thread references the strand anymore, so the items are canceled without holding the lock
+  for( i = 0; i < count; i++ )
+  {
+    CrosWorkItem *item = &(items[(first + i) % s->capacity]);
+    item->func( item->arg, 1 );
+  }
+
+  free( items );
+  s->items = NULL;
+  s->pool = NULL;
+  s->capacity = 0;
+  s->first = 0;
+  s->count = 0;
+  s->scheduled = 0;
+}
+
+int cRosWorkStrandPost( CrosWorkStrand *s, CrosWorkCallback func, void *arg )
+{
+  CrosWorkerPool *p = s->pool;
+  CrosWorkItem *item;
+
+  cRosMutexLock( &(p->lock) );
+  if( s->count == s->capacity )
+  {
+    s->n_rejected++;
+    cRosMutexUnlock( &(p->lock) );
+    return -1;
+  }
+
+  item = &(s->items[(s->first + s->count) % s->capacity]);
+  item->func = func;
+  item->arg = arg;
+  s->count++;
+
+  if( !s->scheduled )
+  {
+    s->scheduled = 1;
+    appendReadyStrand( p, s );
+    cRosCondSignal( &(p->work_ready) );
+  }
+  cRosMutexUnlock( &(p->lock) );
+  return 0;
+}
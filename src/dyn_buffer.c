@@ -17,6 +17,16 @@ void dynBufferInit ( DynBuffer *d_buf )
   d_buf->max = 0;
 }
 
+void dynBufferInitView ( DynBuffer *d_buf, const unsigned char *data, size_t n )
+{
+  PRINT_VVDEBUG ( "dynBufferInitView()\n" );
+
+  d_buf->data = (unsigned char *)data;
+  d_buf->size = n;
+  d_buf->pos_offset = 0;
+  d_buf->max = n;
+}
+
 void dynBufferRelease ( DynBuffer *d_buf )
 {
   PRINT_VVDEBUG ( "dynBufferRelease()\n" );
@@ -29,48 +39,76 @@ void dynBufferRelease ( DynBuffer *d_buf )
   d_buf->max = 0;
 }
 
-int dynBufferPushBackBuf ( DynBuffer *d_buf, const unsigned char *new_buf, size_t n )
+unsigned char *dynBufferReserve ( DynBuffer *d_buf, size_t n )
 {
-  PRINT_VVDEBUG ( "dynBufferPushBackBuf()\n" );
-
-  if (new_buf == NULL && n > 0) // If n == 0, the function accepts NULL as new_buf since nothing have to be appended
-  {
-    PRINT_ERROR ( "dynBufferPushBackBuf() : Invalid function argument values: new buffer content must be different from NULL and no shorter than 0\n" );
-    return -1;
-  }
+  PRINT_VVDEBUG ( "dynBufferReserve()\n" );
 
   if ( d_buf->data == NULL )
   {
-    PRINT_VVDEBUG ( "dynBufferPushBackBuf() : allocate memory for the first time\n" );
+    PRINT_VVDEBUG ( "dynBufferReserve() : allocate memory for the first time\n" );
     d_buf->data = ( unsigned char * ) malloc ( DYNBUFFER_INIT_SIZE * sizeof ( unsigned char ) );
 
     if ( d_buf->data == NULL )
     {
-      PRINT_ERROR ( "dynBufferPushBackBuf() : Can't allocate memory\n" );
-      return -1;
+      PRINT_ERROR ( "dynBufferReserve() : Can't allocate memory\n" );
+      return NULL;
     }
 
     d_buf->size = 0;
     d_buf->max = DYNBUFFER_INIT_SIZE;
   }
 
-  while ( d_buf->size + n > d_buf->max )
+  if ( d_buf->size + n > d_buf->max )
   {
-    PRINT_VVDEBUG ( "dynBufferPushBackBuf() : reallocate memory\n" );
-    unsigned char *new_d_buf = ( unsigned char * ) realloc ( d_buf->data, ( DYNBUFFER_GROW_RATE * d_buf->max ) *
-                                                                             sizeof ( unsigned char ) );
+    size_t new_max = d_buf->max;
+    while ( d_buf->size + n > new_max )
+      new_max *= DYNBUFFER_GROW_RATE;
+
+    PRINT_VVDEBUG ( "dynBufferReserve() : reallocate memory\n" );
+    unsigned char *new_d_buf = ( unsigned char * ) realloc ( d_buf->data, new_max * sizeof ( unsigned char ) );
     if ( new_d_buf == NULL )
     {
-      PRINT_ERROR ( "dynBufferPushBackBuf() : Can't allocate more memory\n" );
-      return -1;
+      PRINT_ERROR ( "dynBufferReserve() : Can't allocate more memory\n" );
+      return NULL;
     }
-    d_buf->max *= DYNBUFFER_GROW_RATE;
+    d_buf->max = new_max;
     d_buf->data = new_d_buf;
   }
 
+  return d_buf->data + d_buf->size;
+}
+
+void dynBufferCommit ( DynBuffer *d_buf, size_t n )
+{
+  PRINT_VVDEBUG ( "dynBufferCommit()\n" );
+
+  if ( d_buf->size + n > d_buf->max )
+  {
+    PRINT_ERROR ( "dynBufferCommit() : More bytes committed than reserved\n" );
+    n = d_buf->max - d_buf->size;
+  }
+  d_buf->size += n;
+}
+
+int dynBufferPushBackBuf ( DynBuffer *d_buf, const unsigned char *new_buf, size_t n )
+{
+  unsigned char *tail;
+
+  PRINT_VVDEBUG ( "dynBufferPushBackBuf()\n" );
+
+  if (new_buf == NULL && n > 0) // If n == 0, the function accepts NULL as new_buf since nothing have to be appended
+  {
+    PRINT_ERROR ( "dynBufferPushBackBuf() : Invalid function argument values: new buffer content must be different from NULL and no shorter than 0\n" );
+    return -1;
+  }
+
+  tail = dynBufferReserve ( d_buf, n );
+  if ( tail == NULL )
+    return -1;
+
   if(n>0)
   {
-    memcpy ( ( void * ) ( d_buf->data + d_buf->size ), ( void * ) new_buf, n );
+    memcpy ( ( void * ) tail, ( void * ) new_buf, n );
     d_buf->size += n;
   }
 
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring_buffer.h"
+#include "cros_defs.h"
+#include "cros_log.h"
+
+void ringBufferInit( RingBuffer *r_buf )
+{
+  PRINT_VVDEBUG ( "ringBufferInit()\n" );
+
+  r_buf->data = NULL;
+  r_buf->capacity = 0;
+  r_buf->head = 0;
+  r_buf->size = 0;
+}
+
+void ringBufferRelease( RingBuffer *r_buf )
+{
+  PRINT_VVDEBUG ( "ringBufferRelease()\n" );
+
+  free( r_buf->data );
+  ringBufferInit( r_buf );
+}
+
+void ringBufferClear( RingBuffer *r_buf )
+{
+  PRINT_VVDEBUG ( "ringBufferClear()\n" );
+
+  r_buf->head = 0;
+  r_buf->size = 0;
+}
+
+int ringBufferReserve( RingBuffer *r_buf, size_t capacity )
+{
+  unsigned char *new_data;
+
+  PRINT_VVDEBUG ( "ringBufferReserve()\n" );
+
+  if( capacity <= r_buf->capacity )
+    return 0;
+
+  new_data = (unsigned char *)malloc( capacity );
+  if( new_data == NULL )
+  {
+    PRINT_ERROR ( "ringBufferReserve() : Can't allocate memory\n" );
+    return -1;
+  }
+
+  // The stored bytes are moved to the beginning of the new memory
+  ringBufferPeek( r_buf, 0, new_data, r_buf->size );
+  free( r_buf->data );
+  r_buf->data = new_data;
+  r_buf->capacity = capacity;
+  r_buf->head = 0;
+  return 0;
+}
+
+size_t ringBufferGetSize( RingBuffer *r_buf )
+{
+  return r_buf->size;
+}
+
+unsigned char *ringBufferGetWriteRegion( RingBuffer *r_buf, size_t *len )
+{
+  size_t tail;
+
+  if( r_buf->size == 0 )
+    r_buf->head = 0; // Empty buffer: the whole memory is contiguous
+
+  tail = ( r_buf->head + r_buf->size ) % ( r_buf->capacity > 0 ? r_buf->capacity : 1 );
+  if( r_buf->size == r_buf->capacity )
+    *len = 0;
+  else if( tail >= r_buf->head )
+    *len = r_buf->capacity - tail;
+  else
+    *len = r_buf->head - tail;
+
+  return r_buf->data + tail;
+}
+
+void ringBufferCommit( RingBuffer *r_buf, size_t n )
+{
+  r_buf->size += n;
+}
+
+const unsigned char *ringBufferGetReadRegion( RingBuffer *r_buf, size_t *len )
+{
+  if( r_buf->head + r_buf->size > r_buf->capacity )
+    *len = r_buf->capacity - r_buf->head;
+  else
+    *len = r_buf->size;
+
+  return r_buf->data + r_buf->head;
+}
+
+int ringBufferPeek( RingBuffer *r_buf, size_t offset, void *dst, size_t n )
+{
+  size_t start, first_len;
+
+  if( offset + n > r_buf->size )
+    return -1;
+
+  if( n == 0 )
+    return 0;
+
+  start = ( r_buf->head + offset ) % r_buf->capacity;
+  first_len = r_buf->capacity - start;
+  if( first_len >= n )
+    memcpy( dst, r_buf->data + start, n );
+  else
+  {
+    memcpy( dst, r_buf->data + start, first_len );
+    memcpy( (unsigned char *)dst + first_len, r_buf->data, n - first_len );
+  }
+  return 0;
+}
+
+void ringBufferConsume( RingBuffer *r_buf, size_t n )
+{
+  if( n >= r_buf->size )
+  {
+    r_buf->head = 0;
+    r_buf->size = 0;
+  }
+  else
+  {
+    r_buf->head = ( r_buf->head + n ) % r_buf->capacity;
+    r_buf->size -= n;
+  }
+}
@@ -0,0 +1,39 @@
+#include <stdlib.h>
+
+#include "shared_buffer.h"
+#include "cros_atomic.h"
+#include "cros_defs.h"
+#include "cros_log.h"
+
+SharedBuffer *sharedBufferNewFrom( DynBuffer *d_buf )
+{
+  PRINT_VVDEBUG ( "sharedBufferNewFrom()\n" );
+
+  SharedBuffer *s_buf = ( SharedBuffer * ) malloc ( sizeof ( SharedBuffer ) );
+  if ( s_buf == NULL )
+  {
+    PRINT_ERROR ( "sharedBufferNewFrom() : Can't allocate memory\n" );
+    return NULL;
+  }
+
+  s_buf->ref_count = 1;
+  s_buf->buffer = *d_buf;
+  dynBufferInit( d_buf );
+  return s_buf;
+}
+
+SharedBuffer *sharedBufferRetain( SharedBuffer *s_buf )
+{
+  if ( s_buf != NULL )
+    CROS_ATOMIC_FETCH_ADD_INT( &(s_buf->ref_count), 1 );
+  return s_buf;
+}
+
+void sharedBufferRelease( SharedBuffer *s_buf )
+{
+  if ( s_buf == NULL || CROS_ATOMIC_FETCH_ADD_INT( &(s_buf->ref_count), -1 ) != 1 )
+    return;
+
+  dynBufferRelease( &(s_buf->buffer) );
+  free( s_buf );
+}
@@ -34,6 +34,11 @@ typedef int fn_socklen_t;
 #  include <netinet/tcp.h>
 #  include <arpa/inet.h>
 #  include <errno.h>
+#  include <sys/uio.h>
+#  ifdef __linux__
+#    include <linux/errqueue.h>
+#    include <sys/eventfd.h>
+#  endif
 #  define closesocket close
 
 // connect()/accept()/send()/recv()/select() error codes:
@@ -52,6 +57,16 @@ typedef socklen_t fn_socklen_t;
 #endif
 
 #define TCPIP_SOCKET_READ_BUFFER_SIZE 2048
+// Maximum number of memory regions passed to each sendmsg() call
+#define TCPIP_SOCKET_MAX_IOV 16
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#  define TCPIP_SOCKET_HAS_ZEROCOPY 1
+#else
+#  define TCPIP_SOCKET_HAS_ZEROCOPY 0
+#endif
+// Number of large send operations of a socket done by copying the data after the kernel refuses MSG_ZEROCOPY
+#define TCPIP_SOCKET_ZEROCOPY_BACKOFF 64
 // Definitions for debug messages only.
 // Console virtual-terminal color sequences (supported on Linux and on Windows 10 build 16257 and later):
 #define ANSI_COLOR_GREEN   "\x1b[32m"
@@ -73,6 +88,11 @@ void tcpIpSocketInit ( TcpIpSocket *s )
   s->connected = 0;
   s->listening = 0;
   s->is_nonblocking = 0;
+  s->ev_events = 0;
+  s->zerocopy = 0;
+  s->zc_sent = 0;
+  s->zc_completed = 0;
+  s->zc_backoff = 0;
 }
 
 int tcpIpSocketOpen ( TcpIpSocket *s )
@@ -188,6 +208,159 @@ int tcpIpSocketSetNoDelay ( TcpIpSocket *s )
   }
 }
 
+int tcpIpSocketSetZeroCopy ( TcpIpSocket *s )
+{
+  PRINT_VVDEBUG ( "tcpIpSocketSetZeroCopy()\n" );
+
+  if ( !s->open )
+  {
+    PRINT_ERROR ( "tcpIpSocketSetZeroCopy() : Socket not opened\n" );
+    return(0);
+  }
+
+#if TCPIP_SOCKET_HAS_ZEROCOPY
+  int enable_zerocopy = 1;
+  int ret = setsockopt ( s->fd, SOL_SOCKET, SO_ZEROCOPY, (const void *)&enable_zerocopy, sizeof(enable_zerocopy) );
+
+  if ( ret == 0 )
+  {
+    s->zerocopy = 1;
+    return(1);
+  }
+  else
+  {
+    PRINT_ERROR ( "tcpIpSocketSetZeroCopy() : setsockopt() with SO_ZEROCOPY failed. System error code: %i \n", tcpIpSocketGetError());
+    return(0);
+  }
+#else
+  PRINT_VDEBUG ( "tcpIpSocketSetZeroCopy() : MSG_ZEROCOPY is not supported on this platform\n" );
+  return(0);
+#endif
+}
+
+int tcpIpSocketPollZeroCopy ( TcpIpSocket *s )
+{
+  int n_notifications = 0;
+
+  PRINT_VVDEBUG ( "tcpIpSocketPollZeroCopy()\n" );
+
+#if TCPIP_SOCKET_HAS_ZEROCOPY
+  if ( !s->zerocopy )
+    return 0;
+
+  for(;;)
+  {
+    char control[128];
+    struct msghdr msg;
+    struct cmsghdr *cm;
+
+    memset ( &msg, 0, sizeof(msg) );
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if ( recvmsg ( s->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 )
+      break; // The error queue is empty
+
+    for ( cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm) )
+    {
+      struct sock_extended_err *serr = (struct sock_extended_err *)CMSG_DATA(cm);
+
+      if ( cm->cmsg_level != SOL_IP || cm->cmsg_type != IP_RECVERR ||
+           serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY )
+        continue;
+
+      // The notification reports that the send operations in the range [ee_info, ee_data] have completed
+      if ( (int32_t)(serr->ee_data + 1 - s->zc_completed) > 0 )
+        s->zc_completed = serr->ee_data + 1;
+      n_notifications++;
+    }
+  }
+#else
+  (void)s;
+#endif
+
+  return n_notifications;
+}
+
+int tcpIpSocketOpenNotifier ( TcpIpSocket *s )
+{
+  PRINT_VVDEBUG ( "tcpIpSocketOpenNotifier()\n" );
+
+  if ( s->open )
+    return(1);
+
+#ifdef __linux__
+  s->fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if ( s->fd == FN_INVALID_SOCKET )
+  {
+    PRINT_ERROR ( "tcpIpSocketOpenNotifier() : Can't create an eventfd. Error code: %i\n", errno );
+    return(0);
+  }
+  s->open = 1;
+  s->is_nonblocking = 1;
+#else
+  // A UDP socket connected to its own address: each notification is a datagram sent to itself
+  struct sockaddr_in addr;
+  fn_socklen_t addr_len = sizeof(addr);
+
+  s->fd = socket ( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+  if ( s->fd == FN_INVALID_SOCKET )
+  {
+    PRINT_ERROR ( "tcpIpSocketOpenNotifier() : Can't open a socket. Error code: %i\n", tcpIpSocketGetError() );
+    return(0);
+  }
+  s->open = 1;
+
+  memset( &addr, 0, sizeof(addr) );
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+  addr.sin_port = 0; // Any free port
+  if ( bind( s->fd, (struct sockaddr *)&addr, sizeof(addr) ) == FN_SOCKET_ERROR ||
+       getsockname( s->fd, (struct sockaddr *)&addr, &addr_len ) == FN_SOCKET_ERROR ||
+       connect( s->fd, (struct sockaddr *)&addr, sizeof(addr) ) == FN_SOCKET_ERROR ||
+       !tcpIpSocketSetNonBlocking( s ) )
+  {
+    PRINT_ERROR ( "tcpIpSocketOpenNotifier() : Can't set up the notification socket. Error code: %i\n", tcpIpSocketGetError() );
+    tcpIpSocketClose( s );
+    return(0);
+  }
+  s->rem_addr = addr;
+  s->connected = 1;
+#endif
+
+  PRINT_VDEBUG ( "tcpIpSocketOpenNotifier(): Created notifier FD: %i\n", s->fd );
+  return(1);
+}
+
+int tcpIpSocketNotify ( TcpIpSocket *s )
+{
+#ifdef __linux__
+  uint64_t increment = 1;
+  ssize_t n_written;
+  n_written = write( s->fd, &increment, sizeof(increment) );
+  // EAGAIN means that the counter is saturated, so the notifier is already readable
+  return( n_written == (ssize_t)sizeof(increment) || (n_written == -1 && errno == EAGAIN) );
+#else
+  char notification = 0;
+  int n_written;
+  n_written = (int)send( s->fd, &notification, sizeof(notification), 0 );
+  // If the socket buffer is full, pending notifications are already waiting to be read
+  return( n_written == (int)sizeof(notification) || (n_written == FN_SOCKET_ERROR && tcpIpSocketGetError() == FN_EWOULDBLOCK) );
+#endif
+}
+
+void tcpIpSocketClearNotifications ( TcpIpSocket *s )
+{
+#ifdef __linux__
+  uint64_t counter;
+  if ( read( s->fd, &counter, sizeof(counter) ) == -1 && errno != EAGAIN )
+    PRINT_ERROR ( "tcpIpSocketClearNotifications() : read() failed. Error code: %i\n", errno );
+#else
+  char notifications[64];
+  while ( recv( s->fd, notifications, sizeof(notifications), 0 ) > 0 )
+    continue;
+#endif
+}
+
 int tcpIpSocketSetReuse ( TcpIpSocket *s )
 {
   PRINT_VVDEBUG ( "tcpIpSocketSetReuse()\n" );
@@ -484,8 +657,19 @@ TcpIpSocketState tcpIpSocketWriteBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
 {
   PRINT_VVDEBUG ( "tcpIpSocketWriteBuffer()\n" );
 
-  const char *data = (const char *)dynBufferGetCurrentData ( d_buf );
-  int data_size = dynBufferGetRemainingDataSize ( d_buf );
+  size_t offset = dynBufferGetPoseIndicatorOffset ( d_buf );
+  TcpIpSocketState sock_state = tcpIpSocketWriteBufferFrom ( s, d_buf, &offset );
+  dynBufferSetPoseIndicator ( d_buf, offset );
+
+  return sock_state;
+}
+
+TcpIpSocketState tcpIpSocketWriteBufferFrom ( TcpIpSocket *s, DynBuffer *d_buf, size_t *offset )
+{
+  PRINT_VVDEBUG ( "tcpIpSocketWriteBufferFrom()\n" );
+
+  const char *data = (const char *)dynBufferGetData ( d_buf ) + *offset;
+  int data_size = (int)(dynBufferGetSize ( d_buf ) - *offset);
 
   if ( !s->connected )
   {
@@ -504,9 +688,9 @@ TcpIpSocketState tcpIpSocketWriteBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
     fn_error_code = tcpIpSocketGetError();
     if ( n_written > 0 )
     {
-      dynBufferMovePoseIndicator ( d_buf, n_written );
-      data = (const char *)dynBufferGetCurrentData ( d_buf );
-      data_size = dynBufferGetRemainingDataSize ( d_buf );
+      *offset += n_written;
+      data += n_written;
+      data_size -= n_written;
     }
     else if ( s->is_nonblocking &&
               ( fn_error_code == FN_EWOULDBLOCK || fn_error_code == FN_EINPROGRESS || fn_error_code == FN_EAGAIN ) )
@@ -530,6 +714,106 @@ TcpIpSocketState tcpIpSocketWriteBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
   return TCPIPSOCKET_DONE;
 }
 
+TcpIpSocketState tcpIpSocketWriteIov ( TcpIpSocket *s, const TcpIpSocketIoVec *iov, int iov_cnt, size_t *offset, size_t zerocopy_min_size )
+{
+  PRINT_VVDEBUG ( "tcpIpSocketWriteIov()\n" );
+
+  if ( !s->connected )
+  {
+    PRINT_ERROR ( "tcpIpSocketWriteIov() : Socket not connected\n" );
+    return TCPIPSOCKET_FAILED;
+  }
+
+  for(;;)
+  {
+    size_t skip = *offset, n_bytes = 0;
+    int n_written, fn_error_code, first_iov, n_iov = 0;
+
+    // Skip the regions already sent
+    for ( first_iov = 0; first_iov < iov_cnt && skip >= iov[first_iov].len; first_iov++ )
+      skip -= iov[first_iov].len;
+
+    if ( first_iov == iov_cnt )
+      return TCPIPSOCKET_DONE;
+
+#ifdef _WIN32
+    // Windows sockets do not provide sendmsg(), so the regions are sent one by one
+    n_bytes = iov[first_iov].len - skip;
+    n_written = send ( s->fd, (const char *)iov[first_iov].base + skip, (int)n_bytes, 0 );
+    n_iov = 1;
+#else
+    struct iovec os_iov[TCPIP_SOCKET_MAX_IOV];
+    struct msghdr msg;
+    int flags = 0;
+
+    for ( n_iov = 0; n_iov < TCPIP_SOCKET_MAX_IOV && first_iov + n_iov < iov_cnt; n_iov++ )
+    {
+      const TcpIpSocketIoVec *cur_iov = &iov[first_iov + n_iov];
+      os_iov[n_iov].iov_base = (void *)((const char *)cur_iov->base + skip);
+      os_iov[n_iov].iov_len = cur_iov->len - skip;
+      n_bytes += os_iov[n_iov].iov_len;
+      skip = 0;
+    }
+
+    memset ( &msg, 0, sizeof(msg) );
+    msg.msg_iov = os_iov;
+    msg.msg_iovlen = n_iov;
+
+#  if TCPIP_SOCKET_HAS_ZEROCOPY
+    if ( s->zerocopy && zerocopy_min_size > 0 && n_bytes >= zerocopy_min_size )
+    {
+      if ( s->zc_backoff > 0 )
+        s->zc_backoff--;
+      else
+        flags |= MSG_ZEROCOPY;
+    }
+#  endif
+
+    n_written = sendmsg ( s->fd, &msg, flags );
+#  if TCPIP_SOCKET_HAS_ZEROCOPY
+    // MSG_ZEROCOPY fails with ENOBUFS when the socket option memory or the locked-page limit is exhausted. The same
+    // regions are sent again by copying them, and the next large sends of the socket are copied too for a while
+    if ( n_written < 0 && ( flags & MSG_ZEROCOPY ) && tcpIpSocketGetError() == ENOBUFS )
+    {
+      PRINT_VDEBUG ( "tcpIpSocketWriteIov() : zero copy refused by the kernel. Sending a copy\n" );
+      flags &= ~MSG_ZEROCOPY;
+      s->zc_backoff = TCPIP_SOCKET_ZEROCOPY_BACKOFF;
+      n_written = sendmsg ( s->fd, &msg, flags );
+    }
+#  endif
+#endif
+    fn_error_code = tcpIpSocketGetError();
+
+    PRINT_VDEBUG ( "tcpIpSocketWriteIov() : %d of %lu bytes written from %d regions\n", n_written, (unsigned long)n_bytes, n_iov );
+
+    if ( n_written > 0 )
+    {
+#if !defined(_WIN32) && TCPIP_SOCKET_HAS_ZEROCOPY
+      if ( flags & MSG_ZEROCOPY )
+        s->zc_sent++;
+#endif
+      *offset += n_written;
+    }
+    else if ( s->is_nonblocking &&
+              ( fn_error_code == FN_EWOULDBLOCK || fn_error_code == FN_EINPROGRESS || fn_error_code == FN_EAGAIN ) )
+    {
+      PRINT_VDEBUG ( "tcpIpSocketWriteIov() : write in progress\n" );
+      return TCPIPSOCKET_IN_PROGRESS;
+    }
+    else if ( fn_error_code == FN_ENOTCONN || fn_error_code == FN_ECONNRESET )
+    {
+      PRINT_VDEBUG ( "tcpIpSocketWriteIov() : socket disconnected\n" );
+      s->connected = 0;
+      return  TCPIPSOCKET_DISCONNECTED;
+    }
+    else
+    {
+      PRINT_ERROR ( "tcpIpSocketWriteIov() : Write failed. Error code: %i\n", fn_error_code);
+      return TCPIPSOCKET_FAILED;
+    }
+  }
+}
+
 TcpIpSocketState tcpIpSocketWriteString ( TcpIpSocket *s, DynString *d_str )
 {
   PRINT_VVDEBUG ( "tcpIpSocketWriteString()\n" );
@@ -587,65 +871,76 @@ TcpIpSocketState tcpIpSocketReadBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
 
 TcpIpSocketState tcpIpSocketReadBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size_t max_size, size_t *n_reads)
 {
-  int recv_ret, fn_error_code;
-  char *read_buf;
+  unsigned char *read_buf;
 
   PRINT_VVDEBUG ( "tcpIpSocketReadBufferEx()\n" );
 
   *n_reads = 0;
-  if ( !s->connected )
+  // The data is received directly at the end of the dynamic buffer
+  read_buf = dynBufferReserve(d_buf, max_size);
+  if (read_buf == NULL)
   {
-    PRINT_ERROR ( "tcpIpSocketReadBufferEx() : Socket not connected\n" );
+    PRINT_ERROR("tcpIpSocketReadBufferEx() : Out of memory allocating %lu bytes before reading from socket", (unsigned long)max_size);
     return TCPIPSOCKET_FAILED;
   }
 
-  read_buf = (char *)malloc(max_size);
-  if (read_buf == NULL)
+  TcpIpSocketState state = tcpIpSocketReadData( s, read_buf, max_size, n_reads );
+  if( state == TCPIPSOCKET_DONE )
+    dynBufferCommit( d_buf, *n_reads );
+
+  return state;
+}
+
+TcpIpSocketState tcpIpSocketReadData( TcpIpSocket *s, void *buf, size_t max_size, size_t *n_reads )
+{
+  int recv_ret, fn_error_code;
+
+  PRINT_VVDEBUG ( "tcpIpSocketReadData()\n" );
+
+  *n_reads = 0;
+  if ( !s->connected )
   {
-    PRINT_ERROR("tcpIpSocketReadBufferEx() : Out of memory allocating %lu bytes before reading from socket", (unsigned long)max_size);
+    PRINT_ERROR ( "tcpIpSocketReadData() : Socket not connected\n" );
     return TCPIPSOCKET_FAILED;
   }
 
   TcpIpSocketState state = TCPIPSOCKET_UNKNOWN;
-  recv_ret = recv ( s->fd, read_buf, max_size, 0);
+  recv_ret = recv ( s->fd, buf, max_size, 0);
   fn_error_code = tcpIpSocketGetError();
   if ( recv_ret == 0 )
   {
-    PRINT_VDEBUG ( "tcpIpSocketReadBufferEx() : socket disconnectd\n" );
+    PRINT_VDEBUG ( "tcpIpSocketReadData() : socket disconnectd\n" );
     s->connected = 0;
     state = TCPIPSOCKET_DISCONNECTED;
   }
   else if ( recv_ret > 0 )
   {
-    PRINT_VDEBUG ( "tcpIpSocketReadBufferEx() : read %d bytes \n", recv_ret );
+    PRINT_VDEBUG ( "tcpIpSocketReadData() : read %d bytes \n", recv_ret );
     #if CROS_DEBUG_LEVEL >= 2
-    printTransmissionBuffer((const char *)read_buf, "tcpIpSocketReadBufferEx() : Buffer", ANSI_COLOR_CYAN, s->fd, recv_ret);
+    printTransmissionBuffer((const char *)buf, "tcpIpSocketReadData() : Buffer", ANSI_COLOR_CYAN, s->fd, recv_ret);
     #endif
 
-    dynBufferPushBackBuf ( d_buf, (const unsigned char *)read_buf, recv_ret );
     state = TCPIPSOCKET_DONE;
     *n_reads = recv_ret;
   }
   else if ( s->is_nonblocking &&
             ( fn_error_code == FN_EWOULDBLOCK || fn_error_code == FN_EINPROGRESS || fn_error_code == FN_EAGAIN ) )
   {
-    PRINT_VDEBUG ( "tcpIpSocketReadBufferEx() : read in progress\n" );
+    PRINT_VDEBUG ( "tcpIpSocketReadData() : read in progress\n" );
     state = TCPIPSOCKET_IN_PROGRESS;
   }
   else if ( fn_error_code == FN_ENOTCONN || fn_error_code == FN_ECONNRESET )
   {
-    PRINT_VDEBUG ( "tcpIpSocketReadBufferEx() : socket disconnectd\n" );
+    PRINT_VDEBUG ( "tcpIpSocketReadData() : socket disconnectd\n" );
     s->connected = 0;
     state = TCPIPSOCKET_DISCONNECTED;
   }
   else
   {
-    PRINT_ERROR ( "tcpIpSocketReadBufferEx() : Read through socket failed. Error code: %i\n", fn_error_code);
+    PRINT_ERROR ( "tcpIpSocketReadData() : Read through socket failed. Error code: %i\n", fn_error_code);
     state = TCPIPSOCKET_FAILED;
   }
 
-  free(read_buf);
-
   return state;
 }
 
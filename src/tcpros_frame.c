@@ -0,0 +1,265 @@
+#include <stdlib.h>
+
+#include "tcpros_frame.h"
+#include "cros_defs.h"
+
+TcprosFrame *tcprosFrameNew( void )
+{
+  TcprosFrame *f = (TcprosFrame *)malloc( sizeof(TcprosFrame) );
+  if( f == NULL )
+  {
+    PRINT_ERROR("tcprosFrameNew() : Can't allocate memory\n");
+    return NULL;
+  }
+
+  dynBufferInit( &(f->packet) );
+  f->size_field = 0;
+  f->segments = NULL;
+  f->n_segments = 0;
+  f->max_segments = 0;
+  f->packet_seg_start = 0;
+  f->iov = NULL;
+  f->iov_cnt = 0;
+  f->ref_count = 1;
+  return f;
+}
+
+static TcprosFrameSegment *addSegment( TcprosFrame *f )
+{
+  if( f->n_segments == f->max_segments )
+  {
+    int new_max = (f->max_segments == 0)? 4 : 2 * f->max_segments;
+    TcprosFrameSegment *new_segments = (TcprosFrameSegment *)realloc( f->segments, new_max * sizeof(TcprosFrameSegment) );
+    if( new_segments == NULL )
+    {
+      PRINT_ERROR("addSegment() : Can't allocate memory\n");
+      return NULL;
+    }
+    f->segments = new_segments;
+    f->max_segments = new_max;
+  }
+
+  TcprosFrameSegment *seg = &(f->segments[f->n_segments++]);
+  seg->ext_data = NULL;
+  seg->offset = 0;
+  seg->len = 0;
+  seg->release = NULL;
+  seg->release_context = NULL;
+  return seg;
+}
+
+// Add a segment with the bytes serialized in the packet since the previous segment (if any)
+static int closePacketSegment( TcprosFrame *f )
+{
+  size_t packet_size = dynBufferGetSize( &(f->packet) );
+  TcprosFrameSegment *seg;
+
+  if( packet_size == f->packet_seg_start )
+    return 0;
+
+  seg = addSegment( f );
+  if( seg == NULL )
+    return -1;
+
+  seg->offset = f->packet_seg_start;
+  seg->len = packet_size - f->packet_seg_start;
+  f->packet_seg_start = packet_size;
+  return 0;
+}
+
+int tcprosFrameAppendExternal( TcprosFrame *f, const void *data, size_t len,
+                               TcprosFrameReleaseCallback release, void *release_context )
+{
+  TcprosFrameSegment *seg;
+
+  if( closePacketSegment( f ) != 0 )
+    return -1;
+
+  seg = addSegment( f );
+  if( seg == NULL )
+    return -1;
+
+  seg->ext_data = data;
+  seg->len = len;
+  seg->release = release;
+  seg->release_context = release_context;
+  return 0;
+}
+
+int tcprosFrameSeal( TcprosFrame *f )
+{
+  uint32_t content_size = 0;
+  int i;
+
+  if( closePacketSegment( f ) != 0 )
+    return -1;
+
+  f->iov = (TcpIpSocketIoVec *)malloc( (f->n_segments + 1) * sizeof(TcpIpSocketIoVec) );
+  if( f->iov == NULL )
+  {
+    PRINT_ERROR("tcprosFrameSeal() : Can't allocate memory\n");
+    return -1;
+  }
+
+  // The packet memory does not change anymore, so the regions can point to it
+  for( i = 0; i < f->n_segments; i++ )
+  {
+    TcprosFrameSegment *seg = &(f->segments[i]);
+    f->iov[i + 1].base = (seg->ext_data != NULL)? seg->ext_data : dynBufferGetData( &(f->packet) ) + seg->offset;
+    f->iov[i + 1].len = seg->len;
+    content_size += (uint32_t)seg->len;
+  }
+
+  f->size_field = HOST_TO_ROS_UINT32( content_size );
+  f->iov[0].base = &(f->size_field);
+  f->iov[0].len = sizeof(uint32_t);
+  f->iov_cnt = f->n_segments + 1;
+  return 0;
+}
+
+TcprosFrame *tcprosFrameRetain( TcprosFrame *f )
+{
+  f->ref_count++;
+  return f;
+}
+
+void tcprosFrameRelease( TcprosFrame *f )
+{
+  if( f == NULL )
+    return;
+
+  if( --f->ref_count == 0 )
+  {
+    int i;
+    for( i = 0; i < f->n_segments; i++ )
+      if( f->segments[i].release != NULL )
+        f->segments[i].release( f->segments[i].release_context );
+
+    dynBufferRelease( &(f->packet) );
+    free( f->segments );
+    free( f->iov );
+    free( f );
+  }
+}
+
+void tcprosFrameQueueInit( TcprosFrameQueue *q )
+{
+  q->entries = NULL;
+  q->capacity = 0;
+  q->first = 0;
+  q->count = 0;
+  q->policy = TCPROS_FRAME_QUEUE_DROP_OLDEST;
+  q->n_dropped = 0;
+}
+
+void tcprosFrameQueueRelease( TcprosFrameQueue *q )
+{
+  tcprosFrameQueueClear( q );
+  free( q->entries );
+  q->entries = NULL;
+  q->capacity = 0;
+}
+
+int tcprosFrameQueueSetCapacity( TcprosFrameQueue *q, int capacity )
+{
+  TcprosFrameQueueEntry *new_entries;
+  int i;
+
+  if( capacity <= 0 )
+    return -1;
+
+  if( capacity == q->capacity )
+    return 0;
+
+  new_entries = (TcprosFrameQueueEntry *)malloc( capacity * sizeof(TcprosFrameQueueEntry) );
+  if( new_entries == NULL )
+  {
+    PRINT_ERROR("tcprosFrameQueueSetCapacity() : Can't allocate memory\n");
+    return -1;
+  }
+
+  // Keep the newest frames
+  while( q->count > capacity )
+  {
+    tcprosFrameRelease( tcprosFrameQueuePop( q ) );
+    q->n_dropped++;
+  }
+
+  for( i = 0; i < q->count; i++ )
+    new_entries[i] = q->entries[(q->first + i) % q->capacity];
+
+  free( q->entries );
+  q->entries = new_entries;
+  q->capacity = capacity;
+  q->first = 0;
+  return 0;
+}
+
+int tcprosFrameQueuePush( TcprosFrameQueue *q, TcprosFrame *f )
+{
+  return tcprosFrameQueuePushTagged( q, f, 0 );
+}
+
+int tcprosFrameQueuePushTagged( TcprosFrameQueue *q, TcprosFrame *f, uint32_t tag )
+{
+  TcprosFrameQueueEntry *entry;
+  int ret = 0;
+
+  if( q->count == q->capacity )
+  {
+    switch( q->policy )
+    {
+      case TCPROS_FRAME_QUEUE_DROP_OLDEST:
+        if( q->count == 0 )
+          return -1; // No room at all
+        tcprosFrameRelease( tcprosFrameQueuePop( q ) );
+        q->n_dropped++;
+        ret = 1;
+        break;
+
+      case TCPROS_FRAME_QUEUE_DROP_NEWEST:
+        q->n_dropped++;
+        return 1;
+
+      case TCPROS_FRAME_QUEUE_DISCONNECT:
+      default:
+        return -1;
+    }
+  }
+
+  entry = &(q->entries[(q->first + q->count) % q->capacity]);
+  entry->frame = tcprosFrameRetain( f );
+  entry->tag = tag;
+  q->count++;
+  return ret;
+}
+
+TcprosFrame *tcprosFrameQueuePop( TcprosFrameQueue *q )
+{
+  TcprosFrame *f;
+
+  if( q->count == 0 )
+    return NULL;
+
+  f = q->entries[q->first].frame;
+  q->first = (q->first + 1) % q->capacity;
+  q->count--;
+  return f;
+}
+
+TcprosFrame *tcprosFrameQueuePeek( TcprosFrameQueue *q, uint32_t *tag )
+{
+  if( q->count == 0 )
+    return NULL;
+
+  if( tag != NULL )
+    *tag = q->entries[q->first].tag;
+  return q->entries[q->first].frame;
+}
+
+void tcprosFrameQueueClear( TcprosFrameQueue *q )
+{
+  while( q->count > 0 )
+    tcprosFrameRelease( tcprosFrameQueuePop( q ) );
+  q->first = 0;
+}
@@ -1,5 +1,6 @@
 #include "tcpros_process.h"
 #include "cros_clock.h"
+#include "cros_defs.h"
 #include <stdlib.h>
 
 void tcprosProcessInit( TcprosProcess *p )
@@ -14,6 +15,15 @@ void tcprosProcessInit( TcprosProcess *p )
   dynStringInit( &(p->serviceresponse_type) );
   dynStringInit( &(p->md5sum) );
   dynBufferInit( &(p->packet) );
+  p->frame = NULL;
+  p->frame_offset = 0;
+  tcprosFrameQueueInit( &(p->frame_queue) );
+  p->frame_zc_sent = 0;
+  p->zerocopy_min_size = 0;
+  tcprosFrameQueueInit( &(p->zc_frames) );
+  p->zc_frames.policy = TCPROS_FRAME_QUEUE_DISCONNECT; // The queue grows instead of discarding frames
+  ringBufferInit( &(p->recv_buffer) );
+  p->read_paused = 0;
   p->latching = p->tcp_nodelay = p->persistent = 0;
   p->probe = 0;
   p->last_change_time = 0;
@@ -23,6 +33,15 @@ void tcprosProcessInit( TcprosProcess *p )
   p->left_to_recv = 0;
   p->sub_tcpros_host = NULL;
   p->sub_tcpros_port = -1;
+  p->event_backend = NULL;
+  p->event_tag = 0;
+  p->idle_slots = NULL;
+  p->slot_idx = -1;
+  p->in_idle_slots = 0;
+  p->connect_slots = NULL;
+  p->in_connect_slots = 0;
+  p->in_pending_slots = 0;
+  p->svc_work_seq = 0;
 }
 
 void tcprosProcessRelease( TcprosProcess *p )
@@ -38,6 +57,10 @@ void tcprosProcessRelease( TcprosProcess *p )
   dynStringRelease( &(p->serviceresponse_type) );
   dynStringRelease( &(p->md5sum) );
   dynBufferRelease( &(p->packet) );
+  tcprosProcessSetFrame( p, NULL );
+  tcprosFrameQueueRelease( &(p->frame_queue) );
+  tcprosFrameQueueRelease( &(p->zc_frames) );
+  ringBufferRelease( &(p->recv_buffer) );
   free(p->sub_tcpros_host);
 }
 
@@ -50,6 +73,11 @@ void tcprosProcessClear( TcprosProcess *p)
 void tcprosProcessReset( TcprosProcess *p)
 {
   tcprosProcessClear( p );
+  tcprosProcessSetFrame( p, NULL );
+  tcprosFrameQueueClear( &(p->frame_queue) );
+  tcprosFrameQueueClear( &(p->zc_frames) ); // Empty unless the kernel still used them when the socket was closed (see tcprosProcessDetachZeroCopyFrames())
+  p->zerocopy_min_size = 0;
+  ringBufferClear( &(p->recv_buffer) );
 
   dynStringClear( &(p->topic) );
   dynStringClear( &(p->caller_id) );
@@ -72,8 +100,137 @@ void tcprosProcessReset( TcprosProcess *p)
   tcprosProcessChangeState( p, TCPROS_PROCESS_STATE_IDLE );
 }
 
+void tcprosProcessSetFrame( TcprosProcess *p, TcprosFrame *f )
+{
+  if( f != NULL )
+    tcprosFrameRetain( f );
+  tcprosFrameRelease( p->frame );
+  p->frame = f;
+  p->frame_offset = 0;
+  p->frame_zc_sent = p->socket.zc_sent;
+}
+
+// Keep the frame of the process until the kernel releases it if it has been sent (partially) with zero copy
+static void keepZeroCopyFrame( TcprosProcess *p )
+{
+  if( p->frame != NULL && p->socket.zc_sent != p->frame_zc_sent )
+  {
+    TcprosFrameQueue *zc_frames = &(p->zc_frames);
+    if( zc_frames->count == zc_frames->capacity )
+      tcprosFrameQueueSetCapacity( zc_frames, (zc_frames->capacity == 0)? 4 : 2 * zc_frames->capacity );
+    if( tcprosFrameQueuePushTagged( zc_frames, p->frame, p->socket.zc_sent ) < 0 )
+      PRINT_ERROR("keepZeroCopyFrame() : Can't keep a frame sent with zero copy\n");
+    p->frame_zc_sent = p->socket.zc_sent;
+  }
+}
+
+int tcprosProcessNextFrame( TcprosProcess *p )
+{
+  TcprosFrame *f;
+
+  keepZeroCopyFrame( p );
+  f = tcprosFrameQueuePop( &(p->frame_queue) );
+  tcprosProcessSetFrame( p, f );
+  tcprosFrameRelease( f ); // The reference of the queue is now held by p->frame
+  return (f != NULL);
+}
+
+int tcprosProcessReleaseZeroCopyFrames( TcprosProcess *p )
+{
+  TcprosFrame *f;
+  uint32_t last_send;
+  int n_notifications;
+
+  n_notifications = tcpIpSocketPollZeroCopy( &(p->socket) );
+
+  // The send operations are completed in order, so the frames are released in order too
+  while( (f = tcprosFrameQueuePeek( &(p->zc_frames), &last_send )) != NULL &&
+         (int32_t)(p->socket.zc_completed - last_send) >= 0 )
+    tcprosFrameRelease( tcprosFrameQueuePop( &(p->zc_frames) ) );
+
+  return n_notifications;
+}
+
+int tcprosProcessZeroCopyInUse( TcprosProcess *p )
+{
+  if( !p->socket.zerocopy )
+    return 0;
+
+  keepZeroCopyFrame( p );
+  tcprosProcessReleaseZeroCopyFrames( p );
+  return (p->zc_frames.count > 0);
+}
+
+void tcprosProcessDetachZeroCopyFrames( TcprosProcess *p, TcprosProcess *dst )
+{
+  // The socket of dst is not monitored: its notifications are read by polling the error queue
+  if( p->event_backend != NULL )
+    cRosEventBackendSetInterest( p->event_backend, &(p->socket), 0, p->event_tag );
+  tcpIpSocketDisconnect( &(p->socket) ); // The peer gets the data already sent and then the end of the connection
+
+  dst->socket = p->socket;
+  dst->zc_frames = p->zc_frames;
+  dst->last_change_time = cRosClockGetTimeMs();
+  tcpIpSocketInit( &(p->socket) );
+  tcprosFrameQueueInit( &(p->zc_frames) );
+  p->zc_frames.policy = TCPROS_FRAME_QUEUE_DISCONNECT;
+}
+
 void tcprosProcessChangeState( TcprosProcess *p, TcprosProcessState state )
 {
   p->state = state;
+  if( state == TCPROS_PROCESS_STATE_IDLE )
+    p->read_paused = 0; // The next connection of the process is read normally
   p->last_change_time = cRosClockGetTimeMs();
+  tcprosProcessUpdateEvents( p );
+
+  // An idle process can be reused by the node to attend a new connection
+  if( state == TCPROS_PROCESS_STATE_IDLE && p->idle_slots != NULL && !p->in_idle_slots &&
+      cRosSlotTablePushFree( p->idle_slots, p->slot_idx ) == 0 )
+    p->in_idle_slots = 1;
+
+  // The node starts the connection in its next cycle
+  if( state == TCPROS_PROCESS_STATE_CONNECTING && p->connect_slots != NULL && !p->in_connect_slots &&
+      cRosSlotListPush( p->connect_slots, p->slot_idx ) == 0 )
+    p->in_connect_slots = 1;
+}
+
+void tcprosProcessUpdateEvents( TcprosProcess *p )
+{
+  unsigned int events;
+
+  if( p->event_backend == NULL )
+    return;
+
+  switch( p->state )
+  {
+    case TCPROS_PROCESS_STATE_CONNECTING: // The connection completion is notified through the write-ready event
+    case TCPROS_PROCESS_STATE_WRITING_HEADER:
+    case TCPROS_PROCESS_STATE_START_WRITING:
+    case TCPROS_PROCESS_STATE_WRITING:
+      events = CROS_EVENT_WRITE | CROS_EVENT_EXCEPT;
+      break;
+    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+    case TCPROS_PROCESS_STATE_READING_SIZE:
+    case TCPROS_PROCESS_STATE_READING:
+      events = (p->read_paused)? CROS_EVENT_EXCEPT : CROS_EVENT_READ | CROS_EVENT_EXCEPT;
+      break;
+    case TCPROS_PROCESS_STATE_WAIT_FOR_WRITING: // Only watch for errors until a new message must be sent
+      events = CROS_EVENT_EXCEPT;
+      break;
+    default:
+      events = 0;
+  }
+
+  cRosEventBackendSetInterest( p->event_backend, &(p->socket), events, p->event_tag );
+}
+
+void tcprosProcessPauseReading( TcprosProcess *p, int pause )
+{
+  if( p->read_paused == (pause != 0) )
+    return;
+
+  p->read_paused = (pause != 0);
+  tcprosProcessUpdateEvents( p );
 }
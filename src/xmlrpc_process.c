@@ -17,6 +17,13 @@ void xmlrpcProcessInit( XmlrpcProcess *p )
   p->last_change_time = 0;
   memset(p->host, 0, sizeof(p->host));
   p->port = -1;
+  p->event_backend = NULL;
+  p->event_tag = 0;
+  p->idle_slots = NULL;
+  p->slot_idx = -1;
+  p->in_idle_slots = 0;
+  p->connect_slots = NULL;
+  p->in_connect_slots = 0;
 }
 
 void xmlrpcProcessRelease( XmlrpcProcess *p )
@@ -59,4 +66,38 @@ void xmlrpcProcessChangeState( XmlrpcProcess *p, XmlrpcProcessState state )
 {
   p->state = state;
   p->last_change_time = cRosClockGetTimeMs();
+  xmlrpcProcessUpdateEvents( p );
+
+  // An idle process can be reused by the node to attend a new connection
+  if( state == XMLRPC_PROCESS_STATE_IDLE && p->idle_slots != NULL && !p->in_idle_slots &&
+      cRosSlotTablePushFree( p->idle_slots, p->slot_idx ) == 0 )
+    p->in_idle_slots = 1;
+
+  // The node starts the connection in its next cycle
+  if( state == XMLRPC_PROCESS_STATE_CONNECTING && p->connect_slots != NULL && !p->in_connect_slots &&
+      cRosSlotListPush( p->connect_slots, p->slot_idx ) == 0 )
+    p->in_connect_slots = 1;
+}
+
+void xmlrpcProcessUpdateEvents( XmlrpcProcess *p )
+{
+  unsigned int events;
+
+  if( p->event_backend == NULL )
+    return;
+
+  switch( p->state )
+  {
+    case XMLRPC_PROCESS_STATE_CONNECTING: // The connection completion is notified through the write-ready event
+    case XMLRPC_PROCESS_STATE_WRITING:
+      events = CROS_EVENT_WRITE | CROS_EVENT_EXCEPT;
+      break;
+    case XMLRPC_PROCESS_STATE_READING:
+      events = CROS_EVENT_READ | CROS_EVENT_EXCEPT;
+      break;
+    default:
+      events = 0;
+  }
+
+  cRosEventBackendSetInterest( p->event_backend, &(p->socket), events, p->event_tag );
 }
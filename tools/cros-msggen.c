@@ -0,0 +1,734 @@
+/*! \file cros-msggen.c
+ *  \brief Build-time generator of C message types (see cros_typed_message.h)
+ *
+ *  Usage: cros-msggen <msg_root_dir> <output_dir> <pkg/Type.msg | pkg/Type.srv>...
+ *  For each message or service file (relative to msg_root_dir) it writes the header <output_dir>/<pkg>/<Type>.h,
+ *  together with the headers of the custom message types used by its fields. The MD5 sums are computed by the
+ *  cROS library from the same files that the dynamic cRosMessage model would load at run time.
+ *  The function cros_generate_messages() of cmake/CrosMessages.cmake runs this tool as a build step.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#  include <direct.h>
+#  define makeDir(path) _mkdir(path)
+#  define DIR_SEPARATOR_STR "\\"
+#else
+#  include <sys/stat.h>
+#  define makeDir(path) mkdir(path, 0777)
+#  define DIR_SEPARATOR_STR "/"
+#endif
+
+#include "cros_message.h"
+#include "cros_message_internal.h"
+#include "cros_service.h"
+#include "cros_service_internal.h"
+
+#define MAX_NAME_LEN 256
+#define MAX_FUNC_NAME_LEN (MAX_NAME_LEN + 32) // Names built by adding a suffix to a type name
+
+typedef enum ElemKind
+{
+  ELEM_NUMERIC = 0, // Numeric, bool, time and duration: they are copied as they are
+  ELEM_STRING,
+  ELEM_HEADER,
+  ELEM_MSG
+} ElemKind;
+
+// Element of a field of the generated struct (the field itself or the elements of an array field)
+typedef struct ElemType
+{
+  ElemKind kind;
+  const char *c_type;
+  size_t size; // Serialized size of the numeric elements
+  char c_msg_type[MAX_NAME_LEN]; // C type of the custom message elements
+  cRosMessageDef *msg_def; // Definition of the custom message elements
+} ElemType;
+
+static const char *Msg_root_dir;
+static const char *Output_dir;
+static char **Generated_types = NULL; // Message types whose header has already been written
+static int N_generated_types = 0;
+
+static void fail(const char *reason, const char *name)
+{
+  fprintf(stderr, "cros-msggen: %s: %s\n", reason, name);
+  exit(EXIT_FAILURE);
+}
+
+// C identifier of the type pkg/Name: pkg_Name
+static void buildCName(char *c_name, const char *package, const char *name)
+{
+  char *c;
+
+  snprintf(c_name, MAX_NAME_LEN, "%s_%s", package, name);
+  for(c = c_name; *c != '\0'; c++)
+    if(!isalnum((unsigned char)*c))
+      *c = '_';
+}
+
+static void buildUpperName(char *upper_name, const char *c_name)
+{
+  size_t i;
+
+  for(i = 0; c_name[i] != '\0' && i < MAX_NAME_LEN - 1; i++)
+    upper_name[i] = (char)toupper((unsigned char)c_name[i]);
+  upper_name[i] = '\0';
+}
+
+static void getElemType(msgFieldDef *field_def, ElemType *elem)
+{
+  elem->kind = ELEM_NUMERIC;
+  elem->msg_def = NULL;
+  elem->c_msg_type[0] = '\0';
+  switch(field_def->type)
+  {
+    case CROS_STD_MSGS_INT8: elem->c_type = "int8_t"; elem->size = 1; break;
+    case CROS_STD_MSGS_UINT8: elem->c_type = "uint8_t"; elem->size = 1; break;
+    case CROS_STD_MSGS_INT16: elem->c_type = "int16_t"; elem->size = 2; break;
+    case CROS_STD_MSGS_UINT16: elem->c_type = "uint16_t"; elem->size = 2; break;
+    case CROS_STD_MSGS_INT32: elem->c_type = "int32_t"; elem->size = 4; break;
+    case CROS_STD_MSGS_UINT32: elem->c_type = "uint32_t"; elem->size = 4; break;
+    case CROS_STD_MSGS_INT64: elem->c_type = "int64_t"; elem->size = 8; break;
+    case CROS_STD_MSGS_UINT64: elem->c_type = "uint64_t"; elem->size = 8; break;
+    case CROS_STD_MSGS_FLOAT32: elem->c_type = "float"; elem->size = 4; break;
+    case CROS_STD_MSGS_FLOAT64: elem->c_type = "double"; elem->size = 8; break;
+    case CROS_STD_MSGS_BOOL: elem->c_type = "uint8_t"; elem->size = 1; break;
+    case CROS_STD_MSGS_CHAR: elem->c_type = "uint8_t"; elem->size = 1; break;
+    case CROS_STD_MSGS_BYTE: elem->c_type = "int8_t"; elem->size = 1; break;
+    case CROS_STD_MSGS_TIME: elem->c_type = "cRosTypedTime"; elem->size = 8; break;
+    case CROS_STD_MSGS_DURATION: elem->c_type = "cRosTypedDuration"; elem->size = 8; break;
+    case CROS_STD_MSGS_STRING: elem->kind = ELEM_STRING; elem->c_type = "char *"; elem->size = 0; break;
+    case CROS_STD_MSGS_HEADER: elem->kind = ELEM_HEADER; elem->c_type = "cRosTypedHeader"; elem->size = 0; break;
+    default:
+      if(field_def->child_msg_def == NULL)
+        fail("Unsupported type of field", field_def->name);
+      elem->kind = ELEM_MSG;
+      elem->msg_def = field_def->child_msg_def;
+      buildCName(elem->c_msg_type, elem->msg_def->package, elem->msg_def->name);
+      elem->c_type = elem->c_msg_type;
+      elem->size = 0;
+      break;
+  }
+}
+
+static int hasFields(cRosMessageDef *msg_def)
+{
+  return msg_def != NULL && msg_def->first_field->next != NULL;
+}
+
+// Minimum number of bytes of a serialized message of the type (used to reject array lengths that cannot fit in a packet)
+static size_t minWireSize(cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+  size_t size = 0;
+
+  for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+  {
+    ElemType elem;
+    size_t elem_size;
+
+    getElemType(field_def, &elem);
+    switch(elem.kind)
+    {
+      case ELEM_NUMERIC: elem_size = elem.size; break;
+      case ELEM_STRING: elem_size = sizeof(uint32_t); break;
+      case ELEM_HEADER: elem_size = 3 * sizeof(uint32_t) + sizeof(uint32_t); break;
+      default: elem_size = minWireSize(elem.msg_def); break;
+    }
+    if(!field_def->is_array)
+      size += elem_size;
+    else if(field_def->array_size >= 0)
+      size += field_def->array_size * elem_size;
+    else
+      size += sizeof(uint32_t);
+  }
+  return size;
+}
+
+// 1 if the generated functions need a loop index: arrays whose elements are not copied as they are
+static int needsElemLoop(cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+  {
+    ElemType elem;
+    getElemType(field_def, &elem);
+    if(field_def->is_array && elem.kind != ELEM_NUMERIC)
+      return 1;
+  }
+  return 0;
+}
+
+static int hasVarArrays(cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    if(field_def->is_array && field_def->array_size < 0)
+      return 1;
+  return 0;
+}
+
+static void printStringLiteral(FILE *f, const char *text)
+{
+  const char *c;
+
+  fprintf(f, "  \"");
+  for(c = (text != NULL)? text : ""; *c != '\0'; c++)
+  {
+    switch(*c)
+    {
+      case '\\': fprintf(f, "\\\\"); break;
+      case '"': fprintf(f, "\\\""); break;
+      case '\t': fprintf(f, "\\t"); break;
+      case '\r': fprintf(f, "\\r"); break;
+      case '\n':
+        fprintf(f, "\\n\"");
+        if(c[1] != '\0')
+          fprintf(f, " \\\n  \"");
+        else
+          return;
+        break;
+      default:
+        if((unsigned char)*c < 0x20)
+          fprintf(f, "\\%03o", (unsigned char)*c);
+        else
+          fputc(*c, f);
+        break;
+    }
+  }
+  fprintf(f, "\"");
+}
+
+static void printDefinitionMacros(FILE *f, const char *upper_name, const char *md5sum, const char *text)
+{
+  fprintf(f, "#define %s_MD5SUM \"%s\"\n", upper_name, md5sum);
+  fprintf(f, "#define %s_DEFINITION \\\n", upper_name);
+  printStringLiteral(f, text);
+  fprintf(f, "\n\n");
+}
+
+static void printConstants(FILE *f, const char *upper_name, cRosMessageDef *msg_def)
+{
+  msgConst *const_def;
+  int n_consts = 0;
+
+  for(const_def = msg_def->first_const; const_def->next != NULL; const_def = const_def->next)
+  {
+    if(const_def->type == CROS_STD_MSGS_STRING)
+    {
+      fprintf(f, "#define %s_%s \\\n", upper_name, const_def->name);
+      printStringLiteral(f, const_def->value);
+      fprintf(f, "\n");
+    }
+    else
+    {
+      msgFieldDef const_field;
+      ElemType elem;
+
+      initFieldDef(&const_field);
+      const_field.type = const_def->type;
+      const_field.name = const_def->name;
+      getElemType(&const_field, &elem);
+      fprintf(f, "#define %s_%s ((%s)%s)\n", upper_name, const_def->name, elem.c_type, const_def->value);
+    }
+    n_consts++;
+  }
+  if(n_consts > 0)
+    fprintf(f, "\n");
+}
+
+static void printStruct(FILE *f, const char *c_name, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  fprintf(f, "typedef struct %s %s;\n", c_name, c_name);
+  fprintf(f, "struct %s\n{\n", c_name);
+  if(!hasFields(msg_def))
+    fprintf(f, "  uint8_t empty_; //! The message type has no fields\n");
+  else
+  {
+    for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    {
+      ElemType elem;
+      const char *type_sep;
+
+      getElemType(field_def, &elem);
+      type_sep = (elem.kind == ELEM_STRING)? "" : " ";
+      if(!field_def->is_array)
+        fprintf(f, "  %s%s%s;\n", elem.c_type, type_sep, field_def->name);
+      else if(field_def->array_size >= 0)
+        fprintf(f, "  %s%s%s[%d];\n", elem.c_type, type_sep, field_def->name, field_def->array_size);
+      else
+        fprintf(f, "  %s%s*%s;\n  uint32_t %s_size;\n  uint32_t %s_capacity;\n", elem.c_type, type_sep, field_def->name,
+                field_def->name, field_def->name);
+    }
+  }
+  fprintf(f, "};\n\n");
+}
+
+// Name of the function that handles the elements of a field (e.g. release), or NULL for the numeric elements
+static const char *elemFunction(const ElemType *elem, const char *func, char *func_name)
+{
+  switch(elem->kind)
+  {
+    case ELEM_STRING:
+      if(strcmp(func, "release") == 0)
+        strcpy(func_name, "free");
+      else
+        snprintf(func_name, MAX_FUNC_NAME_LEN, "cRosTypedString%c%s", toupper((unsigned char)func[0]), func + 1);
+      break;
+    case ELEM_HEADER:
+      snprintf(func_name, MAX_FUNC_NAME_LEN, "cRosTypedHeader%c%s", toupper((unsigned char)func[0]), func + 1);
+      break;
+    case ELEM_MSG:
+      snprintf(func_name, MAX_FUNC_NAME_LEN, "%s_%s", elem->c_msg_type, func);
+      break;
+    default:
+      return NULL;
+  }
+  return func_name;
+}
+
+// Number of elements of an array field as a C expression
+static void arrayLenExpr(msgFieldDef *field_def, char *expr)
+{
+  if(field_def->array_size >= 0)
+    snprintf(expr, MAX_NAME_LEN, "%d", field_def->array_size);
+  else
+    snprintf(expr, MAX_NAME_LEN, "msg->%s_size", field_def->name);
+}
+
+static void printInitRelease(FILE *f, const char *c_name, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  fprintf(f, "static inline void %s_init(%s *msg)\n{\n  memset(msg, 0, sizeof(*msg));\n}\n\n", c_name, c_name);
+
+  fprintf(f, "static inline void %s_release(%s *msg)\n{\n", c_name, c_name);
+  if(hasFields(msg_def))
+  {
+    if(needsElemLoop(msg_def))
+      fprintf(f, "  uint32_t i;\n\n");
+    for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    {
+      ElemType elem;
+      char func_name[MAX_FUNC_NAME_LEN];
+      const char *amp, *elem_func;
+
+      getElemType(field_def, &elem);
+      elem_func = elemFunction(&elem, "release", func_name);
+      amp = (elem.kind == ELEM_STRING)? "" : "&";
+      if(!field_def->is_array)
+      {
+        if(elem_func != NULL)
+          fprintf(f, "  %s(%smsg->%s);\n", elem_func, amp, field_def->name);
+      }
+      else if(field_def->array_size >= 0)
+      {
+        if(elem_func != NULL)
+          fprintf(f, "  for(i = 0; i < %d; i++)\n    %s(%smsg->%s[i]);\n", field_def->array_size, elem_func, amp, field_def->name);
+      }
+      else
+      {
+        // The elements beyond the size are zeroed, so freeing up to the capacity also covers the arrays shrunk by the user
+        if(elem_func != NULL)
+          fprintf(f, "  for(i = 0; i < msg->%s_size || i < msg->%s_capacity; i++)\n    %s(%smsg->%s[i]);\n",
+                  field_def->name, field_def->name, elem_func, amp, field_def->name);
+        fprintf(f, "  free(msg->%s);\n", field_def->name);
+      }
+    }
+  }
+  fprintf(f, "  memset(msg, 0, sizeof(*msg));\n}\n\n");
+}
+
+static void printSize(FILE *f, const char *c_name, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+  size_t fixed_size = 0;
+  int is_fixed = 1; // The messages of the type always have the same size
+
+  if(hasFields(msg_def))
+  {
+    for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    {
+      ElemType elem;
+      getElemType(field_def, &elem);
+      if(field_def->is_array && field_def->array_size < 0)
+        fixed_size += sizeof(uint32_t);
+      else if(elem.kind == ELEM_NUMERIC)
+        fixed_size += elem.size * (field_def->is_array? field_def->array_size : 1);
+      if(elem.kind != ELEM_NUMERIC || (field_def->is_array && field_def->array_size < 0))
+        is_fixed = 0;
+    }
+  }
+
+  fprintf(f, "static inline size_t %s_size(const %s *msg)\n{\n", c_name, c_name);
+  if(is_fixed)
+  {
+    fprintf(f, "  (void)msg;\n  return %lu;\n}\n\n", (unsigned long)fixed_size);
+    return;
+  }
+  fprintf(f, "  size_t size = %lu;\n", (unsigned long)fixed_size);
+  if(needsElemLoop(msg_def))
+    fprintf(f, "  uint32_t i;\n");
+  fprintf(f, "\n");
+  for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+  {
+    ElemType elem;
+    char func_name[MAX_FUNC_NAME_LEN], len_expr[MAX_NAME_LEN];
+    const char *amp, *elem_func;
+
+    getElemType(field_def, &elem);
+    elem_func = elemFunction(&elem, "size", func_name);
+    amp = (elem.kind == ELEM_STRING)? "" : "&";
+    if(!field_def->is_array)
+    {
+      if(elem_func != NULL)
+        fprintf(f, "  size += %s(%smsg->%s);\n", elem_func, amp, field_def->name);
+      continue;
+    }
+    arrayLenExpr(field_def, len_expr);
+    if(elem_func != NULL)
+      fprintf(f, "  for(i = 0; i < %s; i++)\n    size += %s(%smsg->%s[i]);\n", len_expr, elem_func, amp, field_def->name);
+    else if(field_def->array_size < 0)
+      fprintf(f, "  size += (size_t)%s * %lu;\n", len_expr, (unsigned long)elem.size);
+  }
+  fprintf(f, "  return size;\n}\n\n");
+}
+
+static void printPack(FILE *f, const char *c_name, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  fprintf(f, "static inline unsigned char *%s_pack(const %s *msg, unsigned char *dst)\n{\n", c_name, c_name);
+  if(hasFields(msg_def))
+  {
+    if(needsElemLoop(msg_def))
+      fprintf(f, "  uint32_t i;\n\n");
+    for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    {
+      ElemType elem;
+      char func_name[MAX_FUNC_NAME_LEN], len_expr[MAX_NAME_LEN];
+      const char *elem_func;
+
+      getElemType(field_def, &elem);
+      elem_func = elemFunction(&elem, "pack", func_name);
+      if(!field_def->is_array)
+      {
+        if(elem.kind == ELEM_STRING)
+          fprintf(f, "  dst = %s(dst, msg->%s);\n", elem_func, field_def->name);
+        else if(elem_func != NULL)
+          fprintf(f, "  dst = %s(&msg->%s, dst);\n", elem_func, field_def->name);
+        else
+          fprintf(f, "  memcpy(dst, &msg->%s, %lu);\n  dst += %lu;\n", field_def->name, (unsigned long)elem.size, (unsigned long)elem.size);
+        continue;
+      }
+      arrayLenExpr(field_def, len_expr);
+      if(field_def->array_size < 0)
+        fprintf(f, "  dst = cRosTypedPackUInt32(dst, %s);\n", len_expr);
+      if(elem_func == NULL)
+      {
+        if(field_def->array_size < 0)
+          fprintf(f, "  if(%s > 0)\n    memcpy(dst, msg->%s, (size_t)%s * %lu);\n  dst += (size_t)%s * %lu;\n", len_expr, field_def->name,
+                  len_expr, (unsigned long)elem.size, len_expr, (unsigned long)elem.size);
+        else
+          fprintf(f, "  memcpy(dst, msg->%s, %lu);\n  dst += %lu;\n", field_def->name,
+                  (unsigned long)(elem.size * field_def->array_size), (unsigned long)(elem.size * field_def->array_size));
+      }
+      else if(elem.kind == ELEM_STRING)
+        fprintf(f, "  for(i = 0; i < %s; i++)\n    dst = %s(dst, msg->%s[i]);\n", len_expr, elem_func, field_def->name);
+      else
+        fprintf(f, "  for(i = 0; i < %s; i++)\n    dst = %s(&msg->%s[i], dst);\n", len_expr, elem_func, field_def->name);
+    }
+  }
+  else
+    fprintf(f, "  (void)msg;\n");
+  fprintf(f, "  return dst;\n}\n\n");
+}
+
+static void printUnpack(FILE *f, const char *c_name, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+
+  fprintf(f, "static inline cRosErrCodePack %s_unpack(%s *msg, const unsigned char **src, const unsigned char *end)\n{\n", c_name, c_name);
+  fprintf(f, "  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;\n");
+  if(hasFields(msg_def))
+  {
+    if(needsElemLoop(msg_def))
+      fprintf(f, "  uint32_t i;\n");
+    if(hasVarArrays(msg_def))
+      fprintf(f, "  uint32_t n_elems;\n");
+    fprintf(f, "\n");
+    for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+    {
+      ElemType elem;
+      char func_name[MAX_FUNC_NAME_LEN], release_name[MAX_FUNC_NAME_LEN], len_expr[MAX_NAME_LEN];
+      const char *name = field_def->name, *elem_func, *release_func;
+
+      getElemType(field_def, &elem);
+      elem_func = elemFunction(&elem, "unpack", func_name);
+      release_func = elemFunction(&elem, "release", release_name);
+      if(!field_def->is_array)
+      {
+        if(elem_func != NULL)
+          fprintf(f, "  if(ret_err == CROS_SUCCESS_ERR_PACK)\n    ret_err = %s(&msg->%s, src, end);\n", elem_func, name);
+        else
+          fprintf(f, "  if(ret_err == CROS_SUCCESS_ERR_PACK)\n    ret_err = cRosTypedUnpackBytes(&msg->%s, %lu, src, end);\n",
+                  name, (unsigned long)elem.size);
+        continue;
+      }
+      arrayLenExpr(field_def, len_expr);
+      if(field_def->array_size < 0)
+      {
+        size_t min_elem_size;
+
+        switch(elem.kind)
+        {
+          case ELEM_NUMERIC: min_elem_size = elem.size; break;
+          case ELEM_MSG: min_elem_size = minWireSize(elem.msg_def); break;
+          case ELEM_HEADER: min_elem_size = 4 * sizeof(uint32_t); break;
+          default: min_elem_size = sizeof(uint32_t); break;
+        }
+        fprintf(f, "  if(ret_err == CROS_SUCCESS_ERR_PACK)\n    ret_err = cRosTypedUnpackArrayLen(&n_elems, %lu, src, end);\n",
+                (unsigned long)min_elem_size);
+        fprintf(f, "  if(ret_err == CROS_SUCCESS_ERR_PACK)\n  {\n");
+        if(release_func != NULL)
+        {
+          fprintf(f, "    for(i = n_elems; i < msg->%s_size; i++)\n", name);
+          if(elem.kind == ELEM_STRING)
+            fprintf(f, "    {\n      free(msg->%s[i]);\n      msg->%s[i] = NULL;\n    }\n", name, name);
+          else
+            fprintf(f, "      %s(&msg->%s[i]);\n", release_func, name); // The release functions zero the element
+        }
+        fprintf(f, "    ret_err = cRosTypedArrayReserve((void **)&msg->%s, &msg->%s_capacity, n_elems, sizeof(*msg->%s));\n", name, name, name);
+        fprintf(f, "    if(ret_err == CROS_SUCCESS_ERR_PACK)\n      msg->%s_size = n_elems;\n  }\n", name);
+      }
+      if(elem_func == NULL)
+        fprintf(f, "  if(ret_err == CROS_SUCCESS_ERR_PACK)\n    ret_err = cRosTypedUnpackBytes(msg->%s, (size_t)%s * %lu, src, end);\n",
+                name, len_expr, (unsigned long)elem.size);
+      else
+        fprintf(f, "  for(i = 0; i < %s && ret_err == CROS_SUCCESS_ERR_PACK; i++)\n    ret_err = %s(&msg->%s[i], src, end);\n",
+                len_expr, elem_func, name);
+    }
+  }
+  else
+    fprintf(f, "  (void)msg;\n  (void)src;\n  (void)end;\n");
+  fprintf(f, "  return ret_err;\n}\n\n");
+}
+
+static void printTypeDescriptor(FILE *f, const char *c_name, const char *type_name, const char *upper_name)
+{
+  fprintf(f, "static inline void %s_typedInit(void *msg) { %s_init((%s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static inline void %s_typedRelease(void *msg) { %s_release((%s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static inline size_t %s_typedSize(const void *msg) { return %s_size((const %s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static inline unsigned char *%s_typedPack(const void *msg, unsigned char *dst) { return %s_pack((const %s *)msg, dst); }\n",
+          c_name, c_name, c_name);
+  fprintf(f, "static inline cRosErrCodePack %s_typedUnpack(void *msg, const unsigned char **src, const unsigned char *end)"
+             " { return %s_unpack((%s *)msg, src, end); }\n\n", c_name, c_name, c_name);
+
+  fprintf(f, "static inline const cRosTypedMessageType *%s_type(void)\n{\n", c_name);
+  fprintf(f, "  static const cRosTypedMessageType type = {\"%s\", %s_MD5SUM, %s_DEFINITION, sizeof(%s),\n", type_name,
+          upper_name, upper_name, c_name);
+  fprintf(f, "    %s_typedInit, %s_typedRelease, %s_typedSize, %s_typedPack, %s_typedUnpack};\n", c_name, c_name, c_name, c_name, c_name);
+  fprintf(f, "  return &type;\n}\n\n");
+}
+
+// Struct, functions and type description of a message. The MD5 sum and definition macros are those of desc_upper_name
+static void printMessageType(FILE *f, const char *c_name, cRosMessageDef *msg_def, const char *type_name, const char *desc_upper_name)
+{
+  char upper_name[MAX_NAME_LEN];
+
+  buildUpperName(upper_name, c_name);
+  if(msg_def != NULL)
+    printConstants(f, upper_name, msg_def);
+  printStruct(f, c_name, msg_def);
+  printInitRelease(f, c_name, msg_def);
+  printSize(f, c_name, msg_def);
+  printPack(f, c_name, msg_def);
+  printUnpack(f, c_name, msg_def);
+  printTypeDescriptor(f, c_name, type_name, desc_upper_name);
+}
+
+static int isGenerated(const char *type_name)
+{
+  int type_ind;
+
+  for(type_ind = 0; type_ind < N_generated_types; type_ind++)
+    if(strcmp(Generated_types[type_ind], type_name) == 0)
+      return 1;
+  return 0;
+}
+
+static void addGenerated(const char *type_name)
+{
+  Generated_types = (char **)realloc(Generated_types, (N_generated_types + 1) * sizeof(char *));
+  if(Generated_types == NULL || (Generated_types[N_generated_types] = strdup(type_name)) == NULL)
+    fail("Can't allocate memory", type_name);
+  N_generated_types++;
+}
+
+static FILE *openHeader(const char *package, const char *name, const char *src_ext)
+{
+  char path[4096], c_name[MAX_NAME_LEN], upper_name[MAX_NAME_LEN];
+  FILE *f;
+
+  makeDir(Output_dir); // They may already exist
+  snprintf(path, sizeof(path), "%s%s%s", Output_dir, DIR_SEPARATOR_STR, package);
+  makeDir(path);
+  snprintf(path, sizeof(path), "%s%s%s%s%s.h", Output_dir, DIR_SEPARATOR_STR, package, DIR_SEPARATOR_STR, name);
+  f = fopen(path, "w");
+  if(f == NULL)
+    fail("Can't create the file", path);
+
+  buildCName(c_name, package, name);
+  buildUpperName(upper_name, c_name);
+  fprintf(f, "/*! \\file %s/%s.h\n", package, name);
+  fprintf(f, " *  \\brief C type of %s/%s generated by cros-msggen from %s/%s.%s. Do not edit it\n */\n\n", package, name, package, name, src_ext);
+  fprintf(f, "#ifndef _CROS_MSG_%s_H_\n#define _CROS_MSG_%s_H_\n\n", upper_name, upper_name);
+  fprintf(f, "#include \"cros_typed_message.h\"\n");
+  return f;
+}
+
+static void closeHeader(FILE *f)
+{
+  fprintf(f, "#endif\n");
+  if(fclose(f) != 0)
+    fail("Error writing a header", "");
+}
+
+static void generateMessageDef(cRosMessageDef *msg_def);
+
+// Generate the headers of the custom types used by the fields of msg_def and include them
+static void includeFieldTypes(FILE *f, cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def;
+  char type_name[MAX_NAME_LEN];
+
+  if(msg_def == NULL)
+    return;
+  for(field_def = msg_def->first_field; field_def->next != NULL; field_def = field_def->next)
+  {
+    if(field_def->type != CROS_CUSTOM_TYPE || field_def->child_msg_def == NULL)
+      continue;
+    generateMessageDef(field_def->child_msg_def);
+    snprintf(type_name, sizeof(type_name), "%s/%s.h", field_def->child_msg_def->package, field_def->child_msg_def->name);
+    fprintf(f, "#include \"%s\"\n", type_name);
+  }
+}
+
+static void generateMessageDef(cRosMessageDef *msg_def)
+{
+  char type_name[MAX_NAME_LEN], c_name[MAX_NAME_LEN], upper_name[MAX_NAME_LEN];
+  cRosMessage *msg;
+  FILE *f;
+
+  snprintf(type_name, sizeof(type_name), "%s/%s", msg_def->package, msg_def->name);
+  if(isGenerated(type_name))
+    return;
+  addGenerated(type_name);
+
+  // The MD5 sum of the type is computed as the dynamic messages do
+  if(cRosMessageBuildFromDef(&msg, msg_def) != CROS_SUCCESS_ERR_PACK)
+    fail("Can't compute the MD5 sum of the message type", type_name);
+
+  f = openHeader(msg_def->package, msg_def->name, FILEEXT_MSG);
+  includeFieldTypes(f, msg_def);
+  fprintf(f, "\n");
+  buildCName(c_name, msg_def->package, msg_def->name);
+  buildUpperName(upper_name, c_name);
+  printDefinitionMacros(f, upper_name, msg->md5sum, msg_def->plain_text);
+  printMessageType(f, c_name, msg_def, type_name, upper_name);
+  closeHeader(f);
+  cRosMessageFree(msg);
+}
+
+static void generateMessage(const char *msg_type)
+{
+  cRosMessage *msg;
+
+  if(cRosMessageNewBuild(Msg_root_dir, msg_type, &msg) != CROS_SUCCESS_ERR_PACK)
+    fail("Can't load the message type", msg_type);
+  generateMessageDef(msg->msgDef);
+  cRosMessageFree(msg);
+}
+
+static void generateService(const char *srv_type)
+{
+  char path[4096], type_name[MAX_NAME_LEN], c_name[MAX_NAME_LEN], part_name[MAX_FUNC_NAME_LEN], upper_name[MAX_NAME_LEN];
+  char md5sum[33], *definition = NULL;
+  cRosMessage *request = NULL, *response = NULL;
+  const char *name;
+  char *package;
+  FILE *f;
+
+  snprintf(path, sizeof(path), "%s%s%s.%s", Msg_root_dir, DIR_SEPARATOR_STR, srv_type, FILEEXT_SRV);
+  if(cRosServiceBuildInner(&request, &response, &definition, md5sum, path) != CROS_SUCCESS_ERR_PACK)
+    fail("Can't load the service type", srv_type);
+
+  strncpy(type_name, srv_type, sizeof(type_name) - 1);
+  type_name[sizeof(type_name) - 1] = '\0';
+  package = type_name;
+  name = strchr(type_name, '/');
+  if(name == NULL)
+    fail("The service type must be pkg/Type", srv_type);
+  type_name[name - type_name] = '\0';
+  name++;
+
+  f = openHeader(package, name, FILEEXT_SRV);
+  includeFieldTypes(f, (request != NULL)? request->msgDef : NULL);
+  includeFieldTypes(f, (response != NULL)? response->msgDef : NULL);
+  fprintf(f, "\n");
+  buildCName(c_name, package, name);
+  buildUpperName(upper_name, c_name);
+  printDefinitionMacros(f, upper_name, md5sum, definition);
+  // The requests and responses are identified by the service type
+  snprintf(part_name, sizeof(part_name), "%sRequest", c_name);
+  printMessageType(f, part_name, (request != NULL)? request->msgDef : NULL, srv_type, upper_name);
+  snprintf(part_name, sizeof(part_name), "%sResponse", c_name);
+  printMessageType(f, part_name, (response != NULL)? response->msgDef : NULL, srv_type, upper_name);
+  closeHeader(f);
+
+  cRosMessageFree(request);
+  cRosMessageFree(response);
+  free(definition);
+}
+
+int main(int argc, char **argv)
+{
+  int arg_ind;
+
+  if(argc < 4)
+  {
+    fprintf(stderr, "Usage: %s <msg_root_dir> <output_dir> <pkg/Type.msg | pkg/Type.srv>...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  Msg_root_dir = argv[1];
+  Output_dir = argv[2];
+
+  for(arg_ind = 3; arg_ind < argc; arg_ind++)
+  {
+    char type_name[MAX_NAME_LEN];
+    char *ext;
+
+    strncpy(type_name, argv[arg_ind], sizeof(type_name) - 1);
+    type_name[sizeof(type_name) - 1] = '\0';
+    ext = strrchr(type_name, '.');
+    if(ext == NULL)
+      fail("The file must have the extension .msg or .srv", argv[arg_ind]);
+    *ext++ = '\0';
+    if(strcmp(ext, FILEEXT_MSG) == 0)
+      generateMessage(type_name);
+    else if(strcmp(ext, FILEEXT_SRV) == 0)
+      generateService(type_name);
+    else
+      fail("The file must have the extension .msg or .srv", argv[arg_ind]);
+  }
+  return EXIT_SUCCESS;
+}